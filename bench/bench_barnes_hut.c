@@ -0,0 +1,143 @@
+#include "bench_util.h"
+#include "body.h"
+#include "forces.h"
+#include "quadtree.h"
+#include "scene.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+const double BENCH_SECONDS = 1.0;
+const double G = 1.0;
+const double DT = 0.001;
+const double MIN_DISTANCE = 5.0;
+const double SPACE_WIDTH = 1000.0;
+const double SPACE_HEIGHT = 500.0;
+// the number of masses for the accuracy sweep
+const size_t FIELD_COUNT = 20000;
+// the field is compared against the exact sum at this many of them
+const size_t ERROR_SAMPLES = 200;
+const double THETAS[] = {0.0, 0.3, 0.5, 0.7, 1.0};
+// pairwise force creators get too slow and big much beyond this
+const size_t PAIRWISE_COUNT = 500;
+// what the nbodies demo runs
+const size_t DEMO_COUNT = 50000;
+const double DEMO_THETA = 0.7;
+
+void random_masses(vector_t *points, double *masses, size_t count) {
+  srand(9);
+  for (size_t i = 0; i < count; i++) {
+    points[i] = (vector_t){SPACE_WIDTH * rand() / RAND_MAX,
+                           SPACE_HEIGHT * rand() / RAND_MAX};
+    masses[i] = 5.0 + 15.0 * rand() / RAND_MAX;
+  }
+}
+
+vector_t exact_field(const vector_t *points, const double *masses,
+                     size_t count, vector_t point) {
+  vector_t field = VEC_ZERO;
+  for (size_t i = 0; i < count; i++) {
+    double dx = points[i].x - point.x, dy = points[i].y - point.y;
+    double squared = dx * dx + dy * dy;
+    if (squared >= MIN_DISTANCE * MIN_DISTANCE) {
+      double scale = masses[i] / (squared * sqrt(squared));
+      field.x += dx * scale;
+      field.y += dy * scale;
+    }
+  }
+  return field;
+}
+
+/**
+ * Times building the tree and finding the field at every mass,
+ * i.e. one tick's worth of gravity, and reports its error against
+ * the exact field.
+ */
+void bench_theta(double theta, const vector_t *points, const double *masses,
+                 const vector_t *exact) {
+  quadtree_t *tree = quadtree_init();
+  size_t iterations = 0;
+  double start = bench_now();
+  double elapsed = 0.0;
+  while (elapsed < BENCH_SECONDS) {
+    quadtree_build(tree, points, masses, FIELD_COUNT);
+    for (size_t i = 0; i < FIELD_COUNT; i++) {
+      quadtree_field(tree, points[i], theta, MIN_DISTANCE);
+    }
+    iterations++;
+    elapsed = bench_now() - start;
+  }
+  char name[64];
+  snprintf(name, sizeof(name), "field/theta=%.1f", theta);
+  bench_report(name, FIELD_COUNT, elapsed, iterations);
+
+  double error = 0.0;
+  double magnitude = 0.0;
+  for (size_t i = 0; i < ERROR_SAMPLES; i++) {
+    vector_t point = points[i * (FIELD_COUNT / ERROR_SAMPLES)];
+    vector_t field = quadtree_field(tree, point, theta, MIN_DISTANCE);
+    double dx = field.x - exact[i].x, dy = field.y - exact[i].y;
+    error += dx * dx + dy * dy;
+    magnitude += exact[i].x * exact[i].x + exact[i].y * exact[i].y;
+  }
+  printf("%-28s rms relative error %.2e\n", name, sqrt(error / magnitude));
+  quadtree_free(tree);
+}
+
+scene_t *make_scene(size_t count, bool pairwise, double theta) {
+  vector_t *points = malloc(sizeof(vector_t) * count);
+  double *masses = malloc(sizeof(double) * count);
+  random_masses(points, masses, count);
+  scene_t *scene = scene_init();
+  for (size_t i = 0; i < count; i++) {
+    body_t *body =
+        body_init(bench_square(points[i], 2.0), masses[i], (rgb_color_t){0});
+    scene_add_body(scene, body);
+    for (size_t j = 0; pairwise && j < i; j++) {
+      create_newtonian_gravity(scene, G, body, scene_get_body(scene, j));
+    }
+  }
+  if (!pairwise) {
+    create_barnes_hut_gravity(scene, G, theta, SIZE_MAX);
+  }
+  free(points);
+  free(masses);
+  return scene;
+}
+
+void bench_ticks(const char *name, size_t count, bool pairwise,
+                 double theta) {
+  scene_t *scene = make_scene(count, pairwise, theta);
+  size_t ticks = 0;
+  double start = bench_now();
+  double elapsed = 0.0;
+  while (elapsed < BENCH_SECONDS) {
+    scene_tick(scene, DT);
+    ticks++;
+    elapsed = bench_now() - start;
+  }
+  bench_report(name, count, elapsed, ticks);
+  scene_free(scene);
+}
+
+int main(int argc, char *argv[]) {
+  vector_t *points = malloc(sizeof(vector_t) * FIELD_COUNT);
+  double *masses = malloc(sizeof(double) * FIELD_COUNT);
+  vector_t *exact = malloc(sizeof(vector_t) * ERROR_SAMPLES);
+  random_masses(points, masses, FIELD_COUNT);
+  for (size_t i = 0; i < ERROR_SAMPLES; i++) {
+    exact[i] = exact_field(points, masses, FIELD_COUNT,
+                           points[i * (FIELD_COUNT / ERROR_SAMPLES)]);
+  }
+  for (size_t i = 0; i < sizeof(THETAS) / sizeof(THETAS[0]); i++) {
+    bench_theta(THETAS[i], points, masses, exact);
+  }
+  free(points);
+  free(masses);
+  free(exact);
+
+  bench_ticks("tick/pairwise", PAIRWISE_COUNT, true, 0.0);
+  bench_ticks("tick/barnes_hut", PAIRWISE_COUNT, false, DEMO_THETA);
+  bench_ticks("tick/barnes_hut", DEMO_COUNT, false, DEMO_THETA);
+}
@@ -0,0 +1,103 @@
+#include "bench_util.h"
+#include "body.h"
+#include "forces.h"
+#include "map.h"
+#include "scene.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+const size_t BULLET_COUNTS[] = {500, 1000, 2000};
+// registering every pair grows quadratically, so it is only run on small n
+const size_t PAIRWISE_BULLET_COUNTS[] = {100, 200, 400};
+const size_t WARMUP_TICKS = 5;
+const double BENCH_SECONDS = 1.0;
+const double TICK_DT = 1.0 / 60.0;
+const double BENCH_BULLET_SIZE = 10.0;
+const double BENCH_BULLET_SPEED = 300.0;
+const double BENCH_BULLET_MASS = 5.0;
+// bullets spawn on a grid inside the arena walls
+const double SPAWN_MIN_X = 40.0;
+const double SPAWN_MIN_Y = 140.0;
+const double SPAWN_SPACING = 25.0;
+const size_t SPAWN_COLUMNS = 56;
+// the golden angle, so the bullets' headings are spread evenly
+const double SPAWN_ANGLE_STEP = 2.39996;
+
+/**
+ * Builds the game's map with the given number of bullets flying around it.
+ * Bullets bounce off the obstacles and each other, so the count stays fixed.
+ */
+scene_t *make_arena(size_t bullet_count) {
+  scene_t *scene = scene_init();
+  map_init(scene);
+  for (size_t i = 0; i < bullet_count; i++) {
+    vector_t center = {SPAWN_MIN_X + SPAWN_SPACING * (i % SPAWN_COLUMNS),
+                       SPAWN_MIN_Y + SPAWN_SPACING * (i / SPAWN_COLUMNS)};
+    size_t *type = malloc(sizeof(size_t));
+    *type = BULLET_TYPE;
+    body_t *bullet = body_init_with_info(
+        bench_square(center, BENCH_BULLET_SIZE), BENCH_BULLET_MASS,
+        (rgb_color_t){0, 0, 0}, type, free);
+    body_set_collision_layers(bullet, BULLET_LAYER,
+                              BULLET_LAYER | OBSTACLE_LAYER);
+    body_set_velocity(bullet, vec_rotate((vector_t){BENCH_BULLET_SPEED, 0},
+                                         (double)i * SPAWN_ANGLE_STEP));
+    scene_add_body(scene, bullet);
+  }
+  return scene;
+}
+
+/** Registers the collisions with one rule per pair of collision layers. */
+void add_layer_collisions(scene_t *scene) {
+  create_layer_physics_collision(scene, 1.0, BULLET_LAYER, BULLET_LAYER);
+  create_layer_physics_collision(scene, 1.0, BULLET_LAYER, OBSTACLE_LAYER);
+}
+
+/** Registers the same collisions with one force creator per pair of bodies. */
+void add_pairwise_collisions(scene_t *scene) {
+  for (size_t i = 0; i < scene_bodies(scene); i++) {
+    body_t *body1 = scene_get_body(scene, i);
+    for (size_t j = i + 1; j < scene_bodies(scene); j++) {
+      body_t *body2 = scene_get_body(scene, j);
+      if (body_get_type(body1) == BULLET_TYPE ||
+          body_get_type(body2) == BULLET_TYPE) {
+        create_physics_collision(scene, 1.0, body1, body2);
+      }
+    }
+  }
+}
+
+void bench_tick(const char *name, scene_t *scene, size_t bullet_count) {
+  for (size_t i = 0; i < WARMUP_TICKS; i++) {
+    scene_tick(scene, TICK_DT);
+  }
+  size_t ticks = 0;
+  double start = bench_now();
+  double elapsed = 0.0;
+  while (elapsed < BENCH_SECONDS) {
+    scene_tick(scene, TICK_DT);
+    ticks++;
+    elapsed = bench_now() - start;
+  }
+  bench_report(name, bullet_count, elapsed, ticks);
+  scene_free(scene);
+}
+
+int main(int argc, char *argv[]) {
+  for (size_t i = 0;
+       i < sizeof(PAIRWISE_BULLET_COUNTS) / sizeof(*PAIRWISE_BULLET_COUNTS);
+       i++) {
+    scene_t *scene = make_arena(PAIRWISE_BULLET_COUNTS[i]);
+    add_pairwise_collisions(scene);
+    bench_tick("pairwise_collisions", scene, PAIRWISE_BULLET_COUNTS[i]);
+
+    scene = make_arena(PAIRWISE_BULLET_COUNTS[i]);
+    add_layer_collisions(scene);
+    bench_tick("layer_collisions", scene, PAIRWISE_BULLET_COUNTS[i]);
+  }
+  for (size_t i = 0; i < sizeof(BULLET_COUNTS) / sizeof(*BULLET_COUNTS); i++) {
+    scene_t *scene = make_arena(BULLET_COUNTS[i]);
+    add_layer_collisions(scene);
+    bench_tick("layer_collisions", scene, BULLET_COUNTS[i]);
+  }
+}
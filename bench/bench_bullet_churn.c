@@ -0,0 +1,139 @@
+#include "bench_util.h"
+#include "body.h"
+#include "forces.h"
+#include "map.h"
+#include "scene.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+const size_t FIRE_RATES[] = {1000, 2000, 4000};
+const double BENCH_SECONDS = 1.0;
+const double TICK_DT = 1.0 / 60.0;
+// ticks to run before timing, so bullets are expiring as fast as they fire
+const size_t WARMUP_TICKS = 60;
+const double BULLET_LIFETIME = 0.5;
+const double BENCH_BULLET_SIZE = 10.0;
+const double BENCH_BULLET_SPEED = 300.0;
+const double BENCH_BULLET_MASS = 5.0;
+const double BENCH_DRAG = 1.0;
+const double BENCH_GRAVITY = 5000.0;
+const double BENCH_TANK_SIZE = 80.0;
+const double BENCH_TANK_MASS = 1000.0;
+const double BENCH_TANK_HEALTH = 1e9;
+// bullets are fired from points on a grid inside the arena walls
+const double SPAWN_MIN_X = 40.0;
+const double SPAWN_MIN_Y = 140.0;
+const double SPAWN_SPACING = 25.0;
+const size_t SPAWN_COLUMNS = 56;
+const size_t SPAWN_ROWS = 40;
+// the golden angle, so the bullets' headings are spread evenly
+const double SPAWN_ANGLE_STEP = 2.39996;
+
+/**
+ * Builds the game's map with its two tanks and collision rules,
+ * and, if bullets are to get their forces from fields,
+ * drag and the pull of both tanks as fields.
+ */
+scene_t *make_game(bool fields) {
+  scene_t *scene = scene_init();
+  scene_add_body(scene, init_default_tank(
+                            (vector_t){MAX_WIDTH_GAME / 6, MAX_HEIGHT_GAME / 2},
+                            BENCH_TANK_SIZE, VEC_ZERO, BENCH_TANK_MASS,
+                            (rgb_color_t){1, 0, 0}, BENCH_TANK_HEALTH,
+                            DEFAULT_TANK_TYPE));
+  scene_add_body(scene, init_default_tank(
+                            (vector_t){MAX_WIDTH_GAME * 5 / 6,
+                                       MAX_HEIGHT_GAME / 2},
+                            BENCH_TANK_SIZE, VEC_ZERO, BENCH_TANK_MASS,
+                            (rgb_color_t){0, 0, 1}, BENCH_TANK_HEALTH,
+                            DEFAULT_TANK_TYPE));
+  map_init(scene);
+  create_layer_partial_destructive_collision(scene, TANK_LAYER, BULLET_LAYER);
+  create_layer_destructive_collision(scene, BULLET_LAYER, BULLET_LAYER);
+  create_layer_physics_collision(scene, 1.0, BULLET_LAYER, OBSTACLE_LAYER);
+  if (fields) {
+    create_drag_field(scene, BENCH_DRAG, BULLET_TAG);
+    create_attractor(scene, BENCH_GRAVITY, scene_get_body(scene, 0),
+                     BULLET_TAG);
+    create_attractor(scene, -BENCH_GRAVITY / 2, scene_get_body(scene, 1),
+                     BULLET_TAG);
+  }
+  return scene;
+}
+
+/**
+ * Fires a bullet with drag and the pull of both tanks,
+ * either from the scene's fields or as forces of its own.
+ */
+void fire_bullet(scene_t *scene, size_t index, bool fields) {
+  size_t spot = index % (SPAWN_COLUMNS * SPAWN_ROWS);
+  vector_t center = {SPAWN_MIN_X + SPAWN_SPACING * (spot % SPAWN_COLUMNS),
+                     SPAWN_MIN_Y + SPAWN_SPACING * (spot / SPAWN_COLUMNS)};
+  size_t *type = malloc(sizeof(size_t));
+  *type = BULLET_TYPE;
+  body_t *bullet =
+      body_init_with_info(bench_square(center, BENCH_BULLET_SIZE),
+                          BENCH_BULLET_MASS, (rgb_color_t){0, 0, 0}, type, free);
+  body_set_collision_layers(bullet, BULLET_LAYER,
+                            TANK_LAYER | BULLET_LAYER | OBSTACLE_LAYER);
+  body_set_bullet(bullet, true);
+  body_set_velocity(bullet, vec_rotate((vector_t){BENCH_BULLET_SPEED, 0},
+                                       (double)index * SPAWN_ANGLE_STEP));
+  body_set_time(bullet, 0.0);
+  scene_add_body(scene, bullet);
+  if (fields) {
+    body_set_tags(bullet, BULLET_TAG);
+    return;
+  }
+  create_drag(scene, BENCH_DRAG, bullet);
+  create_newtonian_gravity(scene, BENCH_GRAVITY, scene_get_body(scene, 0),
+                           bullet);
+  create_newtonian_gravity(scene, -BENCH_GRAVITY / 2,
+                           scene_get_body(scene, 1), bullet);
+}
+
+/** Fires this tick's bullets and expires the old ones, then ticks. */
+void churn_tick(scene_t *scene, size_t fire_rate, size_t *fired,
+                bool fields) {
+  for (size_t i = 0; i < scene_bodies(scene); i++) {
+    body_t *body = scene_get_body(scene, i);
+    if (body_get_type(body) == BULLET_TYPE) {
+      body_set_time(body, body_get_time(body) + TICK_DT);
+      if (body_get_time(body) > BULLET_LIFETIME) {
+        body_remove(body);
+      }
+    }
+  }
+  size_t target = (size_t)((*fired / (double)fire_rate + TICK_DT) * fire_rate);
+  while (*fired < target) {
+    fire_bullet(scene, *fired, fields);
+    (*fired)++;
+  }
+  scene_tick(scene, TICK_DT);
+}
+
+void bench_churn(const char *name, size_t fire_rate, bool fields) {
+  scene_t *scene = make_game(fields);
+  size_t fired = 0;
+  for (size_t i = 0; i < WARMUP_TICKS; i++) {
+    churn_tick(scene, fire_rate, &fired, fields);
+  }
+  size_t ticks = 0;
+  double start = bench_now();
+  double elapsed = 0.0;
+  while (elapsed < BENCH_SECONDS) {
+    churn_tick(scene, fire_rate, &fired, fields);
+    ticks++;
+    elapsed = bench_now() - start;
+  }
+  bench_report(name, fire_rate, elapsed, ticks);
+  scene_free(scene);
+}
+
+int main(int argc, char *argv[]) {
+  for (size_t i = 0; i < sizeof(FIRE_RATES) / sizeof(*FIRE_RATES); i++) {
+    bench_churn("bullet_churn/own_forces", FIRE_RATES[i], false);
+    bench_churn("bullet_churn/fields", FIRE_RATES[i], true);
+  }
+}
@@ -0,0 +1,91 @@
+#include "bench_util.h"
+#include "body.h"
+#include "collision.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+const size_t PAIR_COUNT = 1024;
+const double BENCH_SECONDS = 1.0;
+// the pegs demo's balls and pegs, and game.c's circles
+const size_t POLYGON_SIDES[] = {40, 300};
+const double BALL_RADIUS = 1.0;
+const double PEG_RADIUS = 0.5;
+// pairs are placed at random in a box about twice their size,
+// so some of them collide
+const double SPREAD = 4.0;
+
+/** Builds a circle the way the demos did, as a many-sided polygon. */
+polygon_t make_polygon_circle(vector_t center, double radius, size_t sides) {
+  polygon_t circle = polygon_init(sides);
+  for (size_t i = 0; i < sides; i++) {
+    double angle = 2 * M_PI * i / sides;
+    polygon_add(&circle, (vector_t){center.x + radius * cos(angle),
+                                    center.y + radius * sin(angle)});
+  }
+  return circle;
+}
+
+vector_t random_point(void) {
+  return (vector_t){SPREAD * rand() / RAND_MAX, SPREAD * rand() / RAND_MAX};
+}
+
+/**
+ * Builds pairs of a ball and a peg.
+ * If sides is 0 they are exact circles, otherwise polygons.
+ */
+void make_pairs(body_t **first, body_t **second, size_t sides) {
+  srand(7);
+  for (size_t i = 0; i < PAIR_COUNT; i++) {
+    vector_t ball = random_point();
+    vector_t peg = random_point();
+    if (sides == 0) {
+      first[i] = body_init_circle(ball, BALL_RADIUS, 1.0,
+                                  (rgb_color_t){0, 0, 0}, NULL, NULL);
+      second[i] = body_init_circle(peg, PEG_RADIUS, 1.0,
+                                   (rgb_color_t){0, 0, 0}, NULL, NULL);
+    } else {
+      first[i] = body_init(make_polygon_circle(ball, BALL_RADIUS, sides), 1.0,
+                           (rgb_color_t){0, 0, 0});
+      second[i] = body_init(make_polygon_circle(peg, PEG_RADIUS, sides), 1.0,
+                            (rgb_color_t){0, 0, 0});
+    }
+  }
+}
+
+void bench_pairs(const char *name, size_t sides) {
+  body_t **first = malloc(sizeof(body_t *) * PAIR_COUNT);
+  body_t **second = malloc(sizeof(body_t *) * PAIR_COUNT);
+  make_pairs(first, second, sides);
+  size_t rounds = 0;
+  size_t hits = 0;
+  double start = bench_now();
+  double elapsed = 0.0;
+  while (elapsed < BENCH_SECONDS) {
+    for (size_t i = 0; i < PAIR_COUNT; i++) {
+      hits += find_body_collision(first[i], second[i]).collided;
+    }
+    rounds++;
+    elapsed = bench_now() - start;
+  }
+  bench_report(name, PAIR_COUNT, elapsed, rounds);
+  printf("%-28s %.2f Mpairs/s (%zu%% colliding)\n", name,
+         PAIR_COUNT * rounds / elapsed / 1e6,
+         hits * 100 / (PAIR_COUNT * rounds));
+  for (size_t i = 0; i < PAIR_COUNT; i++) {
+    body_free(first[i]);
+    body_free(second[i]);
+  }
+  free(first);
+  free(second);
+}
+
+int main(int argc, char *argv[]) {
+  for (size_t i = 0; i < sizeof(POLYGON_SIDES) / sizeof(*POLYGON_SIDES);
+       i++) {
+    char name[64];
+    snprintf(name, sizeof(name), "circles_polygon_%zu", POLYGON_SIDES[i]);
+    bench_pairs(name, POLYGON_SIDES[i]);
+  }
+  bench_pairs("circles_exact", 0);
+}
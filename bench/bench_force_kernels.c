@@ -0,0 +1,142 @@
+#include "bench_util.h"
+#include "body.h"
+#include "forces.h"
+#include "list.h"
+#include "scene.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+const double BENCH_SECONDS = 1.0;
+const double TICK_DT = 1.0 / 60.0;
+// the damping demo: a spring to an anchor and drag on each of 50 bodies
+const size_t SPRING_COUNT = 50;
+const double SPRING_CONSTANT = 100.0;
+const double GAMMA = 2.5;
+// the old nbodies demo: gravity between every pair
+const size_t GRAVITY_BODY_COUNT = 500;
+const double G = 500.0;
+const double MIN_GRAVITY_DISTANCE = 5.0;
+
+/**
+ * A force creator for one pair, as forces used to be stored:
+ * its bodies in a list and the kind of force picked by function pointer.
+ */
+typedef struct pair_force {
+  list_t *bodies;
+  double constant;
+} pair_force_t;
+
+void pair_gravity(pair_force_t *force) {
+  body_t *body1 = list_get(force->bodies, 0);
+  body_t *body2 = list_get(force->bodies, 1);
+  vector_t centroid1 = body_get_centroid(body1);
+  vector_t centroid2 = body_get_centroid(body2);
+  double distance = body_get_distance(centroid1, centroid2);
+  if (distance < MIN_GRAVITY_DISTANCE) {
+    return;
+  }
+  vector_t unit = calculate_unit_vector(centroid1, centroid2);
+  double magnitude = body_get_mass(body1) * body_get_mass(body2) *
+                     force->constant / (distance * distance);
+  vector_t pull = vec_multiply(magnitude, unit);
+  body_add_force(body1, pull);
+  body_add_force(body2, vec_negate(pull));
+}
+
+void pair_spring(pair_force_t *force) {
+  body_t *body1 = list_get(force->bodies, 0);
+  body_t *body2 = list_get(force->bodies, 1);
+  vector_t centroid1 = body_get_centroid(body1);
+  vector_t centroid2 = body_get_centroid(body2);
+  double distance = body_get_distance(centroid1, centroid2);
+  vector_t unit = calculate_unit_vector(centroid1, centroid2);
+  vector_t pull = vec_multiply(force->constant * distance, unit);
+  body_add_force(body1, pull);
+  body_add_force(body2, vec_negate(pull));
+}
+
+void pair_drag(pair_force_t *force) {
+  body_t *body = list_get(force->bodies, 0);
+  body_add_force(body, vec_multiply(-force->constant, body_get_velocity(body)));
+}
+
+void add_pair_force(scene_t *scene, force_creator_t forcer, double constant,
+                    body_t *body1, body_t *body2) {
+  pair_force_t *force = malloc(sizeof(pair_force_t));
+  force->bodies = list_init(2, NULL);
+  list_add(force->bodies, body1);
+  if (body2 != NULL) {
+    list_add(force->bodies, body2);
+  }
+  force->constant = constant;
+  // the scene frees the list, so only the record itself is left
+  scene_add_bodies_force_creator(scene, forcer, force, force->bodies, free);
+}
+
+body_t *add_body(scene_t *scene, vector_t center, double mass) {
+  body_t *body =
+      body_init(bench_square(center, 4.0), mass, (rgb_color_t){0, 0, 0});
+  scene_add_body(scene, body);
+  return body;
+}
+
+scene_t *make_damping(bool batched) {
+  scene_t *scene = scene_init();
+  for (size_t i = 0; i < SPRING_COUNT; i++) {
+    body_t *body =
+        add_body(scene, (vector_t){i * 20.0, 250 + 250 * cos(i * M_PI / 10)},
+                 10.0);
+    body_t *anchor = add_body(scene, (vector_t){i * 20.0, 250}, INFINITY);
+    if (batched) {
+      create_spring(scene, SPRING_CONSTANT, body, anchor);
+      create_drag(scene, GAMMA, body);
+    } else {
+      add_pair_force(scene, (force_creator_t)pair_spring, SPRING_CONSTANT,
+                     body, anchor);
+      add_pair_force(scene, (force_creator_t)pair_drag, GAMMA, body, NULL);
+    }
+  }
+  return scene;
+}
+
+scene_t *make_nbodies(bool batched) {
+  scene_t *scene = scene_init();
+  srand(10);
+  for (size_t i = 0; i < GRAVITY_BODY_COUNT; i++) {
+    vector_t center = {1000.0 * rand() / RAND_MAX, 500.0 * rand() / RAND_MAX};
+    body_t *body = add_body(scene, center, 5.0 + 15.0 * rand() / RAND_MAX);
+    for (size_t j = 0; j < i; j++) {
+      body_t *other = scene_get_body(scene, j);
+      if (batched) {
+        create_newtonian_gravity(scene, G, body, other);
+      } else {
+        add_pair_force(scene, (force_creator_t)pair_gravity, G, body, other);
+      }
+    }
+  }
+  return scene;
+}
+
+void bench_ticks(const char *name, scene_t *scene, size_t forces) {
+  size_t ticks = 0;
+  double start = bench_now();
+  double elapsed = 0.0;
+  while (elapsed < BENCH_SECONDS) {
+    scene_tick(scene, TICK_DT);
+    ticks++;
+    elapsed = bench_now() - start;
+  }
+  bench_report(name, forces, elapsed, ticks);
+  scene_free(scene);
+}
+
+int main(int argc, char *argv[]) {
+  size_t pairs = GRAVITY_BODY_COUNT * (GRAVITY_BODY_COUNT - 1) / 2;
+  bench_ticks("damping/force_creators", make_damping(false),
+              2 * SPRING_COUNT);
+  bench_ticks("damping/batched", make_damping(true), 2 * SPRING_COUNT);
+  bench_ticks("nbodies/force_creators", make_nbodies(false), pairs);
+  bench_ticks("nbodies/batched", make_nbodies(true), pairs);
+}
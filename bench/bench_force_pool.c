@@ -0,0 +1,100 @@
+#include "bench_util.h"
+#include "body.h"
+#include "forces.h"
+#include "list.h"
+#include "scene.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+const size_t COLLISION_COUNTS[] = {100, 1000, 4000};
+const double BENCH_SECONDS = 1.0;
+const double TICK_DT = 1.0 / 60.0;
+const double ELASTICITY = 1.0;
+// the bodies sit far apart, so only adding and removing forces is timed
+const double BODY_SPACING = 10.0;
+const size_t BODY_COLUMNS = 100;
+
+/**
+ * A collision force creator's state, as it was stored before the scene
+ * pooled them: the record, its list of bodies and the elasticity
+ * each had an allocation of their own.
+ */
+typedef struct malloc_collision {
+  list_t *bodies;
+  double *elasticity;
+} malloc_collision_t;
+
+void malloc_collision_forcer(malloc_collision_t *collision) {}
+
+void malloc_collision_free(malloc_collision_t *collision) {
+  free(collision->elasticity);
+  free(collision);
+}
+
+void add_malloc_collision(scene_t *scene, body_t *body1, body_t *body2) {
+  malloc_collision_t *collision = malloc(sizeof(malloc_collision_t));
+  collision->bodies = list_init(2, NULL);
+  list_add(collision->bodies, body1);
+  list_add(collision->bodies, body2);
+  collision->elasticity = malloc(sizeof(double));
+  *collision->elasticity = ELASTICITY;
+  scene_add_bodies_force_creator(
+      scene, (force_creator_t)malloc_collision_forcer, collision,
+      collision->bodies, (free_func_t)malloc_collision_free);
+}
+
+/**
+ * Adds a body with a collision force against an anchor for each count,
+ * then removes them all, as a burst of bullets would.
+ */
+void churn_collisions(scene_t *scene, body_t *anchor, size_t count,
+                      bool pooled) {
+  for (size_t i = 0; i < count; i++) {
+    vector_t center = {BODY_SPACING * (i % BODY_COLUMNS),
+                       BODY_SPACING * (i / BODY_COLUMNS)};
+    body_t *body =
+        body_init(bench_square(center, 1.0), 1.0, (rgb_color_t){0, 0, 0});
+    scene_add_body(scene, body);
+    if (pooled) {
+      create_physics_collision(scene, ELASTICITY, anchor, body);
+    } else {
+      add_malloc_collision(scene, anchor, body);
+    }
+  }
+  for (size_t i = 1; i < scene_bodies(scene); i++) {
+    body_remove(scene_get_body(scene, i));
+  }
+  scene_tick(scene, TICK_DT);
+}
+
+void bench_pool(const char *name, size_t count, bool pooled) {
+  scene_t *scene = scene_init();
+  body_t *anchor = body_init(bench_square((vector_t){-100, -100}, 1.0),
+                             INFINITY, (rgb_color_t){0, 0, 0});
+  scene_add_body(scene, anchor);
+  // once, so the pool has all of its slabs before timing
+  churn_collisions(scene, anchor, count, pooled);
+  size_t cycles = 0;
+  double start = bench_now();
+  double elapsed = 0.0;
+  while (elapsed < BENCH_SECONDS) {
+    churn_collisions(scene, anchor, count, pooled);
+    cycles++;
+    elapsed = bench_now() - start;
+  }
+  bench_report(name, count, elapsed, cycles);
+  pool_stats_t stats = scene_get_pool_stats(scene);
+  printf("  pool: %zu live, %zu peak, %zu slabs\n", stats.live, stats.peak,
+         stats.slabs);
+  scene_free(scene);
+}
+
+int main(int argc, char *argv[]) {
+  for (size_t i = 0; i < sizeof(COLLISION_COUNTS) / sizeof(*COLLISION_COUNTS);
+       i++) {
+    bench_pool("force_pool/malloc", COLLISION_COUNTS[i], false);
+    bench_pool("force_pool/pooled", COLLISION_COUNTS[i], true);
+  }
+}
@@ -0,0 +1,163 @@
+#include "bench_util.h"
+#include "body.h"
+#include "forces.h"
+#include "scene.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// every run covers this much simulated time
+const double SIMULATED_SECONDS = 20.0;
+const double TICK_DTS[] = {1.0 / 30.0, 1.0 / 60.0, 1.0 / 120.0};
+const size_t SUBSTEPS[] = {1, 4};
+// the damping demo's springs, without the drag that hides the drift
+const size_t SPRING_COUNT = 50;
+const double SPRING_CONSTANT = 100.0;
+const double SPRING_MASS = 10.0;
+// the gravity demo: light bodies orbiting a heavy one,
+// kept further apart than the minimum distance gravity acts over
+const size_t ORBIT_COUNT = 8;
+const double G = 500.0;
+const double SUN_MASS = 1000.0;
+const double PLANET_MASS = 1.0;
+const double FIRST_ORBIT = 100.0;
+const double ORBIT_SPACING = 30.0;
+
+const integrator_t INTEGRATORS[] = {
+    INTEGRATOR_AVERAGE_VELOCITY, INTEGRATOR_SEMI_IMPLICIT_EULER,
+    INTEGRATOR_VELOCITY_VERLET, INTEGRATOR_RK4};
+const char *INTEGRATOR_NAMES[] = {"average", "euler", "verlet", "rk4"};
+
+typedef enum { DEMO_SPRINGS, DEMO_GRAVITY } demo_t;
+const char *DEMO_NAMES[] = {"springs", "gravity"};
+
+body_t *add_body(scene_t *scene, vector_t center, double mass) {
+  body_t *body =
+      body_init(bench_square(center, 4.0), mass, (rgb_color_t){0, 0, 0});
+  scene_add_body(scene, body);
+  return body;
+}
+
+scene_t *make_springs(void) {
+  scene_t *scene = scene_init();
+  for (size_t i = 0; i < SPRING_COUNT; i++) {
+    body_t *body =
+        add_body(scene, (vector_t){i * 20.0, 250 + 250 * cos(i * M_PI / 10)},
+                 SPRING_MASS);
+    body_t *anchor = add_body(scene, (vector_t){i * 20.0, 250}, INFINITY);
+    create_spring(scene, SPRING_CONSTANT, body, anchor);
+  }
+  return scene;
+}
+
+scene_t *make_gravity(void) {
+  scene_t *scene = scene_init();
+  body_t *sun = add_body(scene, (vector_t){500, 250}, SUN_MASS);
+  vector_t momentum = VEC_ZERO;
+  for (size_t i = 0; i < ORBIT_COUNT; i++) {
+    double radius = FIRST_ORBIT + i * ORBIT_SPACING;
+    double angle = i * 2 * M_PI / ORBIT_COUNT;
+    vector_t offset = {radius * cos(angle), radius * sin(angle)};
+    body_t *planet =
+        add_body(scene, vec_add((vector_t){500, 250}, offset), PLANET_MASS);
+    // a circular orbit, perpendicular to the offset
+    double speed = sqrt(G * SUN_MASS / radius);
+    vector_t velocity =
+        vec_multiply(speed / radius, vec_rotate(offset, M_PI / 2));
+    body_set_velocity(planet, velocity);
+    momentum = vec_add(momentum, vec_multiply(PLANET_MASS, velocity));
+  }
+  // so the system as a whole stays put
+  body_set_velocity(sun, vec_multiply(-1.0 / SUN_MASS, momentum));
+  for (size_t i = 0; i <= ORBIT_COUNT; i++) {
+    for (size_t j = 0; j < i; j++) {
+      create_newtonian_gravity(scene, G, scene_get_body(scene, i),
+                               scene_get_body(scene, j));
+    }
+  }
+  return scene;
+}
+
+double kinetic_energy(scene_t *scene) {
+  double energy = 0.0;
+  for (size_t i = 0; i < scene_bodies(scene); i++) {
+    body_t *body = scene_get_body(scene, i);
+    double mass = body_get_mass(body);
+    if (mass != INFINITY) {
+      vector_t velocity = body_get_velocity(body);
+      energy += mass * vec_dot(velocity, velocity) / 2;
+    }
+  }
+  return energy;
+}
+
+double spring_energy(scene_t *scene) {
+  double energy = kinetic_energy(scene);
+  for (size_t i = 0; i < SPRING_COUNT; i++) {
+    vector_t stretch =
+        vec_subtract(body_get_centroid(scene_get_body(scene, 2 * i)),
+                     body_get_centroid(scene_get_body(scene, 2 * i + 1)));
+    energy += SPRING_CONSTANT * vec_dot(stretch, stretch) / 2;
+  }
+  return energy;
+}
+
+double gravity_energy(scene_t *scene) {
+  double energy = kinetic_energy(scene);
+  for (size_t i = 0; i < scene_bodies(scene); i++) {
+    body_t *body1 = scene_get_body(scene, i);
+    for (size_t j = 0; j < i; j++) {
+      body_t *body2 = scene_get_body(scene, j);
+      double distance = body_get_distance(body_get_centroid(body1),
+                                          body_get_centroid(body2));
+      energy -= G * body_get_mass(body1) * body_get_mass(body2) / distance;
+    }
+  }
+  return energy;
+}
+
+/**
+ * Runs a demo for SIMULATED_SECONDS and prints the largest relative change
+ * in its energy along the way, next to the CPU time the ticks took.
+ * Energy is only measured between ticks, so it is not in the timing.
+ */
+void bench_drift(demo_t demo, size_t integrator, double dt, size_t substeps) {
+  scene_t *scene = demo == DEMO_SPRINGS ? make_springs() : make_gravity();
+  double (*energy)(scene_t *) =
+      demo == DEMO_SPRINGS ? spring_energy : gravity_energy;
+  scene_set_integrator(scene, INTEGRATORS[integrator]);
+  scene_set_substeps(scene, substeps);
+
+  double initial = energy(scene);
+  double drift = 0.0;
+  double seconds = 0.0;
+  size_t ticks = (size_t)round(SIMULATED_SECONDS / dt);
+  for (size_t i = 0; i < ticks; i++) {
+    double start = bench_now();
+    scene_tick(scene, dt);
+    seconds += bench_now() - start;
+    drift = fmax(drift, fabs(energy(scene) - initial) / fabs(initial));
+  }
+  scene_free(scene);
+
+  char name[64];
+  snprintf(name, sizeof(name), "%s/%s/%.0fhz/x%zu", DEMO_NAMES[demo],
+           INTEGRATOR_NAMES[integrator], 1 / dt, substeps);
+  printf("%-28s %9.2e energy drift %8.2f ms CPU\n", name, drift,
+         seconds * 1e3);
+}
+
+int main(int argc, char *argv[]) {
+  size_t integrators = sizeof(INTEGRATORS) / sizeof(INTEGRATORS[0]);
+  size_t dts = sizeof(TICK_DTS) / sizeof(TICK_DTS[0]);
+  size_t substeps = sizeof(SUBSTEPS) / sizeof(SUBSTEPS[0]);
+  for (demo_t demo = DEMO_SPRINGS; demo <= DEMO_GRAVITY; demo++) {
+    for (size_t i = 0; i < integrators; i++) {
+      for (size_t j = 0; j < dts; j++) {
+        for (size_t k = 0; k < substeps; k++) {
+          bench_drift(demo, i, TICK_DTS[j], SUBSTEPS[k]);
+        }
+      }
+    }
+  }
+}
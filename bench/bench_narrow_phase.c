@@ -0,0 +1,79 @@
+#include "bench_util.h"
+#include "body.h"
+#include "scene.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+const size_t THREAD_COUNTS[] = {1, 2, 4, 8};
+// a grid filling the arena, about the size of a crowded game
+const size_t BODY_COUNT = 8000;
+const size_t ROW_LENGTH = 100;
+// closer than the bodies' size, so each touches its neighbours
+const double SPACING = 12.0;
+const double BODY_SIZE = 14.0;
+const size_t WARMUP_TICKS = 3;
+const double BENCH_SECONDS = 1.0;
+const size_t BENCH_LAYER = 1;
+
+void ignore_collision(body_t *body1, body_t *body2, vector_t axis,
+                      void *aux) {}
+
+/**
+ * Builds a dense grid of rotated squares and circles, where most
+ * candidate pair collides, so the narrow phase dominates the tick.
+ */
+scene_t *make_scene(size_t threads) {
+  scene_t *scene = scene_init_with_threads(threads);
+  for (size_t i = 0; i < BODY_COUNT; i++) {
+    vector_t center = {SPACING * (i % ROW_LENGTH), SPACING * (i / ROW_LENGTH)};
+    body_t *body;
+    if (i % 3 == 0) {
+      body = body_init_circle(center, BODY_SIZE / 2, 1.0,
+                              (rgb_color_t){0, 0, 0}, NULL, NULL);
+    } else {
+      body = body_init(bench_square(center, BODY_SIZE), 1.0,
+                       (rgb_color_t){0, 0, 0});
+      body_set_rotation(body, 0.1 * (i % 7));
+    }
+    body_set_collision_layers(body, BENCH_LAYER, BENCH_LAYER);
+    scene_add_body(scene, body);
+  }
+  scene_add_collision_rule(scene, BENCH_LAYER, BENCH_LAYER, ignore_collision,
+                           NULL, NULL);
+  return scene;
+}
+
+/** Times ticks of the scene, which does not move with dt = 0. */
+double bench_threads(size_t threads) {
+  scene_t *scene = make_scene(threads);
+  for (size_t i = 0; i < WARMUP_TICKS; i++) {
+    scene_tick(scene, 0.0);
+  }
+  size_t ticks = 0;
+  double start = bench_now();
+  double elapsed = 0.0;
+  while (elapsed < BENCH_SECONDS) {
+    scene_tick(scene, 0.0);
+    ticks++;
+    elapsed = bench_now() - start;
+  }
+  char name[32];
+  snprintf(name, sizeof(name), "narrow_phase/%zu", scene_threads(scene));
+  bench_report(name, BODY_COUNT, elapsed, ticks);
+  printf("%-28s %zu contacts per tick\n", name, scene_contacts(scene));
+  scene_free(scene);
+  return elapsed / ticks;
+}
+
+int main(int argc, char *argv[]) {
+  double serial = 0.0;
+  for (size_t i = 0; i < sizeof(THREAD_COUNTS) / sizeof(*THREAD_COUNTS);
+       i++) {
+    double tick = bench_threads(THREAD_COUNTS[i]);
+    if (i == 0) {
+      serial = tick;
+    }
+    printf("%-28s %.2fx speedup over 1 thread\n", "", serial / tick);
+  }
+}
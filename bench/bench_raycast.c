@@ -0,0 +1,94 @@
+#include "bench_util.h"
+#include "body.h"
+#include "collision.h"
+#include "map.h"
+#include "scene.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+const size_t RAYS_PER_FRAME = 10000;
+const double BENCH_SECONDS = 1.0;
+// how far the AI looks for the other tank
+const double RAY_LENGTH = 750.0;
+const size_t TANK_COUNT = 20;
+const double BENCH_TANK_SIZE = 60.0;
+// rays start anywhere in the arena
+const double ARENA_MIN_X = 0.0;
+const double ARENA_MIN_Y = 100.0;
+const double ARENA_WIDTH = 1520.0;
+const double ARENA_HEIGHT = 1100.0;
+
+typedef ray_hit_t (*raycaster_t)(scene_t *scene, vector_t origin,
+                                 vector_t direction, double max_distance,
+                                 size_t mask);
+
+/** The game's map with some tanks spread over it. */
+scene_t *make_arena(void) {
+  scene_t *scene = scene_init();
+  map_init(scene);
+  srand(3);
+  for (size_t i = 0; i < TANK_COUNT; i++) {
+    vector_t center = {ARENA_MIN_X + ARENA_WIDTH * rand() / RAND_MAX,
+                       ARENA_MIN_Y + ARENA_HEIGHT * rand() / RAND_MAX};
+    body_t *tank = body_init(bench_square(center, BENCH_TANK_SIZE), 1.0,
+                             (rgb_color_t){0, 0, 0});
+    body_set_collision_layers(tank, TANK_LAYER, OBSTACLE_LAYER);
+    scene_add_body(scene, tank);
+  }
+  return scene;
+}
+
+/** Tests the ray against every body, as a baseline. */
+ray_hit_t raycast_every_body(scene_t *scene, vector_t origin,
+                             vector_t direction, double max_distance,
+                             size_t mask) {
+  ray_hit_t best = {NULL, VEC_ZERO, VEC_ZERO, max_distance};
+  for (size_t i = 0; i < scene_bodies(scene); i++) {
+    body_t *body = scene_get_body(scene, i);
+    if ((body_get_collision_category(body) & mask) != 0) {
+      ray_hit_t hit = find_ray_hit(body, origin, direction, best.distance);
+      if (hit.body != NULL) {
+        best = hit;
+      }
+    }
+  }
+  return best;
+}
+
+void bench_rays(const char *name, raycaster_t raycast) {
+  scene_t *scene = make_arena();
+  vector_t *origins = malloc(sizeof(vector_t) * RAYS_PER_FRAME);
+  vector_t *directions = malloc(sizeof(vector_t) * RAYS_PER_FRAME);
+  srand(4);
+  for (size_t i = 0; i < RAYS_PER_FRAME; i++) {
+    origins[i] = (vector_t){ARENA_MIN_X + ARENA_WIDTH * rand() / RAND_MAX,
+                            ARENA_MIN_Y + ARENA_HEIGHT * rand() / RAND_MAX};
+    double angle = 2 * M_PI * rand() / RAND_MAX;
+    directions[i] = (vector_t){cos(angle), sin(angle)};
+  }
+  size_t frames = 0;
+  size_t hits = 0;
+  double start = bench_now();
+  double elapsed = 0.0;
+  while (elapsed < BENCH_SECONDS) {
+    for (size_t i = 0; i < RAYS_PER_FRAME; i++) {
+      hits += raycast(scene, origins[i], directions[i], RAY_LENGTH,
+                      TANK_LAYER | OBSTACLE_LAYER)
+                  .body != NULL;
+    }
+    frames++;
+    elapsed = bench_now() - start;
+  }
+  bench_report(name, RAYS_PER_FRAME, elapsed, frames);
+  printf("%-28s %zu%% of rays hit something\n", name,
+         hits * 100 / (RAYS_PER_FRAME * frames));
+  free(origins);
+  free(directions);
+  scene_free(scene);
+}
+
+int main(int argc, char *argv[]) {
+  bench_rays("raycast/every_body", raycast_every_body);
+  bench_rays("raycast/scene", scene_raycast);
+}
@@ -0,0 +1,94 @@
+#include "bench_util.h"
+#include "body.h"
+#include "collision.h"
+#include "map.h"
+#include "scene.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+const size_t QUERIES_PER_FRAME = 1000;
+const double BENCH_SECONDS = 1.0;
+// e.g. the radius of an explosion
+const double QUERY_RADIUS = 150.0;
+// a busy game: tanks and a lot of bullets in flight
+const size_t BODY_COUNT = 2000;
+const double BENCH_BODY_SIZE = 10.0;
+const size_t RESULT_CAPACITY = 256;
+const double ARENA_MIN_X = 0.0;
+const double ARENA_MIN_Y = 100.0;
+const double ARENA_WIDTH = 1520.0;
+const double ARENA_HEIGHT = 1100.0;
+
+typedef size_t (*radius_query_t)(scene_t *scene, vector_t center,
+                                 double radius, size_t mask, body_t **bodies,
+                                 size_t capacity);
+
+/** The game's map with many small bodies spread over it. */
+scene_t *make_arena(void) {
+  scene_t *scene = scene_init();
+  map_init(scene);
+  srand(3);
+  for (size_t i = 0; i < BODY_COUNT; i++) {
+    vector_t center = {ARENA_MIN_X + ARENA_WIDTH * rand() / RAND_MAX,
+                       ARENA_MIN_Y + ARENA_HEIGHT * rand() / RAND_MAX};
+    body_t *body = body_init(bench_square(center, BENCH_BODY_SIZE), 1.0,
+                             (rgb_color_t){0, 0, 0});
+    body_set_collision_layers(body, i % 2 == 0 ? TANK_LAYER : BULLET_LAYER,
+                              0);
+    scene_add_body(scene, body);
+  }
+  scene_tick(scene, 0.0);
+  return scene;
+}
+
+/** Checks every body, as a baseline. */
+size_t query_every_body(scene_t *scene, vector_t center, double radius,
+                        size_t mask, body_t **bodies, size_t capacity) {
+  size_t count = 0;
+  for (size_t i = 0; i < scene_bodies(scene); i++) {
+    body_t *body = scene_get_body(scene, i);
+    if ((body_get_collision_category(body) & mask) != 0 &&
+        find_point_distance(body, center) <= radius) {
+      if (count < capacity) {
+        bodies[count] = body;
+      }
+      count++;
+    }
+  }
+  return count;
+}
+
+void bench_queries(const char *name, radius_query_t query) {
+  scene_t *scene = make_arena();
+  vector_t *centers = malloc(sizeof(vector_t) * QUERIES_PER_FRAME);
+  body_t **found = malloc(sizeof(body_t *) * RESULT_CAPACITY);
+  srand(4);
+  for (size_t i = 0; i < QUERIES_PER_FRAME; i++) {
+    centers[i] = (vector_t){ARENA_MIN_X + ARENA_WIDTH * rand() / RAND_MAX,
+                            ARENA_MIN_Y + ARENA_HEIGHT * rand() / RAND_MAX};
+  }
+  size_t frames = 0;
+  size_t total = 0;
+  double start = bench_now();
+  double elapsed = 0.0;
+  while (elapsed < BENCH_SECONDS) {
+    for (size_t i = 0; i < QUERIES_PER_FRAME; i++) {
+      total += query(scene, centers[i], QUERY_RADIUS,
+                     TANK_LAYER | BULLET_LAYER | OBSTACLE_LAYER, found,
+                     RESULT_CAPACITY);
+    }
+    frames++;
+    elapsed = bench_now() - start;
+  }
+  bench_report(name, QUERIES_PER_FRAME, elapsed, frames);
+  printf("%-28s %zu bodies found per query\n", name,
+         total / (QUERIES_PER_FRAME * frames));
+  free(centers);
+  free(found);
+  scene_free(scene);
+}
+
+int main(int argc, char *argv[]) {
+  bench_queries("region_query/every_body", query_every_body);
+  bench_queries("region_query/scene", scene_query_radius);
+}
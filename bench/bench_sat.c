@@ -0,0 +1,95 @@
+#include "bench_util.h"
+#include "body.h"
+#include "collision.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+const size_t PAIR_COUNT = 1024;
+const double BENCH_SECONDS = 1.0;
+// pairs are placed at random in a box about twice their size,
+// so roughly half of them collide
+const double SPREAD = 120.0;
+const double TANK_SIZE = 80.0;
+const double BULLET_SIZE = 10.0;
+
+/** Builds a triangle, like the map's triangular obstacles. */
+polygon_t make_bench_triangle(vector_t center, double size) {
+  polygon_t triangle = polygon_init(3);
+  polygon_add(&triangle, (vector_t){center.x - size / 2, center.y - size / 2});
+  polygon_add(&triangle, (vector_t){center.x + size / 2, center.y - size / 2});
+  polygon_add(&triangle, (vector_t){center.x, center.y + size / 2});
+  return triangle;
+}
+
+vector_t random_point(void) {
+  return (vector_t){SPREAD * rand() / RAND_MAX, SPREAD * rand() / RAND_MAX};
+}
+
+/** Builds pairs of a rotated tank and either a bullet or a triangle. */
+void make_pairs(body_t **first, body_t **second) {
+  srand(7);
+  for (size_t i = 0; i < PAIR_COUNT; i++) {
+    first[i] = body_init(bench_square(random_point(), TANK_SIZE), 1.0,
+                         (rgb_color_t){0, 0, 0});
+    body_set_rotation(first[i], 2.0 * rand() / RAND_MAX);
+    polygon_t shape = i % 2 == 0
+                          ? bench_square(random_point(), BULLET_SIZE)
+                          : make_bench_triangle(random_point(), TANK_SIZE);
+    second[i] = body_init(shape, 1.0, (rgb_color_t){0, 0, 0});
+    body_set_rotation(second[i], 2.0 * rand() / RAND_MAX);
+  }
+}
+
+void report_pairs(const char *name, double elapsed, size_t rounds,
+                  size_t hits) {
+  bench_report(name, PAIR_COUNT, elapsed, rounds);
+  printf("%-28s %.2f Mpairs/s (%zu%% colliding)\n", name,
+         PAIR_COUNT * rounds / elapsed / 1e6,
+         hits * 100 / (PAIR_COUNT * rounds));
+}
+
+void bench_polygons(body_t **first, body_t **second) {
+  size_t rounds = 0;
+  size_t hits = 0;
+  double start = bench_now();
+  double elapsed = 0.0;
+  while (elapsed < BENCH_SECONDS) {
+    for (size_t i = 0; i < PAIR_COUNT; i++) {
+      hits += find_collision(body_peek_shape(first[i]),
+                             body_peek_shape(second[i]))
+                  .collided;
+    }
+    rounds++;
+    elapsed = bench_now() - start;
+  }
+  report_pairs("sat_polygons", elapsed, rounds, hits);
+}
+
+void bench_cached_axes(body_t **first, body_t **second) {
+  size_t rounds = 0;
+  size_t hits = 0;
+  double start = bench_now();
+  double elapsed = 0.0;
+  while (elapsed < BENCH_SECONDS) {
+    for (size_t i = 0; i < PAIR_COUNT; i++) {
+      hits += find_body_collision(first[i], second[i]).collided;
+    }
+    rounds++;
+    elapsed = bench_now() - start;
+  }
+  report_pairs("sat_cached_axes", elapsed, rounds, hits);
+}
+
+int main(int argc, char *argv[]) {
+  body_t **first = malloc(sizeof(body_t *) * PAIR_COUNT);
+  body_t **second = malloc(sizeof(body_t *) * PAIR_COUNT);
+  make_pairs(first, second);
+  bench_polygons(first, second);
+  bench_cached_axes(first, second);
+  for (size_t i = 0; i < PAIR_COUNT; i++) {
+    body_free(first[i]);
+    body_free(second[i]);
+  }
+  free(first);
+  free(second);
+}
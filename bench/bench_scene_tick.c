@@ -0,0 +1,49 @@
+#include "bench_util.h"
+#include "body.h"
+#include "scene.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+const size_t BODY_COUNTS[] = {1000, 10000, 100000};
+const size_t WARMUP_TICKS = 5;
+const double BENCH_SECONDS = 1.0;
+const double TICK_DT = 1.0 / 60.0;
+const size_t SCENE_BODY_TYPE = 100;
+
+scene_t *make_scene(size_t body_count) {
+  scene_t *scene = scene_init();
+  for (size_t i = 0; i < body_count; i++) {
+    vector_t center = {(double)(i % 1000), (double)(i / 1000)};
+    size_t *type = malloc(sizeof(size_t));
+    *type = SCENE_BODY_TYPE;
+    body_t *body = body_init_with_info(bench_square(center, 0.5), 1.0,
+                                       (rgb_color_t){0, 0, 0}, type, free);
+    body_set_velocity(body, (vector_t){(double)(i % 7), (double)(i % 5)});
+    body_add_force(body, (vector_t){1.0, -1.0});
+    scene_add_body(scene, body);
+  }
+  return scene;
+}
+
+void bench_tick(size_t body_count) {
+  scene_t *scene = make_scene(body_count);
+  for (size_t i = 0; i < WARMUP_TICKS; i++) {
+    scene_tick(scene, TICK_DT);
+  }
+  size_t ticks = 0;
+  double start = bench_now();
+  double elapsed = 0.0;
+  while (elapsed < BENCH_SECONDS) {
+    scene_tick(scene, TICK_DT);
+    ticks++;
+    elapsed = bench_now() - start;
+  }
+  bench_report("scene_tick", body_count, elapsed, ticks);
+  scene_free(scene);
+}
+
+int main(int argc, char *argv[]) {
+  for (size_t i = 0; i < sizeof(BODY_COUNTS) / sizeof(*BODY_COUNTS); i++) {
+    bench_tick(BODY_COUNTS[i]);
+  }
+}
@@ -0,0 +1,95 @@
+#include "bench_util.h"
+#include "body.h"
+#include "forces.h"
+#include "map.h"
+#include "scene.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+const size_t TANK_COUNTS[] = {2, 20, 100};
+const size_t WARMUP_TICKS = 5;
+const double BENCH_SECONDS = 1.0;
+const double TICK_DT = 1.0 / 60.0;
+const double BENCH_TANK_SIZE = 60.0;
+const double BENCH_TANK_SPEED = 160.0;
+const double BENCH_TANK_MASS = 1000.0;
+const double BENCH_ELASTICITY = 1.0;
+// tanks spawn on a grid inside the arena walls
+const double SPAWN_MIN_X = 100.0;
+const double SPAWN_MIN_Y = 200.0;
+const double SPAWN_SPACING = 100.0;
+const size_t SPAWN_COLUMNS = 13;
+// the golden angle, so the tanks' headings are spread evenly
+const double SPAWN_ANGLE_STEP = 2.39996;
+
+/**
+ * Adds the game's map to a scene as ordinary bodies,
+ * the way it was before static geometry,
+ * by copying the obstacles out of a scratch scene.
+ */
+void add_dynamic_map(scene_t *scene) {
+  scene_t *map = scene_init();
+  map_init(map);
+  for (size_t i = 0; i < scene_bodies(map); i++) {
+    body_t *obstacle = scene_get_body(map, i);
+    size_t *type = malloc(sizeof(size_t));
+    *type = body_get_type(obstacle);
+    body_t *body = body_init_with_info(body_get_shape(obstacle),
+                                       body_get_mass(obstacle),
+                                       body_get_color(obstacle), type, free);
+    body_set_collision_layers(body, body_get_collision_category(obstacle),
+                              body_get_collision_mask(obstacle));
+    scene_add_body(scene, body);
+  }
+  scene_free(map);
+}
+
+/** Builds the map with the given number of tanks driving around it. */
+scene_t *make_arena(size_t tank_count, bool static_map) {
+  scene_t *scene = scene_init();
+  if (static_map) {
+    map_init(scene);
+  } else {
+    add_dynamic_map(scene);
+  }
+  for (size_t i = 0; i < tank_count; i++) {
+    vector_t center = {SPAWN_MIN_X + SPAWN_SPACING * (i % SPAWN_COLUMNS),
+                       SPAWN_MIN_Y + SPAWN_SPACING * (i / SPAWN_COLUMNS)};
+    size_t *type = malloc(sizeof(size_t));
+    *type = DEFAULT_TANK_TYPE;
+    body_t *tank = body_init_with_info(bench_square(center, BENCH_TANK_SIZE),
+                                       BENCH_TANK_MASS, (rgb_color_t){0, 0, 0},
+                                       type, free);
+    body_set_collision_layers(tank, TANK_LAYER, TANK_LAYER | OBSTACLE_LAYER);
+    body_set_velocity(tank, vec_rotate((vector_t){BENCH_TANK_SPEED, 0},
+                                       (double)i * SPAWN_ANGLE_STEP));
+    scene_add_body(scene, tank);
+  }
+  create_layer_physics_collision(scene, BENCH_ELASTICITY, TANK_LAYER,
+                                 OBSTACLE_LAYER);
+  return scene;
+}
+
+void bench_tick(const char *name, size_t tank_count, bool static_map) {
+  scene_t *scene = make_arena(tank_count, static_map);
+  for (size_t i = 0; i < WARMUP_TICKS; i++) {
+    scene_tick(scene, TICK_DT);
+  }
+  size_t ticks = 0;
+  double start = bench_now();
+  double elapsed = 0.0;
+  while (elapsed < BENCH_SECONDS) {
+    scene_tick(scene, TICK_DT);
+    ticks++;
+    elapsed = bench_now() - start;
+  }
+  bench_report(name, tank_count, elapsed, ticks);
+  scene_free(scene);
+}
+
+int main(int argc, char *argv[]) {
+  for (size_t i = 0; i < sizeof(TANK_COUNTS) / sizeof(*TANK_COUNTS); i++) {
+    bench_tick("dynamic_map", TANK_COUNTS[i], false);
+    bench_tick("static_map", TANK_COUNTS[i], true);
+  }
+}
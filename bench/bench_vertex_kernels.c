@@ -0,0 +1,137 @@
+#include "bench_util.h"
+#include "collision.h"
+#include "polygon.h"
+#include "simd.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// bullets and tanks, make_half_circle() and the demos' circles
+const size_t VERTEX_COUNTS[] = {4, 18, 300};
+const double BENCH_SECONDS = 0.25;
+// calls between clock reads, so reading the clock does not dominate
+const size_t CALLS_PER_CHECK = 256;
+const double BENCH_RADIUS = 50.0;
+const double BENCH_ANGLE = 0.01;
+
+typedef enum { PROJECT, TRANSLATE, ROTATE } operation_t;
+const char *OPERATION_NAMES[] = {"project", "translate", "rotate"};
+
+// keeps results alive so the compiler cannot drop the work
+volatile double sink = 0.0;
+
+polygon_t make_circle(size_t count) {
+  polygon_t circle = polygon_init(count);
+  for (size_t i = 0; i < count; i++) {
+    double angle = 2 * M_PI * i / count;
+    polygon_add(&circle, (vector_t){BENCH_RADIUS * cos(angle),
+                                    BENCH_RADIUS * sin(angle)});
+  }
+  return circle;
+}
+
+// the loops polygon.c and collision.c used before the batch kernels
+
+void loop_project(const polygon_t *shape, vector_t axis, double *min,
+                  double *max) {
+  vector_t *points = polygon_points(shape);
+  *min = INFINITY;
+  *max = -INFINITY;
+  for (size_t i = 0; i < polygon_size(shape); i++) {
+    double proj = vec_dot(axis, points[i]);
+    if (proj > *max) {
+      *max = proj;
+    }
+    if (proj < *min) {
+      *min = proj;
+    }
+  }
+}
+
+void loop_translate(polygon_t *polygon, vector_t translation) {
+  vector_t *points = polygon_points(polygon);
+  for (size_t i = 0; i < polygon_size(polygon); i++) {
+    points[i].x += translation.x;
+    points[i].y += translation.y;
+  }
+}
+
+void loop_rotate(polygon_t *polygon, double angle, vector_t point) {
+  vector_t *points = polygon_points(polygon);
+  double cosine = cos(angle);
+  double sine = sin(angle);
+  for (size_t i = 0; i < polygon_size(polygon); i++) {
+    vector_t offset = vec_subtract(points[i], point);
+    points[i].x = point.x + offset.x * cosine - offset.y * sine;
+    points[i].y = point.y + offset.x * sine + offset.y * cosine;
+  }
+}
+
+/**
+ * Runs one operation on the shape, alternating directions
+ * so the vertices stay put.
+ */
+void run_operation(operation_t operation, polygon_t *shape, bool use_loop,
+                   size_t call) {
+  double sign = call % 2 == 0 ? 1.0 : -1.0;
+  vector_t *points = polygon_points(shape);
+  size_t count = polygon_size(shape);
+  if (operation == PROJECT) {
+    double min, max;
+    vector_t axis = {0.6, sign * 0.8};
+    if (use_loop) {
+      loop_project(shape, axis, &min, &max);
+    } else {
+      points_project(points, count, axis, &min, &max);
+    }
+    sink += max - min;
+  } else if (operation == TRANSLATE) {
+    vector_t translation = {sign * 3.0, sign * -2.0};
+    if (use_loop) {
+      loop_translate(shape, translation);
+    } else {
+      points_translate(points, count, translation);
+    }
+  } else {
+    if (use_loop) {
+      loop_rotate(shape, sign * BENCH_ANGLE, VEC_ZERO);
+    } else {
+      points_rotate(points, count, sign * BENCH_ANGLE, VEC_ZERO);
+    }
+  }
+}
+
+void bench_operation(operation_t operation, const char *kernels,
+                     size_t vertex_count, bool use_loop) {
+  polygon_t shape = make_circle(vertex_count);
+  size_t calls = 0;
+  double start = bench_now();
+  double elapsed = 0.0;
+  while (elapsed < BENCH_SECONDS) {
+    for (size_t i = 0; i < CALLS_PER_CHECK; i++) {
+      run_operation(operation, &shape, use_loop, calls++);
+    }
+    elapsed = bench_now() - start;
+  }
+  sink += polygon_get(&shape, 0).x;
+  char name[64];
+  snprintf(name, sizeof(name), "%s_%s", OPERATION_NAMES[operation], kernels);
+  bench_report(name, vertex_count, elapsed, calls);
+  polygon_free(&shape);
+}
+
+int main(int argc, char *argv[]) {
+  const simd_kernels_t *const *kernels;
+  size_t kernel_count = simd_kernels_supported(&kernels);
+  for (operation_t op = PROJECT; op <= ROTATE; op++) {
+    for (size_t i = 0; i < sizeof(VERTEX_COUNTS) / sizeof(*VERTEX_COUNTS);
+         i++) {
+      bench_operation(op, "loop", VERTEX_COUNTS[i], true);
+      for (size_t k = 0; k < kernel_count; k++) {
+        simd_kernels_use(kernels[k]);
+        bench_operation(op, kernels[k]->name, VERTEX_COUNTS[i],
+                        false);
+      }
+    }
+  }
+}
@@ -23,7 +23,7 @@ double DEFAULT_ROTATION_SPEED = M_PI / 8;
  * Use this to store any variable needed every 'tick' of your demo
  */
 typedef struct state {
-  list_t *polygon;
+  polygon_t polygon;
   vector_t *velocity;
   double rotation;
   bool just_moved;
@@ -67,7 +67,7 @@ void emscripten_main(state_t *state) {
   sdl_clear();
   double dt = time_since_last_tick();
 
-  list_t *poly = state->polygon;
+  polygon_t *poly = &state->polygon;
   vector_t *vel = state->velocity;
   vector_t vec = {dt * vel->x, dt * vel->y};
 
@@ -75,8 +75,8 @@ void emscripten_main(state_t *state) {
   polygon_rotate(poly, dt * state->rotation, polygon_centroid(poly));
 
   if (!state->just_moved) {
-    for (size_t i = 0; i < list_size(poly); i++) {
-      vector_t *vector = list_get(poly, i);
+    for (size_t i = 0; i < polygon_size(poly); i++) {
+      vector_t *vector = &polygon_points(poly)[i];
       if (vector->y >= MAX_HEIGHT || vector->y <= 0.0) {
         vel->y = -1 * vel->y;
         state->just_moved = true;
@@ -102,7 +102,6 @@ void emscripten_main(state_t *state) {
  * Should free everything in state as well as state itself.
  */
 void emscripten_free(state_t *state) {
-  list_t *poly = state->polygon;
-  list_free(poly);
+  polygon_free(&state->polygon);
   free(state);
 }
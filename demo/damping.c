@@ -34,18 +34,12 @@ typedef struct state {
   scene_t *scene;
 } state_t;
 
-list_t *make_pellet(vector_t center, double length) {
-  list_t *shape = list_init(PELLET_POINTS, (free_func_t)free);
+polygon_t make_pellet(vector_t center, double length) {
+  polygon_t shape = polygon_init(PELLET_POINTS);
 
   for (size_t i = 0; i < PELLET_POINTS; i++) {
-    vector_t *point = malloc(sizeof(vector_t));
-    assert(point != NULL);
-
-    point->x = center.x;
-    point->y = center.y + length;
-
-    list_add(shape, point);
-    polygon_rotate(shape, -M_PI / (PELLET_POINTS / 2), center);
+    polygon_add(&shape, (vector_t){center.x, center.y + length});
+    polygon_rotate(&shape, -M_PI / (PELLET_POINTS / 2), center);
   }
 
   return shape;
@@ -70,13 +64,13 @@ state_t *emscripten_init() {
     vector_t center = {i * MAX_WIDTH / NUM_STARS,
                        MAX_HEIGHT / 2 +
                            MAX_HEIGHT / 2 * cos(i * 2 * M_PI / 20)};
-    list_t *shape = make_pellet(center, RADIUS);
+    polygon_t shape = make_pellet(center, RADIUS);
     rgb_color_t colour = {r + i / 100.0, g, b - i / 100.0};
     body_t *circle = body_init(shape, MASS, colour);
     scene_add_body(state->scene, circle);
 
     vector_t center2 = {i * MAX_WIDTH / NUM_STARS, MAX_HEIGHT / 2};
-    list_t *body2 = make_pellet(center2, SMALL_RADIUS);
+    polygon_t body2 = make_pellet(center2, SMALL_RADIUS);
     body_t *mini_body = body_init(body2, HUGE_MASS, WHITE);
     create_spring(state->scene, SPRING_CONSTANT,
                   scene_get_body(state->scene, i), mini_body);
@@ -9,6 +9,7 @@
 #include "star.h"
 #include "state.h"
 #include "text.h"
+#include "timestep.h"
 #include "vector.h"
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_mixer.h>
@@ -19,18 +20,6 @@
 #include <stdio.h>
 #include <stdlib.h>
 
-// types of different bodies
-const size_t WALL_TYPE = 0;
-const size_t BULLET_TYPE = 1;
-const size_t SNIPER_BULLET_TYPE = 10;
-const size_t GRAVITY_BULLET_TYPE = 13;
-const size_t GATLING_BULLET_TYPE = 11;
-const size_t DEFAULT_TANK_TYPE = 2;
-const size_t GRAVITY_TANK_TYPE = 3;
-const size_t SNIPER_TANK_TYPE = 4;
-const size_t HEALTH_BAR_TYPE = 6;
-const size_t GATLING_TANK_TYPE = 7;
-
 int FONT_SIZE = 50;
 int TITLE_SIZE = 100;
 int TANK_SELECT_SIZE = 25;
@@ -39,8 +28,10 @@ double CIRCLE_POINTS = 300.0;
 // DEATH animation time
 double DEATH_PAUSE_TIME = 0.2;
 
-const double MAX_WIDTH_GAME = 1600.0;
-const double MAX_HEIGHT_GAME = 1300.0;
+// the game ticks at a fixed rate, however fast frames are drawn
+double PHYSICS_HZ = 120.0;
+// after a slower frame than this many ticks, the game falls behind
+size_t MAX_CATCH_UP_STEPS = 8;
 
 // elasticity between tank
 double TANKS_ELASTICITY = 3.0;
@@ -56,6 +47,10 @@ double BULLET_HEIGHT = 25.0;
 double BULLET_WIDTH = 10.0;
 double BULLET_VELOCITY = 300.0;
 double RELOAD_SPEED = 1.0;
+// how close the other tank must be for the AI to aim and shoot at it
+double AI_RANGE = 750.0;
+// room for every tank within the AI's range
+#define AI_NEARBY_CAPACITY 8
 
 // GRAVITY tank stats
 size_t GRAVITY_TANK_POINTS = 6;
@@ -95,12 +90,6 @@ double GATLING_BULLET_HEIGHT = 25.0;
 double GATLING_BULLET_WIDTH = 10.0;
 double GATLING_BULLET_VELOCITY = 400.0;
 
-// bullet damage
-const double BULLET_DAMAGE = 10.0;
-const double GRAVITY_BULLET_DAMAGE = 15.0;
-const double SNIPER_BULLET_DAMAGE = 25.0;
-const double GATLING_BULLET_DAMAGE = 5.0;
-
 // default bullet characteristics
 double BULLET_MASS = 5.0;
 double BULLET_DISAPPEAR_TIME = 10.0;
@@ -112,6 +101,10 @@ double HEALTH_BAR_OFFSET_VERTICAL = 25.0;
 
 double COLLISION_ELASTICITY = 20.0;
 
+// prints how many SAT tests the bounding boxes skip, averaged per tick
+bool SHOW_COLLISION_STATS = true;
+double COLLISION_STATS_INTERVAL = 1.0;
+
 // menu stats
 double BUTTON_X_MIN = 404.0;
 double BUTTON_X_MAX = 598.0;
@@ -160,6 +153,9 @@ typedef struct state {
   size_t player2_tank_type;
   int player1_score;
   int player2_score;
+  // the health each health bar currently shows
+  double player1_bar_health;
+  double player2_bar_health;
   bool singleplayer;
   bool is_menu;
   bool is_options;
@@ -168,118 +164,81 @@ typedef struct state {
   text_t *title;
   text_t *select_tank;
   text_t *scoreboard;
+  // collision counts since they were last printed
+  collision_stats_t collision_stats;
+  size_t stats_ticks;
+  double stats_time;
+  // turns the time between frames into fixed-length ticks
+  timestep_t *timestep;
 } state_t;
 
-list_t *make_half_circle(vector_t center, double radius) {
-  list_t *shape = list_init(18, (free_func_t)free);
+polygon_t make_half_circle(vector_t center, double radius) {
+  polygon_t shape = polygon_init(19);
   for (size_t i = 0; i < 18; i++) {
-    vector_t *point = malloc(sizeof(vector_t));
-    assert(point != NULL);
-    point->x = center.x + radius;
-    point->y = center.y;
-    list_add(shape, point);
-    polygon_rotate(shape, M_PI / 18, center);
+    polygon_add(&shape, (vector_t){center.x + radius, center.y});
+    polygon_rotate(&shape, M_PI / 18, center);
   }
-  vector_t *point = malloc(sizeof(vector_t));
-  assert(point != NULL);
-  point->x = center.x + radius;
-  point->y = center.y;
-  list_add(shape, point);
+  polygon_add(&shape, (vector_t){center.x + radius, center.y});
   return shape;
 }
 
-list_t *make_heart(vector_t center, double length) {
-  list_t *shape = list_init(100, (free_func_t)free);
+polygon_t make_heart(vector_t center, double length) {
+  polygon_t shape = polygon_init(39);
 
   // create first half circle
   vector_t rotation_area1 = {center.x + length / 2, center.y};
-  list_t *half_circle1 = make_half_circle(rotation_area1, length / 2);
+  polygon_t half_circle1 = make_half_circle(rotation_area1, length / 2);
   // have to use int here since size_t is unsigned
-  for (int i = (int)list_size(half_circle1) - 1; i >= 0; i--) {
-    vector_t *point = list_get(half_circle1, i);
-    list_add(shape, point);
+  for (int i = (int)polygon_size(&half_circle1) - 1; i >= 0; i--) {
+    polygon_add(&shape, polygon_get(&half_circle1, i));
   }
+  polygon_free(&half_circle1);
 
   // create second half circle
   vector_t rotation_area2 = {center.x - length / 2, center.y};
-  list_t *half_circle2 = make_half_circle(rotation_area2, length / 2);
-  for (int i = (int)list_size(half_circle2) - 1; i >= 0; i--) {
-    vector_t *point = list_get(half_circle2, i);
-    list_add(shape, point);
+  polygon_t half_circle2 = make_half_circle(rotation_area2, length / 2);
+  for (int i = (int)polygon_size(&half_circle2) - 1; i >= 0; i--) {
+    polygon_add(&shape, polygon_get(&half_circle2, i));
   }
+  polygon_free(&half_circle2);
 
-  vector_t *bottom_point = malloc(sizeof(vector_t));
-  *bottom_point = (vector_t){center.x, center.y - length};
-  list_add(shape, bottom_point);
+  polygon_add(&shape, (vector_t){center.x, center.y - length});
   return shape;
 }
 
-list_t *make_health_bar_p1(double health) {
-  list_t *shape = list_init(4, (free_func_t)free);
+polygon_t make_health_bar_p1(double health) {
+  polygon_t shape = polygon_init(4);
   if (health < 0) {
     health = 0.0;
   }
 
-  vector_t *point1 = malloc(sizeof(vector_t));
-  assert(point1 != NULL);
-  point1->x = health / DEFAULT_TANK_MAX_HEALTH * HEALTH_BAR_WIDTH +
-              HEALTH_BAR_OFFSET_HORIZONTAL;
-  point1->y = MAX_HEIGHT_GAME - HEALTH_BAR_HEIGHT - HEALTH_BAR_OFFSET_VERTICAL;
-  list_add(shape, point1);
-
-  vector_t *point2 = malloc(sizeof(vector_t));
-  assert(point2 != NULL);
-  point2->x = health / DEFAULT_TANK_MAX_HEALTH * HEALTH_BAR_WIDTH +
-              HEALTH_BAR_OFFSET_HORIZONTAL;
-  point2->y = MAX_HEIGHT_GAME - HEALTH_BAR_OFFSET_VERTICAL;
-  list_add(shape, point2);
-
-  vector_t *point3 = malloc(sizeof(vector_t));
-  assert(point3 != NULL);
-  point3->x = +HEALTH_BAR_OFFSET_HORIZONTAL;
-  point3->y = MAX_HEIGHT_GAME - HEALTH_BAR_OFFSET_VERTICAL;
-  list_add(shape, point3);
-  vector_t *point4 = malloc(sizeof(vector_t));
-  assert(point4 != NULL);
-  point4->x = +HEALTH_BAR_OFFSET_HORIZONTAL;
-  point4->y = MAX_HEIGHT_GAME - HEALTH_BAR_HEIGHT - HEALTH_BAR_OFFSET_VERTICAL;
-  list_add(shape, point4);
+  double right = health / DEFAULT_TANK_MAX_HEALTH * HEALTH_BAR_WIDTH +
+                 HEALTH_BAR_OFFSET_HORIZONTAL;
+  double top = MAX_HEIGHT_GAME - HEALTH_BAR_OFFSET_VERTICAL;
+  double bottom = top - HEALTH_BAR_HEIGHT;
+  polygon_add(&shape, (vector_t){right, bottom});
+  polygon_add(&shape, (vector_t){right, top});
+  polygon_add(&shape, (vector_t){HEALTH_BAR_OFFSET_HORIZONTAL, top});
+  polygon_add(&shape, (vector_t){HEALTH_BAR_OFFSET_HORIZONTAL, bottom});
   return shape;
 }
 
-list_t *make_health_bar_p2(double health) {
-  list_t *shape = list_init(4, (free_func_t)free);
+polygon_t make_health_bar_p2(double health) {
+  polygon_t shape = polygon_init(4);
   if (health < 0) {
     health = 0.0;
   }
 
-  vector_t *point1 = malloc(sizeof(vector_t));
-  assert(point1 != NULL);
-  point1->x = MAX_WIDTH_GAME -
-              health / DEFAULT_TANK_MAX_HEALTH * HEALTH_BAR_WIDTH -
-              HEALTH_BAR_OFFSET_HORIZONTAL;
-  point1->y = MAX_HEIGHT_GAME - HEALTH_BAR_OFFSET_VERTICAL;
-  list_add(shape, point1);
-
-  vector_t *point2 = malloc(sizeof(vector_t));
-  assert(point2 != NULL);
-  point2->x = MAX_WIDTH_GAME -
-              health / DEFAULT_TANK_MAX_HEALTH * HEALTH_BAR_WIDTH -
-              HEALTH_BAR_OFFSET_HORIZONTAL;
-  point2->y = MAX_HEIGHT_GAME - HEALTH_BAR_HEIGHT - HEALTH_BAR_OFFSET_VERTICAL;
-  list_add(shape, point2);
-
-  vector_t *point3 = malloc(sizeof(vector_t));
-  assert(point3 != NULL);
-  point3->x = MAX_WIDTH_GAME - HEALTH_BAR_OFFSET_HORIZONTAL;
-  point3->y = MAX_HEIGHT_GAME - HEALTH_BAR_HEIGHT - HEALTH_BAR_OFFSET_VERTICAL;
-  list_add(shape, point3);
-
-  vector_t *point4 = malloc(sizeof(vector_t));
-  assert(point4 != NULL);
-  point4->x = MAX_WIDTH_GAME - HEALTH_BAR_OFFSET_HORIZONTAL;
-  point4->y = MAX_HEIGHT_GAME - HEALTH_BAR_OFFSET_VERTICAL;
-  list_add(shape, point4);
+  double left = MAX_WIDTH_GAME -
+                health / DEFAULT_TANK_MAX_HEALTH * HEALTH_BAR_WIDTH -
+                HEALTH_BAR_OFFSET_HORIZONTAL;
+  double right = MAX_WIDTH_GAME - HEALTH_BAR_OFFSET_HORIZONTAL;
+  double top = MAX_HEIGHT_GAME - HEALTH_BAR_OFFSET_VERTICAL;
+  double bottom = top - HEALTH_BAR_HEIGHT;
+  polygon_add(&shape, (vector_t){left, top});
+  polygon_add(&shape, (vector_t){left, bottom});
+  polygon_add(&shape, (vector_t){right, bottom});
+  polygon_add(&shape, (vector_t){right, top});
   return shape;
 }
 void init_sounds() {
@@ -302,47 +261,30 @@ void death_sound() {
 
 void free_channel(int channel) { Mix_FreeChunk(Mix_GetChunk(channel)); }
 
-list_t *make_bullet(vector_t edge) {
-  list_t *shape = list_init(4, (free_func_t)free);
-  vector_t *point1 = malloc(sizeof(vector_t));
-  assert(point1 != NULL);
-  point1->x = edge.x;
-  point1->y = edge.y - BULLET_WIDTH / 2;
-  list_add(shape, point1);
-
-  vector_t *point2 = malloc(sizeof(vector_t));
-  assert(point2 != NULL);
-  point2->x = edge.x + BULLET_HEIGHT;
-  point2->y = edge.y - BULLET_WIDTH / 2;
-  list_add(shape, point2);
-
-  vector_t *point3 = malloc(sizeof(vector_t));
-  assert(point3 != NULL);
-  point3->x = edge.x + BULLET_HEIGHT;
-  point3->y = edge.y + BULLET_WIDTH / 2;
-  list_add(shape, point3);
-
-  vector_t *point4 = malloc(sizeof(vector_t));
-  assert(point4 != NULL);
-  point4->x = edge.x;
-  point4->y = edge.y + BULLET_WIDTH / 2;
-  list_add(shape, point4);
+polygon_t make_bullet(vector_t edge) {
+  polygon_t shape = polygon_init(4);
+  polygon_add(&shape, (vector_t){edge.x, edge.y - BULLET_WIDTH / 2});
+  polygon_add(&shape,
+              (vector_t){edge.x + BULLET_HEIGHT, edge.y - BULLET_WIDTH / 2});
+  polygon_add(&shape,
+              (vector_t){edge.x + BULLET_HEIGHT, edge.y + BULLET_WIDTH / 2});
+  polygon_add(&shape, (vector_t){edge.x, edge.y + BULLET_WIDTH / 2});
   return shape;
 }
 
 void handle_bullet(state_t *state, body_t *player, rgb_color_t color) {
   body_set_time(player, 0.0);
   vector_t spawn_point = body_get_centroid(player);
-  list_t *bullet_points =
+  polygon_t bullet_points =
       make_bullet(spawn_point); // can change make bullet later for sniper
                                 // bullet and machine gun bullet
-  polygon_rotate(bullet_points, body_get_rotation(player),
+  polygon_rotate(&bullet_points, body_get_rotation(player),
                  body_get_centroid(player));
   vector_t player_dir = {cos(body_get_rotation(player)),
                          sin(body_get_rotation(player))};
   vector_t move_up =
       vec_multiply(DEFAULT_TANK_SIDE_LENGTH / 2 + 10, player_dir);
-  polygon_translate(bullet_points, move_up);
+  polygon_translate(&bullet_points, move_up);
   size_t *type = malloc(sizeof(size_t));
   double vel;
   if (*(size_t *)body_get_info(player) == DEFAULT_TANK_TYPE) {
@@ -363,47 +305,22 @@ void handle_bullet(state_t *state, body_t *player, rgb_color_t color) {
   }
   body_t *bullet = body_init_with_info(bullet_points, BULLET_MASS, color, type,
                                        (free_func_t)free);
+  body_set_collision_layers(bullet, BULLET_LAYER,
+                            TANK_LAYER | BULLET_LAYER | OBSTACLE_LAYER);
+  body_set_bullet(bullet, true);
 
+  // drag and the gravity tank's pull come from the scene's force fields
+  size_t tags = BULLET_TAG;
   if (*(size_t *)body_get_info(player) == GRAVITY_TANK_TYPE) {
-    if (scene_get_body(state->scene, 0) == player) {
-      create_newtonian_gravity(state->scene, GRAVITY_TANK_STRENGTH,
-                               scene_get_body(state->scene, 1), bullet);
-      create_newtonian_gravity(state->scene, (-1 * GRAVITY_TANK_STRENGTH / 2),
-                               scene_get_body(state->scene, 0), bullet);
-    } else {
-      create_newtonian_gravity(state->scene, GRAVITY_TANK_STRENGTH,
-                               scene_get_body(state->scene, 0), bullet);
-      create_newtonian_gravity(state->scene, (-1 * GRAVITY_TANK_STRENGTH / 2),
-                               scene_get_body(state->scene, 1), bullet);
-    }
+    tags |= scene_get_body(state->scene, 0) == player ? PLAYER1_GRAVITY_TAG
+                                                      : PLAYER2_GRAVITY_TAG;
   }
+  body_set_tags(bullet, tags);
   body_set_rotation_empty(bullet, body_get_rotation(player));
+  body_set_align_to_velocity(bullet, true);
   body_set_velocity(bullet, vec_multiply(vel, player_dir));
   body_set_time(bullet, 0.0);
   scene_add_body(state->scene, bullet);
-
-  // create collision with tanks
-  create_partial_destructive_collision(state->scene,
-                                       scene_get_body(state->scene, 0), bullet);
-  create_partial_destructive_collision(state->scene,
-                                       scene_get_body(state->scene, 1), bullet);
-
-  // add drag force
-  create_drag(state->scene, GAMMA, bullet);
-
-  // create collision with walls and other bullets
-  for (size_t i = 2; i < scene_bodies(state->scene) - 1; i++) {
-    body_t *body = scene_get_body(state->scene, i);
-    if (*(size_t *)body_get_info(body) == BULLET_TYPE ||
-        *(size_t *)body_get_info(body) == SNIPER_BULLET_TYPE ||
-        *(size_t *)body_get_info(body) == GATLING_BULLET_TYPE ||
-        *(size_t *)body_get_info(body) == GRAVITY_BULLET_TYPE) {
-      create_destructive_collision(state->scene, body, bullet);
-    } else if (*(size_t *)body_get_info(body) == RECTANGLE_OBSTACLE_TYPE ||
-               *(size_t *)body_get_info(body) == TRIANGLE_OBSTACLE_TYPE) {
-      create_physics_collision(state->scene, 1.0, bullet, body);
-    }
-  }
 }
 
 void tank_handler(char key, key_event_type_t type, double held_time,
@@ -696,10 +613,23 @@ void reset_mode(body_t *ai) {
   body_set_ai_time(ai, 0.0);
 }
 
-void ai_aim(body_t *player, body_t *ai) {
+/** Whether the player's tank is within the AI's range. */
+bool ai_in_range(state_t *state, body_t *player, body_t *ai) {
+  body_t *nearby[AI_NEARBY_CAPACITY];
+  size_t count =
+      scene_query_radius(state->scene, body_get_centroid(ai), AI_RANGE,
+                         TANK_LAYER, nearby, AI_NEARBY_CAPACITY);
+  for (size_t i = 0; i < count && i < AI_NEARBY_CAPACITY; i++) {
+    if (nearby[i] == player) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void ai_aim(state_t *state, body_t *player, body_t *ai) {
   // program ai to aim towards enemy, works for default tank
-  if (body_get_distance(body_get_centroid(ai), body_get_centroid(player)) <
-      750.0) {
+  if (ai_in_range(state, player, ai)) {
     vector_t distance =
         vec_subtract(body_get_centroid(player), body_get_centroid(ai));
     double angle = atan(distance.y / distance.x);
@@ -723,9 +653,19 @@ void ai_aim(body_t *player, body_t *ai) {
   }
 }
 
+/**
+ * Whether the AI has a clear shot at the player:
+ * the first tank or obstacle on the line between them is the player.
+ */
+bool ai_sees(state_t *state, body_t *player, body_t *ai) {
+  ray_hit_t sight =
+      scene_segment_query(state->scene, body_get_centroid(ai),
+                          body_get_centroid(player), TANK_LAYER | OBSTACLE_LAYER);
+  return sight.body == player;
+}
+
 void ai_shoot(state_t *state, body_t *player, body_t *ai) {
-  if (body_get_distance(body_get_centroid(ai), body_get_centroid(player)) <
-      750.0) {
+  if (ai_in_range(state, player, ai)) {
     vector_t distance =
         vec_subtract(body_get_centroid(player), body_get_centroid(ai));
     double angle = atan(distance.y / distance.x);
@@ -741,8 +681,8 @@ void ai_shoot(state_t *state, body_t *player, body_t *ai) {
         2 * M_PI * ((size_t)angle / ((size_t)(2 * M_PI))); // simulate % by 2pi
 
     // program ai to shoot randomly, but only if pointed somewhat close to enemy
-    // tank
-    if (double_abs(angle - ai_angle) < M_PI / 8) {
+    // tank and no wall is in the way
+    if (double_abs(angle - ai_angle) < M_PI / 8 && ai_sees(state, player, ai)) {
       double time = body_get_time(ai);
       if (time > rand_num(RELOAD_SPEED, RELOAD_SPEED * 3)) {
         handle_bullet(state, ai, PLAYER2_COLOR);
@@ -751,6 +691,25 @@ void ai_shoot(state_t *state, body_t *player, body_t *ai) {
   }
 }
 
+/**
+ * Whether the AI's tank ran into a wall or the other tank on the last tick.
+ * Bullets hitting it do not count, and neither does staying against
+ * something it already hit.
+ */
+bool ai_bumped(state_t *state, body_t *ai) {
+  for (size_t i = 0; i < scene_contacts(state->scene); i++) {
+    const contact_t *contact = scene_get_contact(state->scene, i);
+    body_t *other = contact->body1 == ai   ? contact->body2
+                    : contact->body2 == ai ? contact->body1
+                                           : NULL;
+    if (other != NULL && !body_is_bullet(other) &&
+        contact->first_tick == scene_ticks(state->scene)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 void move_ai(state_t *state, double dt) {
   body_t *player = scene_get_body(state->scene, 0);
   body_t *ai = scene_get_body(state->scene, 1);
@@ -759,7 +718,7 @@ void move_ai(state_t *state, double dt) {
   ai_shoot(state, player, ai);
 
   if (ai_mode == 0) {
-    ai_aim(player, ai);
+    ai_aim(state, player, ai);
 
     body_set_velocity(ai, VEC_ZERO);
     body_set_magnitude(ai, 0.0);
@@ -770,10 +729,9 @@ void move_ai(state_t *state, double dt) {
       body_set_ai_time(ai, 0.0);
     }
   } else if (ai_mode == 1) {
-    if (body_get_just_collided(ai)) {
+    if (ai_bumped(state, ai)) {
       body_set_ai_mode(ai, 2);
       body_set_ai_time(ai, 1.5 - ai_time);
-      body_set_just_collided(ai, false);
     } else {
       body_set_magnitude(ai, DEFAULT_TANK_VELOCITY);
       if (ai_time > 1.5) {
@@ -781,10 +739,9 @@ void move_ai(state_t *state, double dt) {
       }
     }
   } else if (ai_mode == 2) {
-    if (body_get_just_collided(ai)) {
+    if (ai_bumped(state, ai)) {
       body_set_ai_mode(ai, 1);
       body_set_ai_time(ai, 1.5 - ai_time);
-      body_set_just_collided(ai, false);
     } else {
       body_set_magnitude(ai, -DEFAULT_TANK_VELOCITY);
       if (ai_time > 1.5) {
@@ -792,10 +749,9 @@ void move_ai(state_t *state, double dt) {
       }
     }
   } else if (ai_mode == 3) {
-    if (body_get_just_collided(ai)) {
+    if (ai_bumped(state, ai)) {
       body_set_ai_mode(ai, 6);
       body_set_ai_time(ai, 1.5 - ai_time);
-      body_set_just_collided(ai, false);
     } else {
       body_set_magnitude(ai, DEFAULT_TANK_VELOCITY);
       body_set_rotation_speed(ai, DEFAULT_TANK_ROTATION_SPEED);
@@ -804,10 +760,9 @@ void move_ai(state_t *state, double dt) {
       }
     }
   } else if (ai_mode == 4) {
-    if (body_get_just_collided(ai)) {
+    if (ai_bumped(state, ai)) {
       body_set_ai_mode(ai, 5);
       body_set_ai_time(ai, 1.5 - ai_time);
-      body_set_just_collided(ai, false);
     } else {
       body_set_magnitude(ai, DEFAULT_TANK_VELOCITY);
       body_set_rotation_speed(ai, -DEFAULT_TANK_ROTATION_SPEED);
@@ -816,10 +771,9 @@ void move_ai(state_t *state, double dt) {
       }
     }
   } else if (ai_mode == 5) {
-    if (body_get_just_collided(ai)) {
+    if (ai_bumped(state, ai)) {
       body_set_ai_mode(ai, 4);
       body_set_ai_time(ai, 1.5 - ai_time);
-      body_set_just_collided(ai, false);
     } else {
       body_set_magnitude(ai, -DEFAULT_TANK_VELOCITY);
       body_set_rotation_speed(ai, DEFAULT_TANK_ROTATION_SPEED);
@@ -828,10 +782,9 @@ void move_ai(state_t *state, double dt) {
       }
     }
   } else if (ai_mode == 6) {
-    if (body_get_just_collided(ai)) {
+    if (ai_bumped(state, ai)) {
       body_set_ai_mode(ai, 3);
       body_set_ai_time(ai, 1.5 - ai_time);
-      body_set_just_collided(ai, false);
     } else {
       body_set_magnitude(ai, -DEFAULT_TANK_VELOCITY);
       body_set_rotation_speed(ai, -DEFAULT_TANK_ROTATION_SPEED);
@@ -859,8 +812,8 @@ void move_ai(state_t *state, double dt) {
 void gameover_pop_up(state_t *state) {
   // background
   vector_t corner1 = {0.0, MAX_HEIGHT_GAME};
-  list_t *background = make_rectangle(corner1, MAX_WIDTH_GAME, MAX_HEIGHT_GAME);
-  sdl_draw_polygon(background, BLACK);
+  polygon_t background = make_rectangle(corner1, MAX_WIDTH_GAME, MAX_HEIGHT_GAME);
+  sdl_draw_polygon(&background, BLACK);
   char* player1_wins = "Player 1 wins";
   char* player2_wins = "Player 2 wins";
   char* winning_message;
@@ -890,9 +843,9 @@ void check_end_game(state_t *state) {
 
 void show_scoreboard(state_t *state, int player1_score, int player2_score) {
   vector_t corner = {600.0, MAX_HEIGHT_GAME - 25.0};
-  list_t *points = make_rectangle(corner, 400.0, 150.0);
+  polygon_t points = make_rectangle(corner, 400.0, 150.0);
   rgb_color_t black = {0.0, 0.0, 0.0};
-  sdl_draw_polygon(points, black);
+  sdl_draw_polygon(&points, black);
 
   SDL_Color white = {255, 255, 255, 255};
   // loc
@@ -959,21 +912,35 @@ void make_players(state_t *state) {
   body_set_health(player2, DEFAULT_TANK_MAX_HEALTH);
   scene_add_body(state->scene, player1);
   scene_add_body(state->scene, player2);
-  create_physics_collision(state->scene, TANKS_ELASTICITY,
-                           scene_get_body(state->scene, 0),
-                           scene_get_body(state->scene, 1));
+
+  // a gravity tank's bullets are pulled towards the other tank
+  // and pushed away from the tank that fired them
+  if (state->player1_tank_type == GRAVITY_TANK_TYPE) {
+    create_attractor(state->scene, GRAVITY_TANK_STRENGTH, player2,
+                     PLAYER1_GRAVITY_TAG);
+    create_attractor(state->scene, -GRAVITY_TANK_STRENGTH / 2, player1,
+                     PLAYER1_GRAVITY_TAG);
+  }
+  if (state->player2_tank_type == GRAVITY_TANK_TYPE) {
+    create_attractor(state->scene, GRAVITY_TANK_STRENGTH, player1,
+                     PLAYER2_GRAVITY_TAG);
+    create_attractor(state->scene, -GRAVITY_TANK_STRENGTH / 2, player2,
+                     PLAYER2_GRAVITY_TAG);
+  }
 }
 
 void make_health_bars(state_t *state) {
   // initialize health bars
-  list_t *p1_health_bar_shape = make_health_bar_p1(DEFAULT_TANK_MAX_HEALTH);
+  state->player1_bar_health = DEFAULT_TANK_MAX_HEALTH;
+  state->player2_bar_health = DEFAULT_TANK_MAX_HEALTH;
+  polygon_t p1_health_bar_shape = make_health_bar_p1(DEFAULT_TANK_MAX_HEALTH);
   size_t *type = malloc(sizeof(size_t));
   *type = HEALTH_BAR_TYPE;
   body_t *p1_health_bar = body_init_with_info(
       p1_health_bar_shape, 10.0, PLAYER1_COLOR, type, (free_func_t)free);
   scene_add_body(state->scene, p1_health_bar);
 
-  list_t *p2_health_bar_shape = make_health_bar_p2(DEFAULT_TANK_MAX_HEALTH);
+  polygon_t p2_health_bar_shape = make_health_bar_p2(DEFAULT_TANK_MAX_HEALTH);
   size_t *type2 = malloc(sizeof(size_t));
   *type2 = HEALTH_BAR_TYPE;
   body_t *p2_health_bar = body_init_with_info(
@@ -983,14 +950,14 @@ void make_health_bars(state_t *state) {
   vector_t P1_HEART_CENTER = {50.0, MAX_HEIGHT_GAME - 40.0};
   vector_t P2_HEART_CENTER = {MAX_WIDTH_GAME - 50.0, MAX_HEIGHT_GAME - 40.0};
 
-  list_t *p1_heart = make_heart(P1_HEART_CENTER, 50.0);
+  polygon_t p1_heart = make_heart(P1_HEART_CENTER, 50.0);
   size_t *type3 = malloc(sizeof(size_t));
   *type3 = HEALTH_BAR_TYPE;
   body_t *p1_heart_body = body_init_with_info(
       p1_heart, 10.0, PLAYER1_COLOR_SIMILAR, type3, (free_func_t)free);
   scene_add_body(state->scene, p1_heart_body);
 
-  list_t *p2_heart = make_heart(P2_HEART_CENTER, 50.0);
+  polygon_t p2_heart = make_heart(P2_HEART_CENTER, 50.0);
   size_t *type4 = malloc(sizeof(size_t));
   *type4 = HEALTH_BAR_TYPE;
   body_t *p2_heart_body = body_init_with_info(
@@ -1009,18 +976,6 @@ void reset_game(state_t *state) {
   make_players(state);
   make_health_bars(state);
   map_init(state->scene);
-  for (size_t i = 2; i < scene_bodies(state->scene); i++) {
-    body_t *body = scene_get_body(state->scene, i);
-    if (*(size_t *)body_get_info(body) == RECTANGLE_OBSTACLE_TYPE ||
-        *(size_t *)body_get_info(body) == TRIANGLE_OBSTACLE_TYPE) {
-      create_physics_collision(state->scene, COLLISION_ELASTICITY,
-                               scene_get_body(state->scene, 0),
-                               scene_get_body(state->scene, i));
-      create_physics_collision(state->scene, COLLISION_ELASTICITY,
-                               scene_get_body(state->scene, 1),
-                               scene_get_body(state->scene, i));
-    }
-  }
 }
 
 bool check_round_end(state_t *state) {
@@ -1150,13 +1105,13 @@ void menu_init(state_t *state) {
 
 void menu_pop_up(state_t *state) {
   vector_t corner1 = {0.0, MAX_HEIGHT_GAME};
-  list_t *background = make_rectangle(corner1, MAX_WIDTH_GAME, MAX_HEIGHT_GAME);
-  sdl_draw_polygon(background, LIGHT_GREY);
+  polygon_t background = make_rectangle(corner1, MAX_WIDTH_GAME, MAX_HEIGHT_GAME);
+  sdl_draw_polygon(&background, LIGHT_GREY);
 
   // start button
   vector_t corner2 = {550.0, 750.0};
-  list_t *start_button = make_rectangle(corner2, 500.0, 180.0);
-  sdl_draw_polygon(start_button, GREEN);
+  polygon_t start_button = make_rectangle(corner2, 500.0, 180.0);
+  sdl_draw_polygon(&start_button, GREEN);
 
   vector_t start_loc = {680.0, 750.0};
   SDL_Texture *start =
@@ -1164,8 +1119,8 @@ void menu_pop_up(state_t *state) {
 
   // options button
   vector_t corner3 = {550.0, 500.0};
-  list_t *options_button = make_rectangle(corner3, 500.0, 180.0);
-  sdl_draw_polygon(options_button, SLATE_GREY);
+  polygon_t options_button = make_rectangle(corner3, 500.0, 180.0);
+  sdl_draw_polygon(&options_button, SLATE_GREY);
 
   // options text
   vector_t options_loc = {640.0, 500.0};
@@ -1186,8 +1141,8 @@ void menu_pop_up(state_t *state) {
 void options_pop_up(state_t *state) {
   // background
   vector_t corner1 = {0.0, MAX_HEIGHT_GAME};
-  list_t *background = make_rectangle(corner1, MAX_WIDTH_GAME, MAX_HEIGHT_GAME);
-  sdl_draw_polygon(background, LIGHT_GREY);
+  polygon_t background = make_rectangle(corner1, MAX_WIDTH_GAME, MAX_HEIGHT_GAME);
+  sdl_draw_polygon(&background, LIGHT_GREY);
 
   rgb_color_t singleplayer_color = FOREST_GREEN_POLY;
   rgb_color_t twoplayer_color = FOREST_GREEN_POLY;
@@ -1200,16 +1155,16 @@ void options_pop_up(state_t *state) {
 
   // 1 PLAYER button
   vector_t corner2 = {200.0, 1140.0};
-  list_t *oneplayer_button = make_rectangle(corner2, 500.0, 200.0);
-  sdl_draw_polygon(oneplayer_button, singleplayer_color);
+  polygon_t oneplayer_button = make_rectangle(corner2, 500.0, 200.0);
+  sdl_draw_polygon(&oneplayer_button, singleplayer_color);
   vector_t one_player_loc = {250.0, 1130.0};
   SDL_Texture *oneplayer =
       sdl_load_text(state, "1 PLAYER", state->text, SDL_WHITE, one_player_loc);
 
   // 2 PLAYER button
   vector_t corner3 = {900.0, 1140.0};
-  list_t *twoplayer_button = make_rectangle(corner3, 500.0, 200.0);
-  sdl_draw_polygon(twoplayer_button, twoplayer_color);
+  polygon_t twoplayer_button = make_rectangle(corner3, 500.0, 200.0);
+  sdl_draw_polygon(&twoplayer_button, twoplayer_color);
   vector_t two_players_loc = {920.0, 1130.0};
   SDL_Texture *twoplayer = sdl_load_text(state, "2 PLAYERS", state->text,
                                          SDL_WHITE, two_players_loc);
@@ -1264,29 +1219,29 @@ void options_pop_up(state_t *state) {
 
   // player 1 tanks
   vector_t tank1_corner = {120.0, 600.0};
-  list_t *tank1_box = make_rectangle(tank1_corner, 200.0, 100.0);
-  sdl_draw_polygon(tank1_box, tank1_color);
+  polygon_t tank1_box = make_rectangle(tank1_corner, 200.0, 100.0);
+  sdl_draw_polygon(&tank1_box, tank1_color);
   vector_t tank1_loc = {135.0, 600.0};
   SDL_Texture *tank1 =
       sdl_load_text(state, "default", state->select_tank, SDL_WHITE, tank1_loc);
 
   vector_t tank2_corner = {460.0, 600.0};
-  list_t *tank2_box = make_rectangle(tank2_corner, 200.0, 100.0);
-  sdl_draw_polygon(tank2_box, tank2_color);
+  polygon_t tank2_box = make_rectangle(tank2_corner, 200.0, 100.0);
+  sdl_draw_polygon(&tank2_box, tank2_color);
   vector_t tank2_loc = {475.0, 600.0};
   SDL_Texture *tank2 =
       sdl_load_text(state, "gravity", state->select_tank, SDL_WHITE, tank2_loc);
 
   vector_t tank3_corner = {120.0, 400.0};
-  list_t *tank3_box = make_rectangle(tank3_corner, 200.0, 100.0);
-  sdl_draw_polygon(tank3_box, tank3_color);
+  polygon_t tank3_box = make_rectangle(tank3_corner, 200.0, 100.0);
+  sdl_draw_polygon(&tank3_box, tank3_color);
   vector_t tank3_loc = {145.0, 400.0};
   SDL_Texture *tank3 =
       sdl_load_text(state, "sniper", state->select_tank, SDL_WHITE, tank3_loc);
 
   vector_t tank4_corner = {460.0, 400.0};
-  list_t *tank4_box = make_rectangle(tank4_corner, 200.0, 100.0);
-  sdl_draw_polygon(tank4_box, tank4_color);
+  polygon_t tank4_box = make_rectangle(tank4_corner, 200.0, 100.0);
+  sdl_draw_polygon(&tank4_box, tank4_color);
   vector_t tank4_loc = {475.0, 400.0};
   SDL_Texture *tank4 =
       sdl_load_text(state, "gatling", state->select_tank, SDL_WHITE, tank4_loc);
@@ -1294,37 +1249,37 @@ void options_pop_up(state_t *state) {
   // player 2 tanks
   double shiftx = 750.0;
   vector_t tank5_corner = {120.0 + shiftx, 600.0};
-  list_t *tank5_box = make_rectangle(tank5_corner, 200.0, 100.0);
-  sdl_draw_polygon(tank5_box, tank5_color);
+  polygon_t tank5_box = make_rectangle(tank5_corner, 200.0, 100.0);
+  sdl_draw_polygon(&tank5_box, tank5_color);
   vector_t tank5_loc = {135.0 + shiftx, 600.0};
   SDL_Texture *tank5 =
       sdl_load_text(state, "default", state->select_tank, SDL_WHITE, tank5_loc);
 
   vector_t tank6_corner = {460.0 + shiftx, 600.0};
-  list_t *tank6_box = make_rectangle(tank6_corner, 200.0, 100.0);
-  sdl_draw_polygon(tank6_box, tank6_color);
+  polygon_t tank6_box = make_rectangle(tank6_corner, 200.0, 100.0);
+  sdl_draw_polygon(&tank6_box, tank6_color);
   vector_t tank6_loc = {475.0 + shiftx, 600.0};
   SDL_Texture *tank6 =
       sdl_load_text(state, "gravity", state->select_tank, SDL_WHITE, tank6_loc);
 
   vector_t tank7_corner = {120.0 + shiftx, 400.0};
-  list_t *tank7_box = make_rectangle(tank7_corner, 200.0, 100.0);
-  sdl_draw_polygon(tank7_box, tank7_color);
+  polygon_t tank7_box = make_rectangle(tank7_corner, 200.0, 100.0);
+  sdl_draw_polygon(&tank7_box, tank7_color);
   vector_t tank7_loc = {145.0 + shiftx, 400.0};
   SDL_Texture *tank7 =
       sdl_load_text(state, "sniper", state->select_tank, SDL_WHITE, tank7_loc);
 
   vector_t tank8_corner = {460.0 + shiftx, 400.0};
-  list_t *tank8_box = make_rectangle(tank8_corner, 200.0, 100.0);
-  sdl_draw_polygon(tank8_box, tank8_color);
+  polygon_t tank8_box = make_rectangle(tank8_corner, 200.0, 100.0);
+  sdl_draw_polygon(&tank8_box, tank8_color);
   vector_t tank8_loc = {475.0 + shiftx, 400.0};
   SDL_Texture *tank8 =
       sdl_load_text(state, "gatling", state->select_tank, SDL_WHITE, tank8_loc);
 
   // go back button
   vector_t go_back_corner = {550.0, 220.0};
-  list_t *go_back_button = make_rectangle(go_back_corner, 500.0, 180.0);
-  sdl_draw_polygon(go_back_button, BLACK);
+  polygon_t go_back_button = make_rectangle(go_back_corner, 500.0, 180.0);
+  sdl_draw_polygon(&go_back_button, BLACK);
   vector_t go_back_loc = {680.0, 220.0};
   SDL_Texture *go_back =
       sdl_load_text(state, "Back", state->text, SDL_WHITE, go_back_loc);
@@ -1352,19 +1307,6 @@ void game_starter(state_t *state) {
   make_health_bars(state);
   map_init(state->scene);
   show_scoreboard(state, 0, 0);
-  // creates collisions
-  for (size_t i = 2; i < scene_bodies(state->scene); i++) {
-    body_t *body = scene_get_body(state->scene, i);
-    if (*(size_t *)body_get_info(body) == RECTANGLE_OBSTACLE_TYPE ||
-        *(size_t *)body_get_info(body) == TRIANGLE_OBSTACLE_TYPE) {
-      create_physics_collision(state->scene, COLLISION_ELASTICITY,
-                               scene_get_body(state->scene, 0),
-                               scene_get_body(state->scene, i));
-      create_physics_collision(state->scene, COLLISION_ELASTICITY,
-                               scene_get_body(state->scene, 1),
-                               scene_get_body(state->scene, i));
-    }
-  }
 }
 
 void handler(char key, key_event_type_t type, double held_time, state_t *state,
@@ -1437,6 +1379,18 @@ void handler(char key, key_event_type_t type, double held_time, state_t *state,
   }
 }
 
+// registers every collision in the game once, by collision layer,
+// so bullets and players pick them up as they are added to the scene
+void add_collision_rules(scene_t *scene) {
+  create_layer_partial_destructive_collision(scene, TANK_LAYER, BULLET_LAYER);
+  create_layer_physics_collision(scene, COLLISION_ELASTICITY, TANK_LAYER,
+                                 OBSTACLE_LAYER);
+  create_layer_physics_collision(scene, TANKS_ELASTICITY, TANK_LAYER,
+                                 TANK_LAYER);
+  create_layer_destructive_collision(scene, BULLET_LAYER, BULLET_LAYER);
+  create_layer_physics_collision(scene, 1.0, BULLET_LAYER, OBSTACLE_LAYER);
+}
+
 state_t *emscripten_init() {
   init_sounds();
   vector_t min = VEC_ZERO;
@@ -1446,6 +1400,8 @@ state_t *emscripten_init() {
   assert(state != NULL);
   state->time = 0.0;
   state->scene = scene_init();
+  add_collision_rules(state->scene);
+  create_drag_field(state->scene, GAMMA, BULLET_TAG);
   state->player1_score = 0;
   state->player2_score = 0;
   state->player1_tank_type = DEFAULT_TANK_TYPE; //
@@ -1453,11 +1409,78 @@ state_t *emscripten_init() {
   state->singleplayer = false; // could comment this out for it to work
   state->is_options = false;
   state->is_round_end = false;
+  state->collision_stats = (collision_stats_t){0, 0};
+  state->stats_ticks = 0;
+  state->stats_time = 0.0;
+  state->timestep = timestep_init(PHYSICS_HZ, MAX_CATCH_UP_STEPS);
 
   menu_init(state);
   return state;
 }
 
+/**
+ * Adds up the collision tests of the last tick,
+ * and prints the average per tick every COLLISION_STATS_INTERVAL seconds.
+ */
+void show_collision_stats(state_t *state, double dt) {
+  collision_stats_t stats = collision_take_stats();
+  state->collision_stats.pairs += stats.pairs;
+  state->collision_stats.sat_tests += stats.sat_tests;
+  state->stats_ticks++;
+  state->stats_time += dt;
+  if (state->stats_time < COLLISION_STATS_INTERVAL) {
+    return;
+  }
+  double ticks = (double)state->stats_ticks;
+  printf("collisions per tick: %.1f pairs, %.1f SAT tests, %.1f skipped\n",
+         state->collision_stats.pairs / ticks,
+         state->collision_stats.sat_tests / ticks,
+         (state->collision_stats.pairs - state->collision_stats.sat_tests) /
+             ticks);
+  pool_stats_t pool = scene_get_pool_stats(state->scene);
+  printf("force pool: %zu live, %zu peak, %zu slabs\n", pool.live, pool.peak,
+         pool.slabs);
+  state->collision_stats = (collision_stats_t){0, 0};
+  state->stats_ticks = 0;
+  state->stats_time = 0.0;
+}
+
+/** Runs one fixed-length tick of the game. */
+void step_game(state_t *state, double dt) {
+  state->time += dt;
+  state->is_round_end = check_round_end(state);
+
+  // add time to player bodies for reload
+  body_t *player1 = scene_get_body(state->scene, 0);
+  body_t *player2 = scene_get_body(state->scene, 1);
+  body_set_time(player1, body_get_time(player1) + dt);
+  body_set_time(player2, body_get_time(player2) + dt);
+
+  if (state->singleplayer) {
+    move_ai(state, dt);
+    body_set_ai_time(player2, body_get_ai_time(player2) + dt);
+  }
+
+  // add time to bullet bodies to see if they should disappear
+  for (size_t i = 2; i < scene_bodies(state->scene); i++) {
+    body_t *body = scene_get_body(state->scene, i);
+    if (*(size_t *)body_get_info(body) == BULLET_TYPE ||
+        *(size_t *)body_get_info(body) == SNIPER_BULLET_TYPE ||
+        *(size_t *)body_get_info(body) == GATLING_BULLET_TYPE ||
+        *(size_t *)body_get_info(body) == GRAVITY_BULLET_TYPE) {
+      body_set_time(body, body_get_time(body) + dt);
+      if (body_get_time(body) > BULLET_DISAPPEAR_TIME) {
+        body_remove(body);
+      }
+    }
+  }
+
+  scene_tick(state->scene, dt);
+  if (SHOW_COLLISION_STATS) {
+    show_collision_stats(state, dt);
+  }
+}
+
 void emscripten_main(state_t *state) {
   sdl_clear();
   if (state->is_menu) {
@@ -1467,52 +1490,44 @@ void emscripten_main(state_t *state) {
     options_pop_up(state);
     sdl_on_key((key_handler_t)handler);
   } else {
-    double dt = time_since_last_tick();
+    double elapsed = time_since_last_tick();
     sdl_on_key((key_handler_t)handler);
-    state->time += dt;
     if (state->is_round_end) {
       death_sound();
-      while (dt < DEATH_PAUSE_TIME) {
-        dt += time_since_last_tick();
+      double paused = elapsed;
+      while (paused < DEATH_PAUSE_TIME) {
+        paused += time_since_last_tick();
       }
       reset_game(state);
+      state->is_round_end = false;
+    }
+
+    // stop at the end of a round, so the destroyed tank is drawn
+    size_t steps = timestep_advance(state->timestep, elapsed);
+    double dt = timestep_get_dt(state->timestep);
+    for (size_t i = 0; i < steps && !state->is_round_end; i++) {
+      step_game(state, dt);
     }
-    state->is_round_end = check_round_end(state);
 
-    // add time to player bodies for reload
+    // update the health bars, only rebuilding them when health changes
     body_t *player1 = scene_get_body(state->scene, 0);
     body_t *player2 = scene_get_body(state->scene, 1);
-    body_set_time(player1, body_get_time(player1) + dt);
-    body_set_time(player2, body_get_time(player2) + dt);
-
-    if (state->singleplayer) {
-      move_ai(state, dt);
-      body_set_ai_time(player2, body_get_ai_time(player2) + dt);
+    if (body_get_health(player1) != state->player1_bar_health) {
+      state->player1_bar_health = body_get_health(player1);
+      body_t *health_bar_p1 = scene_get_body(state->scene, 2);
+      body_set_shape(health_bar_p1,
+                     make_health_bar_p1(state->player1_bar_health));
     }
 
-    // add time to bullet bodies to see if they should disappear
-    for (size_t i = 2; i < scene_bodies(state->scene); i++) {
-      body_t *body = scene_get_body(state->scene, i);
-      if (*(size_t *)body_get_info(body) == BULLET_TYPE ||
-          *(size_t *)body_get_info(body) == SNIPER_BULLET_TYPE ||
-          *(size_t *)body_get_info(body) == GATLING_BULLET_TYPE ||
-          *(size_t *)body_get_info(body) == GRAVITY_BULLET_TYPE) {
-        body_set_time(body, body_get_time(body) + dt);
-        if (body_get_time(body) > BULLET_DISAPPEAR_TIME) {
-          body_remove(body);
-        }
-      }
+    if (body_get_health(player2) != state->player2_bar_health) {
+      state->player2_bar_health = body_get_health(player2);
+      body_t *health_bar_p2 = scene_get_body(state->scene, 3);
+      body_set_shape(health_bar_p2,
+                     make_health_bar_p2(state->player2_bar_health));
     }
 
-    // //update health bar
-    body_t *health_bar_p1 = scene_get_body(state->scene, 2);
-    body_set_shape(health_bar_p1, make_health_bar_p1(body_get_health(player1)));
-
-    body_t *health_bar_p2 = scene_get_body(state->scene, 3);
-    body_set_shape(health_bar_p2, make_health_bar_p2(body_get_health(player2)));
-
-    scene_tick(state->scene, dt);
-    sdl_render_scene(state->scene);
+    sdl_render_scene_interpolated(state->scene,
+                                  timestep_get_alpha(state->timestep));
     show_scoreboard(state, state->player1_score, state->player2_score);
     check_end_game(state);
   }
@@ -1520,5 +1535,6 @@ void emscripten_main(state_t *state) {
 
 void emscripten_free(state_t *state) {
   scene_free(state->scene);
+  timestep_free(state->timestep);
   free(state);
 }
@@ -33,10 +33,10 @@ typedef struct state {
 } state_t;
 
 bool is_out_of_bounds(star_t *star) {
-  list_t *polygon = get_star_polygon(star);
-  for (int i = 0; i < list_size(polygon); i++) {
-    vector_t *curr = list_get(polygon, i);
-    if (curr->x < MAX_WIDTH) {
+  polygon_t *polygon = get_star_polygon(star);
+  for (int i = 0; i < polygon_size(polygon); i++) {
+    vector_t curr = polygon_get(polygon, i);
+    if (curr.x < MAX_WIDTH) {
       return false;
     }
   }
@@ -55,9 +55,9 @@ star_t *move_star(int i, state_t *state, double dt) {
 
   if (!get_star_just_moved(star)) {
     if (fabs(vel->y) > dt * GRAVITATIONAL_CONSTANT) {
-      for (size_t j = 0; j < list_size(get_star_polygon(star)); j++) {
-        vector_t *vector = list_get(get_star_polygon(star), j);
-        if (vector->y <= 0.0) {
+      for (size_t j = 0; j < polygon_size(get_star_polygon(star)); j++) {
+        vector_t vector = polygon_get(get_star_polygon(star), j);
+        if (vector.y <= 0.0) {
           vel->y = -1 * vel->y * DAMPING_CONSTANT;
           set_star_just_moved(star, true);
           break;
@@ -9,20 +9,24 @@
 #include <assert.h>
 #include <math.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 
 double MAX_WIDTH = 1000.0;
 double MAX_HEIGHT = 500.0;
-size_t NUM_STARS = 50;
+size_t NUM_STARS = 50000;
 int STAR_POINTS = 4;
 
-double MIN_LENGTH = 10.0;
-double MAX_LENGTH = 30.0;
+double MIN_LENGTH = 1.0;
+double MAX_LENGTH = 3.0;
 double MIN_MASS = 5.0;
 double MAX_MASS = 20.0;
 
-double GRAVITY_CONSTANT = 500;
+// scaled down with the number of stars, so the total pull stays the same
+double GRAVITY_CONSTANT = 0.5;
+// how far the gravity approximation may open up (see quadtree_field())
+double GRAVITY_THETA = 0.7;
 
 typedef struct state {
   scene_t *scene;
@@ -40,7 +44,7 @@ state_t *emscripten_init() {
 
   for (size_t i = 0; i < NUM_STARS; i++) {
     vector_t center = {rand_num(0.0, MAX_WIDTH), rand_num(0.0, MAX_HEIGHT)};
-    list_t *star =
+    polygon_t star =
         make_star(center, rand_num(MIN_LENGTH, MAX_LENGTH), STAR_POINTS);
     double mass = rand_num(MIN_MASS, MAX_MASS);
     rgb_color_t color = {rand_num(0.0, 1.0), rand_num(0.0, 1.0),
@@ -49,13 +53,8 @@ state_t *emscripten_init() {
     scene_add_body(state->scene, body);
   }
 
-  for (size_t i = 0; i < NUM_STARS; i++) {
-    for (size_t j = i + 1; j < NUM_STARS; j++) {
-      create_newtonian_gravity(state->scene, GRAVITY_CONSTANT,
-                               scene_get_body(state->scene, i),
-                               scene_get_body(state->scene, j));
-    }
-  }
+  create_barnes_hut_gravity(state->scene, GRAVITY_CONSTANT, GRAVITY_THETA,
+                            SIZE_MAX);
 
   return state;
 }
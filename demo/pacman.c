@@ -89,26 +89,16 @@ void check_pacman_wrap(scene_t *scene) {
 }
 
 body_t *make_pacman(vector_t center, double length) {
-  list_t *shape = list_init(CIRCLE_POINTS + 1, (free_func_t)free);
+  polygon_t shape = polygon_init(CIRCLE_POINTS + 1);
 
   for (size_t i = 0; i < CIRCLE_POINTS; i++) {
-    vector_t *point = malloc(sizeof(vector_t));
-    assert(point != NULL);
-
-    point->x = center.x;
-    point->y = center.y + length;
-
-    list_add(shape, point);
-    polygon_rotate(shape, -1 * M_PI / 180, center);
+    polygon_add(&shape, (vector_t){center.x, center.y + length});
+    polygon_rotate(&shape, -1 * M_PI / 180, center);
   }
 
-  polygon_rotate(shape, -1 * M_PI / 6 - M_PI / 2, center);
+  polygon_rotate(&shape, -1 * M_PI / 6 - M_PI / 2, center);
 
-  vector_t *center_point = malloc(sizeof(vector_t));
-  assert(center_point != NULL);
-  center_point->x = center.x;
-  center_point->y = center.y;
-  list_add(shape, center_point);
+  polygon_add(&shape, center);
 
   body_t *pacman = body_init(shape, INITIAL_MASS, YELLOW);
 
@@ -116,17 +106,11 @@ body_t *make_pacman(vector_t center, double length) {
 }
 
 body_t *make_pellet(vector_t center, double length) {
-  list_t *shape = list_init(PELLET_POINTS, (free_func_t)free);
+  polygon_t shape = polygon_init(PELLET_POINTS);
 
   for (size_t i = 0; i < PELLET_POINTS; i++) {
-    vector_t *point = malloc(sizeof(vector_t));
-    assert(point != NULL);
-
-    point->x = center.x;
-    point->y = center.y + length;
-
-    list_add(shape, point);
-    polygon_rotate(shape, -M_PI / (PELLET_POINTS / 2), center);
+    polygon_add(&shape, (vector_t){center.x, center.y + length});
+    polygon_rotate(&shape, -M_PI / (PELLET_POINTS / 2), center);
   }
 
   body_t *pellet = body_init(shape, PELLET_MASS, YELLOW);
@@ -7,8 +7,6 @@
 #include <stdlib.h>
 #include <time.h>
 
-#define CIRCLE_POINTS 40
-
 #define MAX ((vector_t){.x = 80.0, .y = 80.0})
 
 #define N_ROWS 11
@@ -59,39 +57,17 @@ body_type_t get_type(body_t *body) {
 double rand_double(void) { return (double)rand() / RAND_MAX; }
 
 /** Constructs a rectangle with the given dimensions centered at (0, 0) */
-list_t *rect_init(double width, double height) {
+polygon_t rect_init(double width, double height) {
   vector_t half_width = {.x = width / 2, .y = 0.0},
            half_height = {.x = 0.0, .y = height / 2};
-  list_t *rect = list_init(4, free);
-  vector_t *v = malloc(sizeof(*v));
-  *v = vec_add(half_width, half_height);
-  list_add(rect, v);
-  v = malloc(sizeof(*v));
-  *v = vec_subtract(half_height, half_width);
-  list_add(rect, v);
-  v = malloc(sizeof(*v));
-  *v = vec_negate(*(vector_t *)list_get(rect, 0));
-  list_add(rect, v);
-  v = malloc(sizeof(*v));
-  *v = vec_subtract(half_width, half_height);
-  list_add(rect, v);
+  polygon_t rect = polygon_init(4);
+  polygon_add(&rect, vec_add(half_width, half_height));
+  polygon_add(&rect, vec_subtract(half_height, half_width));
+  polygon_add(&rect, vec_negate(polygon_get(&rect, 0)));
+  polygon_add(&rect, vec_subtract(half_width, half_height));
   return rect;
 }
 
-/** Constructs a circles with the given radius centered at (0, 0) */
-list_t *circle_init(double radius) {
-  list_t *circle = list_init(CIRCLE_POINTS, free);
-  double arc_angle = 2 * M_PI / CIRCLE_POINTS;
-  vector_t point = {.x = radius, .y = 0.0};
-  for (size_t i = 0; i < CIRCLE_POINTS; i++) {
-    vector_t *v = malloc(sizeof(*v));
-    *v = point;
-    list_add(circle, v);
-    point = vec_rotate(point, arc_angle);
-  }
-  return circle;
-}
-
 /** Computes the center of the peg in the given row and column */
 vector_t get_peg_center(size_t row, size_t col) {
   vector_t center = {.x = MAX.x / 2 + (col - row * 0.5) * COL_SPACING,
@@ -102,7 +78,7 @@ vector_t get_peg_center(size_t row, size_t col) {
 /** Creates an Earth-like mass to accelerate the balls */
 void add_gravity_body(scene_t *scene) {
   // Will be offscreen, so shape is irrelevant
-  list_t *gravity_ball = rect_init(1, 1);
+  polygon_t gravity_ball = rect_init(1, 1);
   body_t *body = body_init_with_info(gravity_ball, M, WALL_COLOR,
                                      make_type_info(GRAVITY), free);
 
@@ -114,11 +90,8 @@ void add_gravity_body(scene_t *scene) {
 
 /** Creates a ball with the given starting position and velocity */
 body_t *get_ball(vector_t center, vector_t velocity) {
-  list_t *shape = circle_init(BALL_RADIUS);
-  body_t *ball = body_init_with_info(shape, BALL_MASS, BALL_COLOR,
-                                     make_type_info(BALL), free);
-
-  body_set_centroid(ball, center);
+  body_t *ball = body_init_circle(center, BALL_RADIUS, BALL_MASS, BALL_COLOR,
+                                  make_type_info(BALL), free);
   body_set_velocity(ball, velocity);
 
   return ball;
@@ -184,10 +157,9 @@ void add_pegs(scene_t *scene) {
   // Add N_ROWS and N_COLS of pegs.
   for (size_t i = 1; i <= N_ROWS; i++) {
     for (size_t j = 0; j <= i; j++) {
-      list_t *polygon = circle_init(PEG_RADIUS);
-      body_t *body = body_init_with_info(polygon, INFINITY, PEG_COLOR,
-                                         make_type_info(WALL), free);
-      body_set_centroid(body, get_peg_center(i, j));
+      body_t *body = body_init_circle(get_peg_center(i, j), PEG_RADIUS,
+                                      INFINITY, PEG_COLOR,
+                                      make_type_info(WALL), free);
       scene_add_body(scene, body);
     }
   }
@@ -196,16 +168,16 @@ void add_pegs(scene_t *scene) {
 /** Adds the walls to the scene */
 void add_walls(scene_t *scene) {
   // Add walls
-  list_t *rect = rect_init(WALL_LENGTH, WALL_WIDTH);
-  polygon_translate(rect, (vector_t){.x = WALL_LENGTH / 2, .y = 0.0});
-  polygon_rotate(rect, WALL_ANGLE, VEC_ZERO);
+  polygon_t rect = rect_init(WALL_LENGTH, WALL_WIDTH);
+  polygon_translate(&rect, (vector_t){.x = WALL_LENGTH / 2, .y = 0.0});
+  polygon_rotate(&rect, WALL_ANGLE, VEC_ZERO);
   body_t *body = body_init_with_info(rect, INFINITY, WALL_COLOR,
                                      make_type_info(WALL), free);
   scene_add_body(scene, body);
 
   rect = rect_init(WALL_LENGTH, WALL_WIDTH);
-  polygon_translate(rect, (vector_t){.x = MAX.x - WALL_LENGTH / 2, .y = 0.0});
-  polygon_rotate(rect, -WALL_ANGLE, (vector_t){.x = MAX.x, .y = 0.0});
+  polygon_translate(&rect, (vector_t){.x = MAX.x - WALL_LENGTH / 2, .y = 0.0});
+  polygon_rotate(&rect, -WALL_ANGLE, (vector_t){.x = MAX.x, .y = 0.0});
   body = body_init_with_info(rect, INFINITY, WALL_COLOR, make_type_info(WALL),
                              free);
   scene_add_body(scene, body);
@@ -0,0 +1,39 @@
+/** Common functions for benchmarks. */
+
+#ifndef __BENCH_UTIL_H__
+#define __BENCH_UTIL_H__
+
+#include <stddef.h>
+
+#include "polygon.h"
+#include "vector.h"
+
+/**
+ * Returns the current value of a monotonic wall clock, in seconds.
+ * Only differences between two calls are meaningful.
+ */
+double bench_now(void);
+
+/**
+ * Builds an axis-aligned square, centered at the given point,
+ * as a polygon with vertices in counterclockwise order.
+ *
+ * @param center the center of the square
+ * @param side_length the length of each side
+ * @return the square, which must be polygon_free()d unless given to a body
+ */
+polygon_t bench_square(vector_t center, double side_length);
+
+/**
+ * Prints one line of a benchmark report in a fixed format, so reports from
+ * different runs can be diffed against each other.
+ *
+ * @param name the name of the measured case
+ * @param n the problem size of the case (e.g. the number of bodies)
+ * @param seconds the total time spent in the measured region
+ * @param iterations how many times the measured region was executed
+ */
+void bench_report(const char *name, size_t n, double seconds,
+                  size_t iterations);
+
+#endif // #ifndef __BENCH_UTIL_H__
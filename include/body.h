@@ -3,6 +3,7 @@
 
 #include "color.h"
 #include "list.h"
+#include "polygon.h"
 #include "vector.h"
 #include <stdbool.h>
 
@@ -15,6 +16,16 @@ extern const size_t HEALTH_BAR_TYPE;
 extern const size_t SNIPER_BULLET_TYPE;
 extern const size_t GATLING_BULLET_TYPE;
 
+// collision layers, as bits of a body's collision category and mask
+extern const size_t TANK_LAYER;
+extern const size_t BULLET_LAYER;
+extern const size_t OBSTACLE_LAYER;
+
+// force field tags, as bits of a body's tags
+extern const size_t BULLET_TAG;
+extern const size_t PLAYER1_GRAVITY_TAG;
+extern const size_t PLAYER2_GRAVITY_TAG;
+
 // ai modes
 extern const size_t AI_UP;
 extern const size_t AI_DOWN;
@@ -26,32 +37,234 @@ extern const size_t AI_180;
 extern const size_t AI_90_LEFT;
 extern const size_t AI_90_RIGHT;
 
+/**
+ * The kinds of shape a body can have.
+ * Circles and capsules collide as exact round shapes;
+ * their polygon (see body_peek_shape()) is only an outline to draw.
+ */
+typedef enum {
+  /** A convex polygon */
+  SHAPE_POLYGON,
+  /** The points within a radius of the centroid */
+  SHAPE_CIRCLE,
+  /** The points within a radius of a segment centered on the centroid */
+  SHAPE_CAPSULE,
+} shape_type_t;
+
+// the number of vertices in the outline drawn for a circle
+extern const size_t ROUND_OUTLINE_POINTS;
+
 /**
  * A rigid body constrained to the plane.
- * Implemented as a polygon with uniform density.
+ * Implemented as a polygon, circle or capsule with uniform density.
  * Bodies can accumulate forces and impulses during each tick.
  * Angular physics (i.e. torques) are not currently implemented.
  */
 typedef struct body body_t;
 
+/**
+ * The ways a body's motion can be integrated over a step.
+ * Schemes with more stages need the force evaluated once per stage,
+ * so they cost more per step but stay accurate over longer steps.
+ */
+typedef enum {
+  /**
+   * The velocity is updated from the force,
+   * and the centroid moves at the average of the old and new velocities.
+   * One stage; what bodies have always used.
+   */
+  INTEGRATOR_AVERAGE_VELOCITY,
+  /** The velocity is updated first and moves the centroid. One stage. */
+  INTEGRATOR_SEMI_IMPLICIT_EULER,
+  /**
+   * Half a kick, a whole drift, then another half kick
+   * with the force at the new position. Two stages.
+   */
+  INTEGRATOR_VELOCITY_VERLET,
+  /** The classic fourth-order Runge-Kutta method. Four stages. */
+  INTEGRATOR_RK4,
+} integrator_t;
+
+/**
+ * A function that adds the forces on a body that depend on it alone,
+ * e.g. from force fields, so they can be re-evaluated within a tick.
+ *
+ * @param body the body to add forces to
+ * @param aux an auxiliary value passed to whatever calls the function
+ */
+typedef void (*body_force_t)(body_t *body, void *aux);
+
+/**
+ * Gets how many times an integrator needs the force evaluated per step.
+ *
+ * @param integrator the integrator
+ * @return the number of stages in each of its steps
+ */
+size_t integrator_stages(integrator_t integrator);
+
+/**
+ * A link in the intrusive list of force creators acting on a body.
+ * A force creator embeds one link for each body it acts on,
+ * so removing a body only has to visit its own force creators.
+ */
+typedef struct force_link {
+  struct force_link *prev;
+  struct force_link *next;
+  // the force creator this link belongs to
+  void *force;
+} force_link_t;
+
 /**
  * Graphic struct that represents a visual element
  * on the screen, including text.
  */
 typedef struct graphic graphic_t;
 
+/**
+ * Contiguous storage for the per-tick state of many bodies
+ * (centroid, velocity, force, impulse, mass, rotation).
+ * Every body keeps its state in exactly one store; a body_t is a handle
+ * to its slot there plus the state that is not touched every tick.
+ * Bodies start out in a shared store and move into a scene's store
+ * when they are added to the scene.
+ */
+typedef struct body_store body_store_t;
+
+/**
+ * Allocates an empty body store.
+ * Asserts that the required memory was allocated.
+ *
+ * @param initial_size the number of bodies to allocate space for
+ * @return a pointer to the newly allocated store
+ */
+body_store_t *body_store_init(size_t initial_size);
+
+/**
+ * Releases the memory allocated for a store.
+ * Asserts that every body has already left the store (see body_free()).
+ *
+ * @param store a pointer to a store returned from body_store_init()
+ */
+void body_store_free(body_store_t *store);
+
+/**
+ * Gets the number of bodies whose state lives in a store.
+ *
+ * @param store a pointer to a store returned from body_store_init()
+ * @return the number of occupied slots
+ */
+size_t body_store_size(body_store_t *store);
+
+/**
+ * Gets the body whose state lives in a given slot of a store.
+ * Slots are reordered as bodies leave the store,
+ * so indices are only meaningful until the next body does.
+ *
+ * @param store a pointer to a store returned from body_store_init()
+ * @param index an index in [0, body_store_size(store))
+ * @return the body in that slot
+ */
+body_t *body_store_get(body_store_t *store, size_t index);
+
+/**
+ * Moves a body's state into a store.
+ * The body keeps its position, velocity and pending forces.
+ *
+ * @param store the store that should hold the body's state from now on
+ * @param body a pointer to a body returned from body_init()
+ */
+void body_store_add(body_store_t *store, body_t *body);
+
+/**
+ * Ticks every body in a store, as if body_tick() were called on each one,
+ * but running the integration as a single pass over the store's arrays.
+ *
+ * @param store a pointer to a store returned from body_store_init()
+ * @param dt the number of seconds elapsed since the last tick
+ */
+void body_store_tick(body_store_t *store, double dt);
+
+/**
+ * Remembers the force on every body in a store,
+ * so it can be held for the whole tick while other forces are re-evaluated.
+ *
+ * @param store a pointer to a store returned from body_store_init()
+ */
+void body_store_hold_forces(body_store_t *store);
+
+/**
+ * Resets the force on every body in a store
+ * to the one remembered by body_store_hold_forces().
+ *
+ * @param store a pointer to a store returned from body_store_init()
+ */
+void body_store_restore_forces(body_store_t *store);
+
+/**
+ * Ticks the bodies in a store that take more than one substep
+ * (see body_set_substeps()), as body_tick_with() would,
+ * starting each from the force remembered by body_store_hold_forces().
+ *
+ * @param store a pointer to a store returned from body_store_init()
+ * @param integrator how to integrate each substep
+ * @param dt the number of seconds elapsed since the last tick
+ * @param local if non-NULL, adds the forces re-evaluated every stage
+ * @param aux an auxiliary value to pass to local
+ */
+void body_store_step_substepped(body_store_t *store, integrator_t integrator,
+                                double dt, body_force_t local, void *aux);
+
+/**
+ * Starts a step of every body in a store that takes one substep,
+ * before the stages of its integrator (see body_store_stage()).
+ * Impulses are applied at the start of the step.
+ *
+ * @param store a pointer to a store returned from body_store_init()
+ * @param integrator how to integrate the step
+ * @param tick_start whether this is the first step of a tick,
+ *   whose start body_get_previous_centroid() reports
+ */
+void body_store_begin_step(body_store_t *store, integrator_t integrator,
+                           bool tick_start);
+
+/**
+ * Runs one stage of an integrator on every body in a store
+ * that takes one substep, using the force on each body.
+ * Afterwards the bodies are where the next stage's force should be
+ * evaluated, or at the end of the step after the last stage.
+ *
+ * @param store a pointer to a store returned from body_store_init()
+ * @param integrator how to integrate the step
+ * @param stage the stage, in [0, integrator_stages(integrator))
+ * @param dt the length of the step in seconds
+ */
+void body_store_stage(body_store_t *store, integrator_t integrator,
+                      size_t stage, double dt);
+
+/**
+ * Finishes a step of every body in a store that takes one substep:
+ * turns each body and resets its force.
+ * Bodies with more substeps were already moved by
+ * body_store_step_substepped(), so the forces the stages applied to them
+ * are just dropped.
+ *
+ * @param store a pointer to a store returned from body_store_init()
+ * @param dt the length of the step in seconds
+ */
+void body_store_end_step(body_store_t *store, double dt);
+
 /**
  * Initializes a body without any info.
  * Acts like body_init_with_info() where info and info_freer are NULL.
  */
-body_t *body_init(list_t *shape, double mass, rgb_color_t color);
+body_t *body_init(polygon_t shape, double mass, rgb_color_t color);
 
 /**
  * Allocates memory for a body with the given parameters.
  * The body is initially at rest.
  * Asserts that the mass is positive and that the required memory is allocated.
  *
- * @param shape a list of vectors describing the initial shape of the body
+ * @param shape the initial shape of the body; the body takes ownership of it
  * @param mass the mass of the body (if INFINITY, stops the body from moving)
  * @param color the color of the body, used to draw it on the screen
  * @param info additional information to associate with the body,
@@ -59,9 +272,47 @@ body_t *body_init(list_t *shape, double mass, rgb_color_t color);
  * @param info_freer if non-NULL, a function call on the info to free it
  * @return a pointer to the newly allocated body
  */
-body_t *body_init_with_info(list_t *shape, double mass, rgb_color_t color,
+body_t *body_init_with_info(polygon_t shape, double mass, rgb_color_t color,
                             void *info, free_func_t info_freer);
 
+/**
+ * Allocates memory for a circular body.
+ * Collisions with it are exact instead of testing
+ * every edge of a many-sided polygon.
+ * Asserts that the radius is positive and that the memory was allocated.
+ *
+ * @param center the center of the circle, which becomes the centroid
+ * @param radius the radius of the circle
+ * @param mass the mass of the body (if INFINITY, stops the body from moving)
+ * @param color the color of the body, used to draw it on the screen
+ * @param info additional information to associate with the body
+ * @param info_freer if non-NULL, a function call on the info to free it
+ * @return a pointer to the newly allocated body
+ */
+body_t *body_init_circle(vector_t center, double radius, double mass,
+                         rgb_color_t color, void *info,
+                         free_func_t info_freer);
+
+/**
+ * Allocates memory for a capsule: the points within a radius of a segment,
+ * i.e. a rectangle with half circles on its ends.
+ * The capsule turns with the body, about the middle of the segment.
+ * Asserts that the radius is positive, that the segment's ends differ
+ * and that the memory was allocated.
+ *
+ * @param start one end of the segment
+ * @param end the other end of the segment
+ * @param radius the radius of the capsule
+ * @param mass the mass of the body (if INFINITY, stops the body from moving)
+ * @param color the color of the body, used to draw it on the screen
+ * @param info additional information to associate with the body
+ * @param info_freer if non-NULL, a function call on the info to free it
+ * @return a pointer to the newly allocated body
+ */
+body_t *body_init_capsule(vector_t start, vector_t end, double radius,
+                          double mass, rgb_color_t color, void *info,
+                          free_func_t info_freer);
+
 /**
  * Releases the memory allocated for a body.
  *
@@ -71,12 +322,56 @@ void body_free(body_t *body);
 
 /**
  * Gets the current shape of a body.
- * Returns a newly allocated vector list, which must be list_free()d.
+ * Returns a copy of the body's polygon, which must be polygon_free()d.
  *
  * @param body a pointer to a body returned from body_init()
  * @return the polygon describing the body's current position
  */
-list_t *body_get_shape(body_t *body);
+polygon_t body_get_shape(body_t *body);
+
+/**
+ * Gets what kind of shape a body has.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return SHAPE_POLYGON, unless the body was made by body_init_circle()
+ *   or body_init_capsule() and has not had body_set_shape() called since
+ */
+shape_type_t body_get_shape_type(body_t *body);
+
+/**
+ * Gets how far a body's shape reaches past its core (see body_peek_core()).
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the radius of a circle or capsule, or 0 for a polygon
+ */
+double body_get_radius(body_t *body);
+
+/**
+ * Borrows the points a body's shape is built around, in world coordinates:
+ * the shape is every point within body_get_radius() of their convex hull.
+ * That is a polygon's vertices, a circle's center
+ * or the two ends of a capsule's segment.
+ * Like body_peek_shape(), they are only current until the body moves again.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param count set to the number of points
+ * @return the points, owned by the body
+ */
+const vector_t *body_peek_core(body_t *body, size_t *count);
+
+/**
+ * Gets the current shape of a body without copying it.
+ * The polygon is still owned by the body and must not be modified or freed.
+ * Bodies only store their shape relative to their centroid, so the
+ * world-space vertices are rebuilt here if the body moved since the last call.
+ * The vertices are only current until the body moves again,
+ * so call this again after ticking instead of keeping the pointer.
+ * Prefer this over body_get_shape() when the shape is only read.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the polygon describing the body's current position
+ */
+const polygon_t *body_peek_shape(body_t *body);
 
 /**
  * Gets the current center of mass of a body.
@@ -97,6 +392,22 @@ vector_t body_get_centroid(body_t *body);
  */
 vector_t body_get_velocity(body_t *body);
 
+/**
+ * Gets the force accumulated on a body since it was last ticked.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the body's force vector
+ */
+vector_t body_get_force(body_t *body);
+
+/**
+ * Gets the impulse accumulated on a body since it was last ticked.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the body's impulse vector
+ */
+vector_t body_get_impulse(body_t *body);
+
 /**
  * Gets the current rotation of a body.
  *
@@ -133,9 +444,65 @@ rgb_color_t body_get_color(body_t *body);
  */
 void *body_get_info(body_t *body);
 
-double body_get_magnitude(body_t *);
+/**
+ * Gets the type of a body whose info is a size_t type (e.g. BULLET_TYPE).
+ * Asserts that the body has info.
+ *
+ * @param body a pointer to a body returned from body_init_with_info()
+ * @return the type stored in the body's info
+ */
+size_t body_get_type(body_t *body);
+
+/**
+ * Sets which collision layers a body is on and which it collides with.
+ * The scene only checks two bodies against each other when each one's
+ * category overlaps the other's mask; see scene_add_collision_rule().
+ * Bodies start with no layers, so they are left out of collision rules.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param category the layers the body is on, e.g. TANK_LAYER
+ * @param mask the layers the body collides with,
+ *   e.g. BULLET_LAYER | OBSTACLE_LAYER
+ */
+void body_set_collision_layers(body_t *body, size_t category, size_t mask);
+
+/**
+ * Gets the collision layers a body is on.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the category passed to body_set_collision_layers(), or 0
+ */
+size_t body_get_collision_category(body_t *body);
+
+/**
+ * Gets the collision layers a body collides with.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the mask passed to body_set_collision_layers(), or 0
+ */
+size_t body_get_collision_mask(body_t *body);
 
-bool body_get_just_collided(body_t *body);
+/**
+ * Sets a body's tags, which pick the scene-wide force fields
+ * that act on it (see scene_add_force_field()).
+ * Tags are independent of collision layers, so e.g. each player's bullets
+ * can be pulled differently while colliding the same way.
+ * Bodies start with no tags.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param tags bit flags, e.g. BULLET_TAG
+ */
+void body_set_tags(body_t *body, size_t tags);
+
+/**
+ * Gets a body's tags.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the tags passed to body_set_tags(), or 0
+ */
+size_t body_get_tags(body_t *body);
+
+double body_get_magnitude(body_t *);
 
 void body_set_graphic(body_t *body, graphic_t *graphic);
 
@@ -143,6 +510,9 @@ void body_combine_mass(body_t *body1, body_t *body2);
 /**
  * Translates a body to a new position.
  * The position is specified by the position of the body's center of mass.
+ * The move is a teleport: swept collisions (see body_set_bullet())
+ * do not check the path from the old position,
+ * and it is not interpolated when drawn.
  *
  * @param body a pointer to a body returned from body_init()
  * @param x the body's new centroid
@@ -157,7 +527,23 @@ void body_set_centroid(body_t *body, vector_t x);
  */
 void body_set_velocity(body_t *body, vector_t v);
 
-void body_set_shape(body_t *body, list_t *shape);
+/**
+ * Replaces the force accumulated on a body since it was last ticked.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param v the body's new force
+ */
+void body_set_force(body_t *body, vector_t v);
+
+/**
+ * Replaces a body's shape, freeing the old one.
+ * The new shape should already be at the body's current position.
+ * A circle or capsule becomes a polygon.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param shape the body's new shape; the body takes ownership of it
+ */
+void body_set_shape(body_t *body, polygon_t shape);
 
 void body_set_rotation_speed(body_t *body, double w);
 
@@ -169,6 +555,7 @@ void body_set_health(body_t *body, double health);
  * Changes a body's orientation in the plane.
  * The body is rotated about its center of mass.
  * Note that the angle is *absolute*, not relative to the current orientation.
+ * Like body_set_centroid(), the turn is not interpolated when drawn.
  *
  * @param body a pointer to a body returned from body_init()
  * @param angle the body's new angle in radians. Positive is counterclockwise.
@@ -200,6 +587,15 @@ void body_add_impulse(body_t *body, vector_t impulse);
 void body_set_time(body_t *body, double time);
 
 void body_set_rotation_empty(body_t *body, double rotation);
+
+/**
+ * Makes a body turn to face the direction of its velocity on every tick,
+ * e.g. so that a bullet points where it is flying.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param align whether the body's rotation should follow its velocity
+ */
+void body_set_align_to_velocity(body_t *body, bool align);
 /**
  * Updates the body after a given time interval has elapsed.
  * Sets acceleration and velocity according to the forces and impulses
@@ -213,6 +609,48 @@ void body_set_rotation_empty(body_t *body, double rotation);
  */
 void body_tick(body_t *body, double dt);
 
+/**
+ * Updates a body after a given time interval with a chosen integrator,
+ * split into the body's substeps (see body_set_substeps()).
+ * The force accumulated on the body is held for the whole interval;
+ * only the forces local adds are re-evaluated, at every stage.
+ * body_tick() is the same as this with INTEGRATOR_AVERAGE_VELOCITY
+ * and no local forces.
+ *
+ * @param body the body to tick
+ * @param integrator how to integrate each substep
+ * @param dt the number of seconds elapsed since the last tick
+ * @param local if non-NULL, adds the forces that depend on the body alone
+ * @param aux an auxiliary value to pass to local
+ */
+void body_tick_with(body_t *body, integrator_t integrator, double dt,
+                    body_force_t local, void *aux);
+
+/**
+ * Sets how many equal substeps a body splits each tick into.
+ * A body with more than one substep is integrated on its own in a scene:
+ * the batched forces it is part of (e.g. springs) and its force fields
+ * are re-evaluated every substep, so a body on a stiff spring
+ * or in a strong field can stay accurate without shortening every body's
+ * tick. Force creators are still only run once a tick.
+ * The other bodies of its batched forces are taken to stay where they were
+ * at the start of the tick, and feel it where it ends up,
+ * so those forces are not exactly equal and opposite.
+ * Asserts that the count is positive.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param substeps the number of substeps; 1 by default
+ */
+void body_set_substeps(body_t *body, size_t substeps);
+
+/**
+ * Gets how many substeps a body splits each tick into.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the number of substeps
+ */
+size_t body_get_substeps(body_t *body);
+
 /**
  * Marks a body for removal--future calls to body_is_removed() will return true.
  * Does not free the body.
@@ -222,6 +660,179 @@ void body_tick(body_t *body, double dt);
  */
 void body_remove(body_t *body);
 
+/**
+ * Borrows the axes to test a body's shape on for collisions:
+ * the unit normals of its edges, with parallel edges sharing one axis.
+ * A capsule has one, for its straight sides, and a circle has none.
+ * They are computed once per shape and only rotated when the body turns.
+ * Like body_peek_shape(), they are only current until the body moves again.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param count set to the number of axes
+ * @return the body's axes, owned by the body
+ */
+const vector_t *body_peek_axes(body_t *body, size_t *count);
+
+/**
+ * Gets the axis-aligned bounding box of a body's shape.
+ * The box of the rotated shape is cached relative to the centroid,
+ * so it is only rebuilt when the body turns; moving just offsets it.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the smallest box around the body's shape
+ */
+aabb_t body_get_bounds(body_t *body);
+
+/**
+ * Gets a bounding box around everywhere a body's shape
+ * has been during its last tick, at its current rotation.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return a box around the shape at both ends of its last move
+ */
+aabb_t body_get_swept_bounds(body_t *body);
+
+/**
+ * Gets where a body's centroid was before its last tick.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the centroid at the start of the last tick
+ */
+vector_t body_get_previous_centroid(body_t *body);
+
+/**
+ * Gets where a body's centroid is drawn part of the way through a tick,
+ * between where it was before its last tick and where it is now.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param alpha how far through the tick, from 0 (its start) to 1 (now)
+ * @return the interpolated centroid
+ */
+vector_t body_get_interpolated_centroid(body_t *body, double alpha);
+
+/**
+ * Gets a body's rotation part of the way through a tick,
+ * turning the shorter way from its rotation before the last tick.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param alpha how far through the tick, from 0 (its start) to 1 (now)
+ * @return the interpolated rotation
+ */
+double body_get_interpolated_rotation(body_t *body, double alpha);
+
+/**
+ * Places a body's shape at its interpolated centroid and rotation,
+ * so it can be drawn between ticks of a fixed timestep.
+ * Reusing the same polygon for every body avoids allocating
+ * unless a shape has more than POLYGON_INLINE_SIZE vertices.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param alpha how far through the tick, from 0 (its start) to 1 (now)
+ * @param shape a polygon from polygon_init(), whose vertices are replaced
+ */
+void body_get_interpolated_shape(body_t *body, double alpha,
+                                 polygon_t *shape);
+
+/**
+ * Moves a body back along its last tick's path.
+ * The start of the path stays where it was,
+ * so later swept tests only check the part of the path still travelled.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param time how far along the path to put the body,
+ *   from 0 (the start of the tick) to 1 (where it is now)
+ */
+void body_rewind(body_t *body, double time);
+
+/**
+ * Adds a link to the front of a body's list of force creators.
+ * Called by the scene when a force creator is added.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param link a link owned by the force creator, not in any list
+ */
+void body_link_force(body_t *body, force_link_t *link);
+
+/**
+ * Removes a link from a body's list of force creators.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param link a link previously passed to body_link_force() for this body
+ */
+void body_unlink_force(body_t *body, force_link_t *link);
+
+/**
+ * Points a body's list of force creators at a link that was copied
+ * to a new address, e.g. when the array holding it grows.
+ * The copy's neighbours must be where its prev and next say they are,
+ * and the old copy must not be used again.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param link the link at its new address
+ */
+void body_move_force_link(body_t *body, force_link_t *link);
+
+/**
+ * Gets the first link in a body's list of force creators.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the first link, or NULL if no force creator acts on the body
+ */
+force_link_t *body_get_force_links(body_t *body);
+
+/**
+ * Marks a body as static geometry that never moves, like a wall.
+ * Static bodies are not integrated and ignore forces and impulses;
+ * use scene_add_static_body() rather than calling this directly.
+ *
+ * @param body the body to mark as static
+ */
+void body_set_static(body_t *body);
+
+/**
+ * Returns whether a body has been marked as static.
+ *
+ * @param body the body to check
+ * @return whether body_set_static() has been called on the body
+ */
+bool body_is_static(body_t *body);
+
+/**
+ * Records where a scene keeps a body in its spatial index (see grid.h).
+ * Only scenes should call this.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param proxy the body's proxy in the index
+ */
+void body_set_proxy(body_t *body, size_t proxy);
+
+/**
+ * Gets where a scene keeps a body in its spatial index.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the proxy passed to body_set_proxy(), or 0 if it was never called
+ */
+size_t body_get_proxy(body_t *body);
+
+/**
+ * Marks a body as a fast-moving bullet.
+ * Collisions with bullets check the whole path they moved along
+ * during the last tick, so they cannot pass through thin walls
+ * between ticks (see find_swept_collision()).
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param is_bullet whether the body is a bullet
+ */
+void body_set_bullet(body_t *body, bool is_bullet);
+
+/**
+ * Returns whether a body has been marked as a bullet.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return whether body_set_bullet() last marked the body as a bullet
+ */
+bool body_is_bullet(body_t *body);
+
 /**
  * Returns whether a body has been marked for removal.
  * This function returns false until body_remove() is called on the body,
@@ -244,8 +855,6 @@ double body_get_ai_time(body_t *body);
 
 void body_set_ai_time(body_t *body, double time);
 
-void body_set_just_collided(body_t *body, bool just_collided);
-
 void body_set_image_path(body_t *body, char *image_path);
 
 char *body_get_image_path(body_t *body);
@@ -0,0 +1,60 @@
+#ifndef __BROADPHASE_H__
+#define __BROADPHASE_H__
+
+#include "polygon.h"
+#include "vector.h"
+#include <stddef.h>
+
+/**
+ * A uniform grid over a rectangular arena, used to find which bounding boxes
+ * might overlap without testing every pair.
+ * Boxes outside the arena are clamped into the border cells,
+ * so they are still found, just less efficiently.
+ */
+typedef struct broadphase broadphase_t;
+
+/**
+ * Two indices into the boxes passed to broadphase_find_pairs().
+ * first is always less than second.
+ */
+typedef struct {
+  size_t first;
+  size_t second;
+} index_pair_t;
+
+/**
+ * Allocates memory for an empty grid covering the given arena.
+ * Asserts that the arena and cell size are positive
+ * and that the required memory is allocated.
+ *
+ * @param min the lower-left corner of the arena
+ * @param max the upper-right corner of the arena
+ * @param cell_size the side length of each square cell; works best
+ *   around the size of the typical body
+ * @return the new grid
+ */
+broadphase_t *broadphase_init(vector_t min, vector_t max, double cell_size);
+
+/**
+ * Releases the memory allocated for a grid.
+ *
+ * @param grid a pointer to a grid returned from broadphase_init()
+ */
+void broadphase_free(broadphase_t *grid);
+
+/**
+ * Finds every pair of boxes that overlap. Each pair is reported once.
+ * The grid reuses its buffers between calls,
+ * so this does not allocate once the buffers are big enough.
+ *
+ * @param grid a pointer to a grid returned from broadphase_init()
+ * @param bounds the boxes to check
+ * @param count the number of boxes
+ * @param pairs set to the overlapping pairs, which stay valid
+ *   until the next call on this grid
+ * @return the number of pairs found
+ */
+size_t broadphase_find_pairs(broadphase_t *grid, const aabb_t *bounds,
+                             size_t count, index_pair_t **pairs);
+
+#endif // #ifndef __BROADPHASE_H__
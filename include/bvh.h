@@ -0,0 +1,82 @@
+#ifndef __BVH_H__
+#define __BVH_H__
+
+#include "polygon.h"
+#include <stddef.h>
+
+/**
+ * A bounding volume hierarchy over a fixed set of bounding boxes.
+ * It is built once from all the boxes, then queried many times,
+ * so it suits geometry that never moves, like the map's obstacles.
+ */
+typedef struct bvh bvh_t;
+
+/**
+ * Allocates memory for an empty tree.
+ * Asserts that the required memory is successfully allocated.
+ *
+ * @return the new tree
+ */
+bvh_t *bvh_init(void);
+
+/**
+ * Releases the memory allocated for a tree.
+ *
+ * @param tree a pointer to a tree returned from bvh_init()
+ */
+void bvh_free(bvh_t *tree);
+
+/**
+ * Rebuilds a tree over the given boxes, replacing what it held before.
+ * Boxes are referred to by their index in bounds.
+ *
+ * @param tree a pointer to a tree returned from bvh_init()
+ * @param bounds the boxes to store
+ * @param count the number of boxes
+ */
+void bvh_build(bvh_t *tree, const aabb_t *bounds, size_t count);
+
+/**
+ * Finds every stored box that overlaps a given box.
+ * The tree reuses its result buffer between calls,
+ * so this does not allocate once the buffer is big enough.
+ *
+ * @param tree a pointer to a tree returned from bvh_init()
+ * @param box the box to check
+ * @param hits set to the indices of the overlapping boxes, which stay valid
+ *   until the next call on this tree
+ * @return the number of overlapping boxes
+ */
+size_t bvh_query(bvh_t *tree, aabb_t box, size_t **hits);
+
+/**
+ * A function called with each stored box a ray reaches (see bvh_cast_ray()),
+ * e.g. to test the exact shape inside it.
+ *
+ * @param item the index of the box
+ * @param max_distance how far along the ray is still being searched
+ * @param aux the auxiliary value passed to bvh_cast_ray()
+ * @return how far to keep searching: max_distance,
+ *   or less once something nearer has been found
+ */
+typedef double (*bvh_ray_visitor_t)(size_t item, double max_distance,
+                                    void *aux);
+
+/**
+ * Visits the stored boxes a ray passes through, nearest subtrees first.
+ * Subtrees beyond the distance the visitor last returned are skipped,
+ * so finding the first thing a ray hits only visits the boxes near it.
+ *
+ * @param tree a pointer to a tree returned from bvh_init()
+ * @param origin where the ray starts
+ * @param direction a unit vector along the ray
+ * @param max_distance how far along the ray to look
+ * @param visitor the function to call with each box reached
+ * @param aux an auxiliary value to pass to the visitor
+ * @return the distance the visitor last returned,
+ *   or max_distance if no box was reached
+ */
+double bvh_cast_ray(bvh_t *tree, vector_t origin, vector_t direction,
+                    double max_distance, bvh_ray_visitor_t visitor, void *aux);
+
+#endif // #ifndef __BVH_H__
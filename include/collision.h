@@ -1,7 +1,8 @@
 #ifndef __COLLISION_H__
 #define __COLLISION_H__
 
-#include "list.h"
+#include "body.h"
+#include "polygon.h"
 #include "vector.h"
 #include <stdbool.h>
 
@@ -19,19 +20,216 @@ typedef struct {
    * If collided is false, this value is undefined.
    */
   vector_t axis;
+  /**
+   * If the shapes are colliding, how far they overlap along the axis.
+   * If collided is false, this value is undefined.
+   */
+  double depth;
+  /**
+   * If the shapes are colliding, the vertex of one shape
+   * that is furthest inside the other.
+   * If collided is false, this value is undefined.
+   */
+  vector_t contact;
+  /**
+   * If the shapes are colliding, when they first touched during the last
+   * tick, from 0 (its start) to 1 (now). Only swept collisions
+   * (see find_swept_collision()) are found before now.
+   * If collided is false, this value is undefined.
+   */
+  double time;
 } collision_info_t;
 
+/**
+ * Counts how much of the narrow phase bounding boxes save.
+ * pairs - sat_tests is the number of SAT tests that were skipped.
+ */
+typedef struct {
+  /** Pairs of bodies that could have needed a SAT test */
+  size_t pairs;
+  /** Pairs whose bounding boxes overlapped, so SAT actually ran */
+  size_t sat_tests;
+} collision_stats_t;
+
+/**
+ * Where a ray first hits a body (see find_ray_hit()).
+ */
+typedef struct {
+  /** The body that was hit, or NULL if the ray hit nothing */
+  body_t *body;
+  /** The first point of the body along the ray */
+  vector_t point;
+  /** The unit normal of the body's surface at point, pointing out of it */
+  vector_t normal;
+  /** How far along the ray point is, or how far was searched if nothing was hit */
+  double distance;
+} ray_hit_t;
+
+/**
+ * A function called when a collision occurs.
+ * @param body1 the first body passed to create_collision()
+ *   (or the body on the rule's first layer, see scene_add_collision_rule())
+ * @param body2 the second body passed to create_collision()
+ * @param axis a unit vector pointing from body1 towards body2
+ *   that defines the direction the two bodies are colliding in
+ * @param aux the auxiliary value passed to create_collision()
+ */
+typedef void (*collision_handler_t)(body_t *body1, body_t *body2, vector_t axis,
+                                    void *aux);
+
 /**
  * Computes the status of the collision between two convex polygons.
- * The shapes are given as lists of vertices in counterclockwise order.
+ * The shapes are given as polygons with vertices in counterclockwise order.
  * There is an edge between each pair of consecutive vertices,
  * and one between the first vertex and the last vertex.
+ * Neither shape is modified or freed.
  *
  * @param shape1 the first shape
  * @param shape2 the second shape
  * @return whether the shapes are colliding, and if so, the collision axis.
  * The axis should be a unit vector pointing from shape1 towards shape2.
  */
-collision_info_t find_collision(list_t *shape1, list_t *shape2);
+collision_info_t find_collision(const polygon_t *shape1,
+                                const polygon_t *shape2);
+
+/**
+ * Projects an array of vertices onto an axis,
+ * using the fastest vector instructions the CPU supports (see simd.h).
+ *
+ * @param points the vertices
+ * @param count the number of vertices
+ * @param axis the axis to project onto
+ * @param min set to the smallest projection (INFINITY if count is 0)
+ * @param max set to the largest projection (-INFINITY if count is 0)
+ */
+void points_project(const vector_t *points, size_t count, vector_t axis,
+                    double *min, double *max);
+
+/**
+ * Computes the axes to test a convex polygon on:
+ * the unit normals of its edges, with parallel edges sharing one axis
+ * (so a rectangle only has two).
+ *
+ * @param shape the shape, with vertices in counterclockwise order
+ * @param axes where to store the axes;
+ *   must have room for one per vertex of the shape
+ * @return the number of axes stored
+ */
+size_t find_separating_axes(const polygon_t *shape, vector_t *axes);
+
+/**
+ * Like find_collision(), but tests precomputed axes for each shape
+ * (see find_separating_axes()), projecting each shape once per axis.
+ *
+ * @param shape1 the first shape
+ * @param axes1 the axes of the first shape
+ * @param count1 the number of axes of the first shape
+ * @param shape2 the second shape
+ * @param axes2 the axes of the second shape
+ * @param count2 the number of axes of the second shape
+ * @return the status of the collision, as in find_collision()
+ */
+collision_info_t find_collision_with_axes(const polygon_t *shape1,
+                                          const vector_t *axes1,
+                                          size_t count1,
+                                          const polygon_t *shape2,
+                                          const vector_t *axes2,
+                                          size_t count2);
+
+/**
+ * Computes the status of the collision between two bodies' shapes,
+ * using the axes each body caches until it rotates (see body_peek_axes()).
+ * Circles and capsules are tested exactly, from their cores and radii
+ * (see body_peek_core()), adding at most two axes each for their curves,
+ * so a circle costs far less than a polygon with enough sides to look round.
+ * Bodies whose bounding boxes (see body_get_bounds()) are apart
+ * are rejected without projecting either shape.
+ * Does not allocate any memory.
+ *
+ * @param body1 the first body
+ * @param body2 the second body
+ * @return the status of the collision, as in find_collision()
+ */
+collision_info_t find_body_collision(body_t *body1, body_t *body2);
+
+/**
+ * Computes whether two bodies touched at any point during the last tick,
+ * by sweeping their shapes along the paths their centroids took
+ * (see body_get_previous_centroid()). The shapes keep their current
+ * rotation along the way. find_body_collision() uses this whenever
+ * either body is a bullet (see body_set_bullet()).
+ *
+ * If the bodies were apart when the tick started, the collision's time
+ * is when they met, its axis is the one they met along, and its depth is 0.
+ * If they were already touching, the bodies are tested where they are now,
+ * as in find_body_collision().
+ *
+ * @param body1 the first body
+ * @param body2 the second body
+ * @return the status of the collision, as in find_collision()
+ */
+collision_info_t find_swept_collision(body_t *body1, body_t *body2);
+
+/**
+ * Finds where a ray first hits a body's shape,
+ * exactly for circles and capsules as well as polygons.
+ * A ray starting inside the body does not hit it,
+ * so rays can be cast from a body's own centroid.
+ *
+ * @param body the body to test
+ * @param origin where the ray starts
+ * @param direction a unit vector along the ray
+ * @param max_distance how far along the ray to look
+ * @return the hit, whose body is NULL if the ray misses
+ *   or only reaches the body beyond max_distance
+ */
+ray_hit_t find_ray_hit(body_t *body, vector_t origin, vector_t direction,
+                       double max_distance);
+
+/**
+ * Finds how far a point is from a body's shape,
+ * exactly for circles and capsules as well as polygons.
+ *
+ * @param body the body
+ * @param point the point
+ * @return the distance from the point to the nearest point of the shape,
+ *   or 0 if the point is inside it
+ */
+double find_point_distance(body_t *body, vector_t point);
+
+/**
+ * Brings the shape, axes and bounds a body caches up to date.
+ * find_body_collision() only reads bodies prepared since they last moved,
+ * so it can test pairs that share bodies on several threads at once.
+ *
+ * @param body a pointer to a body returned from body_init()
+ */
+void collision_prepare_body(body_t *body);
+
+/**
+ * Records pairs that a broadphase ruled out by their bounding boxes
+ * without calling find_body_collision(), so the statistics
+ * cover every pair that could have needed a SAT test.
+ *
+ * @param count the number of pairs ruled out
+ */
+void collision_count_culled_pairs(size_t count);
+
+/**
+ * Gets the statistics gathered by find_body_collision()
+ * and collision_count_culled_pairs(), and starts counting again from zero.
+ * Each thread counts separately, so threads that test pairs
+ * hand their counts to the main thread with collision_add_stats().
+ *
+ * @return the counts this thread gathered since the last call
+ */
+collision_stats_t collision_take_stats(void);
+
+/**
+ * Adds counts gathered on another thread to this thread's statistics.
+ *
+ * @param stats counts returned by collision_take_stats() on that thread
+ */
+void collision_add_stats(collision_stats_t stats);
 
 #endif // #ifndef __COLLISION_H__
@@ -0,0 +1,142 @@
+#ifndef __CONTACTS_H__
+#define __CONTACTS_H__
+
+#include "body.h"
+#include "list.h"
+#include "vector.h"
+#include <stddef.h>
+
+/**
+ * What happened to a contact on a tick.
+ * The values are bit flags, so they can be combined into a set of events
+ * to subscribe to (see scene_add_contact_rule()).
+ */
+typedef enum {
+  /** The bodies started touching this tick */
+  CONTACT_BEGIN = 1 << 0,
+  /** The bodies were already touching and still are */
+  CONTACT_PERSIST = 1 << 1,
+  /** The bodies stopped touching, or one of them was removed */
+  CONTACT_END = 1 << 2,
+} contact_event_t;
+
+/**
+ * Two bodies that are touching, with the manifold from the last tick
+ * they were found touching.
+ */
+typedef struct {
+  body_t *body1;
+  body_t *body2;
+  /** A unit vector pointing from body1 towards body2 */
+  vector_t normal;
+  /** How far the bodies overlap along the normal */
+  double depth;
+  /**
+   * The vertex of one body that is furthest inside the other.
+   * SAT finds a single deepest point, so manifolds have one point.
+   */
+  vector_t point;
+  /**
+   * When during the last tick the bodies met, from 0 (its start) to 1 (now);
+   * only bullets are found before now (see find_swept_collision())
+   */
+  double time;
+  /** The tick the bodies started touching */
+  size_t first_tick;
+  /** The last tick the bodies were found touching */
+  size_t last_tick;
+} contact_t;
+
+/**
+ * A function called when a contact begins, persists or ends.
+ * @param body1 the body on the rule's first layer
+ * @param body2 the body on the rule's second layer
+ * @param contact the contact, with contact->body1 == body1
+ * @param event what happened to the contact this tick
+ * @param aux the auxiliary value passed to scene_add_contact_rule()
+ */
+typedef void (*contact_handler_t)(body_t *body1, body_t *body2,
+                                  const contact_t *contact,
+                                  contact_event_t event, void *aux);
+
+/**
+ * The contacts between bodies, kept from tick to tick.
+ * Contacts are stored densely, with a hash table from each pair of bodies
+ * to its contact, so finding the contact of a pair takes O(1) time.
+ */
+typedef struct contact_cache contact_cache_t;
+
+/**
+ * Allocates memory for an empty contact cache.
+ * Asserts that the required memory was allocated.
+ *
+ * @return the new cache
+ */
+contact_cache_t *contact_cache_init(void);
+
+/**
+ * Releases the memory allocated for a contact cache.
+ *
+ * @param cache a pointer to a cache returned from contact_cache_init()
+ */
+void contact_cache_free(contact_cache_t *cache);
+
+/**
+ * Gets the number of contacts in a cache.
+ *
+ * @param cache a pointer to a cache returned from contact_cache_init()
+ * @return the number of contacts
+ */
+size_t contact_cache_size(contact_cache_t *cache);
+
+/**
+ * Gets the contact at a given index in a cache.
+ * Like every contact the cache returns, it is only valid
+ * until the next contact is added or removed.
+ *
+ * @param cache a pointer to a cache returned from contact_cache_init()
+ * @param index an index in [0, contact_cache_size(cache))
+ * @return the contact
+ */
+contact_t *contact_cache_get(contact_cache_t *cache, size_t index);
+
+/**
+ * Finds the contact between two bodies, given in either order.
+ *
+ * @param cache a pointer to a cache returned from contact_cache_init()
+ * @param body1 one of the bodies
+ * @param body2 the other body
+ * @return the contact, or NULL if the bodies have none
+ */
+contact_t *contact_cache_find(contact_cache_t *cache, body_t *body1,
+                              body_t *body2);
+
+/**
+ * Records that two bodies are touching on a tick.
+ * If they were not already in contact, a contact is added
+ * with body1 first and first_tick set to the tick.
+ * Either way, last_tick is set to the tick;
+ * the caller fills in the manifold.
+ *
+ * @param cache a pointer to a cache returned from contact_cache_init()
+ * @param body1 one of the bodies
+ * @param body2 the other body
+ * @param tick the current tick
+ * @return the bodies' contact
+ */
+contact_t *contact_cache_touch(contact_cache_t *cache, body_t *body1,
+                               body_t *body2, size_t tick);
+
+/**
+ * Removes every contact that a predicate holds for,
+ * keeping the rest in order.
+ *
+ * @param cache a pointer to a cache returned from contact_cache_init()
+ * @param predicate called with each contact_t * and aux
+ * @param aux an auxiliary value to pass to the predicate
+ * @return the number of contacts removed
+ */
+size_t contact_cache_remove_if(contact_cache_t *cache, predicate_t predicate,
+                               void *aux);
+
+#endif // #ifndef __CONTACTS_H__
@@ -25,17 +25,6 @@ void store_force_free(store_force_t *storage);
 
 vector_t calculate_unit_vector(vector_t body1, vector_t body2);
 
-/**
- * A function called when a collision occurs.
- * @param body1 the first body passed to create_collision()
- * @param body2 the second body passed to create_collision()
- * @param axis a unit vector pointing from body1 towards body2
- *   that defines the direction the two bodies are colliding in
- * @param aux the auxiliary value passed to create_collision()
- */
-typedef void (*collision_handler_t)(body_t *body1, body_t *body2, vector_t axis,
-                                    void *aux);
-
 /**
  * Adds a force creator to a scene that applies gravity between two bodies.
  * The force creator will be called each tick
@@ -53,6 +42,26 @@ typedef void (*collision_handler_t)(body_t *body1, body_t *body2, vector_t axis,
 void create_newtonian_gravity(scene_t *scene, double G, body_t *body1,
                               body_t *body2);
 
+/**
+ * Adds a force creator to a scene that applies gravity between every pair
+ * of its moving bodies on the given layers, including ones added later.
+ * Rather than one force creator per pair, which takes O(n^2) time,
+ * each tick it builds a quadtree over the bodies (see quadtree.h)
+ * and approximates far groups of bodies as single masses,
+ * which takes O(n log n) time. Like create_newtonian_gravity(),
+ * it leaves out bodies that are very close together.
+ *
+ * @param scene the scene containing the bodies
+ * @param G the gravitational proportionality constant
+ * @param theta how coarse the approximation may be:
+ *   0 is exact, 0.5 is typical and larger values are faster
+ *   (see quadtree_field())
+ * @param mask the collision layers of the bodies that attract each other
+ *   (see body_set_collision_layers()); SIZE_MAX includes every body
+ */
+void create_barnes_hut_gravity(scene_t *scene, double G, double theta,
+                               size_t mask);
+
 /**
  * Adds a force creator to a scene that acts like a spring between two bodies.
  * The force creator will be called each tick
@@ -79,6 +88,43 @@ void create_spring(scene_t *scene, double k, body_t *body1, body_t *body2);
  */
 void create_drag(scene_t *scene, double gamma, body_t *body);
 
+/**
+ * Adds a force field to a scene that applies drag to every moving body
+ * with any of the given tags, like create_drag() does to one body.
+ *
+ * @param scene the scene
+ * @param gamma the proportionality constant between force and velocity
+ * @param tags the tags of the bodies to slow down (see body_set_tags())
+ */
+void create_drag_field(scene_t *scene, double gamma, size_t tags);
+
+/**
+ * Adds a force field to a scene that accelerates every moving body
+ * with any of the given tags the same way, whatever its mass,
+ * like gravity near the ground.
+ *
+ * @param scene the scene
+ * @param acceleration the acceleration to give the bodies
+ * @param tags the tags of the bodies to accelerate (see body_set_tags())
+ */
+void create_uniform_gravity(scene_t *scene, vector_t acceleration,
+                            size_t tags);
+
+/**
+ * Adds a force field to a scene that pulls every moving body
+ * with any of the given tags towards a source body,
+ * with the force create_newtonian_gravity() would apply between them.
+ * Unlike create_newtonian_gravity(), the source is not pulled back.
+ * The field is removed when the source is.
+ *
+ * @param scene the scene containing the source
+ * @param G the gravitational proportionality constant;
+ *   a negative constant pushes bodies away instead
+ * @param source the body the field is centered on
+ * @param tags the tags of the bodies to pull (see body_set_tags())
+ */
+void create_attractor(scene_t *scene, double G, body_t *source, size_t tags);
+
 /**
  * Adds a force creator to a scene that calls a given collision handler
  * function each time two bodies collide.
@@ -132,4 +178,39 @@ void create_partial_destructive_collision(scene_t *scene, body_t *body1,
  */
 void create_physics_collision(scene_t *scene, double elasticity, body_t *body1,
                               body_t *body2);
+
+/**
+ * Like create_destructive_collision(), but for every pair of bodies
+ * on the given layers, using scene_add_collision_rule().
+ *
+ * @param scene the scene containing the bodies
+ * @param layer1 the layers of the first body
+ * @param layer2 the layers of the second body
+ */
+void create_layer_destructive_collision(scene_t *scene, size_t layer1,
+                                        size_t layer2);
+
+/**
+ * Like create_partial_destructive_collision(), but for every pair of bodies
+ * on the given layers, using scene_add_collision_rule().
+ *
+ * @param scene the scene containing the bodies
+ * @param tank_layer the layers of the body that loses health
+ * @param bullet_layer the layers of the bullet that is destroyed
+ */
+void create_layer_partial_destructive_collision(scene_t *scene,
+                                                size_t tank_layer,
+                                                size_t bullet_layer);
+
+/**
+ * Like create_physics_collision(), but for every pair of bodies
+ * on the given layers, using scene_add_collision_rule().
+ *
+ * @param scene the scene containing the bodies
+ * @param elasticity the "coefficient of restitution" of the collision
+ * @param layer1 the layers of the first body
+ * @param layer2 the layers of the second body
+ */
+void create_layer_physics_collision(scene_t *scene, double elasticity,
+                                    size_t layer1, size_t layer2);
 #endif // #ifndef __FORCES_H__
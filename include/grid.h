@@ -0,0 +1,119 @@
+#ifndef __GRID_H__
+#define __GRID_H__
+
+#include "polygon.h"
+#include "vector.h"
+#include <stddef.h>
+
+/**
+ * A uniform grid over a rectangular arena that keeps track of moving boxes
+ * from tick to tick, to find what is in a region without checking everything.
+ * Each box is held by a proxy, which is only moved between cells
+ * when the box crosses into different ones, so updating boxes that moved
+ * a little is cheap. Boxes outside the arena are clamped into the border
+ * cells, like in the broadphase (see broadphase.h).
+ */
+typedef struct grid grid_t;
+
+/**
+ * A function called with each item a query finds (see grid_query()).
+ *
+ * @param item the item passed to grid_insert()
+ * @param aux the auxiliary value passed to grid_query()
+ */
+typedef void (*grid_visitor_t)(void *item, void *aux);
+
+/**
+ * Allocates memory for an empty grid covering the given arena.
+ * Asserts that the arena and cell size are positive
+ * and that the required memory is allocated.
+ *
+ * @param min the lower-left corner of the arena
+ * @param max the upper-right corner of the arena
+ * @param cell_size the side length of each square cell
+ * @return the new grid
+ */
+grid_t *grid_init(vector_t min, vector_t max, double cell_size);
+
+/**
+ * Releases the memory allocated for a grid.
+ *
+ * @param grid a pointer to a grid returned from grid_init()
+ */
+void grid_free(grid_t *grid);
+
+/**
+ * Adds an item with a bounding box to a grid.
+ *
+ * @param grid a pointer to a grid returned from grid_init()
+ * @param item the item, which must not be NULL
+ * @param box the item's bounding box
+ * @return the proxy holding the item, to move or remove it with
+ */
+size_t grid_insert(grid_t *grid, void *item, aabb_t box);
+
+/**
+ * Updates the bounding box of an item in a grid.
+ * The item only changes cells if the box now touches different ones.
+ *
+ * @param grid a pointer to a grid returned from grid_init()
+ * @param proxy a proxy returned from grid_insert()
+ * @param box the item's new bounding box
+ */
+void grid_move(grid_t *grid, size_t proxy, aabb_t box);
+
+/**
+ * Removes an item from a grid. Its proxy may be reused by later insertions.
+ *
+ * @param grid a pointer to a grid returned from grid_init()
+ * @param proxy a proxy returned from grid_insert()
+ */
+void grid_remove(grid_t *grid, size_t proxy);
+
+/**
+ * Calls a function with every item whose box overlaps a given box,
+ * once each, in no particular order. Does not allocate any memory.
+ * The visitor must not change the grid.
+ *
+ * @param grid a pointer to a grid returned from grid_init()
+ * @param box the box to check
+ * @param visitor the function to call with each item found
+ * @param aux an auxiliary value to pass to the visitor
+ */
+void grid_query(grid_t *grid, aabb_t box, grid_visitor_t visitor, void *aux);
+
+/**
+ * A function called with each item whose box a ray reaches
+ * (see grid_cast_ray()), e.g. to test the exact shape inside it.
+ *
+ * @param item the item passed to grid_insert()
+ * @param max_distance how far along the ray is still being searched
+ * @param aux the auxiliary value passed to grid_cast_ray()
+ * @return how far to keep searching: max_distance,
+ *   or less once something nearer has been found
+ */
+typedef double (*grid_ray_visitor_t)(void *item, double max_distance,
+                                     void *aux);
+
+/**
+ * Visits the items whose boxes a ray passes through, once each,
+ * walking the cells the ray crosses from nearest to furthest.
+ * Items in cells the ray never enters are not looked at,
+ * and the walk stops at the distance the visitor last returned,
+ * so finding the first thing a ray hits only visits the items near it.
+ * Does not allocate any memory. The visitor must not change the grid.
+ *
+ * @param grid a pointer to a grid returned from grid_init()
+ * @param origin where the ray starts
+ * @param direction a unit vector along the ray
+ * @param max_distance how far along the ray to look
+ * @param visitor the function to call with each item reached
+ * @param aux an auxiliary value to pass to the visitor
+ * @return the distance the visitor last returned,
+ *   or max_distance if no item was reached
+ */
+double grid_cast_ray(grid_t *grid, vector_t origin, vector_t direction,
+                     double max_distance, grid_ray_visitor_t visitor,
+                     void *aux);
+
+#endif // #ifndef __GRID_H__
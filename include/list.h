@@ -1,6 +1,7 @@
 #ifndef __LIST_H__
 #define __LIST_H__
 
+#include <stdbool.h>
 #include <stddef.h>
 
 /**
@@ -16,6 +17,12 @@ typedef struct list list_t;
  */
 typedef void (*free_func_t)(void *);
 
+/**
+ * A function that decides whether to act on a list element.
+ * Takes in an auxiliary value that can store parameters or state.
+ */
+typedef bool (*predicate_t)(void *value, void *aux);
+
 /**
  * Allocates memory for a new list with space for the given number of elements.
  * The list is initially empty.
@@ -64,6 +71,51 @@ void *list_get(list_t *list, size_t index);
  */
 void *list_remove(list_t *list, size_t index);
 
+/**
+ * Removes the element at a given index in a list and returns it,
+ * moving the last element into its place.
+ * This takes constant time, but does not keep the order of the list.
+ * Asserts that the index is valid, given the list's current size.
+ *
+ * @param list a pointer to a list returned from list_init()
+ * @param index an index in the list (the first element is at 0)
+ * @return the element at the given index in the list
+ */
+void *list_swap_remove(list_t *list, size_t index);
+
+/**
+ * Removes and frees every element of a list that a predicate accepts,
+ * keeping the other elements in order.
+ * Runs in a single pass, however many elements are removed.
+ * The removed elements are freed with the list's freer, if it has one.
+ *
+ * @param list a pointer to a list returned from list_init()
+ * @param predicate a function that returns true for elements to remove
+ * @param aux an auxiliary value to pass to the predicate
+ * @return the number of elements removed
+ */
+size_t list_remove_if(list_t *list, predicate_t predicate, void *aux);
+
+/**
+ * Removes and frees every element past the first few in a list,
+ * using the list's freer, if it has one.
+ * Asserts that the list has at least that many elements.
+ *
+ * @param list a pointer to a list returned from list_init()
+ * @param size the number of elements to keep
+ */
+void list_truncate(list_t *list, size_t size);
+
+/**
+ * Makes sure a list can hold at least the given number of elements
+ * without growing again, resizing it if needed.
+ * Asserts that the resize succeeded.
+ *
+ * @param list a pointer to a list returned from list_init()
+ * @param capacity the number of elements to make space for
+ */
+void list_reserve(list_t *list, size_t capacity);
+
 /**
  * Appends an element to the end of a list.
  * If the list is filled to capacity, resizes the list to fit more elements
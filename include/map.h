@@ -3,6 +3,7 @@
 
 #include "body.h"
 #include "list.h"
+#include "polygon.h"
 #include "sdl_wrapper.h"
 #include "scene.h"
 
@@ -10,10 +11,11 @@ extern const size_t RECTANGLE_OBSTACLE_TYPE;
 extern const size_t TRIANGLE_OBSTACLE_TYPE;
 extern const double TRIANGLE_DAMAGE;
 
-list_t *make_rectangle(vector_t corner, double width, double height);
+polygon_t make_rectangle(vector_t corner, double width, double height);
 
 /**
  * This function initializes the game map and is called once 
+ * The obstacles are added with scene_add_static_body(), so they never move
  *
  * @param scene the scene 
  */
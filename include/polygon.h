@@ -1,49 +1,229 @@
 #ifndef __POLYGON_H__
 #define __POLYGON_H__
 
-#include "list.h"
 #include "vector.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * The number of vertices a polygon can hold without allocating memory.
+ * Bullets, tanks and map obstacles all fit, so they never touch the heap.
+ */
+#define POLYGON_INLINE_SIZE 8
+
+/**
+ * A polygon stored as a contiguous array of vertices.
+ * Up to POLYGON_INLINE_SIZE vertices are stored inside the struct itself;
+ * larger polygons keep their vertices in a single heap array.
+ * polygon_t is defined here instead of polygon.c because it is embedded in
+ * other structs and passed *by value*.
+ * Assigning a polygon_t moves its vertices: only one of the copies
+ * may be used or freed afterwards. Use polygon_copy() for a separate copy.
+ */
+typedef struct {
+  size_t size;
+  size_t capacity;
+  /** The vertex array if it outgrew inline_points, otherwise NULL */
+  vector_t *heap;
+  vector_t inline_points[POLYGON_INLINE_SIZE];
+} polygon_t;
+
+/**
+ * An axis-aligned bounding box, given by its lower-left and upper-right corners.
+ */
+typedef struct {
+  vector_t min;
+  vector_t max;
+} aabb_t;
+
+/**
+ * Creates an empty polygon with space for the given number of vertices.
+ * Asserts that the required memory was allocated.
+ *
+ * @param initial_size the number of vertices to allocate space for
+ * @return the new polygon, which must be polygon_free()d
+ */
+polygon_t polygon_init(size_t initial_size);
+
+/**
+ * Releases the memory allocated for a polygon's vertices.
+ *
+ * @param polygon a polygon returned from polygon_init()
+ */
+void polygon_free(polygon_t *polygon);
+
+/**
+ * Creates a separate copy of a polygon.
+ *
+ * @param polygon the polygon to copy
+ * @return a polygon with the same vertices, which must be polygon_free()d
+ */
+polygon_t polygon_copy(const polygon_t *polygon);
+
+/**
+ * Removes every vertex from a polygon, keeping its allocated space
+ * so the polygon can be refilled without allocating.
+ *
+ * @param polygon a polygon returned from polygon_init()
+ */
+void polygon_clear(polygon_t *polygon);
+
+/**
+ * Gets the number of times vertices have been allocated on the heap so far,
+ * by polygon_init() and polygon_copy() for polygons too big to store inline
+ * and by polygon_add() growing a polygon.
+ * Lets tests check that a code path allocates no shape storage.
+ *
+ * @return the number of heap allocations since the program started
+ */
+size_t polygon_allocation_count(void);
+
+/**
+ * Gets the number of vertices in a polygon.
+ *
+ * @param polygon a polygon returned from polygon_init()
+ * @return the number of vertices
+ */
+size_t polygon_size(const polygon_t *polygon);
+
+/**
+ * Gets the polygon's vertices as an array of polygon_size() elements.
+ * The array is invalidated by polygon_add() and polygon_free().
+ *
+ * @param polygon a polygon returned from polygon_init()
+ * @return a pointer to the first vertex
+ */
+vector_t *polygon_points(const polygon_t *polygon);
+
+/**
+ * Gets the vertex at a given index in a polygon.
+ * Asserts that the index is valid.
+ *
+ * @param polygon a polygon returned from polygon_init()
+ * @param index an index in the polygon (the first vertex is at 0)
+ * @return the vertex at the given index
+ */
+vector_t polygon_get(const polygon_t *polygon, size_t index);
+
+/**
+ * Appends a vertex to the end of a polygon.
+ * Grows the vertex array if it is full and asserts that the resize succeeded.
+ *
+ * @param polygon a polygon returned from polygon_init()
+ * @param point the vertex to add
+ */
+void polygon_add(polygon_t *polygon, vector_t point);
 
 /**
  * Computes the area of a polygon.
  * See https://en.wikipedia.org/wiki/Shoelace_formula#Statement.
  *
- * @param polygon the list of vertices that make up the polygon,
+ * @param polygon the vertices that make up the polygon,
  * listed in a counterclockwise direction. There is an edge between
  * each pair of consecutive vertices, plus one between the first and last.
  * @return the area of the polygon
  */
-double polygon_area(list_t *polygon);
+double polygon_area(const polygon_t *polygon);
 
 /**
  * Computes the center of mass of a polygon.
  * See https://en.wikipedia.org/wiki/Centroid#Of_a_polygon.
  *
- * @param polygon the list of vertices that make up the polygon,
+ * @param polygon the vertices that make up the polygon,
  * listed in a counterclockwise direction. There is an edge between
  * each pair of consecutive vertices, plus one between the first and last.
  * @return the centroid of the polygon
  */
-vector_t polygon_centroid(list_t *polygon);
+vector_t polygon_centroid(const polygon_t *polygon);
+
+/**
+ * Computes the smallest axis-aligned box containing a polygon.
+ * Asserts that the polygon has at least one vertex.
+ *
+ * @param polygon the vertices that make up the polygon
+ * @return the polygon's bounding box
+ */
+aabb_t polygon_bounds(const polygon_t *polygon);
+
+/**
+ * Checks whether two axis-aligned boxes overlap (touching counts).
+ *
+ * @param a the first box
+ * @param b the second box
+ * @return true if the boxes share at least one point
+ */
+bool aabb_overlaps(aabb_t a, aabb_t b);
+
+/**
+ * Finds how far along a ray it enters an axis-aligned box.
+ * Takes the reciprocal of the ray's direction,
+ * so a ray tested against many boxes divides only once.
+ *
+ * @param box the box
+ * @param origin where the ray starts
+ * @param inverse_direction 1 over each component of a unit vector
+ *   along the ray (infinite for components that are 0)
+ * @param max_distance how far along the ray to look
+ * @return the distance to the box (0 if the ray starts inside it),
+ *   or INFINITY if the ray misses it or only reaches it past max_distance
+ */
+double aabb_ray_distance(aabb_t box, vector_t origin,
+                         vector_t inverse_direction, double max_distance);
 
 /**
  * Translates all vertices in a polygon by a given vector.
  * Note: mutates the original polygon.
  *
- * @param polygon the list of vertices that make up the polygon
+ * @param polygon the vertices that make up the polygon
  * @param translation the vector to add to each vertex's position
  */
-void polygon_translate(list_t *polygon, vector_t translation);
+void polygon_translate(polygon_t *polygon, vector_t translation);
 
 /**
  * Rotates vertices in a polygon by a given angle about a given point.
  * Note: mutates the original polygon.
  *
- * @param polygon the list of vertices that make up the polygon
+ * @param polygon the vertices that make up the polygon
  * @param angle the angle to rotate the polygon, in radians.
  * A positive angle means counterclockwise.
  * @param point the point to rotate around
  */
-void polygon_rotate(list_t *polygon, double angle, vector_t point);
+void polygon_rotate(polygon_t *polygon, double angle, vector_t point);
+
+/**
+ * Translates an array of vertices in place,
+ * using the fastest vector instructions the CPU supports (see simd.h).
+ *
+ * @param points the vertices
+ * @param count the number of vertices
+ * @param translation the vector to add to each vertex's position
+ */
+void points_translate(vector_t *points, size_t count, vector_t translation);
+
+/**
+ * Rotates an array of vertices in place about a given point,
+ * using the fastest vector instructions the CPU supports (see simd.h).
+ *
+ * @param points the vertices
+ * @param count the number of vertices
+ * @param angle the angle to rotate by, in radians, counterclockwise
+ * @param point the point to rotate around
+ */
+void points_rotate(vector_t *points, size_t count, double angle,
+                   vector_t point);
+
+/**
+ * Places vertices given relative to an origin in the world:
+ * each one is rotated about the origin, then moved by position.
+ * Uses the fastest vector instructions the CPU supports (see simd.h).
+ *
+ * @param out where to store the placed vertices; may be the same as local
+ * @param local the vertices relative to the origin
+ * @param count the number of vertices
+ * @param angle the angle to rotate by, in radians, counterclockwise
+ * @param position where the origin ends up
+ */
+void points_place(vector_t *out, const vector_t *local, size_t count,
+                  double angle, vector_t position);
 
 #endif // #ifndef __POLYGON_H__
@@ -0,0 +1,69 @@
+#ifndef __POOL_H__
+#define __POOL_H__
+
+#include <stddef.h>
+
+/**
+ * An allocator for many small records of one size, e.g. force creators.
+ * Records are carved out of large slabs and kept on a free list
+ * when released, so adding and removing records over and over
+ * reuses the same memory instead of calling malloc() and free().
+ * Slabs are only given back when the pool is freed.
+ */
+typedef struct pool pool_t;
+
+/** How much of a pool is in use, for monitoring. */
+typedef struct pool_stats {
+  /** The number of records allocated and not yet released */
+  size_t live;
+  /** The most records that were ever live at once */
+  size_t peak;
+  /** The number of slabs the pool has allocated */
+  size_t slabs;
+} pool_stats_t;
+
+/**
+ * Allocates memory for an empty pool. No slabs are allocated
+ * until the first record is.
+ * Asserts that the sizes are positive and the memory was allocated.
+ *
+ * @param record_size the size of each record in bytes
+ * @param slab_records how many records each slab holds
+ * @return the new pool
+ */
+pool_t *pool_init(size_t record_size, size_t slab_records);
+
+/**
+ * Releases a pool and every slab it allocated,
+ * including any records that are still live.
+ *
+ * @param pool a pointer to a pool returned from pool_init()
+ */
+void pool_free(pool_t *pool);
+
+/**
+ * Allocates a record from a pool, adding a slab if every record is in use.
+ * Asserts that the memory was allocated.
+ *
+ * @param pool a pointer to a pool returned from pool_init()
+ * @return the record, aligned for any type, with unspecified contents
+ */
+void *pool_alloc(pool_t *pool);
+
+/**
+ * Returns a record to a pool, to be reused by a later pool_alloc().
+ *
+ * @param pool the pool the record was allocated from
+ * @param record a record returned from pool_alloc(), or NULL
+ */
+void pool_release(pool_t *pool, void *record);
+
+/**
+ * Gets how much of a pool is in use.
+ *
+ * @param pool a pointer to a pool returned from pool_init()
+ * @return the pool's statistics
+ */
+pool_stats_t pool_get_stats(pool_t *pool);
+
+#endif // #ifndef __POOL_H__
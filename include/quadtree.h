@@ -0,0 +1,62 @@
+#ifndef __QUADTREE_H__
+#define __QUADTREE_H__
+
+#include "vector.h"
+#include <stddef.h>
+
+/**
+ * A quadtree over a set of point masses, for finding the gravitational field
+ * they make with the Barnes-Hut approximation: a far enough group of masses
+ * pulls like a single mass at their center of mass.
+ * Like a bounding volume hierarchy (see bvh.h), it is rebuilt from scratch
+ * whenever the masses move, which takes O(n log n) time,
+ * and then each point's field takes about O(log n) time to find.
+ */
+typedef struct quadtree quadtree_t;
+
+/**
+ * Allocates memory for an empty tree.
+ * Asserts that the required memory is successfully allocated.
+ *
+ * @return the new tree
+ */
+quadtree_t *quadtree_init(void);
+
+/**
+ * Releases the memory allocated for a tree.
+ *
+ * @param tree a pointer to a tree returned from quadtree_init()
+ */
+void quadtree_free(quadtree_t *tree);
+
+/**
+ * Rebuilds a tree over the given point masses, replacing what it held before.
+ * The tree keeps its own copy of them and reuses its memory between builds.
+ *
+ * @param tree a pointer to a tree returned from quadtree_init()
+ * @param points the positions of the masses
+ * @param masses the masses, which must be finite
+ * @param count the number of masses
+ */
+void quadtree_build(quadtree_t *tree, const vector_t *points,
+                    const double *masses, size_t count);
+
+/**
+ * Finds the gravitational field of the stored masses at a point,
+ * i.e. the sum of m * r / |r|^3 over the masses m at offsets r,
+ * to be multiplied by G and the mass at the point to get its force.
+ * A group of masses in a square of side s at distance d is treated
+ * as a single mass when s / d < theta, so theta 0 sums every mass exactly
+ * and larger values trade accuracy for speed; 0.5 is a common choice.
+ *
+ * @param tree a pointer to a tree returned from quadtree_init()
+ * @param point where to find the field
+ * @param theta the opening angle, at least 0
+ * @param min_distance masses closer to the point than this are left out,
+ *   including one at the point itself
+ * @return the field at the point
+ */
+vector_t quadtree_field(quadtree_t *tree, vector_t point, double theta,
+                        double min_distance);
+
+#endif // #ifndef __QUADTREE_H__
@@ -2,10 +2,15 @@
 #define __SCENE_H__
 
 #include "body.h"
+#include "collision.h"
+#include "contacts.h"
 #include "list.h"
+#include "pool.h"
 
 extern const double MAX_WIDTH_GAME;
 extern const double MAX_HEIGHT_GAME;
+// the largest record scene_alloc() hands out, in bytes
+extern const size_t SCENE_RECORD_SIZE;
 
 /**
  * A collection of bodies and force creators.
@@ -29,8 +34,57 @@ typedef void (*force_creator_t)(void *aux);
 
 typedef struct force_info force_info_t;
 
+/**
+ * A force on one or two bodies that only depends on a constant,
+ * like a spring or drag. Forces of one kind are stored together
+ * and applied in a single call (see scene_add_batched_force()).
+ */
+typedef struct force_record {
+  body_t *body1;
+  /** The other body, or NULL for a force on body1 alone */
+  body_t *body2;
+  double constant;
+} force_record_t;
+
+/**
+ * A function which applies one kind of force for many records at once,
+ * e.g. every spring in a scene.
+ *
+ * @param records the records, stored contiguously
+ * @param count the number of records
+ */
+typedef void (*force_kernel_t)(const force_record_t *records, size_t count);
+
 void force_free(force_info_t *force_storage);
 
+/**
+ * A force that acts on every moving body with any of some tags
+ * (see body_set_tags()), like drag or a pull towards a body.
+ * Fields are stored by the scene, so bodies do not register with them.
+ */
+typedef struct force_field {
+  /** The tags of the bodies the field acts on */
+  size_t tags;
+  /**
+   * The body the field is centered on, or NULL.
+   * The field does not act on its source,
+   * and is removed when its source is removed.
+   */
+  body_t *source;
+  /** The field's strength, e.g. a drag coefficient */
+  double constant;
+  /** The field's direction, e.g. the acceleration of uniform gravity */
+  vector_t vector;
+} force_field_t;
+
+/**
+ * A function which applies a force field to one body it acts on.
+ *
+ * @param body the body, which is not the field's source
+ * @param field the field
+ */
+typedef void (*field_kernel_t)(body_t *body, const force_field_t *field);
+
 /**
  * Allocates memory for an empty scene.
  * Makes a reasonable guess of the number of bodies to allocate space for.
@@ -40,6 +94,20 @@ void force_free(force_info_t *force_storage);
  */
 scene_t *scene_init(void);
 
+/**
+ * Allocates memory for an empty scene whose narrow phase
+ * is split between several threads.
+ * Collisions are still handled in the same order as with one thread,
+ * so the scene behaves identically whatever the thread count;
+ * collision handlers always run on the thread calling scene_tick().
+ * Asserts that the required memory is allocated and the threads started.
+ *
+ * @param threads how many threads test collisions, counting the caller;
+ *   0 is treated as 1, and builds without threads always use 1
+ * @return the new scene
+ */
+scene_t *scene_init_with_threads(size_t threads);
+
 /**
  * Releases memory allocated for a given scene
  * and all the bodies and force creators it contains.
@@ -56,6 +124,14 @@ void scene_free(scene_t *scene);
  */
 size_t scene_bodies(scene_t *scene);
 
+/**
+ * Gets the number of threads a scene tests collisions on.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the number of threads, counting the one calling scene_tick()
+ */
+size_t scene_threads(scene_t *scene);
+
 /**
  * Gets the body at a given index in a scene.
  * Asserts that the index is valid.
@@ -74,6 +150,19 @@ body_t *scene_get_body(scene_t *scene, size_t index);
  */
 void scene_add_body(scene_t *scene, body_t *body);
 
+/**
+ * Adds a body to a scene as static geometry, like the map's walls.
+ * The body must not be moved afterwards (see body_set_static()).
+ * Static bodies are drawn and removed like any other body,
+ * but are skipped when the scene is ticked, and collision rules
+ * find them through a tree that is rebuilt only when static bodies
+ * are added or removed.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param body a pointer to the body to add to the scene
+ */
+void scene_add_static_body(scene_t *scene, body_t *body);
+
 /**
  * @deprecated Use body_remove() instead
  *
@@ -98,25 +187,319 @@ void scene_add_force_creator(scene_t *scene, force_creator_t forcer, void *aux,
  * The auxiliary value is passed to the force creator each time it is called.
  * The force creator is registered with a list of bodies it applies to,
  * so it can be removed when any one of the bodies is removed.
+ * Forces that fit in a force_record_t are cheaper to add
+ * with scene_add_batched_force().
  *
  * @param scene a pointer to a scene returned from scene_init()
  * @param forcer a force creator function
  * @param aux an auxiliary value to pass to forcer when it is called
  * @param bodies the list of bodies affected by the force creator.
  *   The force creator will be removed if any of these bodies are removed.
- *   This list does not own the bodies, so its freer should be NULL.
+ *   The scene frees the list along with the force creator;
+ *   it does not own the bodies, so its freer should be NULL.
  * @param freer if non-NULL, a function to call in order to free aux
  */
 void scene_add_bodies_force_creator(scene_t *scene, force_creator_t forcer,
                                     void *aux, list_t *bodies,
                                     free_func_t freer);
 
+/**
+ * Adds a force creator on at most two bodies to a scene,
+ * like scene_add_bodies_force_creator() but without a list of bodies,
+ * so adding it allocates nothing beyond the scene's pool.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param forcer a force creator function
+ * @param aux an auxiliary value to pass to forcer when it is called
+ * @param body1 a body the force creator depends on, or NULL if none
+ * @param body2 another body it depends on, or NULL if at most one
+ * @param freer if non-NULL, a function to call in order to free aux
+ */
+void scene_add_pair_force_creator(scene_t *scene, force_creator_t forcer,
+                                  void *aux, body_t *body1, body_t *body2,
+                                  free_func_t freer);
+
+/**
+ * Allocates a small record, e.g. a force creator's auxiliary value,
+ * from the pool the scene keeps its force creators in.
+ * Records released with scene_release() are reused,
+ * so creating and removing forces often does not call malloc().
+ * Asserts that the size is at most SCENE_RECORD_SIZE.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param size the size of the record in bytes
+ * @return the record, with unspecified contents
+ */
+void *scene_alloc(scene_t *scene, size_t size);
+
+/**
+ * Returns a record from scene_alloc() to the scene's pool.
+ * Any records still allocated are released when the scene is freed.
+ *
+ * @param scene the scene the record was allocated from
+ * @param record a record returned from scene_alloc(), or NULL
+ */
+void scene_release(scene_t *scene, void *record);
+
+/**
+ * Gets how much of a scene's pool is in use,
+ * counting both force creators and records from scene_alloc().
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the pool's statistics
+ */
+pool_stats_t scene_get_pool_stats(scene_t *scene);
+
+/**
+ * Adds a force to a scene, stored with the other forces that use the same
+ * kernel so they are all applied by one call to it each tick,
+ * before the force creators. Like a force creator,
+ * the force is removed when either of its bodies is removed.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param kernel the function that applies this kind of force
+ * @param body1 the first body
+ * @param body2 the second body, or NULL if the force only acts on body1
+ * @param constant the force's constant, e.g. a spring's stiffness
+ */
+void scene_add_batched_force(scene_t *scene, force_kernel_t kernel,
+                             body_t *body1, body_t *body2, double constant);
+
+/**
+ * Adds a force field to a scene. Each tick, before the force creators,
+ * the scene makes one pass over its moving bodies,
+ * calling the kernel of each field that shares a tag with the body.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param kernel the function that applies this kind of field
+ * @param field the field, which is copied
+ */
+void scene_add_force_field(scene_t *scene, field_kernel_t kernel,
+                           force_field_t field);
+
+/**
+ * Adds a collision rule to a scene that calls a handler the first tick
+ * any body on one collision layer touches any body on another layer.
+ * Bodies are only checked against each other if their collision
+ * categories and masks allow it (see body_set_collision_layers()).
+ * Candidate pairs come from a spatial grid over the arena,
+ * so only nearby bodies are checked, and one rule covers bodies added later.
+ * The handler is passed the body on layer1 first.
+ * If several rules match a pair of bodies, each of them is called.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param layer1 the layers (e.g. TANK_LAYER) of the first body
+ * @param layer2 the layers of the second body
+ * @param handler a function to call whenever two such bodies collide
+ * @param aux an auxiliary value to pass to the handler
+ * @param freer if non-NULL, a function to call in order to free aux
+ */
+void scene_add_collision_rule(scene_t *scene, size_t layer1, size_t layer2,
+                              collision_handler_t handler, void *aux,
+                              free_func_t freer);
+
+/**
+ * Adds a collision rule to a scene, like scene_add_collision_rule(),
+ * whose handler is told when contacts begin, persist and end.
+ * Subscribing to CONTACT_BEGIN | CONTACT_END skips resting contacts,
+ * which would otherwise call the handler every tick.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param layer1 the layers (e.g. TANK_LAYER) of the first body
+ * @param layer2 the layers of the second body
+ * @param events the contact_event_t flags to call the handler for
+ * @param handler a function to call on those events
+ * @param aux an auxiliary value to pass to the handler
+ * @param freer if non-NULL, a function to call in order to free aux
+ */
+void scene_add_contact_rule(scene_t *scene, size_t layer1, size_t layer2,
+                            size_t events, contact_handler_t handler,
+                            void *aux, free_func_t freer);
+
+/**
+ * Records that two bodies are colliding this tick in the scene's contacts.
+ * Collision rules do this themselves;
+ * it is for force creators that find collisions, like create_collision().
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param body1 the first body
+ * @param body2 the second body
+ * @param collision their collision, with the axis pointing towards body2
+ * @return CONTACT_BEGIN if the bodies were not touching before this tick,
+ *   otherwise CONTACT_PERSIST
+ */
+contact_event_t scene_record_contact(scene_t *scene, body_t *body1,
+                                     body_t *body2,
+                                     collision_info_t collision);
+
+/**
+ * Queues a call to a collision handler for the end of this tick's
+ * collision detection, so handlers never change bodies while collisions
+ * are still being found. Queued calls are made in one batch,
+ * grouped by handler, before the bodies are ticked.
+ * Collision rules queue their handlers the same way;
+ * this is for force creators that find collisions, like create_collision().
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param body1 the body to pass to the handler first
+ * @param body2 the body to pass to the handler second
+ * @param collision their collision, with the axis pointing towards body2
+ * @param handler the handler to call
+ * @param aux the auxiliary value to pass to the handler
+ */
+void scene_queue_collision(scene_t *scene, body_t *body1, body_t *body2,
+                           collision_info_t collision,
+                           collision_handler_t handler, void *aux);
+
+/**
+ * Gets the number of contacts found on the last tick.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the number of contacts
+ */
+size_t scene_contacts(scene_t *scene);
+
+/**
+ * Gets one of the contacts found on the last tick.
+ * It is only valid until the next tick.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param index an index in [0, scene_contacts(scene))
+ * @return the contact
+ */
+const contact_t *scene_get_contact(scene_t *scene, size_t index);
+
+/**
+ * Finds the contact between two bodies in O(1) time.
+ * It is only valid until the next tick.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param body1 one of the bodies
+ * @param body2 the other body, in either order
+ * @return the contact, or NULL if the bodies were not touching
+ *   on the last tick
+ */
+const contact_t *scene_find_contact(scene_t *scene, body_t *body1,
+                                    body_t *body2);
+
+/**
+ * Gets the number of times a scene has been ticked,
+ * which is the tick contacts' first_tick and last_tick refer to.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the number of calls to scene_tick() so far
+ */
+size_t scene_ticks(scene_t *scene);
+
+/**
+ * Finds the first body a ray hits, e.g. to check an AI's line of sight.
+ * Static bodies are found through the scene's tree of static geometry,
+ * and moving bodies through the grid the region queries use
+ * (see scene_query_aabb()), so only those in cells the ray crosses are
+ * tested, by where their boxes were at the end of the last tick.
+ * Bodies the ray starts inside are not hit
+ * (see find_ray_hit()), and neither are bodies marked for removal.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param origin where the ray starts
+ * @param direction the direction of the ray; need not be a unit vector,
+ *   but must not be zero
+ * @param max_distance how far along the ray to look
+ * @param mask the collision layers to hit (see body_set_collision_layers());
+ *   bodies on none of them are passed through
+ * @return the nearest hit, whose body is NULL if the ray hits nothing
+ */
+ray_hit_t scene_raycast(scene_t *scene, vector_t origin, vector_t direction,
+                        double max_distance, size_t mask);
+
+/**
+ * Finds the first body a segment hits, going from its start to its end,
+ * as in scene_raycast().
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param start where the segment starts
+ * @param end where the segment ends
+ * @param mask the collision layers to hit
+ * @return the nearest hit, whose body is NULL if the segment hits nothing
+ */
+ray_hit_t scene_segment_query(scene_t *scene, vector_t start, vector_t end,
+                              size_t mask);
+
+/**
+ * Finds the bodies whose bounding boxes overlap a box,
+ * without looking at the bodies anywhere else.
+ * Moving bodies are kept in a grid that follows them from tick to tick,
+ * so they are found where they were at the end of the last tick
+ * (or where they were added, if that was since);
+ * static bodies come from the scene's tree of static geometry.
+ * Bodies marked for removal are left out. Allocates no memory
+ * once the scene's buffers are big enough.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param box the region to search
+ * @param mask the collision layers to find (see body_set_collision_layers());
+ *   SIZE_MAX finds every body, even those on no layer
+ * @param bodies where to write the bodies found, in no particular order
+ * @param capacity how many bodies fit in the buffer;
+ *   any found past that are counted but not written
+ * @return how many bodies were found,
+ *   which is more than capacity if the buffer was too small
+ */
+size_t scene_query_aabb(scene_t *scene, aabb_t box, size_t mask,
+                        body_t **bodies, size_t capacity);
+
+/**
+ * Finds the bodies whose shapes come within a distance of a point,
+ * e.g. to apply area damage, as in scene_query_aabb().
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param center the point
+ * @param radius how far from the point to search
+ * @param mask the collision layers to find, as in scene_query_aabb()
+ * @param bodies where to write the bodies found, in no particular order
+ * @param capacity how many bodies fit in the buffer
+ * @return how many bodies were found, as in scene_query_aabb()
+ */
+size_t scene_query_radius(scene_t *scene, vector_t center, double radius,
+                          size_t mask, body_t **bodies, size_t capacity);
+
+/**
+ * Chooses how a scene integrates its bodies' motion each tick.
+ * Batched forces and force fields are re-evaluated at every stage
+ * of the integrator; force creators run once per tick,
+ * since many of them find collisions, and their forces are held.
+ * Scenes start out with INTEGRATOR_AVERAGE_VELOCITY.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param integrator the integrator to use from the next tick on
+ */
+void scene_set_integrator(scene_t *scene, integrator_t integrator);
+
+/**
+ * Sets how many equal steps a scene splits each tick into,
+ * re-evaluating batched forces and fields for each one,
+ * so stiff forces stay stable at a longer tick.
+ * Bodies with substeps of their own (see body_set_substeps())
+ * take those instead.
+ * Asserts that the count is positive.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param substeps the number of steps per tick; 1 by default
+ */
+void scene_set_substeps(scene_t *scene, size_t substeps);
+
 /**
  * Executes a tick of a given scene over a small time interval.
- * This requires executing all the force creators
- * and then ticking each body (see body_tick()).
+ * This requires executing all the force creators and collision rules
+ * and then integrating each body (see scene_set_integrator()).
+ * Collisions are all found before any collision handler runs:
+ * bullets are then moved back to where they first hit (see body_rewind()),
+ * and the queued handlers are called.
  * If any bodies are marked for removal, they should be removed from the scene
- * and freed, along with any force creators acting on them.
+ * and freed, along with any force creators acting on them;
+ * their contacts end first, including those of bodies the handlers removed.
+ * Batched forces and force fields are applied last, just before the bodies
+ * move, on top of whatever the force creators and handlers applied.
  *
  * @param scene a pointer to a scene returned from scene_init()
  * @param dt the time elapsed since the last tick, in seconds
@@ -3,6 +3,7 @@
 
 #include "color.h"
 #include "list.h"
+#include "polygon.h"
 #include "scene.h"
 #include "state.h"
 #include "vector.h"
@@ -67,12 +68,12 @@ bool sdl_is_done(state_t *state);
 void sdl_clear(void);
 
 /**
- * Draws a polygon from the given list of vertices and a color.
+ * Draws a polygon from the given vertices and a color.
  *
- * @param points the list of vertices of the polygon
+ * @param points the vertices of the polygon
  * @param color the color used to fill in the polygon
  */
-void sdl_draw_polygon(list_t *points, rgb_color_t color);
+void sdl_draw_polygon(const polygon_t *points, rgb_color_t color);
 
 SDL_Texture *sdl_load_text(state_t *state, char *words, text_t *text, SDL_Color color, vector_t loc);
 
@@ -96,6 +97,18 @@ void sdl_show(void);
  */
 void sdl_render_scene(scene_t *scene);
 
+/**
+ * Draws all bodies in a scene part of the way through a tick,
+ * placing moving bodies between where they were before their last tick
+ * and where they are now (see body_get_interpolated_shape()).
+ * Like sdl_render_scene(), this clears the window and shows the result.
+ *
+ * @param scene the scene to draw
+ * @param alpha how far through the tick, from 0 (its start) to 1 (now),
+ *   e.g. from timestep_get_alpha()
+ */
+void sdl_render_scene_interpolated(scene_t *scene, double alpha);
+
 vector_t get_window_position(vector_t scene_pos, vector_t window_center);
 
 vector_t get_window_center(void);
@@ -135,8 +148,9 @@ vector_t sdl_mouse_position();
 vector_t get_scene_position(vector_t window_pos, vector_t window_center);
 
 /**
- * Gets the amount of time that has passed since the last time
- * this function was called, in seconds.
+ * Gets the amount of wall time that has passed since the last time
+ * this function was called, in seconds, from a monotonic clock.
+ * Returns 0 the first time it is called.
  *
  * @return the number of seconds that have elapsed
  */
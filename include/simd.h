@@ -0,0 +1,57 @@
+#ifndef __SIMD_H__
+#define __SIMD_H__
+
+#include "vector.h"
+#include <stddef.h>
+
+/**
+ * Batch kernels over arrays of vertices.
+ * There is one set per instruction set (scalar, SSE2, AVX2);
+ * the best one the CPU supports is picked the first time they are needed.
+ * Use points_translate(), points_rotate() and points_place() in polygon.h
+ * and points_project() in collision.h rather than calling these directly.
+ */
+typedef struct {
+  /** The instruction set the kernels use, e.g. "avx2" */
+  const char *name;
+  /** Adds offset to each of the count points, in place */
+  void (*translate)(vector_t *points, size_t count, vector_t offset);
+  /**
+   * Sets out[i] to (in[i] - from), rotated by the angle with
+   * the given cosine and sine, plus to. out may be the same array as in.
+   */
+  void (*transform)(vector_t *out, const vector_t *in, size_t count,
+                    double cosine, double sine, vector_t from, vector_t to);
+  /**
+   * Finds the smallest and largest dot products of the points with axis.
+   * With no points, min is INFINITY and max is -INFINITY.
+   */
+  void (*project)(const vector_t *points, size_t count, vector_t axis,
+                  double *min, double *max);
+} simd_kernels_t;
+
+/**
+ * Gets the kernels in use, picking the best ones this CPU supports
+ * on the first call.
+ *
+ * @return the kernels, which are never freed
+ */
+const simd_kernels_t *simd_kernels_get(void);
+
+/**
+ * Lists every set of kernels this CPU can run, for tests and benchmarks.
+ *
+ * @param kernels set to an array of the supported kernels,
+ *   from the scalar fallback up to the best one
+ * @return the number of supported kernels
+ */
+size_t simd_kernels_supported(const simd_kernels_t *const **kernels);
+
+/**
+ * Overrides the kernels picked by simd_kernels_get().
+ *
+ * @param kernels one of the kernels from simd_kernels_supported()
+ */
+void simd_kernels_use(const simd_kernels_t *kernels);
+
+#endif // #ifndef __SIMD_H__
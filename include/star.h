@@ -6,7 +6,7 @@
 
 typedef struct star star_t;
 
-list_t *make_star(vector_t center, double length, int star_points);
+polygon_t make_star(vector_t center, double length, int star_points);
 
 double rand_num(double min, double max);
 
@@ -19,7 +19,7 @@ void star_translate(star_t *star, vector_t vec);
 
 vector_t *get_star_velocity(star_t *star);
 
-list_t *get_star_polygon(star_t *star);
+polygon_t *get_star_polygon(star_t *star);
 
 double get_star_rotation(star_t *star);
 
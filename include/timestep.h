@@ -0,0 +1,72 @@
+#ifndef __TIMESTEP_H__
+#define __TIMESTEP_H__
+
+#include <stddef.h>
+
+/**
+ * A scheduler that turns the wall time between frames
+ * into whole ticks of a fixed length.
+ * Time that does not make up a whole tick is carried over to the next frame,
+ * so the simulation runs at the same rate however fast frames are drawn,
+ * and the fraction of a tick carried over says how far to interpolate
+ * bodies when drawing (see body_get_interpolated_shape()).
+ */
+typedef struct timestep timestep_t;
+
+/**
+ * Allocates memory for a scheduler with no time carried over.
+ * Asserts that the rate and step limit are positive
+ * and the memory was allocated.
+ *
+ * @param hz how many ticks to run per second of wall time
+ * @param max_steps the most ticks to run in one frame;
+ *   after a slower frame the simulation falls behind instead,
+ *   so it cannot spiral into running ever more ticks per frame
+ * @return the new scheduler
+ */
+timestep_t *timestep_init(double hz, size_t max_steps);
+
+/**
+ * Releases the memory allocated for a scheduler.
+ *
+ * @param timestep a pointer to a scheduler returned from timestep_init()
+ */
+void timestep_free(timestep_t *timestep);
+
+/**
+ * Gets the length of each tick.
+ *
+ * @param timestep a pointer to a scheduler returned from timestep_init()
+ * @return the tick length in seconds, i.e. 1 / hz
+ */
+double timestep_get_dt(timestep_t *timestep);
+
+/**
+ * Adds the wall time since the last frame and takes out as many whole ticks
+ * as it covers, up to the step limit.
+ *
+ * @param timestep a pointer to a scheduler returned from timestep_init()
+ * @param elapsed the seconds since the last frame; negative counts as 0
+ * @return the number of ticks to run this frame
+ */
+size_t timestep_advance(timestep_t *timestep, double elapsed);
+
+/**
+ * Gets how far the simulation is into its next tick,
+ * i.e. how far to interpolate bodies from their last tick when drawing.
+ *
+ * @param timestep a pointer to a scheduler returned from timestep_init()
+ * @return the time carried over as a fraction of a tick, in [0, 1)
+ */
+double timestep_get_alpha(timestep_t *timestep);
+
+/**
+ * Gets the wall time dropped so far because frames needed more ticks
+ * than the step limit allowed.
+ *
+ * @param timestep a pointer to a scheduler returned from timestep_init()
+ * @return the seconds dropped since the scheduler was created
+ */
+double timestep_get_dropped(timestep_t *timestep);
+
+#endif // #ifndef __TIMESTEP_H__
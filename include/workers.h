@@ -0,0 +1,62 @@
+#ifndef __WORKERS_H__
+#define __WORKERS_H__
+
+#include <stddef.h>
+
+/**
+ * A fixed set of threads that run the same job together,
+ * e.g. each testing its share of a list of collision pairs.
+ * The thread that calls worker_pool_run() is worker 0,
+ * so a pool of one worker runs jobs inline without any threads.
+ * Builds without threads (e.g. WebAssembly without pthreads)
+ * always get a pool of one worker.
+ */
+typedef struct worker_pool worker_pool_t;
+
+/**
+ * A job run by every worker in a pool.
+ *
+ * @param worker the index of the worker running it,
+ *   in [0, worker_pool_size(pool))
+ * @param aux the auxiliary value passed to worker_pool_run()
+ */
+typedef void (*worker_job_t)(size_t worker, void *aux);
+
+/**
+ * Allocates a pool and starts its threads,
+ * which sleep until they are given a job.
+ * Asserts that the memory was allocated and the threads started.
+ *
+ * @param workers the number of workers, counting the calling thread;
+ *   0 is treated as 1
+ * @return the new pool
+ */
+worker_pool_t *worker_pool_init(size_t workers);
+
+/**
+ * Stops a pool's threads and releases its memory.
+ *
+ * @param pool a pointer to a pool returned from worker_pool_init()
+ */
+void worker_pool_free(worker_pool_t *pool);
+
+/**
+ * Gets the number of workers in a pool.
+ *
+ * @param pool a pointer to a pool returned from worker_pool_init()
+ * @return the number of workers, which may be fewer than were asked for
+ *   if the build has no threads
+ */
+size_t worker_pool_size(worker_pool_t *pool);
+
+/**
+ * Runs a job on every worker of a pool at once,
+ * returning when all of them have finished.
+ *
+ * @param pool a pointer to a pool returned from worker_pool_init()
+ * @param job the job to run
+ * @param aux an auxiliary value to pass to the job
+ */
+void worker_pool_run(worker_pool_t *pool, worker_job_t job, void *aux);
+
+#endif // #ifndef __WORKERS_H__
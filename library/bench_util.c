@@ -0,0 +1,28 @@
+#include "bench_util.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+double bench_now(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+polygon_t bench_square(vector_t center, double side_length) {
+  polygon_t square = polygon_init(4);
+  double half = side_length / 2;
+  polygon_add(&square, (vector_t){center.x + half, center.y + half});
+  polygon_add(&square, (vector_t){center.x - half, center.y + half});
+  polygon_add(&square, (vector_t){center.x - half, center.y - half});
+  polygon_add(&square, (vector_t){center.x + half, center.y - half});
+  return square;
+}
+
+void bench_report(const char *name, size_t n, double seconds,
+                  size_t iterations) {
+  double per_iteration = seconds / iterations;
+  printf("%-28s n=%-8zu %12.3f us/iter %10.2f ns/item\n", name, n,
+         per_iteration * 1e6, per_iteration * 1e9 / (n > 0 ? n : 1));
+}
@@ -12,6 +12,28 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+// types of different bodies
+const size_t WALL_TYPE = 0;
+const size_t BULLET_TYPE = 1;
+const size_t SNIPER_BULLET_TYPE = 10;
+const size_t GRAVITY_BULLET_TYPE = 13;
+const size_t GATLING_BULLET_TYPE = 11;
+const size_t DEFAULT_TANK_TYPE = 2;
+const size_t GRAVITY_TANK_TYPE = 3;
+const size_t SNIPER_TANK_TYPE = 4;
+const size_t HEALTH_BAR_TYPE = 6;
+const size_t GATLING_TANK_TYPE = 7;
+
+// collision layers
+const size_t TANK_LAYER = 1 << 0;
+const size_t BULLET_LAYER = 1 << 1;
+const size_t OBSTACLE_LAYER = 1 << 2;
+
+// force field tags; gravity bullets are pulled by whoever did not fire them
+const size_t BULLET_TAG = 1 << 0;
+const size_t PLAYER1_GRAVITY_TAG = 1 << 1;
+const size_t PLAYER2_GRAVITY_TAG = 1 << 2;
+
 const size_t AI_UP = 1;
 const size_t AI_DOWN = 2;
 const size_t AI_UP_LEFT = 3;
@@ -27,60 +49,590 @@ char *GRAVITY_IMAGE_PATH = "assets/gravity_tank.png";
 char *SNIPER_IMAGE_PATH = "assets/sniper_tank.png";
 char *GATLING_IMAGE_PATH = "assets/gatling_tank.png";
 
+size_t STORE_GROW_FACTOR = 2;
+size_t DETACHED_STORE_SIZE = 64;
+const size_t ROUND_OUTLINE_POINTS = 64;
+
+/**
+ * The state that changes every tick, kept as parallel arrays so that
+ * integration streams through memory instead of visiting each body_t.
+ * Slot i of every array belongs to owners[i].
+ */
+typedef struct body_store {
+  size_t size;
+  size_t capacity;
+  vector_t *centroid;
+  // where the centroid was before the last tick, for swept collisions
+  vector_t *previous_centroid;
+  vector_t *velocity;
+  vector_t *force;
+  vector_t *impulse;
+  double *mass;
+  double *rotation;
+  // the rotation before the last tick, for drawing between ticks
+  double *previous_rotation;
+  double *rotation_speed;
+  double *magnitude;
+  bool *align_to_velocity;
+  // how many steps each body splits a tick into (see body_set_substeps())
+  size_t *substeps;
+  // the forces that are held for the whole tick (see body_store_hold_forces())
+  vector_t *held_force;
+  // scratch for the integrators: the state at the start of the step,
+  // and RK4's weighted sums of velocity and acceleration
+  vector_t *start_centroid;
+  vector_t *start_velocity;
+  vector_t *sum_velocity;
+  vector_t *sum_acceleration;
+  body_t **owners;
+} body_store_t;
+
 typedef struct body {
+  body_store_t *store;
+  size_t slot;
   graphic_t *graphic;
-  double mass;
-  list_t *shape;
-  vector_t velocity;
-  vector_t centroid;
-  double rotation;
-  double rotation_speed;
+  // the shape relative to the centroid, before rotation
+  polygon_t local_shape;
+  // the shape in world coordinates, rebuilt from local_shape when needed
+  polygon_t world_shape;
+  // the centroid and rotation that world_shape was built for
+  vector_t world_centroid;
+  double world_rotation;
+  // set when world_shape is stale for a reason other than movement
+  bool world_dirty;
+  // the unit edge normals of local_shape, one per direction
+  vector_t *local_axes;
+  // local_axes at the rotation world_axes was built for
+  vector_t *world_axes;
+  double axes_rotation;
+  // set when world_axes is stale for a reason other than rotation
+  bool axes_dirty;
+  size_t axis_count;
+  size_t axes_capacity;
+  // the bounding box of the shape rotated by bounds_rotation,
+  // relative to the centroid, so moving the body only offsets it
+  aabb_t rotated_bounds;
+  double bounds_rotation;
+  bool bounds_dirty;
+  // circles and capsules are the points within radius of their core:
+  // the centroid, or a segment through it. For them, local_shape is
+  // only an outline to draw, and collisions use the core instead
+  shape_type_t shape_type;
+  double radius;
+  vector_t local_core[2];
+  // local_core rotated by core_rotation
+  vector_t rotated_core[2];
+  double core_rotation;
+  bool core_dirty;
+  // rotated_core placed at core_centroid
+  vector_t world_core[2];
+  vector_t core_centroid;
+  size_t core_count;
   rgb_color_t color;
-  vector_t force;
-  vector_t impulse;
   void *info;
   free_func_t freer;
   bool is_removed;
-  double magnitude;
+  bool is_static;
+  bool is_bullet;
+  size_t collision_category;
+  size_t collision_mask;
+  // which force fields act on the body
+  size_t tags;
+  // the body's place in its scene's spatial index
+  size_t proxy;
+  force_link_t *force_links;
   double time;
   double health;
   size_t ai_mode;
   double ai_time;
-  bool just_collided;
   char *image_path;
 } body_t;
 
-body_t *body_init(list_t *shape, double mass, rgb_color_t color) {
+/**
+ * Bodies that have not been added to a scene yet live here,
+ * so every body_t always has a slot to point into.
+ */
+body_store_t *detached_store = NULL;
+
+void store_resize(body_store_t *store, size_t capacity) {
+  store->capacity = capacity;
+  store->centroid = realloc(store->centroid, sizeof(vector_t) * capacity);
+  store->previous_centroid =
+      realloc(store->previous_centroid, sizeof(vector_t) * capacity);
+  store->velocity = realloc(store->velocity, sizeof(vector_t) * capacity);
+  store->force = realloc(store->force, sizeof(vector_t) * capacity);
+  store->impulse = realloc(store->impulse, sizeof(vector_t) * capacity);
+  store->mass = realloc(store->mass, sizeof(double) * capacity);
+  store->rotation = realloc(store->rotation, sizeof(double) * capacity);
+  store->previous_rotation =
+      realloc(store->previous_rotation, sizeof(double) * capacity);
+  store->rotation_speed =
+      realloc(store->rotation_speed, sizeof(double) * capacity);
+  store->magnitude = realloc(store->magnitude, sizeof(double) * capacity);
+  store->align_to_velocity =
+      realloc(store->align_to_velocity, sizeof(bool) * capacity);
+  store->substeps = realloc(store->substeps, sizeof(size_t) * capacity);
+  store->held_force = realloc(store->held_force, sizeof(vector_t) * capacity);
+  store->start_centroid =
+      realloc(store->start_centroid, sizeof(vector_t) * capacity);
+  store->start_velocity =
+      realloc(store->start_velocity, sizeof(vector_t) * capacity);
+  store->sum_velocity =
+      realloc(store->sum_velocity, sizeof(vector_t) * capacity);
+  store->sum_acceleration =
+      realloc(store->sum_acceleration, sizeof(vector_t) * capacity);
+  store->owners = realloc(store->owners, sizeof(body_t *) * capacity);
+  assert(store->centroid != NULL && store->previous_centroid != NULL &&
+         store->velocity != NULL &&
+         store->force != NULL && store->impulse != NULL &&
+         store->mass != NULL && store->rotation != NULL &&
+         store->previous_rotation != NULL && store->rotation_speed != NULL &&
+         store->magnitude != NULL && store->align_to_velocity != NULL &&
+         store->substeps != NULL && store->held_force != NULL &&
+         store->start_centroid != NULL && store->start_velocity != NULL &&
+         store->sum_velocity != NULL &&
+         store->sum_acceleration != NULL && store->owners != NULL);
+}
+
+body_store_t *body_store_init(size_t initial_size) {
+  body_store_t *store = calloc(1, sizeof(body_store_t));
+  assert(store != NULL);
+  store_resize(store, initial_size > 0 ? initial_size : 1);
+  return store;
+}
+
+void body_store_free(body_store_t *store) {
+  assert(store->size == 0);
+  free(store->centroid);
+  free(store->previous_centroid);
+  free(store->velocity);
+  free(store->force);
+  free(store->impulse);
+  free(store->mass);
+  free(store->rotation);
+  free(store->previous_rotation);
+  free(store->rotation_speed);
+  free(store->magnitude);
+  free(store->align_to_velocity);
+  free(store->substeps);
+  free(store->held_force);
+  free(store->start_centroid);
+  free(store->start_velocity);
+  free(store->sum_velocity);
+  free(store->sum_acceleration);
+  free(store->owners);
+  free(store);
+}
+
+size_t body_store_size(body_store_t *store) { return store->size; }
+
+body_t *body_store_get(body_store_t *store, size_t index) {
+  assert(index < store->size);
+  return store->owners[index];
+}
+
+/** Claims a new slot at the end of the store for the given body. */
+size_t store_push(body_store_t *store, body_t *body) {
+  if (store->size >= store->capacity) {
+    store_resize(store, store->capacity * STORE_GROW_FACTOR);
+  }
+  size_t slot = store->size++;
+  store->owners[slot] = body;
+  body->store = store;
+  body->slot = slot;
+  return slot;
+}
+
+/** Copies one slot's state between (possibly different) stores. */
+void store_copy_slot(body_store_t *to, size_t to_slot, body_store_t *from,
+                     size_t from_slot) {
+  to->centroid[to_slot] = from->centroid[from_slot];
+  to->previous_centroid[to_slot] = from->previous_centroid[from_slot];
+  to->velocity[to_slot] = from->velocity[from_slot];
+  to->force[to_slot] = from->force[from_slot];
+  to->impulse[to_slot] = from->impulse[from_slot];
+  to->mass[to_slot] = from->mass[from_slot];
+  to->rotation[to_slot] = from->rotation[from_slot];
+  to->previous_rotation[to_slot] = from->previous_rotation[from_slot];
+  to->rotation_speed[to_slot] = from->rotation_speed[from_slot];
+  to->magnitude[to_slot] = from->magnitude[from_slot];
+  to->align_to_velocity[to_slot] = from->align_to_velocity[from_slot];
+  to->substeps[to_slot] = from->substeps[from_slot];
+  // held between the start of a tick and its integration,
+  // when removed bodies' slots are refilled
+  to->held_force[to_slot] = from->held_force[from_slot];
+}
+
+/**
+ * Releases a slot by moving the last slot into it,
+ * so the arrays stay dense without shifting.
+ */
+void store_release(body_store_t *store, size_t slot) {
+  assert(slot < store->size);
+  size_t last = --store->size;
+  if (slot != last) {
+    store_copy_slot(store, slot, store, last);
+    body_t *moved = store->owners[last];
+    store->owners[slot] = moved;
+    moved->slot = slot;
+  }
+}
+
+void body_store_add(body_store_t *store, body_t *body) {
+  body_store_t *old_store = body->store;
+  size_t old_slot = body->slot;
+  size_t slot = store_push(store, body);
+  store_copy_slot(store, slot, old_store, old_slot);
+  store_release(old_store, old_slot);
+}
+
+size_t integrator_stages(integrator_t integrator) {
+  switch (integrator) {
+  case INTEGRATOR_VELOCITY_VERLET:
+    return 2;
+  case INTEGRATOR_RK4:
+    return 4;
+  default:
+    return 1;
+  }
+}
+
+/**
+ * Starts a step of one slot, saving its state for the integrator.
+ * At the start of a tick, also remembers where the body was
+ * for swept collisions and drawing.
+ */
+void store_begin_step(body_store_t *store, size_t i, integrator_t integrator,
+                      bool tick_start) {
+  if (tick_start) {
+    store->previous_centroid[i] = store->centroid[i];
+    store->previous_rotation[i] = store->rotation[i];
+  }
+  // the averaging scheme folds the impulse into its one stage
+  if (integrator != INTEGRATOR_AVERAGE_VELOCITY) {
+    double inverse_mass = 1.0 / store->mass[i];
+    store->velocity[i].x += store->impulse[i].x * inverse_mass;
+    store->velocity[i].y += store->impulse[i].y * inverse_mass;
+    store->impulse[i] = VEC_ZERO;
+  }
+  store->start_centroid[i] = store->centroid[i];
+  store->start_velocity[i] = store->velocity[i];
+}
+
+/**
+ * Runs one stage of an integrator on a slot over dt,
+ * using the force evaluated at the slot's current state.
+ * Each stage leaves the slot at the state the next stage's force
+ * is evaluated at, and the last leaves it at the end of the step.
+ */
+void store_stage(body_store_t *store, size_t i, integrator_t integrator,
+                 size_t stage, double dt) {
+  double inverse_mass = 1.0 / store->mass[i];
+  vector_t acceleration = {store->force[i].x * inverse_mass,
+                           store->force[i].y * inverse_mass};
+  vector_t velocity = store->velocity[i];
+  vector_t start_centroid = store->start_centroid[i];
+  vector_t start_velocity = store->start_velocity[i];
+  switch (integrator) {
+  case INTEGRATOR_AVERAGE_VELOCITY: {
+    // the centroid moves at the average of the old and new velocities
+    vector_t old_velocity = velocity;
+    velocity.x += (dt * store->force[i].x + store->impulse[i].x) * inverse_mass;
+    velocity.y += (dt * store->force[i].y + store->impulse[i].y) * inverse_mass;
+    store->centroid[i].x += dt * 0.5 * (old_velocity.x + velocity.x);
+    store->centroid[i].y += dt * 0.5 * (old_velocity.y + velocity.y);
+    store->velocity[i] = velocity;
+    store->impulse[i] = VEC_ZERO;
+    break;
+  }
+  case INTEGRATOR_SEMI_IMPLICIT_EULER:
+    velocity.x += dt * acceleration.x;
+    velocity.y += dt * acceleration.y;
+    store->centroid[i].x += dt * velocity.x;
+    store->centroid[i].y += dt * velocity.y;
+    store->velocity[i] = velocity;
+    break;
+  case INTEGRATOR_VELOCITY_VERLET:
+    if (stage == 0) {
+      // drift a whole step and kick half of one
+      store->centroid[i].x += dt * (velocity.x + 0.5 * dt * acceleration.x);
+      store->centroid[i].y += dt * (velocity.y + 0.5 * dt * acceleration.y);
+    }
+    store->velocity[i].x += 0.5 * dt * acceleration.x;
+    store->velocity[i].y += 0.5 * dt * acceleration.y;
+    break;
+  case INTEGRATOR_RK4: {
+    // stages 0 and 3 count once in the sums, 1 and 2 twice
+    double weight = stage == 0 || stage == 3 ? 1.0 : 2.0;
+    if (stage == 0) {
+      store->sum_velocity[i] = VEC_ZERO;
+      store->sum_acceleration[i] = VEC_ZERO;
+    }
+    store->sum_velocity[i].x += weight * velocity.x;
+    store->sum_velocity[i].y += weight * velocity.y;
+    store->sum_acceleration[i].x += weight * acceleration.x;
+    store->sum_acceleration[i].y += weight * acceleration.y;
+    if (stage == 3) {
+      vector_t sum_velocity = store->sum_velocity[i];
+      vector_t sum_acceleration = store->sum_acceleration[i];
+      store->centroid[i].x = start_centroid.x + dt / 6 * sum_velocity.x;
+      store->centroid[i].y = start_centroid.y + dt / 6 * sum_velocity.y;
+      store->velocity[i].x = start_velocity.x + dt / 6 * sum_acceleration.x;
+      store->velocity[i].y = start_velocity.y + dt / 6 * sum_acceleration.y;
+    } else {
+      // the next stage looks half way along the step, then the whole way
+      double step = stage == 2 ? dt : 0.5 * dt;
+      store->centroid[i].x = start_centroid.x + step * velocity.x;
+      store->centroid[i].y = start_centroid.y + step * velocity.y;
+      store->velocity[i].x = start_velocity.x + step * acceleration.x;
+      store->velocity[i].y = start_velocity.y + step * acceleration.y;
+    }
+    break;
+  }
+  }
+}
+
+/**
+ * Finishes a step of one slot: turns the body,
+ * points its velocity along its heading if it has a fixed speed,
+ * and resets its force.
+ */
+void store_end_step(body_store_t *store, size_t i, double dt) {
+  vector_t velocity = store->velocity[i];
+  double rotation = store->rotation[i] + dt * store->rotation_speed[i];
+  if (store->magnitude[i] != 0) {
+    velocity = vec_multiply(store->magnitude[i],
+                            (vector_t){cos(rotation), sin(rotation)});
+  }
+  if (store->align_to_velocity[i]) {
+    rotation = atan(velocity.y / velocity.x);
+  }
+  store->rotation[i] = rotation;
+  store->velocity[i] = velocity;
+
+  // resets impulse and force
+  store->force[i] = VEC_ZERO;
+  store->impulse[i] = VEC_ZERO;
+}
+
+/**
+ * Integrates a single slot over dt in its own substeps.
+ * The force on entry is held for the whole tick;
+ * if given, local adds the forces that depend on the body alone,
+ * and is called again for every stage of every substep.
+ */
+void store_step_slot(body_store_t *store, size_t i, integrator_t integrator,
+                     double dt, body_force_t local, void *aux) {
+  size_t substeps = store->substeps[i];
+  size_t stages = integrator_stages(integrator);
+  double step = dt / substeps;
+  vector_t held = store->force[i];
+  body_t *body = store->owners[i];
+  for (size_t substep = 0; substep < substeps; substep++) {
+    store_begin_step(store, i, integrator, substep == 0);
+    for (size_t stage = 0; stage < stages; stage++) {
+      store->force[i] = held;
+      if (local != NULL) {
+        local(body, aux);
+      }
+      store_stage(store, i, integrator, stage, step);
+    }
+    store_end_step(store, i, step);
+  }
+}
+
+/** Integrates a single slot over dt with the averaging scheme. */
+void store_integrate(body_store_t *store, size_t i, double dt) {
+  store_step_slot(store, i, INTEGRATOR_AVERAGE_VELOCITY, dt, NULL, NULL);
+}
+
+/**
+ * Checks whether a body is at the rotation a cache was built for.
+ * Aligning to a zero velocity gives a rotation of NAN, which must still
+ * match itself, or every read would rebuild the cache, and the threads of
+ * the narrow phase would write the same body's caches at once.
+ */
+bool same_rotation(double rotation, double cached) {
+  return rotation == cached || (isnan(rotation) && isnan(cached));
+}
+
+/**
+ * Rebuilds the body's world-space vertices from its local shape
+ * if the body has moved, rotated or been reshaped since they were last built.
+ */
+void body_update_world_shape(body_t *body) {
+  vector_t centroid = body->store->centroid[body->slot];
+  double rotation = body->store->rotation[body->slot];
+  if (!body->world_dirty && centroid.x == body->world_centroid.x &&
+      centroid.y == body->world_centroid.y &&
+      same_rotation(rotation, body->world_rotation)) {
+    return;
+  }
+  points_place(polygon_points(&body->world_shape),
+               polygon_points(&body->local_shape),
+               polygon_size(&body->local_shape), rotation, centroid);
+  body->world_centroid = centroid;
+  body->world_rotation = rotation;
+  body->world_dirty = false;
+}
+
+/**
+ * Recomputes the body's local shape from its world shape,
+ * treating the world shape as being at the body's current transform.
+ */
+void body_update_local_shape(body_t *body) {
+  vector_t centroid = body->store->centroid[body->slot];
+  double rotation = body->store->rotation[body->slot];
+  vector_t *world = polygon_points(&body->world_shape);
+  double cosine = cos(rotation);
+  double sine = sin(rotation);
+  polygon_clear(&body->local_shape);
+  for (size_t i = 0; i < polygon_size(&body->world_shape); i++) {
+    vector_t offset = vec_subtract(world[i], centroid);
+    polygon_add(&body->local_shape,
+                (vector_t){offset.x * cosine + offset.y * sine,
+                           -offset.x * sine + offset.y * cosine});
+  }
+  body->world_centroid = centroid;
+  body->world_rotation = rotation;
+  body->world_dirty = false;
+
+  if (polygon_size(&body->local_shape) > body->axes_capacity) {
+    body->axes_capacity = polygon_size(&body->local_shape);
+    free(body->local_axes);
+    free(body->world_axes);
+    body->local_axes = malloc(sizeof(vector_t) * body->axes_capacity);
+    body->world_axes = malloc(sizeof(vector_t) * body->axes_capacity);
+    assert(body->local_axes != NULL && body->world_axes != NULL);
+  }
+  if (body->shape_type == SHAPE_POLYGON) {
+    body->axis_count =
+        find_separating_axes(&body->local_shape, body->local_axes);
+  } else if (body->shape_type == SHAPE_CAPSULE) {
+    // the sides of a capsule are its only flat edges
+    vector_t side = vec_subtract(body->local_core[1], body->local_core[0]);
+    double length = sqrt(vec_dot(side, side));
+    body->local_axes[0] = (vector_t){-side.y / length, side.x / length};
+    body->axis_count = 1;
+  } else {
+    body->axis_count = 0;
+  }
+  // world_axes, rotated_bounds and rotated_core are rebuilt when next needed
+  body->axes_dirty = true;
+  body->bounds_dirty = true;
+  body->core_dirty = true;
+}
+
+void body_store_tick(body_store_t *store, double dt) {
+  for (size_t i = 0; i < store->size; i++) {
+    store_integrate(store, i, dt);
+  }
+}
+
+void body_store_hold_forces(body_store_t *store) {
+  for (size_t i = 0; i < store->size; i++) {
+    store->held_force[i] = store->force[i];
+  }
+}
+
+void body_store_restore_forces(body_store_t *store) {
+  for (size_t i = 0; i < store->size; i++) {
+    store->force[i] = store->held_force[i];
+  }
+}
+
+void body_store_step_substepped(body_store_t *store, integrator_t integrator,
+                                double dt, body_force_t local, void *aux) {
+  for (size_t i = 0; i < store->size; i++) {
+    if (store->substeps[i] > 1) {
+      store->force[i] = store->held_force[i];
+      store_step_slot(store, i, integrator, dt, local, aux);
+    }
+  }
+}
+
+void body_store_begin_step(body_store_t *store, integrator_t integrator,
+                           bool tick_start) {
+  for (size_t i = 0; i < store->size; i++) {
+    if (store->substeps[i] == 1) {
+      store_begin_step(store, i, integrator, tick_start);
+    }
+  }
+}
+
+void body_store_stage(body_store_t *store, integrator_t integrator,
+                      size_t stage, double dt) {
+  for (size_t i = 0; i < store->size; i++) {
+    if (store->substeps[i] == 1) {
+      store_stage(store, i, integrator, stage, dt);
+    }
+  }
+}
+
+void body_store_end_step(body_store_t *store, double dt) {
+  for (size_t i = 0; i < store->size; i++) {
+    if (store->substeps[i] == 1) {
+      store_end_step(store, i, dt);
+    } else {
+      // already integrated, but the stages re-applied forces to it
+      store->force[i] = VEC_ZERO;
+      store->impulse[i] = VEC_ZERO;
+    }
+  }
+}
+
+body_t *body_init(polygon_t shape, double mass, rgb_color_t color) {
   body_t *body = malloc(sizeof(body_t));
   assert(body != NULL);
-  body->shape = shape;
-  body->velocity = VEC_ZERO;
-  body->centroid = polygon_centroid(shape);
+  if (detached_store == NULL) {
+    detached_store = body_store_init(DETACHED_STORE_SIZE);
+  }
+  size_t slot = store_push(detached_store, body);
+  body->world_shape = shape;
+  body->local_shape = polygon_init(polygon_size(&shape));
+  body->local_axes = NULL;
+  body->world_axes = NULL;
+  body->axis_count = 0;
+  body->axes_capacity = 0;
+  body->shape_type = SHAPE_POLYGON;
+  body->radius = 0.0;
+  body->core_count = 0;
+  detached_store->centroid[slot] = polygon_centroid(&body->world_shape);
+  detached_store->previous_centroid[slot] = detached_store->centroid[slot];
+  detached_store->velocity[slot] = VEC_ZERO;
+  detached_store->force[slot] = VEC_ZERO;
+  detached_store->impulse[slot] = VEC_ZERO;
+  detached_store->mass[slot] = mass;
+  detached_store->rotation[slot] = 0.0;
+  detached_store->previous_rotation[slot] = 0.0;
+  detached_store->rotation_speed[slot] = 0.0;
+  detached_store->magnitude[slot] = 0.0;
+  detached_store->align_to_velocity[slot] = false;
+  detached_store->substeps[slot] = 1;
+  detached_store->held_force[slot] = VEC_ZERO;
+  body_update_local_shape(body);
   body->color = color;
-  body->rotation = 0.0;
-  body->rotation_speed = 0.0;
-  body->mass = mass;
-  body->force = VEC_ZERO;
-  body->impulse = VEC_ZERO;
   body->info = NULL;
-  body->magnitude = 0.0;
   body->freer = (free_func_t)free;
   body->is_removed = false;
+  body->is_static = false;
+  body->is_bullet = false;
+  body->collision_category = 0;
+  body->collision_mask = 0;
+  body->tags = 0;
+  body->proxy = 0;
+  body->force_links = NULL;
   body->time = INFINITY;
   body->health = 10.0;
   body->ai_mode = 0;
   body->ai_time = 0;
-  body->just_collided = false;
   body->image_path = NULL;
   return body;
 }
 
-body_t *body_init_with_info(list_t *shape, double mass, rgb_color_t color,
+body_t *body_init_with_info(polygon_t shape, double mass, rgb_color_t color,
                             void *info, free_func_t info_freer) {
   body_t *body = body_init(shape, mass, color);
-  if (mass == INFINITY) {
-    body->velocity = VEC_ZERO;
-  }
   body->info = info;
   body->freer = info_freer;
   if (info_freer == NULL) {
@@ -89,53 +641,273 @@ body_t *body_init_with_info(list_t *shape, double mass, rgb_color_t color,
   return body;
 }
 
+/**
+ * Builds the outline of the points within a radius of a segment,
+ * counterclockwise: a circle if the ends are the same point,
+ * otherwise two half circles joined by straight sides.
+ */
+polygon_t round_outline(vector_t start, vector_t end, double radius) {
+  polygon_t outline = polygon_init(ROUND_OUTLINE_POINTS + 2);
+  double step = 2 * M_PI / ROUND_OUTLINE_POINTS;
+  if (start.x == end.x && start.y == end.y) {
+    for (size_t i = 0; i < ROUND_OUTLINE_POINTS; i++) {
+      polygon_add(&outline, vec_add(start, (vector_t){radius * cos(i * step),
+                                                     radius * sin(i * step)}));
+    }
+    return outline;
+  }
+  vector_t side = vec_subtract(end, start);
+  double angle = atan2(side.y, side.x) - M_PI / 2;
+  // each cap includes both of its ends, which the straight sides join
+  for (size_t cap = 0; cap < 2; cap++) {
+    vector_t center = cap == 0 ? end : start;
+    for (size_t i = 0; i <= ROUND_OUTLINE_POINTS / 2; i++) {
+      double theta = angle + cap * M_PI + i * step;
+      polygon_add(&outline, vec_add(center, (vector_t){radius * cos(theta),
+                                                       radius * sin(theta)}));
+    }
+  }
+  return outline;
+}
+
+/** Initializes a circle or capsule whose core runs from start to end. */
+body_t *body_init_round(shape_type_t type, vector_t start, vector_t end,
+                        double radius, double mass, rgb_color_t color,
+                        void *info, free_func_t info_freer) {
+  assert(radius > 0);
+  body_t *body = body_init_with_info(round_outline(start, end, radius), mass,
+                                     color, info, info_freer);
+  vector_t center = vec_multiply(0.5, vec_add(start, end));
+  body->shape_type = type;
+  body->radius = radius;
+  body->local_core[0] = vec_subtract(start, center);
+  body->local_core[1] = vec_subtract(end, center);
+  body->core_count = type == SHAPE_CIRCLE ? 1 : 2;
+  // the outline's centroid is only the center up to rounding
+  body->store->centroid[body->slot] = center;
+  body->store->previous_centroid[body->slot] = center;
+  body_update_local_shape(body);
+  return body;
+}
+
+body_t *body_init_circle(vector_t center, double radius, double mass,
+                         rgb_color_t color, void *info,
+                         free_func_t info_freer) {
+  return body_init_round(SHAPE_CIRCLE, center, center, radius, mass, color,
+                         info, info_freer);
+}
+
+body_t *body_init_capsule(vector_t start, vector_t end, double radius,
+                          double mass, rgb_color_t color, void *info,
+                          free_func_t info_freer) {
+  assert(start.x != end.x || start.y != end.y);
+  return body_init_round(SHAPE_CAPSULE, start, end, radius, mass, color, info,
+                         info_freer);
+}
+
 void body_free(body_t *body) {
-  list_free(body->shape);
+  store_release(body->store, body->slot);
+  polygon_free(&body->local_shape);
+  polygon_free(&body->world_shape);
+  free(body->local_axes);
+  free(body->world_axes);
   body->freer(body->info);
   free(body);
 }
 
-list_t *body_get_shape(body_t *body) {
-  list_t *lst = list_init(list_size(body->shape), &free);
-  for (size_t i = 0; i < list_size(body->shape); i++) {
-    vector_t *elem = list_get(body->shape, i);
-    vector_t *elem_copy = malloc(sizeof(vector_t));
-    elem_copy->x = elem->x;
-    elem_copy->y = elem->y;
-    list_add(lst, elem_copy);
+polygon_t body_get_shape(body_t *body) {
+  return polygon_copy(body_peek_shape(body));
+}
+
+const polygon_t *body_peek_shape(body_t *body) {
+  body_update_world_shape(body);
+  return &body->world_shape;
+}
+
+const vector_t *body_peek_axes(body_t *body, size_t *count) {
+  double rotation = body->store->rotation[body->slot];
+  if (body->axes_dirty || !same_rotation(rotation, body->axes_rotation)) {
+    double cosine = cos(rotation);
+    double sine = sin(rotation);
+    for (size_t i = 0; i < body->axis_count; i++) {
+      vector_t axis = body->local_axes[i];
+      body->world_axes[i] = (vector_t){axis.x * cosine - axis.y * sine,
+                                       axis.x * sine + axis.y * cosine};
+    }
+    body->axes_rotation = rotation;
+    body->axes_dirty = false;
   }
-  return lst;
+  *count = body->axis_count;
+  return body->world_axes;
 }
 
-vector_t body_get_centroid(body_t *body) { return body->centroid; }
+shape_type_t body_get_shape_type(body_t *body) { return body->shape_type; }
 
-double body_get_rotation(body_t *body) { return body->rotation; }
+double body_get_radius(body_t *body) { return body->radius; }
 
-vector_t body_get_velocity(body_t *body) { return body->velocity; }
+const vector_t *body_peek_core(body_t *body, size_t *count) {
+  if (body->shape_type == SHAPE_POLYGON) {
+    const polygon_t *shape = body_peek_shape(body);
+    *count = polygon_size(shape);
+    return polygon_points(shape);
+  }
+  double rotation = body->store->rotation[body->slot];
+  vector_t centroid = body->store->centroid[body->slot];
+  // only written when the body has moved, so bodies that are up to date
+  // can be read from several threads at once
+  if (body->core_dirty || !same_rotation(rotation, body->core_rotation) ||
+      centroid.x != body->core_centroid.x ||
+      centroid.y != body->core_centroid.y) {
+    points_place(body->rotated_core, body->local_core, body->core_count,
+                 rotation, VEC_ZERO);
+    body->core_rotation = rotation;
+    body->core_dirty = false;
+    for (size_t i = 0; i < body->core_count; i++) {
+      body->world_core[i] = vec_add(body->rotated_core[i], centroid);
+    }
+    body->core_centroid = centroid;
+  }
+  *count = body->core_count;
+  return body->world_core;
+}
 
-vector_t body_get_force(body_t *body) { return body->force; }
+aabb_t body_get_bounds(body_t *body) {
+  double rotation = body->store->rotation[body->slot];
+  if (body->bounds_dirty || !same_rotation(rotation, body->bounds_rotation)) {
+    vector_t *local = body->local_core;
+    size_t count = body->core_count;
+    if (body->shape_type == SHAPE_POLYGON) {
+      local = polygon_points(&body->local_shape);
+      count = polygon_size(&body->local_shape);
+    }
+    double cosine = cos(rotation);
+    double sine = sin(rotation);
+    aabb_t bounds = {{INFINITY, INFINITY}, {-INFINITY, -INFINITY}};
+    for (size_t i = 0; i < count; i++) {
+      double x = local[i].x * cosine - local[i].y * sine;
+      double y = local[i].x * sine + local[i].y * cosine;
+      bounds.min = (vector_t){fmin(bounds.min.x, x), fmin(bounds.min.y, y)};
+      bounds.max = (vector_t){fmax(bounds.max.x, x), fmax(bounds.max.y, y)};
+    }
+    vector_t grow = {body->radius, body->radius};
+    bounds.min = vec_subtract(bounds.min, grow);
+    bounds.max = vec_add(bounds.max, grow);
+    body->rotated_bounds = bounds;
+    body->bounds_rotation = rotation;
+    body->bounds_dirty = false;
+  }
+  vector_t centroid = body->store->centroid[body->slot];
+  return (aabb_t){vec_add(body->rotated_bounds.min, centroid),
+                  vec_add(body->rotated_bounds.max, centroid)};
+}
 
-vector_t body_get_impulse(body_t *body) { return body->impulse; }
+aabb_t body_get_swept_bounds(body_t *body) {
+  aabb_t bounds = body_get_bounds(body);
+  vector_t back = vec_subtract(body->store->previous_centroid[body->slot],
+                               body->store->centroid[body->slot]);
+  bounds.min = (vector_t){fmin(bounds.min.x, bounds.min.x + back.x),
+                          fmin(bounds.min.y, bounds.min.y + back.y)};
+  bounds.max = (vector_t){fmax(bounds.max.x, bounds.max.x + back.x),
+                          fmax(bounds.max.y, bounds.max.y + back.y)};
+  return bounds;
+}
+
+vector_t body_get_centroid(body_t *body) {
+  return body->store->centroid[body->slot];
+}
+
+double body_get_rotation(body_t *body) {
+  return body->store->rotation[body->slot];
+}
+
+vector_t body_get_velocity(body_t *body) {
+  return body->store->velocity[body->slot];
+}
+
+vector_t body_get_force(body_t *body) { return body->store->force[body->slot]; }
+
+vector_t body_get_impulse(body_t *body) {
+  return body->store->impulse[body->slot];
+}
 
 double body_get_time(body_t *body) { return body->time; }
 
 double body_get_health(body_t *body) { return body->health; }
 
-double body_get_magnitude(body_t *body) { return body->magnitude; };
+double body_get_magnitude(body_t *body) {
+  return body->store->magnitude[body->slot];
+}
 
 size_t body_get_ai_mode(body_t *body) { return body->ai_mode; }
 
 double body_get_ai_time(body_t *body) { return body->ai_time; }
 
-bool body_get_just_collided(body_t *body) { return body->just_collided; }
-
 void *body_get_info(body_t *body) { return body->info; }
 
+size_t body_get_type(body_t *body) {
+  assert(body->info != NULL);
+  return *(size_t *)body->info;
+}
+
+void body_set_collision_layers(body_t *body, size_t category, size_t mask) {
+  body->collision_category = category;
+  body->collision_mask = mask;
+}
+
+size_t body_get_collision_category(body_t *body) {
+  return body->collision_category;
+}
+
+size_t body_get_collision_mask(body_t *body) { return body->collision_mask; }
+
+void body_set_tags(body_t *body, size_t tags) { body->tags = tags; }
+
+size_t body_get_tags(body_t *body) { return body->tags; }
+
 rgb_color_t body_get_color(body_t *body) { return body->color; }
 
 void body_set_centroid(body_t *body, vector_t x) {
-  polygon_translate(body->shape, vec_subtract(x, body->centroid));
-  body->centroid = x;
+  body->store->centroid[body->slot] = x;
+  // a teleport is not a sweep
+  body->store->previous_centroid[body->slot] = x;
+}
+
+vector_t body_get_previous_centroid(body_t *body) {
+  return body->store->previous_centroid[body->slot];
+}
+
+vector_t body_get_interpolated_centroid(body_t *body, double alpha) {
+  vector_t previous = body->store->previous_centroid[body->slot];
+  vector_t centroid = body->store->centroid[body->slot];
+  return (vector_t){previous.x + alpha * (centroid.x - previous.x),
+                    previous.y + alpha * (centroid.y - previous.y)};
+}
+
+double body_get_interpolated_rotation(body_t *body, double alpha) {
+  double previous = body->store->previous_rotation[body->slot];
+  double turn = body->store->rotation[body->slot] - previous;
+  // turn the short way round, e.g. when aligning to velocity flips the angle
+  turn = remainder(turn, 2 * M_PI);
+  return previous + alpha * turn;
+}
+
+void body_get_interpolated_shape(body_t *body, double alpha,
+                                 polygon_t *shape) {
+  size_t count = polygon_size(&body->local_shape);
+  polygon_clear(shape);
+  for (size_t i = 0; i < count; i++) {
+    polygon_add(shape, VEC_ZERO);
+  }
+  points_place(polygon_points(shape), polygon_points(&body->local_shape),
+               count, body_get_interpolated_rotation(body, alpha),
+               body_get_interpolated_centroid(body, alpha));
+}
+
+void body_rewind(body_t *body, double time) {
+  vector_t previous = body->store->previous_centroid[body->slot];
+  vector_t centroid = body->store->centroid[body->slot];
+  body->store->centroid[body->slot] =
+      vec_add(previous, vec_multiply(time, vec_subtract(centroid, previous)));
 }
 
 void body_set_graphic(body_t *body, graphic_t *graphic) {
@@ -143,97 +915,98 @@ void body_set_graphic(body_t *body, graphic_t *graphic) {
 }
 
 void body_set_magnitude(body_t *body, double magnitude) {
-  body->magnitude = magnitude;
+  body->store->magnitude[body->slot] = magnitude;
 }
 
-void body_set_force(body_t *body, vector_t v) { body->force = v; }
+void body_set_force(body_t *body, vector_t v) {
+  body->store->force[body->slot] = v;
+}
 
-void body_set_shape(body_t *body, list_t *shape) { body->shape = shape; }
+void body_set_shape(body_t *body, polygon_t shape) {
+  polygon_free(&body->world_shape);
+  body->world_shape = shape;
+  body->shape_type = SHAPE_POLYGON;
+  body->radius = 0.0;
+  body->core_count = 0;
+  body_update_local_shape(body);
+}
 
 void body_set_health(body_t *body, double health) { body->health = health; }
 
-void body_set_impulse(body_t *body, vector_t v) { body->impulse = v; }
+void body_set_impulse(body_t *body, vector_t v) {
+  body->store->impulse[body->slot] = v;
+}
 
 void body_set_ai_time(body_t *body, double time) { body->ai_time = time; }
 
-void body_set_velocity(body_t *body, vector_t v) { body->velocity = v; }
+void body_set_velocity(body_t *body, vector_t v) {
+  body->store->velocity[body->slot] = v;
+}
 
 void body_set_time(body_t *body, double time) { body->time = time; }
 
-void body_set_just_collided(body_t *body, bool just_collided) {
-  body->just_collided = just_collided;
-}
-
 void body_set_rotation_speed(body_t *body, double w) {
-  body->rotation_speed = w;
+  body->store->rotation_speed[body->slot] = w;
 }
 
 void body_set_rotation(body_t *body, double angle) {
-  polygon_rotate(body->shape, -1 * body->rotation, body->centroid);
-  polygon_rotate(body->shape, angle, body->centroid);
-  body->rotation = angle;
+  body->store->rotation[body->slot] = angle;
+  body->store->previous_rotation[body->slot] = angle;
 }
 
 void body_set_rotation_empty(body_t *body, double rotation) {
-  body->rotation = rotation;
+  body_update_world_shape(body);
+  // keep the core where it is in the world, like the outline
+  points_rotate(body->local_core, body->core_count,
+                body->store->rotation[body->slot] - rotation, VEC_ZERO);
+  body->store->rotation[body->slot] = rotation;
+  body->store->previous_rotation[body->slot] = rotation;
+  body_update_local_shape(body);
+}
+
+void body_set_align_to_velocity(body_t *body, bool align) {
+  body->store->align_to_velocity[body->slot] = align;
 }
 
 void body_set_ai_mode(body_t *body, size_t mode) { body->ai_mode = mode; };
 
 void body_combine_mass(body_t *body1, body_t *body2) {
-  body1->mass = body1->mass + body2->mass;
+  body1->store->mass[body1->slot] += body2->store->mass[body2->slot];
 }
 
 void body_tick(body_t *body, double dt) {
-  // get acceleration
-  vector_t old_velocity = body_get_velocity(body);
-  vector_t acceleration =
-      vec_multiply(1.0 / body_get_mass(body), body_get_force(body));
-  vector_t changed_velocity =
-      vec_add(body->velocity, vec_multiply(dt, acceleration));
-  body->velocity = changed_velocity;
-  // get velocity
-  vector_t impulse =
-      vec_multiply(1.0 / body_get_mass(body), body_get_impulse(body));
-  vector_t changed_velocity2 = vec_add(body->velocity, impulse);
-  body->velocity = changed_velocity2;
-
-  // average velocity
-  vector_t added = vec_add(old_velocity, body->velocity);
-  vector_t average = vec_multiply(0.5, added);
-
-  // vector_t translation = {dt * (body->velocity.x), dt * (body->velocity.y)};
-  vector_t translation = {dt * (average.x), dt * (average.y)};
-  polygon_translate(body->shape, translation);
-  body->centroid = polygon_centroid(body->shape);
-
-  double change_in_rotation = dt * body->rotation_speed;
-  body_set_rotation(body, body->rotation + change_in_rotation);
-  if (body->magnitude != 0) {
-    body->velocity =
-        vec_multiply(body->magnitude, (vector_t){cos(body_get_rotation(body)),
-                                                 sin(body_get_rotation(body))});
-  }
-
-  if (*(size_t *)body_get_info(body) == BULLET_TYPE ||
-      *(size_t *)body_get_info(body) == SNIPER_BULLET_TYPE ||
-      *(size_t *)body_get_info(body) == GATLING_BULLET_TYPE || 
-      *(size_t *)body_get_info(body) == GRAVITY_BULLET_TYPE) {
-    double angle = atan(body->velocity.y / body->velocity.x);
-    body_set_rotation(body, angle);
-  }
+  store_integrate(body->store, body->slot, dt);
+}
 
-  // resets impulse and force
-  body_set_force(body, VEC_ZERO);
-  body_set_impulse(body, VEC_ZERO);
+void body_tick_with(body_t *body, integrator_t integrator, double dt,
+                    body_force_t local, void *aux) {
+  store_step_slot(body->store, body->slot, integrator, dt, local, aux);
+}
+
+void body_set_substeps(body_t *body, size_t substeps) {
+  assert(substeps > 0);
+  body->store->substeps[body->slot] = substeps;
+}
+
+size_t body_get_substeps(body_t *body) {
+  return body->store->substeps[body->slot];
 }
 
 void body_add_force(body_t *body, vector_t force) {
-  body->force = vec_add(body->force, force);
+  if (body->is_static) {
+    return;
+  }
+  vector_t *total = &body->store->force[body->slot];
+  total->x += force.x;
+  total->y += force.y;
 }
 
 void body_add_impulse(body_t *body, vector_t impulse) {
-  body->impulse = vec_add(body->impulse, impulse);
+  if (body->is_static) {
+    return;
+  }
+  vector_t *total = &body->store->impulse[body->slot];
+  *total = vec_add(*total, impulse);
 }
 
 double body_get_distance(vector_t body1_centroid, vector_t body2_centroid) {
@@ -241,7 +1014,7 @@ double body_get_distance(vector_t body1_centroid, vector_t body2_centroid) {
                       pow(body1_centroid.y - body2_centroid.y, 2));
 }
 
-double body_get_mass(body_t *body) { return body->mass; }
+double body_get_mass(body_t *body) { return body->store->mass[body->slot]; }
 
 void body_remove(body_t *body) {
   if (body->is_removed == false) {
@@ -251,6 +1024,55 @@ void body_remove(body_t *body) {
 
 bool body_is_removed(body_t *body) { return body->is_removed; }
 
+void body_link_force(body_t *body, force_link_t *link) {
+  link->prev = NULL;
+  link->next = body->force_links;
+  if (body->force_links != NULL) {
+    body->force_links->prev = link;
+  }
+  body->force_links = link;
+}
+
+void body_unlink_force(body_t *body, force_link_t *link) {
+  if (link->prev != NULL) {
+    link->prev->next = link->next;
+  } else {
+    body->force_links = link->next;
+  }
+  if (link->next != NULL) {
+    link->next->prev = link->prev;
+  }
+  link->prev = NULL;
+  link->next = NULL;
+}
+
+void body_move_force_link(body_t *body, force_link_t *link) {
+  if (link->prev != NULL) {
+    link->prev->next = link;
+  } else {
+    body->force_links = link;
+  }
+  if (link->next != NULL) {
+    link->next->prev = link;
+  }
+}
+
+force_link_t *body_get_force_links(body_t *body) { return body->force_links; }
+
+void body_set_static(body_t *body) { body->is_static = true; }
+
+bool body_is_static(body_t *body) { return body->is_static; }
+
+void body_set_proxy(body_t *body, size_t proxy) { body->proxy = proxy; }
+
+size_t body_get_proxy(body_t *body) { return body->proxy; }
+
+void body_set_bullet(body_t *body, bool is_bullet) {
+  body->is_bullet = is_bullet;
+}
+
+bool body_is_bullet(body_t *body) { return body->is_bullet; }
+
 void body_set_image_path(body_t *body, char *image_path) {
   body->image_path = image_path;
 }
@@ -262,31 +1084,16 @@ body_t *init_default_tank(vector_t center, double side_length,
                           vector_t velocity, double mass, rgb_color_t color,
                           double max_health, size_t tank_type) {
 
-  list_t *tank_points = list_init(4, (free_func_t)free);
+  polygon_t tank_points = polygon_init(4);
   // creates the points for the tank
-  vector_t *point1 = malloc(sizeof(vector_t));
-  assert(point1 != NULL);
-  point1->x = center.x + side_length / 2;
-  point1->y = center.y + side_length / 2;
-
-  list_add(tank_points, point1);
-  vector_t *point2 = malloc(sizeof(vector_t));
-  assert(point2 != NULL);
-  point2->x = center.x - side_length / 2;
-  point2->y = center.y + side_length / 2;
-
-  list_add(tank_points, point2);
-  vector_t *point3 = malloc(sizeof(vector_t));
-  assert(point3 != NULL);
-  point3->x = center.x - side_length / 2;
-  point3->y = center.y - side_length / 2;
-
-  list_add(tank_points, point3);
-  vector_t *point4 = malloc(sizeof(vector_t));
-  assert(point4 != NULL);
-  point4->x = center.x + side_length / 2;
-  point4->y = center.y - side_length / 2;
-  list_add(tank_points, point4);
+  polygon_add(&tank_points, (vector_t){center.x + side_length / 2,
+                                       center.y + side_length / 2});
+  polygon_add(&tank_points, (vector_t){center.x - side_length / 2,
+                                       center.y + side_length / 2});
+  polygon_add(&tank_points, (vector_t){center.x - side_length / 2,
+                                       center.y - side_length / 2});
+  polygon_add(&tank_points, (vector_t){center.x + side_length / 2,
+                                       center.y - side_length / 2});
 
   size_t *type = malloc(sizeof(size_t));
   *type = tank_type;
@@ -294,6 +1101,8 @@ body_t *init_default_tank(vector_t center, double side_length,
       body_init_with_info(tank_points, mass, color, type, (free_func_t)free);
   assert(tank != NULL);
   tank->health = max_health;
+  body_set_collision_layers(tank, TANK_LAYER,
+                            TANK_LAYER | BULLET_LAYER | OBSTACLE_LAYER);
   body_set_image_path(tank, DEFAULT_IMAGE_PATH);
   return tank;
 }
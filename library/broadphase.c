@@ -0,0 +1,161 @@
+#include "broadphase.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+const size_t BROADPHASE_INITIAL_SIZE = 64;
+const size_t BROADPHASE_GROW_FACTOR = 2;
+
+typedef struct broadphase {
+  vector_t min;
+  double cell_size;
+  size_t columns;
+  size_t rows;
+  // cell_start[c] is where cell c's entries begin in entries;
+  // it has one extra element so cell c ends at cell_start[c + 1]
+  size_t *cell_start;
+  // the indices of the boxes touching each cell, grouped by cell
+  size_t *entries;
+  size_t entries_capacity;
+  index_pair_t *pairs;
+  size_t pairs_capacity;
+} broadphase_t;
+
+broadphase_t *broadphase_init(vector_t min, vector_t max, double cell_size) {
+  assert(max.x > min.x && max.y > min.y);
+  assert(cell_size > 0);
+  broadphase_t *grid = malloc(sizeof(broadphase_t));
+  assert(grid != NULL);
+  grid->min = min;
+  grid->cell_size = cell_size;
+  grid->columns = (size_t)ceil((max.x - min.x) / cell_size);
+  grid->rows = (size_t)ceil((max.y - min.y) / cell_size);
+  grid->cell_start = malloc(sizeof(size_t) * (grid->columns * grid->rows + 1));
+  grid->entries_capacity = BROADPHASE_INITIAL_SIZE;
+  grid->entries = malloc(sizeof(size_t) * grid->entries_capacity);
+  grid->pairs_capacity = BROADPHASE_INITIAL_SIZE;
+  grid->pairs = malloc(sizeof(index_pair_t) * grid->pairs_capacity);
+  assert(grid->cell_start != NULL && grid->entries != NULL &&
+         grid->pairs != NULL);
+  return grid;
+}
+
+void broadphase_free(broadphase_t *grid) {
+  free(grid->cell_start);
+  free(grid->entries);
+  free(grid->pairs);
+  free(grid);
+}
+
+/** Gets the column containing an x coordinate, clamped to the grid. */
+size_t grid_column(broadphase_t *grid, double x) {
+  double column = floor((x - grid->min.x) / grid->cell_size);
+  if (column < 0) {
+    return 0;
+  }
+  if (column >= grid->columns) {
+    return grid->columns - 1;
+  }
+  return (size_t)column;
+}
+
+/** Gets the row containing a y coordinate, clamped to the grid. */
+size_t grid_row(broadphase_t *grid, double y) {
+  double row = floor((y - grid->min.y) / grid->cell_size);
+  if (row < 0) {
+    return 0;
+  }
+  if (row >= grid->rows) {
+    return grid->rows - 1;
+  }
+  return (size_t)row;
+}
+
+void grid_add_pair(broadphase_t *grid, size_t count, size_t first,
+                   size_t second) {
+  if (count >= grid->pairs_capacity) {
+    grid->pairs_capacity *= BROADPHASE_GROW_FACTOR;
+    grid->pairs =
+        realloc(grid->pairs, sizeof(index_pair_t) * grid->pairs_capacity);
+    assert(grid->pairs != NULL);
+  }
+  grid->pairs[count] = (index_pair_t){first, second};
+}
+
+size_t broadphase_find_pairs(broadphase_t *grid, const aabb_t *bounds,
+                             size_t count, index_pair_t **pairs) {
+  size_t cells = grid->columns * grid->rows;
+  size_t *cell_start = grid->cell_start;
+
+  // count the boxes touching each cell, storing the counts one cell ahead
+  memset(cell_start, 0, sizeof(size_t) * (cells + 1));
+  size_t total = 0;
+  for (size_t i = 0; i < count; i++) {
+    size_t min_column = grid_column(grid, bounds[i].min.x);
+    size_t max_column = grid_column(grid, bounds[i].max.x);
+    size_t min_row = grid_row(grid, bounds[i].min.y);
+    size_t max_row = grid_row(grid, bounds[i].max.y);
+    for (size_t row = min_row; row <= max_row; row++) {
+      for (size_t column = min_column; column <= max_column; column++) {
+        cell_start[row * grid->columns + column + 1]++;
+      }
+    }
+    total += (max_row - min_row + 1) * (max_column - min_column + 1);
+  }
+  for (size_t c = 0; c < cells; c++) {
+    cell_start[c + 1] += cell_start[c];
+  }
+  if (total > grid->entries_capacity) {
+    while (total > grid->entries_capacity) {
+      grid->entries_capacity *= BROADPHASE_GROW_FACTOR;
+    }
+    free(grid->entries);
+    grid->entries = malloc(sizeof(size_t) * grid->entries_capacity);
+    assert(grid->entries != NULL);
+  }
+
+  // fill in the entries, using cell_start as the insertion points,
+  // which leaves cell_start[c + 1] at the start of cell c + 1 when done
+  for (size_t i = 0; i < count; i++) {
+    size_t min_column = grid_column(grid, bounds[i].min.x);
+    size_t max_column = grid_column(grid, bounds[i].max.x);
+    size_t min_row = grid_row(grid, bounds[i].min.y);
+    size_t max_row = grid_row(grid, bounds[i].max.y);
+    for (size_t row = min_row; row <= max_row; row++) {
+      for (size_t column = min_column; column <= max_column; column++) {
+        grid->entries[cell_start[row * grid->columns + column]++] = i;
+      }
+    }
+  }
+  // shift the starts back by one cell to undo the insertion offsets
+  memmove(cell_start + 1, cell_start, sizeof(size_t) * cells);
+  cell_start[0] = 0;
+
+  size_t pair_count = 0;
+  for (size_t row = 0; row < grid->rows; row++) {
+    for (size_t column = 0; column < grid->columns; column++) {
+      size_t cell = row * grid->columns + column;
+      for (size_t a = cell_start[cell]; a < cell_start[cell + 1]; a++) {
+        for (size_t b = a + 1; b < cell_start[cell + 1]; b++) {
+          size_t i = grid->entries[a];
+          size_t j = grid->entries[b];
+          if (!aabb_overlaps(bounds[i], bounds[j])) {
+            continue;
+          }
+          // boxes sharing several cells are only reported from the cell
+          // holding the lower-left corner of their overlap
+          if (grid_column(grid, fmax(bounds[i].min.x, bounds[j].min.x)) !=
+                  column ||
+              grid_row(grid, fmax(bounds[i].min.y, bounds[j].min.y)) != row) {
+            continue;
+          }
+          grid_add_pair(grid, pair_count, i < j ? i : j, i < j ? j : i);
+          pair_count++;
+        }
+      }
+    }
+  }
+  *pairs = grid->pairs;
+  return pair_count;
+}
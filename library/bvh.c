@@ -0,0 +1,264 @@
+#include "bvh.h"
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+// the deepest a query can go; median splits keep trees far shallower
+#define BVH_STACK_SIZE 64
+
+const size_t BVH_LEAF_SIZE = 4;
+const size_t BVH_INITIAL_SIZE = 16;
+const size_t BVH_GROW_FACTOR = 2;
+
+typedef struct bvh_node {
+  aabb_t bounds;
+  // for a leaf, the first of its count items;
+  // otherwise count is 0 and the children are nodes first and first + 1
+  size_t first;
+  size_t count;
+} bvh_node_t;
+
+typedef struct bvh {
+  bvh_node_t *nodes;
+  size_t node_count;
+  size_t nodes_capacity;
+  // the indices of the stored boxes, grouped by leaf
+  size_t *items;
+  // a copy of the stored boxes, by index
+  aabb_t *bounds;
+  size_t items_capacity;
+  size_t *hits;
+  size_t hits_capacity;
+} bvh_t;
+
+bvh_t *bvh_init(void) {
+  bvh_t *tree = malloc(sizeof(bvh_t));
+  assert(tree != NULL);
+  tree->node_count = 0;
+  tree->nodes_capacity = BVH_INITIAL_SIZE;
+  tree->nodes = malloc(sizeof(bvh_node_t) * tree->nodes_capacity);
+  tree->items_capacity = BVH_INITIAL_SIZE;
+  tree->items = malloc(sizeof(size_t) * tree->items_capacity);
+  tree->bounds = malloc(sizeof(aabb_t) * tree->items_capacity);
+  tree->hits_capacity = BVH_INITIAL_SIZE;
+  tree->hits = malloc(sizeof(size_t) * tree->hits_capacity);
+  assert(tree->nodes != NULL && tree->items != NULL && tree->bounds != NULL &&
+         tree->hits != NULL);
+  return tree;
+}
+
+void bvh_free(bvh_t *tree) {
+  free(tree->nodes);
+  free(tree->items);
+  free(tree->bounds);
+  free(tree->hits);
+  free(tree);
+}
+
+/** Gets twice the center of a box along one axis, for ordering boxes. */
+double box_center(aabb_t box, bool vertical) {
+  return vertical ? box.min.y + box.max.y : box.min.x + box.max.x;
+}
+
+void swap_items(size_t *items, size_t i, size_t j) {
+  size_t temp = items[i];
+  items[i] = items[j];
+  items[j] = temp;
+}
+
+/**
+ * Reorders items[start, end) so items[nth] is the box that would be there
+ * if they were sorted by center, with smaller centers before it
+ * and larger ones after.
+ */
+void select_nth(size_t *items, const aabb_t *bounds, size_t start, size_t end,
+                size_t nth, bool vertical) {
+  while (end - start > 1) {
+    double pivot =
+        box_center(bounds[items[start + (end - start) / 2]], vertical);
+    // partition into [start, less) < pivot, [less, greater) == pivot,
+    // and [greater, end) > pivot
+    size_t less = start;
+    size_t greater = end;
+    size_t i = start;
+    while (i < greater) {
+      double center = box_center(bounds[items[i]], vertical);
+      if (center < pivot) {
+        swap_items(items, less++, i++);
+      } else if (center > pivot) {
+        swap_items(items, i, --greater);
+      } else {
+        i++;
+      }
+    }
+    if (nth < less) {
+      end = less;
+    } else if (nth >= greater) {
+      start = greater;
+    } else {
+      return;
+    }
+  }
+}
+
+void build_node(bvh_t *tree, const aabb_t *bounds, size_t node, size_t first,
+                size_t count) {
+  aabb_t box = bounds[tree->items[first]];
+  for (size_t i = first + 1; i < first + count; i++) {
+    aabb_t item = bounds[tree->items[i]];
+    box.min = (vector_t){fmin(box.min.x, item.min.x),
+                         fmin(box.min.y, item.min.y)};
+    box.max = (vector_t){fmax(box.max.x, item.max.x),
+                         fmax(box.max.y, item.max.y)};
+  }
+  tree->nodes[node].bounds = box;
+  if (count <= BVH_LEAF_SIZE) {
+    tree->nodes[node].first = first;
+    tree->nodes[node].count = count;
+    return;
+  }
+
+  // split the items in half along the longer side of the box
+  bool vertical = box.max.y - box.min.y > box.max.x - box.min.x;
+  size_t half = count / 2;
+  select_nth(tree->items, bounds, first, first + count, first + half,
+             vertical);
+  size_t left = tree->node_count;
+  tree->node_count += 2;
+  tree->nodes[node].first = left;
+  tree->nodes[node].count = 0;
+  build_node(tree, bounds, left, first, half);
+  build_node(tree, bounds, left + 1, first + half, count - half);
+}
+
+void bvh_build(bvh_t *tree, const aabb_t *bounds, size_t count) {
+  tree->node_count = 0;
+  if (count == 0) {
+    return;
+  }
+  // a binary tree with count leaves or fewer has under 2 * count nodes
+  if (2 * count > tree->nodes_capacity) {
+    while (2 * count > tree->nodes_capacity) {
+      tree->nodes_capacity *= BVH_GROW_FACTOR;
+    }
+    free(tree->nodes);
+    tree->nodes = malloc(sizeof(bvh_node_t) * tree->nodes_capacity);
+    assert(tree->nodes != NULL);
+  }
+  if (count > tree->items_capacity) {
+    while (count > tree->items_capacity) {
+      tree->items_capacity *= BVH_GROW_FACTOR;
+    }
+    free(tree->items);
+    free(tree->bounds);
+    tree->items = malloc(sizeof(size_t) * tree->items_capacity);
+    tree->bounds = malloc(sizeof(aabb_t) * tree->items_capacity);
+    assert(tree->items != NULL && tree->bounds != NULL);
+  }
+  for (size_t i = 0; i < count; i++) {
+    tree->items[i] = i;
+    tree->bounds[i] = bounds[i];
+  }
+  tree->node_count = 1;
+  build_node(tree, tree->bounds, 0, 0, count);
+}
+
+void add_hit(bvh_t *tree, size_t hit_count, size_t item) {
+  if (hit_count >= tree->hits_capacity) {
+    tree->hits_capacity *= BVH_GROW_FACTOR;
+    tree->hits = realloc(tree->hits, sizeof(size_t) * tree->hits_capacity);
+    assert(tree->hits != NULL);
+  }
+  tree->hits[hit_count] = item;
+}
+
+size_t bvh_query(bvh_t *tree, aabb_t box, size_t **hits) {
+  size_t hit_count = 0;
+  size_t stack[BVH_STACK_SIZE];
+  size_t depth = 0;
+  if (tree->node_count > 0) {
+    stack[depth++] = 0;
+  }
+  while (depth > 0) {
+    bvh_node_t *node = &tree->nodes[stack[--depth]];
+    if (!aabb_overlaps(node->bounds, box)) {
+      continue;
+    }
+    if (node->count == 0) {
+      assert(depth + 2 <= BVH_STACK_SIZE);
+      stack[depth++] = node->first;
+      stack[depth++] = node->first + 1;
+      continue;
+    }
+    for (size_t i = node->first; i < node->first + node->count; i++) {
+      size_t item = tree->items[i];
+      if (aabb_overlaps(tree->bounds[item], box)) {
+        add_hit(tree, hit_count, item);
+        hit_count++;
+      }
+    }
+  }
+  *hits = tree->hits;
+  return hit_count;
+}
+
+double bvh_cast_ray(bvh_t *tree, vector_t origin, vector_t direction,
+                    double max_distance, bvh_ray_visitor_t visitor, void *aux) {
+  // each node is kept with where the ray enters it,
+  // so it can be skipped if something nearer is found before it is popped
+  size_t stack[BVH_STACK_SIZE];
+  double entries[BVH_STACK_SIZE];
+  size_t depth = 0;
+  vector_t inverse = {1 / direction.x, 1 / direction.y};
+  if (tree->node_count > 0) {
+    double entry = aabb_ray_distance(tree->nodes[0].bounds, origin, inverse,
+                                     max_distance);
+    if (entry <= max_distance) {
+      stack[depth] = 0;
+      entries[depth++] = entry;
+    }
+  }
+  while (depth > 0) {
+    depth--;
+    if (entries[depth] > max_distance) {
+      continue;
+    }
+    bvh_node_t *node = &tree->nodes[stack[depth]];
+    if (node->count > 0) {
+      for (size_t i = node->first; i < node->first + node->count; i++) {
+        size_t item = tree->items[i];
+        if (aabb_ray_distance(tree->bounds[item], origin, inverse,
+                              max_distance) <= max_distance) {
+          max_distance = visitor(item, max_distance, aux);
+        }
+      }
+      continue;
+    }
+    size_t near = node->first;
+    size_t far = node->first + 1;
+    double near_entry = aabb_ray_distance(tree->nodes[near].bounds, origin,
+                                          inverse, max_distance);
+    double far_entry = aabb_ray_distance(tree->nodes[far].bounds, origin,
+                                         inverse, max_distance);
+    if (far_entry < near_entry) {
+      size_t temp = near;
+      near = far;
+      far = temp;
+      double temp_entry = near_entry;
+      near_entry = far_entry;
+      far_entry = temp_entry;
+    }
+    // the nearer child goes on top, so it is visited first
+    assert(depth + 2 <= BVH_STACK_SIZE);
+    if (far_entry <= max_distance) {
+      stack[depth] = far;
+      entries[depth++] = far_entry;
+    }
+    if (near_entry <= max_distance) {
+      stack[depth] = near;
+      entries[depth++] = near_entry;
+    }
+  }
+  return max_distance;
+}
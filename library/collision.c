@@ -1,92 +1,624 @@
 #include "collision.h"
 #include "forces.h"
 #include "polygon.h"
+#include "simd.h"
 #include "vector.h"
 #include <assert.h>
-#include <list.h>
 #include <math.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 
-double const LARGE_NUM = INFINITY;
-double const SMALL_NUM = -INFINITY;
+// edges whose normals are closer to parallel than this share an axis
+const double PARALLEL_TOLERANCE = 1e-9;
 
-void find_perp_axis(list_t *shape, list_t *axes) {
-  for (size_t i = 0; i < list_size(shape); i++) {
-    vector_t *p1 = list_get(shape, i);
-    vector_t *p2 = list_get(shape, (i + 1) % list_size(shape));
-    vector_t edge = vec_subtract(*p1, *p2);
-    vector_t *axis = malloc(sizeof(vector_t));
-    double magnitude = sqrt(edge.x * edge.x + edge.y * edge.y);
-    assert(axis != NULL);
-    axis->x = -edge.y / magnitude;
-    axis->y = edge.x / magnitude;
-    list_add(axes, axis);
+// a circle or capsule needs at most this many axes from its core
+// to the other shape, one per end of its segment
+#define MAX_ROUND_AXES 2
+
+/**
+ * A convex shape to test: every point within a radius
+ * of the convex hull of some points. Polygons have a radius of 0.
+ */
+typedef struct convex {
+  const vector_t *points;
+  size_t count;
+  double radius;
+} convex_t;
+
+/** The best axis found so far while testing the axes of two shapes. */
+typedef struct sat_state {
+  double least_overlap;
+  vector_t least_axis;
+  // whether least_axis is an edge normal of the first shape
+  bool from_first;
+} sat_state_t;
+
+// sweeps that start closer to touching than this fraction of the tick
+// count as touching from the start, so a body moved back to where it hit
+// something is not stopped there again on the next tick
+const double IMPACT_TOLERANCE = 1e-6;
+// relative speeds along an axis below this count as not moving along it
+const double SWEEP_SPEED_TOLERANCE = 1e-12;
+
+/**
+ * The part of the last tick during which two moving shapes' projections
+ * have overlapped on every axis tested so far, as fractions of the tick.
+ */
+typedef struct sweep_state {
+  double enter;
+  double exit;
+  // the axis whose projections overlapped last
+  vector_t enter_axis;
+  // whether enter_axis is an edge normal of the first shape
+  bool from_first;
+} sweep_state_t;
+
+// the pairs this thread tested since collision_take_stats() was last called
+_Thread_local collision_stats_t collision_stats = {0, 0};
+
+vector_t find_perp_axis(const polygon_t *shape, size_t index) {
+  vector_t *points = polygon_points(shape);
+  vector_t edge =
+      vec_subtract(points[index], points[(index + 1) % polygon_size(shape)]);
+  double magnitude = sqrt(edge.x * edge.x + edge.y * edge.y);
+  return (vector_t){-edge.y / magnitude, edge.x / magnitude};
+}
+
+size_t find_separating_axes(const polygon_t *shape, vector_t *axes) {
+  size_t count = 0;
+  for (size_t i = 0; i < polygon_size(shape); i++) {
+    vector_t axis = find_perp_axis(shape, i);
+    bool parallel = false;
+    for (size_t j = 0; j < count && !parallel; j++) {
+      parallel = fabs(vec_cross(axis, axes[j])) < PARALLEL_TOLERANCE;
+    }
+    if (!parallel) {
+      axes[count++] = axis;
+    }
   }
+  return count;
+}
+
+convex_t polygon_convex(const polygon_t *shape) {
+  return (convex_t){polygon_points(shape), polygon_size(shape), 0.0};
+}
+
+convex_t body_convex(body_t *body) {
+  convex_t shape;
+  shape.points = body_peek_core(body, &shape.count);
+  shape.radius = body_get_radius(body);
+  return shape;
 }
 
-bool test_intersecting_projections(vector_t p1, vector_t p2) {
-  if ((p1.x <= p2.x && p1.y >= p2.x) || (p2.x >= p1.x && p2.y <= p1.y) ||
-      (p1.x <= p2.y && p1.y >= p2.y) || (p2.x <= p1.x && p2.y >= p1.x)) {
-    return true;
+vector_t get_projection(const convex_t *shape, vector_t axis) {
+  vector_t projection;
+  points_project(shape->points, shape->count, axis, &projection.x,
+                 &projection.y);
+  projection.x -= shape->radius;
+  projection.y += shape->radius;
+  return projection;
+}
+
+/** Finds the point of a segment (or a single point) closest to a point. */
+vector_t closest_on_core(const convex_t *shape, vector_t point) {
+  vector_t start = shape->points[0];
+  if (shape->count == 1) {
+    return start;
   }
-  return false;
+  vector_t side = vec_subtract(shape->points[1], start);
+  double t = vec_dot(vec_subtract(point, start), side) / vec_dot(side, side);
+  t = fmax(0.0, fmin(1.0, t));
+  return vec_add(start, vec_multiply(t, side));
 }
 
-vector_t get_projection(list_t *shape, vector_t *axis) {
-  double min = LARGE_NUM;
-  double max = SMALL_NUM;
-  for (size_t i = 0; i < list_size(shape); i++) {
-    vector_t *point = (vector_t *)list_get(shape, i);
-    double proj = vec_dot(*axis, *point);
-    if (proj > max) {
-      max = proj;
+/** Finds the vertex of a polygon closest to a point. */
+vector_t closest_vertex(const convex_t *shape, vector_t point) {
+  vector_t closest = shape->points[0];
+  vector_t offset = vec_subtract(closest, point);
+  double best = vec_dot(offset, offset);
+  for (size_t i = 1; i < shape->count; i++) {
+    offset = vec_subtract(shape->points[i], point);
+    double distance = vec_dot(offset, offset);
+    if (distance < best) {
+      best = distance;
+      closest = shape->points[i];
     }
-    if (proj < min) {
-      min = proj;
+  }
+  return closest;
+}
+
+/**
+ * Finds the axes a round shape's curved edges add against another shape:
+ * from each end of its core to the nearest point of the other's core
+ * (a vertex, if the other is a polygon). Together with both shapes'
+ * edge normals, these contain an axis separating the shapes
+ * whenever they are apart.
+ * Returns the number of axes stored, none if the shape is a polygon.
+ */
+size_t find_round_axes(const convex_t *round, const convex_t *other,
+                       vector_t *axes) {
+  if (round->radius == 0.0) {
+    return 0;
+  }
+  for (size_t i = 0; i < round->count; i++) {
+    vector_t point = round->points[i];
+    vector_t nearest = other->radius > 0.0 ? closest_on_core(other, point)
+                                           : closest_vertex(other, point);
+    vector_t offset = vec_subtract(point, nearest);
+    double distance = sqrt(vec_dot(offset, offset));
+    // cores that touch overlap on every axis, so any axis will do
+    axes[i] = distance > 0.0 ? vec_multiply(1.0 / distance, offset)
+                             : (vector_t){1.0, 0.0};
+  }
+  return round->count;
+}
+
+/**
+ * Projects both shapes onto one axis, once each,
+ * updating the axis of least overlap found so far.
+ * Returns false if the axis separates the shapes.
+ */
+bool check_axis(vector_t axis, bool from_first, const convex_t *shape1,
+                const convex_t *shape2, sat_state_t *state) {
+  vector_t proj1 = get_projection(shape1, axis);
+  vector_t proj2 = get_projection(shape2, axis);
+  double overlap = fmin(proj1.y, proj2.y) - fmax(proj1.x, proj2.x);
+  if (overlap < 0) {
+    return false;
+  }
+  if (overlap < state->least_overlap) {
+    state->least_overlap = overlap;
+    // point the axis from the first shape towards the second
+    bool backwards = proj2.x + proj2.y < proj1.x + proj1.y;
+    state->least_axis = backwards ? vec_negate(axis) : axis;
+    state->from_first = from_first;
+  }
+  return true;
+}
+
+/**
+ * Finds the point of a shape that reaches furthest along a unit direction.
+ */
+vector_t find_support(const convex_t *shape, vector_t direction) {
+  vector_t support = shape->points[0];
+  double best = vec_dot(direction, support);
+  for (size_t i = 1; i < shape->count; i++) {
+    double proj = vec_dot(direction, shape->points[i]);
+    if (proj > best) {
+      best = proj;
+      support = shape->points[i];
     }
   }
-  return (vector_t){min, max};
+  return vec_add(support, vec_multiply(shape->radius, direction));
 }
 
-double calculate_overlap(vector_t p1, vector_t p2) {
-  if (p1.x < p2.x) {
-    return fabs(p2.x - p1.y);
+/** Fills in the collision from the axis of least overlap. */
+collision_info_t finish_collision(const convex_t *shape1,
+                                  const convex_t *shape2,
+                                  sat_state_t *state) {
+  collision_info_t collision;
+  collision.collided = true;
+  collision.axis = state->least_axis;
+  collision.depth = state->least_overlap;
+  collision.time = 1.0;
+  // the deepest point of the shape whose edge was not the axis
+  // is the one pushed furthest into the other shape
+  if (state->from_first) {
+    collision.contact = find_support(shape2, vec_negate(state->least_axis));
   } else {
-    return fabs(p1.x - p2.y);
+    collision.contact = find_support(shape1, state->least_axis);
   }
+  return collision;
 }
 
-collision_info_t find_collision(list_t *shape1, list_t *shape2) {
+/**
+ * Tests a list of axes belonging to one of the shapes.
+ * Returns false as soon as one separates the shapes.
+ */
+bool check_axes(const vector_t *axes, size_t count, bool from_first,
+                const convex_t *shape1, const convex_t *shape2,
+                sat_state_t *state) {
+  for (size_t i = 0; i < count; i++) {
+    if (!check_axis(axes[i], from_first, shape1, shape2, state)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/** Tests two circles, which only need the distance between their centers. */
+collision_info_t find_circle_collision(const convex_t *circle1,
+                                       const convex_t *circle2) {
+  vector_t offset = vec_subtract(circle2->points[0], circle1->points[0]);
+  double reach = circle1->radius + circle2->radius;
+  double squared = vec_dot(offset, offset);
+  if (squared > reach * reach) {
+    return (collision_info_t){.collided = false};
+  }
+  double distance = sqrt(squared);
   collision_info_t collision;
-  size_t num_points = list_size(shape1) + list_size(shape2);
-  list_t *axes = list_init(num_points, (free_func_t)free);
-  find_perp_axis(shape1, axes);
-  find_perp_axis(shape2, axes);
-
-  double least_overlap = INFINITY;
-  for (size_t i = 0; i < num_points; i++) {
-    vector_t *curr_axis = list_get(axes, i);
-    if (!test_intersecting_projections(get_projection(shape1, curr_axis),
-                                       get_projection(shape2, curr_axis))) {
-      list_free(shape1);
-      list_free(shape2);
-      list_free(axes);
-      collision.collided = false;
-      return collision;
-    } else {
-      double overlap = calculate_overlap(get_projection(shape1, curr_axis),
-                                         get_projection(shape2, curr_axis));
-      if (overlap < least_overlap) {
-        least_overlap = overlap;
-        collision.axis = *curr_axis;
-      }
+  collision.collided = true;
+  collision.axis = distance > 0.0 ? vec_multiply(1.0 / distance, offset)
+                                  : (vector_t){1.0, 0.0};
+  collision.depth = reach - distance;
+  collision.contact = vec_subtract(
+      circle2->points[0], vec_multiply(circle2->radius, collision.axis));
+  collision.time = 1.0;
+  return collision;
+}
+
+/**
+ * Tests two convex shapes on their edge normals
+ * and, for round shapes, the axes their curves add.
+ */
+collision_info_t find_convex_collision(const convex_t *shape1,
+                                       const vector_t *axes1, size_t count1,
+                                       const convex_t *shape2,
+                                       const vector_t *axes2, size_t count2) {
+  if (shape1->radius > 0.0 && shape1->count == 1 && shape2->radius > 0.0 &&
+      shape2->count == 1) {
+    return find_circle_collision(shape1, shape2);
+  }
+  vector_t round1[MAX_ROUND_AXES];
+  vector_t round2[MAX_ROUND_AXES];
+  size_t round_count1 = find_round_axes(shape1, shape2, round1);
+  size_t round_count2 = find_round_axes(shape2, shape1, round2);
+  sat_state_t state = {INFINITY, VEC_ZERO, true};
+  if (!check_axes(axes1, count1, true, shape1, shape2, &state) ||
+      !check_axes(round1, round_count1, true, shape1, shape2, &state) ||
+      !check_axes(axes2, count2, false, shape1, shape2, &state) ||
+      !check_axes(round2, round_count2, false, shape1, shape2, &state)) {
+    return (collision_info_t){.collided = false};
+  }
+  return finish_collision(shape1, shape2, &state);
+}
+
+collision_info_t find_collision_with_axes(const polygon_t *shape1,
+                                          const vector_t *axes1,
+                                          size_t count1,
+                                          const polygon_t *shape2,
+                                          const vector_t *axes2,
+                                          size_t count2) {
+  convex_t convex1 = polygon_convex(shape1);
+  convex_t convex2 = polygon_convex(shape2);
+  return find_convex_collision(&convex1, axes1, count1, &convex2, axes2,
+                               count2);
+}
+
+collision_info_t find_collision(const polygon_t *shape1,
+                                const polygon_t *shape2) {
+  // without cached axes, each edge normal is computed as it is tested,
+  // so nothing is allocated here
+  convex_t convex1 = polygon_convex(shape1);
+  convex_t convex2 = polygon_convex(shape2);
+  sat_state_t state = {INFINITY, VEC_ZERO, true};
+  for (size_t i = 0; i < polygon_size(shape1); i++) {
+    if (!check_axis(find_perp_axis(shape1, i), true, &convex1, &convex2,
+                    &state)) {
+      return (collision_info_t){.collided = false};
+    }
+  }
+  for (size_t i = 0; i < polygon_size(shape2); i++) {
+    if (!check_axis(find_perp_axis(shape2, i), false, &convex1, &convex2,
+                    &state)) {
+      return (collision_info_t){.collided = false};
+    }
+  }
+  return finish_collision(&convex1, &convex2, &state);
+}
+
+/**
+ * Narrows the part of the tick during which the shapes overlap
+ * to when their projections on one axis overlap.
+ * The shapes are at their positions at the end of the tick,
+ * and the first moved by motion relative to the second during it.
+ * Returns false if the projections never overlap during the tick.
+ */
+bool sweep_axis(vector_t axis, bool from_first, const convex_t *shape1,
+                const convex_t *shape2, vector_t motion,
+                sweep_state_t *state) {
+  vector_t proj1 = get_projection(shape1, axis);
+  vector_t proj2 = get_projection(shape2, axis);
+  double speed = vec_dot(motion, axis);
+  // at time t, the first shape's projection is offset by -(1 - t) * speed,
+  // so they overlap while (1 - t) * speed is in [low, high]
+  double low = proj1.x - proj2.y;
+  double high = proj1.y - proj2.x;
+  double enter;
+  double exit;
+  if (fabs(speed) < SWEEP_SPEED_TOLERANCE) {
+    if (low > 0 || high < 0) {
+      return false;
+    }
+    enter = -INFINITY;
+    exit = INFINITY;
+  } else if (speed > 0) {
+    enter = 1 - high / speed;
+    exit = 1 - low / speed;
+  } else {
+    enter = 1 - low / speed;
+    exit = 1 - high / speed;
+  }
+  if (enter > state->enter) {
+    state->enter = enter;
+    state->enter_axis = axis;
+    state->from_first = from_first;
+  }
+  state->exit = fmin(state->exit, exit);
+  return state->enter <= state->exit && state->enter <= 1 &&
+         state->exit >= 0;
+}
+
+collision_info_t find_swept_collision(body_t *body1, body_t *body2) {
+  collision_stats.pairs++;
+  if (!aabb_overlaps(body_get_swept_bounds(body1),
+                     body_get_swept_bounds(body2))) {
+    return (collision_info_t){.collided = false};
+  }
+  collision_stats.sat_tests++;
+  size_t count1;
+  size_t count2;
+  const vector_t *axes1 = body_peek_axes(body1, &count1);
+  const vector_t *axes2 = body_peek_axes(body2, &count2);
+  convex_t convex1 = body_convex(body1);
+  convex_t convex2 = body_convex(body2);
+  const convex_t *shape1 = &convex1;
+  const convex_t *shape2 = &convex2;
+  vector_t move1 =
+      vec_subtract(body_get_centroid(body1), body_get_previous_centroid(body1));
+  vector_t move2 =
+      vec_subtract(body_get_centroid(body2), body_get_previous_centroid(body2));
+  vector_t motion = vec_subtract(move1, move2);
+
+  // round shapes' axes are found where the shapes are now, so a sweep
+  // past a curve is only as exact as those axes are along the path
+  vector_t round1[MAX_ROUND_AXES];
+  vector_t round2[MAX_ROUND_AXES];
+  size_t round_count1 = find_round_axes(shape1, shape2, round1);
+  size_t round_count2 = find_round_axes(shape2, shape1, round2);
+
+  sweep_state_t state = {-INFINITY, INFINITY, VEC_ZERO, true};
+  for (size_t i = 0; i < count1 + round_count1; i++) {
+    vector_t axis = i < count1 ? axes1[i] : round1[i - count1];
+    if (!sweep_axis(axis, true, shape1, shape2, motion, &state)) {
+      return (collision_info_t){.collided = false};
+    }
+  }
+  for (size_t i = 0; i < count2 + round_count2; i++) {
+    vector_t axis = i < count2 ? axes2[i] : round2[i - count2];
+    if (!sweep_axis(axis, false, shape1, shape2, motion, &state)) {
+      return (collision_info_t){.collided = false};
     }
   }
+  if (state.enter <= IMPACT_TOLERANCE) {
+    // already touching when the tick started, so only where they are now
+    // matters, as for bodies that are not bullets
+    return find_convex_collision(shape1, axes1, count1, shape2, axes2,
+                                 count2);
+  }
+
+  collision_info_t collision;
   collision.collided = true;
-  list_free(shape1);
-  list_free(shape2);
-  list_free(axes);
+  collision.time = state.enter;
+  collision.depth = 0.0;
+  // point the axis from the first shape towards the second, where they met
+  double back = 1 - state.enter;
+  vector_t offset = vec_subtract(
+      vec_subtract(body_get_centroid(body2), vec_multiply(back, move2)),
+      vec_subtract(body_get_centroid(body1), vec_multiply(back, move1)));
+  collision.axis = vec_dot(offset, state.enter_axis) < 0
+                       ? vec_negate(state.enter_axis)
+                       : state.enter_axis;
+  if (state.from_first) {
+    collision.contact =
+        vec_subtract(find_support(shape2, vec_negate(collision.axis)),
+                     vec_multiply(back, move2));
+  } else {
+    collision.contact = vec_subtract(find_support(shape1, collision.axis),
+                                     vec_multiply(back, move1));
+  }
   return collision;
-}
\ No newline at end of file
+}
+
+collision_info_t find_body_collision(body_t *body1, body_t *body2) {
+  if (body_is_bullet(body1) || body_is_bullet(body2)) {
+    return find_swept_collision(body1, body2);
+  }
+  collision_stats.pairs++;
+  if (!aabb_overlaps(body_get_bounds(body1), body_get_bounds(body2))) {
+    return (collision_info_t){.collided = false};
+  }
+  collision_stats.sat_tests++;
+  size_t count1;
+  size_t count2;
+  const vector_t *axes1 = body_peek_axes(body1, &count1);
+  const vector_t *axes2 = body_peek_axes(body2, &count2);
+  convex_t shape1 = body_convex(body1);
+  convex_t shape2 = body_convex(body2);
+  return find_convex_collision(&shape1, axes1, count1, &shape2, axes2,
+                               count2);
+}
+
+/**
+ * Clips a ray against the edges of a convex polygon of either winding,
+ * finding where it enters the polygon if that is before *distance.
+ * If so, sets *distance to it and *normal to the edge's outward normal.
+ * Rays starting inside the polygon are ignored.
+ */
+bool ray_polygon(const vector_t *points, size_t count, vector_t origin,
+                 vector_t direction, double *distance, vector_t *normal) {
+  // this runs for every shape a ray reaches, so the arithmetic is spelled out
+  // rather than going through vector.h
+  double area = 0.0;
+  vector_t previous = points[count - 1];
+  for (size_t i = 0; i < count; i++) {
+    area += previous.x * points[i].y - previous.y * points[i].x;
+    previous = points[i];
+  }
+  double winding = area < 0 ? -1.0 : 1.0;
+  double enter = -INFINITY;
+  double exit = *distance;
+  vector_t enter_normal = VEC_ZERO;
+  previous = points[count - 1];
+  for (size_t i = 0; i < count; i++) {
+    vector_t outward = {winding * (points[i].y - previous.y),
+                        -winding * (points[i].x - previous.x)};
+    // the ray is inside this edge where t * facing <= offset
+    double facing = outward.x * direction.x + outward.y * direction.y;
+    double offset = outward.x * (previous.x - origin.x) +
+                    outward.y * (previous.y - origin.y);
+    previous = points[i];
+    if (facing == 0) {
+      if (offset < 0) {
+        return false;
+      }
+      continue;
+    }
+    double t = offset / facing;
+    if (facing < 0 && t > enter) {
+      enter = t;
+      enter_normal = outward;
+    } else if (facing > 0 && t < exit) {
+      exit = t;
+    }
+    if (enter > exit) {
+      return false;
+    }
+  }
+  if (enter < 0) {
+    return false;
+  }
+  *distance = enter;
+  *normal = vec_multiply(1 / sqrt(vec_dot(enter_normal, enter_normal)),
+                         enter_normal);
+  return true;
+}
+
+/** Like ray_polygon(), for a circle. */
+bool ray_circle(vector_t center, double radius, vector_t origin,
+                vector_t direction, double *distance, vector_t *normal) {
+  vector_t offset = vec_subtract(origin, center);
+  double along = vec_dot(offset, direction);
+  double outside = vec_dot(offset, offset) - radius * radius;
+  if (outside <= 0 || along > 0) {
+    return false;
+  }
+  double discriminant = along * along - outside;
+  if (discriminant < 0) {
+    return false;
+  }
+  double t = -along - sqrt(discriminant);
+  if (t > *distance) {
+    return false;
+  }
+  *distance = t;
+  *normal = vec_multiply(1 / radius, vec_add(offset, vec_multiply(t, direction)));
+  return true;
+}
+
+/**
+ * Like ray_polygon(), for a capsule:
+ * the nearest of the rectangle along its segment and its two end circles.
+ */
+bool ray_capsule(const convex_t *capsule, vector_t origin, vector_t direction,
+                 double *distance, vector_t *normal) {
+  vector_t inside = vec_subtract(origin, closest_on_core(capsule, origin));
+  if (vec_dot(inside, inside) <= capsule->radius * capsule->radius) {
+    return false;
+  }
+  vector_t start = capsule->points[0];
+  vector_t end = capsule->points[1];
+  vector_t side = vec_subtract(end, start);
+  double length = sqrt(vec_dot(side, side));
+  bool hit = false;
+  if (length > 0) {
+    vector_t across =
+        vec_multiply(capsule->radius / length, (vector_t){-side.y, side.x});
+    vector_t box[4] = {vec_subtract(start, across), vec_subtract(end, across),
+                       vec_add(end, across), vec_add(start, across)};
+    hit = ray_polygon(box, 4, origin, direction, distance, normal);
+  }
+  // each call only succeeds if it is nearer than the hits before it
+  if (ray_circle(start, capsule->radius, origin, direction, distance,
+                 normal)) {
+    hit = true;
+  }
+  if (ray_circle(end, capsule->radius, origin, direction, distance, normal)) {
+    hit = true;
+  }
+  return hit;
+}
+
+ray_hit_t find_ray_hit(body_t *body, vector_t origin, vector_t direction,
+                       double max_distance) {
+  ray_hit_t hit = {NULL, VEC_ZERO, VEC_ZERO, max_distance};
+  convex_t shape = body_convex(body);
+  bool found;
+  if (shape.radius == 0) {
+    found = ray_polygon(shape.points, shape.count, origin, direction,
+                        &hit.distance, &hit.normal);
+  } else if (shape.count == 1) {
+    found = ray_circle(shape.points[0], shape.radius, origin, direction,
+                       &hit.distance, &hit.normal);
+  } else {
+    found = ray_capsule(&shape, origin, direction, &hit.distance, &hit.normal);
+  }
+  if (found) {
+    hit.body = body;
+    hit.point = vec_add(origin, vec_multiply(hit.distance, direction));
+  }
+  return hit;
+}
+
+double find_point_distance(body_t *body, vector_t point) {
+  convex_t shape = body_convex(body);
+  if (shape.radius > 0) {
+    vector_t offset = vec_subtract(point, closest_on_core(&shape, point));
+    return fmax(0.0, sqrt(vec_dot(offset, offset)) - shape.radius);
+  }
+  // inside a convex polygon, the point is on the same side of every edge
+  bool left = true;
+  bool right = true;
+  double nearest = INFINITY;
+  vector_t previous = shape.points[shape.count - 1];
+  for (size_t i = 0; i < shape.count; i++) {
+    vector_t edge = vec_subtract(shape.points[i], previous);
+    vector_t offset = vec_subtract(point, previous);
+    double side = vec_cross(edge, offset);
+    left = left && side >= 0;
+    right = right && side <= 0;
+    double t = fmax(0.0, fmin(1.0, vec_dot(offset, edge) / vec_dot(edge, edge)));
+    vector_t gap = vec_subtract(offset, vec_multiply(t, edge));
+    nearest = fmin(nearest, vec_dot(gap, gap));
+    previous = shape.points[i];
+  }
+  return left || right ? 0.0 : sqrt(nearest);
+}
+
+void collision_prepare_body(body_t *body) {
+  size_t count;
+  body_peek_axes(body, &count);
+  body_peek_core(body, &count);
+  body_get_bounds(body);
+}
+
+void collision_count_culled_pairs(size_t count) {
+  collision_stats.pairs += count;
+}
+
+void collision_add_stats(collision_stats_t stats) {
+  collision_stats.pairs += stats.pairs;
+  collision_stats.sat_tests += stats.sat_tests;
+}
+
+collision_stats_t collision_take_stats(void) {
+  collision_stats_t stats = collision_stats;
+  collision_stats = (collision_stats_t){0, 0};
+  return stats;
+}
+
+void points_project(const vector_t *points, size_t count, vector_t axis,
+                    double *min, double *max) {
+  simd_kernels_get()->project(points, count, axis, min, max);
+}
@@ -0,0 +1,149 @@
+#include "contacts.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+const size_t CONTACT_CACHE_INITIAL_SIZE = 64;
+const size_t CONTACT_CACHE_GROW_FACTOR = 2;
+// the table has at least this many slots per contact, so probes stay short
+const size_t CONTACT_TABLE_LOAD = 2;
+// marks a table slot with no contact in it
+const size_t EMPTY_SLOT = SIZE_MAX;
+
+typedef struct contact_cache {
+  contact_t *contacts;
+  size_t size;
+  size_t capacity;
+  // open addressing with linear probing: each slot holds EMPTY_SLOT
+  // or the index of a contact; the slot count is a power of two
+  size_t *table;
+  size_t table_size;
+} contact_cache_t;
+
+void table_clear(contact_cache_t *cache) {
+  for (size_t i = 0; i < cache->table_size; i++) {
+    cache->table[i] = EMPTY_SLOT;
+  }
+}
+
+contact_cache_t *contact_cache_init(void) {
+  contact_cache_t *cache = malloc(sizeof(contact_cache_t));
+  assert(cache != NULL);
+  cache->size = 0;
+  cache->capacity = CONTACT_CACHE_INITIAL_SIZE;
+  cache->contacts = malloc(sizeof(contact_t) * cache->capacity);
+  cache->table_size = CONTACT_CACHE_INITIAL_SIZE * CONTACT_TABLE_LOAD;
+  cache->table = malloc(sizeof(size_t) * cache->table_size);
+  assert(cache->contacts != NULL && cache->table != NULL);
+  table_clear(cache);
+  return cache;
+}
+
+void contact_cache_free(contact_cache_t *cache) {
+  free(cache->contacts);
+  free(cache->table);
+  free(cache);
+}
+
+size_t contact_cache_size(contact_cache_t *cache) { return cache->size; }
+
+contact_t *contact_cache_get(contact_cache_t *cache, size_t index) {
+  assert(index < cache->size);
+  return &cache->contacts[index];
+}
+
+/** Hashes a pair of bodies the same way whichever order they are in. */
+size_t pair_hash(body_t *body1, body_t *body2) {
+  uint64_t low = (uintptr_t)body1;
+  uint64_t high = (uintptr_t)body2;
+  if (low > high) {
+    uint64_t temp = low;
+    low = high;
+    high = temp;
+  }
+  uint64_t hash = low * 0x9E3779B97F4A7C15ull ^ high * 0xC2B2AE3D27D4EB4Full;
+  return (size_t)(hash ^ (hash >> 29));
+}
+
+bool contact_matches(contact_t *contact, body_t *body1, body_t *body2) {
+  return (contact->body1 == body1 && contact->body2 == body2) ||
+         (contact->body1 == body2 && contact->body2 == body1);
+}
+
+/**
+ * Finds the table slot holding the contact of two bodies,
+ * or the empty slot where it would go.
+ */
+size_t table_probe(contact_cache_t *cache, body_t *body1, body_t *body2) {
+  size_t mask = cache->table_size - 1;
+  size_t slot = pair_hash(body1, body2) & mask;
+  while (cache->table[slot] != EMPTY_SLOT &&
+         !contact_matches(&cache->contacts[cache->table[slot]], body1,
+                          body2)) {
+    slot = (slot + 1) & mask;
+  }
+  return slot;
+}
+
+/** Refills the table from the contacts, e.g. after it grows. */
+void table_rebuild(contact_cache_t *cache) {
+  table_clear(cache);
+  for (size_t i = 0; i < cache->size; i++) {
+    contact_t *contact = &cache->contacts[i];
+    cache->table[table_probe(cache, contact->body1, contact->body2)] = i;
+  }
+}
+
+contact_t *contact_cache_find(contact_cache_t *cache, body_t *body1,
+                              body_t *body2) {
+  size_t index = cache->table[table_probe(cache, body1, body2)];
+  return index == EMPTY_SLOT ? NULL : &cache->contacts[index];
+}
+
+contact_t *contact_cache_touch(contact_cache_t *cache, body_t *body1,
+                               body_t *body2, size_t tick) {
+  size_t slot = table_probe(cache, body1, body2);
+  if (cache->table[slot] != EMPTY_SLOT) {
+    contact_t *contact = &cache->contacts[cache->table[slot]];
+    contact->last_tick = tick;
+    return contact;
+  }
+
+  if (cache->size >= cache->capacity) {
+    cache->capacity *= CONTACT_CACHE_GROW_FACTOR;
+    cache->contacts =
+        realloc(cache->contacts, sizeof(contact_t) * cache->capacity);
+    assert(cache->contacts != NULL);
+  }
+  size_t index = cache->size++;
+  cache->contacts[index] =
+      (contact_t){body1, body2, VEC_ZERO, 0.0, VEC_ZERO, 1.0, tick, tick};
+  if (cache->size * CONTACT_TABLE_LOAD > cache->table_size) {
+    cache->table_size *= CONTACT_CACHE_GROW_FACTOR;
+    free(cache->table);
+    cache->table = malloc(sizeof(size_t) * cache->table_size);
+    assert(cache->table != NULL);
+    table_rebuild(cache);
+  } else {
+    cache->table[slot] = index;
+  }
+  return &cache->contacts[index];
+}
+
+size_t contact_cache_remove_if(contact_cache_t *cache, predicate_t predicate,
+                               void *aux) {
+  size_t kept = 0;
+  for (size_t i = 0; i < cache->size; i++) {
+    if (!predicate(&cache->contacts[i], aux)) {
+      cache->contacts[kept++] = cache->contacts[i];
+    }
+  }
+  size_t removed = cache->size - kept;
+  cache->size = kept;
+  // linear probing cannot just empty slots, so the table is refilled
+  if (removed > 0) {
+    table_rebuild(cache);
+  }
+  return removed;
+}
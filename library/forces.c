@@ -2,25 +2,54 @@
 #include "body.h"
 #include "collision.h"
 #include "map.h"
+#include "quadtree.h"
 #include "scene.h"
 #include <assert.h>
 #include <math.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 
 double MINIMUM_DISTANCE = 5.0;
+const size_t GRAVITY_FIELD_INITIAL_SIZE = 64;
+const size_t GRAVITY_FIELD_GROW_FACTOR = 2;
+
+// bullet damage
+const double BULLET_DAMAGE = 10.0;
+const double GRAVITY_BULLET_DAMAGE = 15.0;
+const double SNIPER_BULLET_DAMAGE = 25.0;
+const double GATLING_BULLET_DAMAGE = 5.0;
 
 typedef struct store_force {
-  list_t *bodies;
+  body_t *body1;
+  body_t *body2;
   double constant;
   collision_handler_t handler;
   void *aux;
-  bool just_collided;
+  free_func_t aux_freer;
+  // the scene that records collision force creators' contacts,
+  // and whose pool the storage is allocated from
+  scene_t *scene;
 } store_force_t;
 
+/** Allocates storage for a force creator from the scene's pool. */
+store_force_t *store_force_init(scene_t *scene, body_t *body1, body_t *body2) {
+  store_force_t *storage = scene_alloc(scene, sizeof(store_force_t));
+  storage->body1 = body1;
+  storage->body2 = body2;
+  storage->constant = 0.0;
+  storage->handler = NULL;
+  storage->aux = NULL;
+  storage->aux_freer = NULL;
+  storage->scene = scene;
+  return storage;
+}
+
 void store_force_free(store_force_t *storage) {
-  list_free(storage->bodies);
-  free(storage);
+  if (storage->aux_freer != NULL) {
+    storage->aux_freer(storage->aux);
+  }
+  scene_release(storage->scene, storage);
 }
 
 vector_t calculate_unit_vector(vector_t body1, vector_t body2) {
@@ -33,98 +62,192 @@ vector_t calculate_unit_vector(vector_t body1, vector_t body2) {
   return unit_vec;
 }
 
-void gravity_forcer(store_force_t *storage) {
-  list_t *bodies = storage->bodies;
-  body_t *body1 = list_get(bodies, 0);
-  body_t *body2 = list_get(bodies, 1);
-  vector_t body1_centroid = body_get_centroid(body1);
-  vector_t body2_centroid = body_get_centroid(body2);
-  double distance = body_get_distance(body1_centroid, body2_centroid);
-  if (distance < MINIMUM_DISTANCE) {
-    return;
+void gravity_kernel(const force_record_t *records, size_t count) {
+  double min_squared = MINIMUM_DISTANCE * MINIMUM_DISTANCE;
+  for (size_t i = 0; i < count; i++) {
+    body_t *body1 = records[i].body1;
+    body_t *body2 = records[i].body2;
+    vector_t body1_centroid = body_get_centroid(body1);
+    vector_t body2_centroid = body_get_centroid(body2);
+    double dx = body2_centroid.x - body1_centroid.x;
+    double dy = body2_centroid.y - body1_centroid.y;
+    double squared = dx * dx + dy * dy;
+    if (squared < min_squared) {
+      continue;
+    }
+    // G m1 m2 / r^2 along the unit vector (dx, dy) / r
+    double scale = records[i].constant * body_get_mass(body1) *
+                   body_get_mass(body2) / (squared * sqrt(squared));
+    vector_t force = {dx * scale, dy * scale};
+    body_add_force(body1, force);
+    body_add_force(body2, (vector_t){-force.x, -force.y});
   }
-  // unit vector calculation
-  vector_t unit_vec = calculate_unit_vector(body1_centroid, body2_centroid);
-
-  // force
-  double force_magnitude = (double)(body_get_mass(body1) *
-                                    body_get_mass(body2) * storage->constant) /
-                           (distance * distance);
-  vector_t force;
-  force.x = unit_vec.x * force_magnitude;
-  force.y = unit_vec.y * force_magnitude;
-
-  body_add_force(body1, force);
-  body_add_force(body2, vec_negate(force));
 }
 
 void create_newtonian_gravity(scene_t *scene, double G, body_t *body1,
                               body_t *body2) {
-  store_force_t *storage = malloc(sizeof(store_force_t));
-  assert(storage != NULL);
-  storage->bodies = list_init(2, NULL);
-  list_add(storage->bodies, body1);
-  list_add(storage->bodies, body2);
-  storage->constant = G;
-
-  force_creator_t forcer = (force_creator_t)gravity_forcer;
+  scene_add_batched_force(scene, gravity_kernel, body1, body2, G);
+}
 
-  scene_add_bodies_force_creator(scene, forcer, storage, storage->bodies,
-                                 (free_func_t)free);
+/** The state of a scene-wide gravity field, kept between ticks. */
+typedef struct gravity_field {
+  double theta;
+  size_t mask;
+  quadtree_t *tree;
+  // the bodies the field acts on this tick, with their positions and masses
+  body_t **bodies;
+  vector_t *points;
+  double *masses;
+  size_t capacity;
+} gravity_field_t;
+
+void gravity_field_free(gravity_field_t *field) {
+  quadtree_free(field->tree);
+  free(field->bodies);
+  free(field->points);
+  free(field->masses);
+  free(field);
 }
 
-void spring_forcer(store_force_t *storage) {
-  list_t *bodies = storage->bodies;
-  body_t *body1 = list_get(bodies, 0);
-  body_t *body2 = list_get(bodies, 1);
-  vector_t body1_centroid = body_get_centroid(body1);
-  vector_t body2_centroid = body_get_centroid(body2);
-  double distance = body_get_distance(body1_centroid, body2_centroid);
+/** Adds a body to the ones the field acts on this tick. */
+void gravity_field_add(gravity_field_t *field, size_t count, body_t *body) {
+  if (count >= field->capacity) {
+    field->capacity *= GRAVITY_FIELD_GROW_FACTOR;
+    field->bodies = realloc(field->bodies, sizeof(body_t *) * field->capacity);
+    field->points = realloc(field->points, sizeof(vector_t) * field->capacity);
+    field->masses = realloc(field->masses, sizeof(double) * field->capacity);
+    assert(field->bodies != NULL && field->points != NULL &&
+           field->masses != NULL);
+  }
+  field->bodies[count] = body;
+  field->points[count] = body_get_centroid(body);
+  field->masses[count] = body_get_mass(body);
+}
 
-  double force_magnitude = storage->constant * distance;
+void gravity_field_forcer(store_force_t *storage) {
+  gravity_field_t *field = storage->aux;
+  scene_t *scene = storage->scene;
+  size_t count = 0;
+  for (size_t i = 0; i < scene_bodies(scene); i++) {
+    body_t *body = scene_get_body(scene, i);
+    if (body_is_removed(body) || body_is_static(body) ||
+        body_get_mass(body) == INFINITY ||
+        (field->mask != SIZE_MAX &&
+         (body_get_collision_category(body) & field->mask) == 0)) {
+      continue;
+    }
+    gravity_field_add(field, count++, body);
+  }
 
-  vector_t unit_vec = calculate_unit_vector(body1_centroid, body2_centroid);
+  quadtree_build(field->tree, field->points, field->masses, count);
+  for (size_t i = 0; i < count; i++) {
+    vector_t pull = quadtree_field(field->tree, field->points[i], field->theta,
+                                   MINIMUM_DISTANCE);
+    body_add_force(field->bodies[i],
+                   vec_multiply(storage->constant * field->masses[i], pull));
+  }
+}
 
-  // force
-  vector_t force;
-  force.x = unit_vec.x * force_magnitude;
-  force.y = unit_vec.y * force_magnitude;
+void create_barnes_hut_gravity(scene_t *scene, double G, double theta,
+                               size_t mask) {
+  assert(theta >= 0);
+  gravity_field_t *field = malloc(sizeof(gravity_field_t));
+  assert(field != NULL);
+  field->theta = theta;
+  field->mask = mask;
+  field->tree = quadtree_init();
+  field->capacity = GRAVITY_FIELD_INITIAL_SIZE;
+  field->bodies = malloc(sizeof(body_t *) * field->capacity);
+  field->points = malloc(sizeof(vector_t) * field->capacity);
+  field->masses = malloc(sizeof(double) * field->capacity);
+  assert(field->bodies != NULL && field->points != NULL &&
+         field->masses != NULL);
+
+  store_force_t *storage = store_force_init(scene, NULL, NULL);
+  storage->constant = G;
+  storage->aux = field;
+  storage->aux_freer = (free_func_t)gravity_field_free;
+
+  // the field follows whichever bodies are in the scene,
+  // so it depends on none of them and is never removed
+  scene_add_pair_force_creator(scene, (force_creator_t)gravity_field_forcer,
+                               storage, NULL, NULL,
+                               (free_func_t)store_force_free);
+}
 
-  body_add_force(body1, force);
-  body_add_force(body2, vec_negate(force));
+void spring_kernel(const force_record_t *records, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    body_t *body1 = records[i].body1;
+    body_t *body2 = records[i].body2;
+    vector_t body1_centroid = body_get_centroid(body1);
+    vector_t body2_centroid = body_get_centroid(body2);
+    // k times the distance, along the unit vector towards body2
+    double k = records[i].constant;
+    vector_t force = {k * (body2_centroid.x - body1_centroid.x),
+                      k * (body2_centroid.y - body1_centroid.y)};
+    body_add_force(body1, force);
+    body_add_force(body2, (vector_t){-force.x, -force.y});
+  }
 }
 
 void create_spring(scene_t *scene, double k, body_t *body1, body_t *body2) {
-  store_force_t *storage = malloc(sizeof(store_force_t));
-  storage->bodies = list_init(2, NULL);
-  list_add(storage->bodies, body1);
-  list_add(storage->bodies, body2);
-  storage->constant = k;
+  scene_add_batched_force(scene, spring_kernel, body1, body2, k);
+}
 
-  force_creator_t forcer = (force_creator_t)spring_forcer;
+void drag_kernel(const force_record_t *records, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    vector_t velocity = body_get_velocity(records[i].body1);
+    double gamma = records[i].constant;
+    body_add_force(records[i].body1,
+                   (vector_t){-gamma * velocity.x, -gamma * velocity.y});
+  }
+}
 
-  scene_add_bodies_force_creator(scene, forcer, storage, storage->bodies,
-                                 (free_func_t)free);
+void create_drag(scene_t *scene, double gamma, body_t *body) {
+  scene_add_batched_force(scene, drag_kernel, body, NULL, gamma);
 }
 
-void drag_forcer(store_force_t *storage) {
-  list_t *bodies = storage->bodies;
-  body_t *body = list_get(bodies, 0);
+void drag_field_kernel(body_t *body, const force_field_t *field) {
   vector_t velocity = body_get_velocity(body);
-  vector_t drag_force = vec_negate(vec_multiply(storage->constant, velocity));
-  body_add_force(body, drag_force);
+  body_add_force(body, (vector_t){-field->constant * velocity.x,
+                                  -field->constant * velocity.y});
 }
 
-void create_drag(scene_t *scene, double gamma, body_t *body) {
-  store_force_t *storage = malloc(sizeof(store_force_t));
-  storage->bodies = list_init(1, NULL);
-  list_add(storage->bodies, body);
-  storage->constant = gamma;
+void create_drag_field(scene_t *scene, double gamma, size_t tags) {
+  scene_add_force_field(scene, drag_field_kernel,
+                        (force_field_t){tags, NULL, gamma, VEC_ZERO});
+}
 
-  force_creator_t forcer = (force_creator_t)drag_forcer;
+void uniform_gravity_kernel(body_t *body, const force_field_t *field) {
+  double mass = body_get_mass(body);
+  body_add_force(body,
+                 (vector_t){mass * field->vector.x, mass * field->vector.y});
+}
 
-  scene_add_bodies_force_creator(scene, forcer, storage, storage->bodies,
-                                 (free_func_t)free);
+void create_uniform_gravity(scene_t *scene, vector_t acceleration,
+                            size_t tags) {
+  scene_add_force_field(scene, uniform_gravity_kernel,
+                        (force_field_t){tags, NULL, 0.0, acceleration});
+}
+
+void attractor_kernel(body_t *body, const force_field_t *field) {
+  vector_t centroid = body_get_centroid(body);
+  vector_t source_centroid = body_get_centroid(field->source);
+  double dx = source_centroid.x - centroid.x;
+  double dy = source_centroid.y - centroid.y;
+  double squared = dx * dx + dy * dy;
+  if (squared < MINIMUM_DISTANCE * MINIMUM_DISTANCE) {
+    return;
+  }
+  double scale = field->constant * body_get_mass(body) *
+                 body_get_mass(field->source) / (squared * sqrt(squared));
+  body_add_force(body, (vector_t){dx * scale, dy * scale});
+}
+
+void create_attractor(scene_t *scene, double G, body_t *source, size_t tags) {
+  assert(source != NULL);
+  scene_add_force_field(scene, attractor_kernel,
+                        (force_field_t){tags, source, G, VEC_ZERO});
 }
 
 void destructive_collision_handler(body_t *body1, body_t *body2, vector_t axis,
@@ -154,13 +277,13 @@ void partial_destructive_collision_handler(body_t *body1, body_t *body2,
 void create_destructive_collision(scene_t *scene, body_t *body1,
                                   body_t *body2) {
   create_collision(scene, body1, body2, destructive_collision_handler, NULL,
-                   (free_func_t)free);
+                   NULL);
 }
 
 void create_partial_destructive_collision(scene_t *scene, body_t *body1,
                                           body_t *body2) {
   create_collision(scene, body1, body2, partial_destructive_collision_handler,
-                   NULL, (free_func_t)free);
+                   NULL, NULL);
 }
 
 void impulse_handler(body_t *body1, body_t *body2, vector_t axis, void *aux) {
@@ -195,55 +318,68 @@ void impulse_handler(body_t *body1, body_t *body2, vector_t axis, void *aux) {
 }
 
 void custom_forcer(store_force_t *storage) {
-  list_t *bodies = storage->bodies;
-  body_t *body1 = list_get(bodies, 0);
-  body_t *body2 = list_get(bodies, 1);
+  body_t *body1 = storage->body1;
+  body_t *body2 = storage->body2;
 
-  // if (storage->just_collided) {
-  //   storage->just_collided = false;
-  //   return;
-  // }
-
-  collision_info_t collision_info =
-      find_collision(body_get_shape(body1), body_get_shape(body2));
+  collision_info_t collision_info = find_body_collision(body1, body2);
 
   if (collision_info.collided == false) {
-    storage->just_collided = false;
     return;
   }
-  body_set_just_collided(body1, true);
-  body_set_just_collided(body2, true);
-  if (storage->just_collided) {
-    return;
+  // the handler only runs on the first tick of each contact,
+  // once the scene has finished finding collisions
+  if (scene_record_contact(storage->scene, body1, body2, collision_info) ==
+      CONTACT_BEGIN) {
+    scene_queue_collision(storage->scene, body1, body2, collision_info,
+                          storage->handler, storage->aux);
   }
-  storage->just_collided = true;
-
-  collision_handler_t handler = storage->handler;
-  void *aux = storage->aux;
+}
 
-  handler(body1, body2, collision_info.axis, aux);
+/** Adds a collision force creator whose storage is already filled in. */
+void add_collision(scene_t *scene, store_force_t *storage) {
+  scene_add_pair_force_creator(scene, (force_creator_t)custom_forcer, storage,
+                               storage->body1, storage->body2,
+                               (free_func_t)store_force_free);
 }
 
 void create_physics_collision(scene_t *scene, double elasticity, body_t *body1,
                               body_t *body2) {
-  double *constant = malloc(sizeof(double));
-  *constant = elasticity;
-  create_collision(scene, body1, body2, impulse_handler, constant,
-                   (free_func_t)free);
+  // the elasticity lives in the storage, so it needs no allocation of its own
+  store_force_t *storage = store_force_init(scene, body1, body2);
+  storage->constant = elasticity;
+  storage->handler = impulse_handler;
+  storage->aux = &storage->constant;
+  add_collision(scene, storage);
 }
 
 void create_collision(scene_t *scene, body_t *body1, body_t *body2,
                       collision_handler_t handler, void *aux,
                       free_func_t freer) {
-  store_force_t *storage = malloc(sizeof(store_force_t));
-  storage->bodies = list_init(2, NULL);
-  list_add(storage->bodies, body1);
-  list_add(storage->bodies, body2);
+  store_force_t *storage = store_force_init(scene, body1, body2);
   storage->aux = aux;
+  storage->aux_freer = freer;
   storage->handler = handler;
+  add_collision(scene, storage);
+}
 
-  force_creator_t forcer = (force_creator_t)custom_forcer;
+void create_layer_destructive_collision(scene_t *scene, size_t layer1,
+                                        size_t layer2) {
+  scene_add_collision_rule(scene, layer1, layer2,
+                           destructive_collision_handler, NULL, NULL);
+}
 
-  scene_add_bodies_force_creator(scene, forcer, storage, storage->bodies,
-                                 (free_func_t)free);
-}
\ No newline at end of file
+void create_layer_partial_destructive_collision(scene_t *scene,
+                                                size_t tank_layer,
+                                                size_t bullet_layer) {
+  scene_add_collision_rule(scene, tank_layer, bullet_layer,
+                           partial_destructive_collision_handler, NULL, NULL);
+}
+
+void create_layer_physics_collision(scene_t *scene, double elasticity,
+                                    size_t layer1, size_t layer2) {
+  double *constant = malloc(sizeof(double));
+  assert(constant != NULL);
+  *constant = elasticity;
+  scene_add_collision_rule(scene, layer1, layer2, impulse_handler, constant,
+                           (free_func_t)free);
+}
@@ -0,0 +1,317 @@
+#include "grid.h"
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+const size_t GRID_INITIAL_SIZE = 64;
+const size_t GRID_CELL_INITIAL_SIZE = 4;
+const size_t GRID_GROW_FACTOR = 2;
+// ends the list of free proxies
+const size_t NO_PROXY = SIZE_MAX;
+
+/** The cells a box touches, as inclusive ranges of columns and rows. */
+typedef struct cell_range {
+  size_t min_column;
+  size_t max_column;
+  size_t min_row;
+  size_t max_row;
+} cell_range_t;
+
+typedef struct grid_proxy {
+  // NULL if the proxy is free
+  void *item;
+  aabb_t box;
+  cell_range_t cells;
+  // the next free proxy, if this one is free
+  size_t next_free;
+  // the last ray cast that visited the proxy, so it is only visited once
+  size_t last_ray;
+} grid_proxy_t;
+
+/** The proxies whose boxes touch a cell, in no particular order. */
+typedef struct grid_cell {
+  size_t *proxies;
+  size_t count;
+  size_t capacity;
+} grid_cell_t;
+
+typedef struct grid {
+  vector_t min;
+  double cell_size;
+  size_t columns;
+  size_t rows;
+  grid_cell_t *cells;
+  grid_proxy_t *proxies;
+  size_t proxy_count;
+  size_t proxies_capacity;
+  size_t first_free;
+  // the number of rays cast so far
+  size_t rays;
+} grid_t;
+
+grid_t *grid_init(vector_t min, vector_t max, double cell_size) {
+  assert(max.x > min.x && max.y > min.y);
+  assert(cell_size > 0);
+  grid_t *grid = malloc(sizeof(grid_t));
+  assert(grid != NULL);
+  grid->min = min;
+  grid->cell_size = cell_size;
+  grid->columns = (size_t)ceil((max.x - min.x) / cell_size);
+  grid->rows = (size_t)ceil((max.y - min.y) / cell_size);
+  // cells start without storage, so empty parts of the arena cost nothing
+  grid->cells = calloc(grid->columns * grid->rows, sizeof(grid_cell_t));
+  grid->proxies_capacity = GRID_INITIAL_SIZE;
+  grid->proxies = malloc(sizeof(grid_proxy_t) * grid->proxies_capacity);
+  assert(grid->cells != NULL && grid->proxies != NULL);
+  grid->proxy_count = 0;
+  grid->first_free = NO_PROXY;
+  grid->rays = 0;
+  return grid;
+}
+
+void grid_free(grid_t *grid) {
+  for (size_t i = 0; i < grid->columns * grid->rows; i++) {
+    free(grid->cells[i].proxies);
+  }
+  free(grid->cells);
+  free(grid->proxies);
+  free(grid);
+}
+
+/** Clamps a column or row, which may be outside the grid, to the grid. */
+size_t grid_clamp(double index, size_t count) {
+  if (index < 0) {
+    return 0;
+  }
+  if (index >= count) {
+    return count - 1;
+  }
+  return (size_t)index;
+}
+
+/** Gets the column or row containing a coordinate, clamped to the grid. */
+size_t grid_index(double coordinate, double min, double cell_size,
+                  size_t count) {
+  return grid_clamp(floor((coordinate - min) / cell_size), count);
+}
+
+cell_range_t grid_cells(grid_t *grid, aabb_t box) {
+  return (cell_range_t){
+      grid_index(box.min.x, grid->min.x, grid->cell_size, grid->columns),
+      grid_index(box.max.x, grid->min.x, grid->cell_size, grid->columns),
+      grid_index(box.min.y, grid->min.y, grid->cell_size, grid->rows),
+      grid_index(box.max.y, grid->min.y, grid->cell_size, grid->rows)};
+}
+
+bool range_contains(cell_range_t range, size_t column, size_t row) {
+  return range.min_column <= column && column <= range.max_column &&
+         range.min_row <= row && row <= range.max_row;
+}
+
+void cell_add(grid_cell_t *cell, size_t proxy) {
+  if (cell->count >= cell->capacity) {
+    cell->capacity = cell->capacity == 0 ? GRID_CELL_INITIAL_SIZE
+                                         : cell->capacity * GRID_GROW_FACTOR;
+    cell->proxies = realloc(cell->proxies, sizeof(size_t) * cell->capacity);
+    assert(cell->proxies != NULL);
+  }
+  cell->proxies[cell->count++] = proxy;
+}
+
+void cell_remove(grid_cell_t *cell, size_t proxy) {
+  for (size_t i = 0; i < cell->count; i++) {
+    if (cell->proxies[i] == proxy) {
+      cell->proxies[i] = cell->proxies[--cell->count];
+      return;
+    }
+  }
+  assert(false);
+}
+
+/** Adds a proxy to the cells in one range that are not in another. */
+void grid_add_cells(grid_t *grid, size_t proxy, cell_range_t cells,
+                    cell_range_t except) {
+  for (size_t row = cells.min_row; row <= cells.max_row; row++) {
+    for (size_t column = cells.min_column; column <= cells.max_column;
+         column++) {
+      if (!range_contains(except, column, row)) {
+        cell_add(&grid->cells[row * grid->columns + column], proxy);
+      }
+    }
+  }
+}
+
+/** Removes a proxy from the cells in one range that are not in another. */
+void grid_remove_cells(grid_t *grid, size_t proxy, cell_range_t cells,
+                       cell_range_t except) {
+  for (size_t row = cells.min_row; row <= cells.max_row; row++) {
+    for (size_t column = cells.min_column; column <= cells.max_column;
+         column++) {
+      if (!range_contains(except, column, row)) {
+        cell_remove(&grid->cells[row * grid->columns + column], proxy);
+      }
+    }
+  }
+}
+
+// a range containing no cells, for adding or removing every cell of another
+const cell_range_t NO_CELLS = {1, 0, 1, 0};
+
+size_t grid_insert(grid_t *grid, void *item, aabb_t box) {
+  assert(item != NULL);
+  size_t proxy = grid->first_free;
+  if (proxy != NO_PROXY) {
+    grid->first_free = grid->proxies[proxy].next_free;
+  } else {
+    if (grid->proxy_count >= grid->proxies_capacity) {
+      grid->proxies_capacity *= GRID_GROW_FACTOR;
+      grid->proxies = realloc(grid->proxies, sizeof(grid_proxy_t) *
+                                                 grid->proxies_capacity);
+      assert(grid->proxies != NULL);
+    }
+    proxy = grid->proxy_count++;
+  }
+  cell_range_t cells = grid_cells(grid, box);
+  grid->proxies[proxy] =
+      (grid_proxy_t){item, box, cells, NO_PROXY, grid->rays};
+  grid_add_cells(grid, proxy, cells, NO_CELLS);
+  return proxy;
+}
+
+void grid_move(grid_t *grid, size_t proxy, aabb_t box) {
+  assert(proxy < grid->proxy_count && grid->proxies[proxy].item != NULL);
+  grid_proxy_t *moved = &grid->proxies[proxy];
+  moved->box = box;
+  cell_range_t cells = grid_cells(grid, box);
+  cell_range_t old = moved->cells;
+  if (cells.min_column == old.min_column &&
+      cells.max_column == old.max_column && cells.min_row == old.min_row &&
+      cells.max_row == old.max_row) {
+    return;
+  }
+  grid_remove_cells(grid, proxy, old, cells);
+  grid_add_cells(grid, proxy, cells, old);
+  moved->cells = cells;
+}
+
+void grid_remove(grid_t *grid, size_t proxy) {
+  assert(proxy < grid->proxy_count && grid->proxies[proxy].item != NULL);
+  grid_remove_cells(grid, proxy, grid->proxies[proxy].cells, NO_CELLS);
+  grid->proxies[proxy].item = NULL;
+  grid->proxies[proxy].next_free = grid->first_free;
+  grid->first_free = proxy;
+}
+
+void grid_query(grid_t *grid, aabb_t box, grid_visitor_t visitor, void *aux) {
+  cell_range_t cells = grid_cells(grid, box);
+  for (size_t row = cells.min_row; row <= cells.max_row; row++) {
+    for (size_t column = cells.min_column; column <= cells.max_column;
+         column++) {
+      grid_cell_t *cell = &grid->cells[row * grid->columns + column];
+      for (size_t i = 0; i < cell->count; i++) {
+        grid_proxy_t *proxy = &grid->proxies[cell->proxies[i]];
+        if (!aabb_overlaps(proxy->box, box)) {
+          continue;
+        }
+        // boxes in several of the cells are only reported from the cell
+        // holding the lower-left corner of their overlap with the query
+        vector_t corner = {fmax(proxy->box.min.x, box.min.x),
+                           fmax(proxy->box.min.y, box.min.y)};
+        if (grid_index(corner.x, grid->min.x, grid->cell_size,
+                       grid->columns) == column &&
+            grid_index(corner.y, grid->min.y, grid->cell_size, grid->rows) ==
+                row) {
+          visitor(proxy->item, aux);
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Visits the proxies in a cell that a ray reaches
+ * and that no earlier cell on the ray has visited.
+ */
+double grid_visit_cell(grid_t *grid, size_t cell_index, vector_t origin,
+                       vector_t inverse, double max_distance,
+                       grid_ray_visitor_t visitor, void *aux) {
+  grid_cell_t *cell = &grid->cells[cell_index];
+  for (size_t i = 0; i < cell->count; i++) {
+    grid_proxy_t *proxy = &grid->proxies[cell->proxies[i]];
+    if (proxy->last_ray == grid->rays) {
+      continue;
+    }
+    proxy->last_ray = grid->rays;
+    if (aabb_ray_distance(proxy->box, origin, inverse, max_distance) !=
+        INFINITY) {
+      max_distance = visitor(proxy->item, max_distance, aux);
+    }
+  }
+  return max_distance;
+}
+
+/**
+ * Gets how far along a ray it first crosses a column or row boundary,
+ * going from one cell to the next along an axis.
+ */
+double grid_first_boundary(double origin, double min, double cell_size,
+                           double index, int step, double inverse) {
+  if (step == 0) {
+    return INFINITY;
+  }
+  double boundary = min + (step > 0 ? index + 1 : index) * cell_size;
+  return (boundary - origin) * inverse;
+}
+
+double grid_cast_ray(grid_t *grid, vector_t origin, vector_t direction,
+                     double max_distance, grid_ray_visitor_t visitor,
+                     void *aux) {
+  grid->rays++;
+  vector_t inverse = {1 / direction.x, 1 / direction.y};
+  // the cell the ray is in, which may be outside the grid,
+  // and how far along the ray it reaches the next column and row
+  double column = floor((origin.x - grid->min.x) / grid->cell_size);
+  double row = floor((origin.y - grid->min.y) / grid->cell_size);
+  int column_step = direction.x > 0 ? 1 : direction.x < 0 ? -1 : 0;
+  int row_step = direction.y > 0 ? 1 : direction.y < 0 ? -1 : 0;
+  double next_column = grid_first_boundary(
+      origin.x, grid->min.x, grid->cell_size, column, column_step, inverse.x);
+  double next_row = grid_first_boundary(origin.y, grid->min.y, grid->cell_size,
+                                        row, row_step, inverse.y);
+  double column_width = fabs(grid->cell_size * inverse.x);
+  double row_height = fabs(grid->cell_size * inverse.y);
+  size_t visited = SIZE_MAX;
+  while (true) {
+    // outside the grid, the ray stays in the nearest border cell
+    size_t cell = grid_clamp(row, grid->rows) * grid->columns +
+                  grid_clamp(column, grid->columns);
+    if (cell != visited) {
+      max_distance = grid_visit_cell(grid, cell, origin, inverse, max_distance,
+                                     visitor, aux);
+      visited = cell;
+    }
+    // once the ray leaves the grid along an axis, it keeps the same
+    // border column or row, so there is nothing new to visit along it
+    if ((column_step < 0 && column <= 0) ||
+        (column_step > 0 && column >= grid->columns - 1)) {
+      next_column = INFINITY;
+    }
+    if ((row_step < 0 && row <= 0) ||
+        (row_step > 0 && row >= grid->rows - 1)) {
+      next_row = INFINITY;
+    }
+    double distance = fmin(next_column, next_row);
+    if (distance == INFINITY || distance > max_distance) {
+      return max_distance;
+    }
+    if (next_column < next_row) {
+      column += column_step;
+      next_column += column_width;
+    } else {
+      row += row_step;
+      next_row += row_height;
+    }
+  }
+}
@@ -8,7 +8,7 @@ size_t GROW_FACTOR = 2;
 typedef struct list {
   void **items;
   size_t size;
-  int capacity;
+  size_t capacity;
   free_func_t freer;
 } list_t;
 
@@ -65,12 +65,60 @@ void *list_remove(list_t *list, size_t index) {
   return elem;
 }
 
+void *list_swap_remove(list_t *list, size_t index) {
+  assert(index < list->size);
+
+  void *elem = list->items[index];
+  list->items[index] = list->items[list->size - 1];
+  list->items[list->size - 1] = NULL;
+  list->size--;
+
+  return elem;
+}
+
+size_t list_remove_if(list_t *list, predicate_t predicate, void *aux) {
+  size_t kept = 0;
+  for (size_t i = 0; i < list->size; i++) {
+    void *item = list->items[i];
+    if (predicate(item, aux)) {
+      if (list->freer != NULL) {
+        list->freer(item);
+      }
+    } else {
+      list->items[kept++] = item;
+    }
+  }
+  size_t removed = list->size - kept;
+  list->size = kept;
+  return removed;
+}
+
+void list_truncate(list_t *list, size_t size) {
+  assert(size <= list->size);
+
+  if (list->freer != NULL) {
+    for (size_t i = size; i < list->size; i++) {
+      list->freer(list->items[i]);
+    }
+  }
+  list->size = size;
+}
+
+void list_reserve(list_t *list, size_t capacity) {
+  if (capacity <= list->capacity) {
+    return;
+  }
+  list->capacity = capacity;
+  list->items = realloc(list->items, sizeof(void *) * list->capacity);
+  assert(list->items != NULL);
+}
+
 void list_add(list_t *list, void *value) {
   assert(value != NULL);
 
   if (list->size >= list->capacity) {
-    list->capacity = list->capacity * GROW_FACTOR;
-    list->items = realloc(list->items, sizeof(void *) * list->capacity);
+    // a list made with no space still needs room for this element
+    list_reserve(list, list->capacity > 0 ? list->capacity * GROW_FACTOR : 1);
   }
 
   list->items[list->size] = value;
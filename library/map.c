@@ -24,96 +24,65 @@ rgb_color_t OBSTACLE_COLOR_1 = {0.76, 0.76, 0.76};
 rgb_color_t OBSTACLE_COLOR_2 = {0.35, 0.35, 0.35};
 rgb_color_t OBSTACLE_COLOR_3 = {0.57, 0.59, 0.60};
 
-list_t *make_rectangle(vector_t corner, double width, double height) {
-    list_t *rectangle = list_init(4, (free_func_t)free);
-    vector_t *point1 = malloc(sizeof(vector_t));
-    assert(point1 != NULL);
-    point1->x = corner.x;
-    point1->y = corner.y;
-    list_add(rectangle, point1);
-    vector_t *point2 = malloc(sizeof(vector_t));
-    assert(point2 != NULL);
-    point2->x = corner.x;
-    point2->y = corner.y - height;
-    list_add(rectangle, point2);
-    vector_t *point3 = malloc(sizeof(vector_t));
-    assert(point3 != NULL);
-    point3->x = corner.x + width;
-    point3->y = corner.y - height;
-    list_add(rectangle, point3);
-    vector_t *point4 = malloc(sizeof(vector_t));
-    assert(point4 != NULL);
-    point4->x = corner.x + width;
-    point4->y = corner.y;
-    list_add(rectangle, point4);
+polygon_t make_rectangle(vector_t corner, double width, double height) {
+    polygon_t rectangle = polygon_init(4);
+    polygon_add(&rectangle, (vector_t){corner.x, corner.y});
+    polygon_add(&rectangle, (vector_t){corner.x, corner.y - height});
+    polygon_add(&rectangle, (vector_t){corner.x + width, corner.y - height});
+    polygon_add(&rectangle, (vector_t){corner.x + width, corner.y});
     return rectangle;
 }
 
-list_t *make_vert_triangle(vector_t bisector_point, double perp_bisector) {
-    list_t *triangle = list_init(3, (free_func_t)free);
-    vector_t *point1 = malloc(sizeof(vector_t));
-    assert(point1 != NULL);
-    point1->x = bisector_point.x + (perp_bisector / sqrt(3));
-    point1->y = bisector_point.y;
-    list_add(triangle, point1);
-    vector_t *point2 = malloc(sizeof(vector_t));
-    assert(point2 != NULL);
-    point2->x = bisector_point.x;
-    point2->y = bisector_point.y + perp_bisector;
-    list_add(triangle, point2);
-    vector_t *point3 = malloc(sizeof(vector_t));
-    assert(point3 != NULL);
-    point3->x = bisector_point.x - (perp_bisector / sqrt(3));
-    point3->y = bisector_point.y;
-    list_add(triangle, point3);
+polygon_t make_vert_triangle(vector_t bisector_point, double perp_bisector) {
+    polygon_t triangle = polygon_init(3);
+    polygon_add(&triangle, (vector_t){bisector_point.x + (perp_bisector / sqrt(3)),
+                                      bisector_point.y});
+    polygon_add(&triangle, (vector_t){bisector_point.x,
+                                      bisector_point.y + perp_bisector});
+    polygon_add(&triangle, (vector_t){bisector_point.x - (perp_bisector / sqrt(3)),
+                                      bisector_point.y});
     return triangle;
 }
 
-list_t *make_horz_triangle(vector_t bisector_point, double perp_bisector) {
-    list_t *triangle = list_init(3, (free_func_t)free);
-    vector_t *point1 = malloc(sizeof(vector_t));
-    assert(point1 != NULL);
-    point1->x = bisector_point.x;
-    point1->y = bisector_point.y - (perp_bisector / sqrt(3));
-    list_add(triangle, point1);
-    vector_t *point2 = malloc(sizeof(vector_t));
-    assert(point2 != NULL);
-    point2->x = bisector_point.x + perp_bisector;
-    point2->y = bisector_point.y;
-    list_add(triangle, point2);
-    vector_t *point3 = malloc(sizeof(vector_t));
-    assert(point3 != NULL);
-    point3->x = bisector_point.x;
-    point3->y = bisector_point.y + (perp_bisector / sqrt(3));
-    list_add(triangle, point3);
+polygon_t make_horz_triangle(vector_t bisector_point, double perp_bisector) {
+    polygon_t triangle = polygon_init(3);
+    polygon_add(&triangle, (vector_t){bisector_point.x,
+                                      bisector_point.y - (perp_bisector / sqrt(3))});
+    polygon_add(&triangle, (vector_t){bisector_point.x + perp_bisector,
+                                      bisector_point.y});
+    polygon_add(&triangle, (vector_t){bisector_point.x,
+                                      bisector_point.y + (perp_bisector / sqrt(3))});
     return triangle;
 }
 
 void spawn_rectangle(scene_t *scene, vector_t corner, double width, double height, rgb_color_t color) {
-    list_t *points = make_rectangle(corner, width, height);
-    int *type = malloc(sizeof(int));
+    polygon_t points = make_rectangle(corner, width, height);
+    size_t *type = malloc(sizeof(size_t));
     *type = RECTANGLE_OBSTACLE_TYPE;
     body_t *rectangle = body_init_with_info(points, OBSTACLE_MASS, color, type,
                                             (free_func_t)free);
-    scene_add_body(scene, rectangle);
+    body_set_collision_layers(rectangle, OBSTACLE_LAYER, TANK_LAYER | BULLET_LAYER);
+    scene_add_static_body(scene, rectangle);
 }
 
 void spawn_vert_triangle(scene_t *scene, vector_t bisector_point, double perp_bisector, rgb_color_t color) {
-    list_t *points = make_vert_triangle(bisector_point, perp_bisector);
-    int *type = malloc(sizeof(int));
+    polygon_t points = make_vert_triangle(bisector_point, perp_bisector);
+    size_t *type = malloc(sizeof(size_t));
     *type = TRIANGLE_OBSTACLE_TYPE;
     body_t *triangle = body_init_with_info(points, OBSTACLE_MASS, color, type,
                                             (free_func_t)free);
-    scene_add_body(scene, triangle);
+    body_set_collision_layers(triangle, OBSTACLE_LAYER, TANK_LAYER | BULLET_LAYER);
+    scene_add_static_body(scene, triangle);
 }
 
 void spawn_horz_triangle(scene_t *scene, vector_t bisector_point, double perp_bisector, rgb_color_t color) {
-    list_t *points = make_horz_triangle(bisector_point, perp_bisector);
-    int *type = malloc(sizeof(int));
+    polygon_t points = make_horz_triangle(bisector_point, perp_bisector);
+    size_t *type = malloc(sizeof(size_t));
     *type = TRIANGLE_OBSTACLE_TYPE;
     body_t *triangle = body_init_with_info(points, OBSTACLE_MASS, color, type,
                                             (free_func_t)free);
-    scene_add_body(scene, triangle);
+    body_set_collision_layers(triangle, OBSTACLE_LAYER, TANK_LAYER | BULLET_LAYER);
+    scene_add_static_body(scene, triangle);
 }
 
 void map_init(scene_t *scene) {
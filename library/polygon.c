@@ -1,73 +1,186 @@
 #include "polygon.h"
-#include "list.h"
+#include "simd.h"
 #include <assert.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
-double polygon_area(list_t *polygon) {
-  // shoelace method
-  double sum = 0.0;
-  for (size_t i = 0; i < list_size(polygon) - 1; i++) {
-    vector_t *cur = list_get(polygon, i);
-    vector_t *nxt = list_get(polygon, i + 1);
+size_t POLYGON_GROW_FACTOR = 2;
+
+// the number of heap allocations of vertices, see polygon_allocation_count()
+size_t allocation_count = 0;
 
-    double first = cur->x * nxt->y;
-    double second = cur->y * nxt->x;
-    sum += first - second;
+polygon_t polygon_init(size_t initial_size) {
+  polygon_t polygon;
+  polygon.size = 0;
+  polygon.capacity = POLYGON_INLINE_SIZE;
+  polygon.heap = NULL;
+  if (initial_size > POLYGON_INLINE_SIZE) {
+    polygon.capacity = initial_size;
+    polygon.heap = malloc(initial_size * sizeof(vector_t));
+    assert(polygon.heap != NULL);
+    allocation_count++;
   }
-  vector_t *cur = list_get(polygon, list_size(polygon) - 1);
-  vector_t *nxt = list_get(polygon, 0);
+  return polygon;
+}
 
-  double first = cur->x * nxt->y;
-  double second = cur->y * nxt->x;
-  sum += first - second;
-  return fabs(sum / 2);
+void polygon_free(polygon_t *polygon) {
+  free(polygon->heap);
+  polygon->heap = NULL;
+  polygon->size = 0;
+  polygon->capacity = POLYGON_INLINE_SIZE;
 }
 
-vector_t polygon_centroid(list_t *polygon) {
-  double center_x = 0.0;
-  for (size_t i = 0; i < list_size(polygon) - 1; i++) {
-    vector_t *cur = list_get(polygon, i);
-    vector_t *nxt = list_get(polygon, i + 1);
-    center_x += (cur->x + nxt->x) * vec_cross(*cur, *nxt);
+polygon_t polygon_copy(const polygon_t *polygon) {
+  polygon_t copy = polygon_init(polygon->size);
+  memcpy(polygon_points(&copy), polygon_points(polygon),
+         polygon->size * sizeof(vector_t));
+  copy.size = polygon->size;
+  return copy;
+}
+
+void polygon_clear(polygon_t *polygon) { polygon->size = 0; }
+
+size_t polygon_allocation_count(void) { return allocation_count; }
+
+size_t polygon_size(const polygon_t *polygon) { return polygon->size; }
+
+vector_t *polygon_points(const polygon_t *polygon) {
+  if (polygon->heap != NULL) {
+    return polygon->heap;
   }
-  vector_t *cur = list_get(polygon, list_size(polygon) - 1);
-  vector_t *nxt = list_get(polygon, 0);
-  center_x += (cur->x + nxt->x) * vec_cross(*cur, *nxt);
-  center_x = center_x / (6 * polygon_area(polygon));
+  return (vector_t *)polygon->inline_points;
+}
 
-  double center_y = 0.0;
-  for (size_t i = 0; i < list_size(polygon) - 1; i++) {
-    vector_t *cur = list_get(polygon, i);
-    vector_t *nxt = list_get(polygon, i + 1);
-    center_y += (cur->y + nxt->y) * vec_cross(*cur, *nxt);
+vector_t polygon_get(const polygon_t *polygon, size_t index) {
+  assert(index < polygon->size);
+  return polygon_points(polygon)[index];
+}
+
+void polygon_add(polygon_t *polygon, vector_t point) {
+  if (polygon->size >= polygon->capacity) {
+    size_t capacity = polygon->capacity * POLYGON_GROW_FACTOR;
+    if (polygon->heap == NULL) {
+      polygon->heap = malloc(capacity * sizeof(vector_t));
+      assert(polygon->heap != NULL);
+      memcpy(polygon->heap, polygon->inline_points,
+             polygon->size * sizeof(vector_t));
+    } else {
+      polygon->heap = realloc(polygon->heap, capacity * sizeof(vector_t));
+      assert(polygon->heap != NULL);
+    }
+    allocation_count++;
+    polygon->capacity = capacity;
   }
-  vector_t *cur2 = list_get(polygon, list_size(polygon) - 1);
-  vector_t *nxt2 = list_get(polygon, 0);
-  center_y += (cur2->y + nxt2->y) * vec_cross(*cur, *nxt);
-  center_y = center_y / (6 * polygon_area(polygon));
+  polygon_points(polygon)[polygon->size] = point;
+  polygon->size++;
+}
 
-  vector_t center = {center_x, center_y};
+double polygon_area(const polygon_t *polygon) {
+  // shoelace method
+  vector_t *points = polygon_points(polygon);
+  size_t size = polygon->size;
+  double sum = 0.0;
+  for (size_t i = 0; i < size; i++) {
+    vector_t cur = points[i];
+    vector_t nxt = points[(i + 1) % size];
+    sum += cur.x * nxt.y - cur.y * nxt.x;
+  }
+  return fabs(sum / 2);
+}
+
+vector_t polygon_centroid(const polygon_t *polygon) {
+  vector_t *points = polygon_points(polygon);
+  size_t size = polygon->size;
+  double center_x = 0.0;
+  double center_y = 0.0;
+  for (size_t i = 0; i < size; i++) {
+    vector_t cur = points[i];
+    vector_t nxt = points[(i + 1) % size];
+    double cross = vec_cross(cur, nxt);
+    center_x += (cur.x + nxt.x) * cross;
+    center_y += (cur.y + nxt.y) * cross;
+  }
+  double area = polygon_area(polygon);
+  vector_t center = {center_x / (6 * area), center_y / (6 * area)};
   return center;
 }
 
-void polygon_translate(list_t *polygon, vector_t translation) {
-  for (size_t i = 0; i < list_size(polygon); i++) {
-    vector_t *vector = list_get(polygon, i);
-    vector_t translated = vec_add(*vector, translation);
-    vector->x = translated.x;
-    vector->y = translated.y;
+aabb_t polygon_bounds(const polygon_t *polygon) {
+  assert(polygon->size > 0);
+  vector_t *points = polygon_points(polygon);
+  aabb_t bounds = {points[0], points[0]};
+  for (size_t i = 1; i < polygon->size; i++) {
+    bounds.min.x = fmin(bounds.min.x, points[i].x);
+    bounds.min.y = fmin(bounds.min.y, points[i].y);
+    bounds.max.x = fmax(bounds.max.x, points[i].x);
+    bounds.max.y = fmax(bounds.max.y, points[i].y);
   }
+  return bounds;
+}
+
+bool aabb_overlaps(aabb_t a, aabb_t b) {
+  return a.min.x <= b.max.x && b.min.x <= a.max.x && a.min.y <= b.max.y &&
+         b.min.y <= a.max.y;
 }
 
-void polygon_rotate(list_t *polygon, double angle, vector_t point) {
-  for (size_t i = 0; i < list_size(polygon); i++) {
-    vector_t *vector = list_get(polygon, i);
-    vector_t subtracted = vec_subtract(*vector, point);
-    vector_t rotated = vec_rotate(subtracted, angle);
-    vector_t final = vec_add(rotated, point);
-    vector->x = final.x;
-    vector->y = final.y;
+/**
+ * Narrows [*enter, *exit], the part of a ray inside a box so far,
+ * to the part between the box's sides along one axis.
+ * A ray parallel to the sides gives infinite distances to them,
+ * so it misses unless it is between them (NaN, if it is on one,
+ * fails every comparison and leaves the range alone).
+ * Comparisons rather than fmin() and fmax(), which are library calls.
+ */
+void clip_slab(double origin, double inverse, double min, double max,
+               double *enter, double *exit) {
+  double near = (min - origin) * inverse;
+  double far = (max - origin) * inverse;
+  if (near > far) {
+    double temp = near;
+    near = far;
+    far = temp;
+  }
+  if (near > *enter) {
+    *enter = near;
+  }
+  if (far < *exit) {
+    *exit = far;
   }
 }
+
+double aabb_ray_distance(aabb_t box, vector_t origin,
+                         vector_t inverse_direction, double max_distance) {
+  double enter = 0.0;
+  double exit = max_distance;
+  clip_slab(origin.x, inverse_direction.x, box.min.x, box.max.x, &enter,
+            &exit);
+  clip_slab(origin.y, inverse_direction.y, box.min.y, box.max.y, &enter,
+            &exit);
+  return enter <= exit ? enter : INFINITY;
+}
+
+void polygon_translate(polygon_t *polygon, vector_t translation) {
+  points_translate(polygon_points(polygon), polygon->size, translation);
+}
+
+void polygon_rotate(polygon_t *polygon, double angle, vector_t point) {
+  points_rotate(polygon_points(polygon), polygon->size, angle, point);
+}
+
+void points_translate(vector_t *points, size_t count, vector_t translation) {
+  simd_kernels_get()->translate(points, count, translation);
+}
+
+void points_rotate(vector_t *points, size_t count, double angle,
+                   vector_t point) {
+  simd_kernels_get()->transform(points, points, count, cos(angle), sin(angle),
+                                point, point);
+}
+
+void points_place(vector_t *out, const vector_t *local, size_t count,
+                  double angle, vector_t position) {
+  simd_kernels_get()->transform(out, local, count, cos(angle), sin(angle),
+                                VEC_ZERO, position);
+}
@@ -0,0 +1,99 @@
+#include "pool.h"
+#include <assert.h>
+#include <stdalign.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+const size_t POOL_SLABS_INITIAL_SIZE = 4;
+const size_t POOL_SLABS_GROW_FACTOR = 2;
+
+/** A released record, which holds the next one on the free list. */
+typedef struct free_record {
+  struct free_record *next;
+} free_record_t;
+
+typedef struct pool {
+  // rounded up so every record in a slab stays aligned
+  size_t record_size;
+  size_t slab_records;
+  free_record_t *free_list;
+  void **slabs;
+  size_t slab_count;
+  size_t slabs_capacity;
+  size_t live;
+  size_t peak;
+} pool_t;
+
+pool_t *pool_init(size_t record_size, size_t slab_records) {
+  assert(record_size > 0 && slab_records > 0);
+  pool_t *pool = malloc(sizeof(pool_t));
+  assert(pool != NULL);
+  size_t alignment = alignof(max_align_t);
+  if (record_size < sizeof(free_record_t)) {
+    record_size = sizeof(free_record_t);
+  }
+  pool->record_size = (record_size + alignment - 1) / alignment * alignment;
+  pool->slab_records = slab_records;
+  pool->free_list = NULL;
+  pool->slabs_capacity = POOL_SLABS_INITIAL_SIZE;
+  pool->slabs = malloc(sizeof(void *) * pool->slabs_capacity);
+  assert(pool->slabs != NULL);
+  pool->slab_count = 0;
+  pool->live = 0;
+  pool->peak = 0;
+  return pool;
+}
+
+void pool_free(pool_t *pool) {
+  for (size_t i = 0; i < pool->slab_count; i++) {
+    free(pool->slabs[i]);
+  }
+  free(pool->slabs);
+  free(pool);
+}
+
+/** Allocates a slab and puts all of its records on the free list. */
+void pool_add_slab(pool_t *pool) {
+  if (pool->slab_count >= pool->slabs_capacity) {
+    pool->slabs_capacity *= POOL_SLABS_GROW_FACTOR;
+    pool->slabs = realloc(pool->slabs, sizeof(void *) * pool->slabs_capacity);
+    assert(pool->slabs != NULL);
+  }
+  char *slab = malloc(pool->record_size * pool->slab_records);
+  assert(slab != NULL);
+  pool->slabs[pool->slab_count++] = slab;
+  // pushed in reverse, so records are handed out in address order
+  for (size_t i = pool->slab_records; i > 0; i--) {
+    free_record_t *record = (free_record_t *)(slab + (i - 1) * pool->record_size);
+    record->next = pool->free_list;
+    pool->free_list = record;
+  }
+}
+
+void *pool_alloc(pool_t *pool) {
+  if (pool->free_list == NULL) {
+    pool_add_slab(pool);
+  }
+  free_record_t *record = pool->free_list;
+  pool->free_list = record->next;
+  pool->live++;
+  if (pool->live > pool->peak) {
+    pool->peak = pool->live;
+  }
+  return record;
+}
+
+void pool_release(pool_t *pool, void *record) {
+  if (record == NULL) {
+    return;
+  }
+  assert(pool->live > 0);
+  free_record_t *released = record;
+  released->next = pool->free_list;
+  pool->free_list = released;
+  pool->live--;
+}
+
+pool_stats_t pool_get_stats(pool_t *pool) {
+  return (pool_stats_t){pool->live, pool->peak, pool->slab_count};
+}
@@ -0,0 +1,227 @@
+#include "quadtree.h"
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+// coincident masses can never be split apart, so nodes stop splitting here
+#define QUADTREE_MAX_DEPTH 40
+// each node visited pops one entry and pushes at most four
+#define QUADTREE_STACK_SIZE (3 * QUADTREE_MAX_DEPTH + 4)
+
+const size_t QUADTREE_LEAF_SIZE = 8;
+const size_t QUADTREE_INITIAL_SIZE = 16;
+const size_t QUADTREE_GROW_FACTOR = 2;
+
+typedef struct quadtree_node {
+  vector_t center_of_mass;
+  double mass;
+  // the side length of the node's square
+  double size;
+  // for a leaf, the first of its count masses; otherwise count is 0
+  // and its children are the nodes [first, first + children)
+  size_t first;
+  size_t count;
+  size_t children;
+} quadtree_node_t;
+
+typedef struct quadtree {
+  quadtree_node_t *nodes;
+  size_t node_count;
+  size_t nodes_capacity;
+  // a copy of the masses, grouped by leaf
+  vector_t *points;
+  double *masses;
+  size_t items_capacity;
+} quadtree_t;
+
+quadtree_t *quadtree_init(void) {
+  quadtree_t *tree = malloc(sizeof(quadtree_t));
+  assert(tree != NULL);
+  tree->node_count = 0;
+  tree->nodes_capacity = QUADTREE_INITIAL_SIZE;
+  tree->nodes = malloc(sizeof(quadtree_node_t) * tree->nodes_capacity);
+  tree->items_capacity = QUADTREE_INITIAL_SIZE;
+  tree->points = malloc(sizeof(vector_t) * tree->items_capacity);
+  tree->masses = malloc(sizeof(double) * tree->items_capacity);
+  assert(tree->nodes != NULL && tree->points != NULL && tree->masses != NULL);
+  return tree;
+}
+
+void quadtree_free(quadtree_t *tree) {
+  free(tree->nodes);
+  free(tree->points);
+  free(tree->masses);
+  free(tree);
+}
+
+/** Makes room for another count nodes and returns the first of them. */
+size_t quadtree_add_nodes(quadtree_t *tree, size_t count) {
+  while (tree->node_count + count > tree->nodes_capacity) {
+    tree->nodes_capacity *= QUADTREE_GROW_FACTOR;
+    tree->nodes = realloc(tree->nodes,
+                          sizeof(quadtree_node_t) * tree->nodes_capacity);
+    assert(tree->nodes != NULL);
+  }
+  size_t first = tree->node_count;
+  tree->node_count += count;
+  return first;
+}
+
+/**
+ * Reorders the masses [start, end) so those below split along one axis
+ * come first, returning the index of the first of the rest.
+ */
+size_t quadtree_partition(quadtree_t *tree, size_t start, size_t end,
+                          bool vertical, double split) {
+  vector_t *points = tree->points;
+  double *masses = tree->masses;
+  while (start < end) {
+    if ((vertical ? points[start].y : points[start].x) < split) {
+      start++;
+      continue;
+    }
+    end--;
+    vector_t point = points[start];
+    points[start] = points[end];
+    points[end] = point;
+    double mass = masses[start];
+    masses[start] = masses[end];
+    masses[end] = mass;
+  }
+  return start;
+}
+
+/**
+ * Fills in a node for the masses [start, end) in the square
+ * with the given lower-left corner and side length,
+ * building the subtree under it.
+ */
+void quadtree_build_node(quadtree_t *tree, size_t node, size_t start,
+                         size_t end, vector_t corner, double size,
+                         size_t depth) {
+  double half = size / 2;
+  vector_t middle = {corner.x + half, corner.y + half};
+  double mass = 0.0;
+  vector_t weighted = VEC_ZERO;
+  size_t first;
+  size_t count = 0;
+  size_t children = 0;
+  if (end - start <= QUADTREE_LEAF_SIZE || depth >= QUADTREE_MAX_DEPTH) {
+    for (size_t i = start; i < end; i++) {
+      mass += tree->masses[i];
+      weighted.x += tree->masses[i] * tree->points[i].x;
+      weighted.y += tree->masses[i] * tree->points[i].y;
+    }
+    first = start;
+    count = end - start;
+  } else {
+    // the quadrants in order: lower left, lower right, upper left, upper right
+    size_t bounds[5] = {start, 0, 0, 0, end};
+    bounds[2] = quadtree_partition(tree, start, end, true, middle.y);
+    bounds[1] = quadtree_partition(tree, start, bounds[2], false, middle.x);
+    bounds[3] = quadtree_partition(tree, bounds[2], end, false, middle.x);
+    for (size_t quadrant = 0; quadrant < 4; quadrant++) {
+      children += bounds[quadrant] < bounds[quadrant + 1];
+    }
+    // the children are added before any grandchildren, so they are adjacent
+    first = quadtree_add_nodes(tree, children);
+    size_t child = first;
+    for (size_t quadrant = 0; quadrant < 4; quadrant++) {
+      if (bounds[quadrant] == bounds[quadrant + 1]) {
+        continue;
+      }
+      vector_t child_corner = {quadrant % 2 == 0 ? corner.x : middle.x,
+                               quadrant / 2 == 0 ? corner.y : middle.y};
+      quadtree_build_node(tree, child, bounds[quadrant], bounds[quadrant + 1],
+                          child_corner, half, depth + 1);
+      quadtree_node_t *built = &tree->nodes[child];
+      mass += built->mass;
+      weighted.x += built->mass * built->center_of_mass.x;
+      weighted.y += built->mass * built->center_of_mass.y;
+      child++;
+    }
+  }
+  // massless nodes pull on nothing, wherever their center is put
+  vector_t center_of_mass =
+      mass > 0 ? (vector_t){weighted.x / mass, weighted.y / mass} : middle;
+  tree->nodes[node] =
+      (quadtree_node_t){center_of_mass, mass, size, first, count, children};
+}
+
+void quadtree_build(quadtree_t *tree, const vector_t *points,
+                    const double *masses, size_t count) {
+  if (count > tree->items_capacity) {
+    while (count > tree->items_capacity) {
+      tree->items_capacity *= QUADTREE_GROW_FACTOR;
+    }
+    tree->points =
+        realloc(tree->points, sizeof(vector_t) * tree->items_capacity);
+    tree->masses = realloc(tree->masses, sizeof(double) * tree->items_capacity);
+    assert(tree->points != NULL && tree->masses != NULL);
+  }
+  tree->node_count = 0;
+  if (count == 0) {
+    return;
+  }
+
+  vector_t min = points[0];
+  vector_t max = points[0];
+  for (size_t i = 0; i < count; i++) {
+    tree->points[i] = points[i];
+    tree->masses[i] = masses[i];
+    min.x = points[i].x < min.x ? points[i].x : min.x;
+    min.y = points[i].y < min.y ? points[i].y : min.y;
+    max.x = points[i].x > max.x ? points[i].x : max.x;
+    max.y = points[i].y > max.y ? points[i].y : max.y;
+  }
+  double width = max.x - min.x;
+  double height = max.y - min.y;
+  quadtree_build_node(tree, quadtree_add_nodes(tree, 1), 0, count, min,
+                      width > height ? width : height, 0);
+}
+
+vector_t quadtree_field(quadtree_t *tree, vector_t point, double theta,
+                        double min_distance) {
+  vector_t field = VEC_ZERO;
+  if (tree->node_count == 0) {
+    return field;
+  }
+  double theta_squared = theta * theta;
+  double min_squared = min_distance * min_distance;
+  size_t stack[QUADTREE_STACK_SIZE];
+  size_t top = 0;
+  stack[top++] = 0;
+  while (top > 0) {
+    quadtree_node_t *node = &tree->nodes[stack[--top]];
+    if (node->children == 0) {
+      for (size_t i = node->first; i < node->first + node->count; i++) {
+        double dx = tree->points[i].x - point.x;
+        double dy = tree->points[i].y - point.y;
+        double squared = dx * dx + dy * dy;
+        if (squared >= min_squared && squared > 0) {
+          double scale = tree->masses[i] / (squared * sqrt(squared));
+          field.x += dx * scale;
+          field.y += dy * scale;
+        }
+      }
+      continue;
+    }
+
+    double dx = node->center_of_mass.x - point.x;
+    double dy = node->center_of_mass.y - point.y;
+    double squared = dx * dx + dy * dy;
+    if (node->size * node->size < theta_squared * squared) {
+      if (squared >= min_squared) {
+        double scale = node->mass / (squared * sqrt(squared));
+        field.x += dx * scale;
+        field.y += dy * scale;
+      }
+      continue;
+    }
+    for (size_t i = 0; i < node->children; i++) {
+      stack[top++] = node->first + i;
+    }
+  }
+  return field;
+}
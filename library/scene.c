@@ -1,34 +1,370 @@
 #include "scene.h"
 #include "body.h"
+#include "broadphase.h"
+#include "bvh.h"
+#include "collision.h"
+#include "contacts.h"
 #include "forces.h"
+#include "grid.h"
 #include "list.h"
+#include "pool.h"
+#include "workers.h"
 #include <assert.h>
+#include <math.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 size_t LIST_SIZE = 10000;
+const size_t CONTACTS_INITIAL_SIZE = 64;
+const size_t CONTACTS_GROW_FACTOR = 2;
+// about the size of a tank, so most bodies only touch a few cells
+const double BROADPHASE_CELL_SIZE = 80.0;
+// fewer candidate pairs per worker than this are tested on one thread,
+// since waking the others would cost more than it saves
+const size_t MIN_PAIRS_PER_WORKER = 64;
+const size_t FORCE_BATCH_INITIAL_SIZE = 16;
+const size_t FORCE_BATCH_GROW_FACTOR = 2;
+const size_t FIELDS_INITIAL_SIZE = 4;
+const size_t FIELDS_GROW_FACTOR = 2;
+// one link per body a record can act on
+#define LINKS_PER_RECORD 2
+// force creators on up to this many bodies keep them inline
+#define FORCE_INLINE_BODIES 2
+// enough for a collision force creator's state and a few more fields
+const size_t SCENE_RECORD_SIZE = 64;
+// enough force creators for a busy game, so most scenes need one slab
+const size_t POOL_SLAB_RECORDS = 256;
+
+const double MAX_WIDTH_GAME = 1600.0;
+const double MAX_HEIGHT_GAME = 1300.0;
+
+typedef struct collision_rule {
+  size_t layer1;
+  size_t layer2;
+  // either handler is called on the first tick of each contact,
+  // or contact_handler is called for the events it subscribed to
+  collision_handler_t handler;
+  contact_handler_t contact_handler;
+  size_t events;
+  void *aux;
+  free_func_t freer;
+} collision_rule_t;
+
+/**
+ * A handler call queued while collisions are being found.
+ * Exactly one of handler and contact_handler is set.
+ */
+typedef struct collision_event {
+  collision_handler_t handler;
+  contact_handler_t contact_handler;
+  void *aux;
+  // oriented so that contact.body1 is passed to the handler first
+  contact_t contact;
+  contact_event_t event;
+  // when the event was queued, so sorting keeps the events
+  // for each handler in the order they were found
+  size_t order;
+} collision_event_t;
+
+/** The earliest time in the tick a bullet hit something. */
+typedef struct bullet_rewind {
+  body_t *bullet;
+  double time;
+} bullet_rewind_t;
+
+/** Two bodies whose bounding boxes overlap, to run the narrow phase on. */
+typedef struct candidate_pair {
+  body_t *body1;
+  body_t *body2;
+} candidate_pair_t;
+
+/** A candidate pair that turned out to be colliding. */
+typedef struct pair_result {
+  size_t pair;
+  collision_info_t collision;
+} pair_result_t;
+
+/**
+ * The collisions one worker found in its share of the candidate pairs,
+ * kept apart from the other workers' until they are merged.
+ */
+typedef struct worker_results {
+  pair_result_t *results;
+  size_t count;
+  size_t capacity;
+  collision_stats_t stats;
+} worker_results_t;
+
+/** The forces that share a kernel, applied together each tick. */
+typedef struct force_batch {
+  force_kernel_t kernel;
+  force_record_t *records;
+  // the records' links to body1 and body2, in the same order;
+  // each link's force is the batch, so the scene can tell them apart
+  force_link_t *links;
+  size_t size;
+  size_t capacity;
+  // set when a record is removed, until the batch is compacted
+  bool has_removed;
+} force_batch_t;
 
 typedef struct scene {
   list_t *bodies;
   list_t *force_infos;
+  // the force creators and the records scene_alloc() hands out,
+  // so adding and removing them reuses memory instead of calling malloc()
+  pool_t *pool;
+  list_t *force_batches;
+  // the force fields and their kernels, in the order they were added
+  force_field_t *fields;
+  field_kernel_t *field_kernels;
+  size_t field_count;
+  size_t fields_capacity;
+  // how bodies are integrated, and how many steps each tick is split into
+  integrator_t integrator;
+  size_t substeps;
+  body_store_t *store;
+  list_t *collision_rules;
+  broadphase_t *broadphase;
+  // the moving bodies, by bounding box, for region queries;
+  // updated after each tick and as bodies are added and removed
+  grid_t *index;
+  // the bodies checked by the broadphase this tick, and their bounds
+  body_t **collidables;
+  aabb_t *collidable_bounds;
+  size_t collidables_capacity;
+  // the pairs to run the narrow phase on this tick,
+  // split between the workers in contiguous runs
+  candidate_pair_t *candidates;
+  size_t candidate_count;
+  size_t candidates_capacity;
+  worker_pool_t *workers;
+  worker_results_t *worker_results;
+  // how many workers share this tick's candidates
+  size_t active_workers;
+  // the pairs touching under some rule or collision force creator,
+  // kept across ticks so handlers can tell new contacts from old ones
+  contact_cache_t *contacts;
+  // the number of ticks so far, for the contacts' first and last ticks
+  size_t tick;
+  // the handler calls found this tick, made once detection is done
+  collision_event_t *events;
+  size_t event_count;
+  size_t events_capacity;
+  // each bullet's hits this tick, so it can be moved back to the first
+  bullet_rewind_t *rewinds;
+  size_t rewinds_capacity;
+  // static bodies are also in bodies, but keep their state in their own
+  // store, which is never ticked, and are found through a tree
+  // that is only rebuilt when static bodies are added or removed
+  list_t *static_bodies;
+  body_store_t *static_store;
+  bvh_t *static_tree;
+  aabb_t *static_bounds;
+  size_t static_bounds_capacity;
+  bool static_dirty;
 } scene_t;
 
 typedef struct force_info {
   force_creator_t forcer;
-  list_t *bodies;
   void *aux;
+  free_func_t freer;
+  // the list passed to scene_add_bodies_force_creator(), if any,
+  // which is freed along with the force creator
+  list_t *body_list;
+  // the bodies the force creator depends on, with one link per body;
+  // these point at the inline arrays unless there are more than fit
+  size_t body_count;
+  body_t **bodies;
+  force_link_t *links;
+  body_t *inline_bodies[FORCE_INLINE_BODIES];
+  force_link_t inline_links[FORCE_INLINE_BODIES];
+  // set once one of its bodies is removed, until the end of the tick
+  bool is_removed;
+  // the scene's pool, which the force creator is returned to when freed
+  pool_t *pool;
 } force_info_t;
 
 void force_free(force_info_t *force_storage) {
-  store_force_free(force_storage->aux);
-  free(force_storage);
+  if (force_storage->freer != NULL) {
+    force_storage->freer(force_storage->aux);
+  }
+  if (force_storage->body_list != NULL) {
+    list_free(force_storage->body_list);
+  }
+  if (force_storage->bodies != force_storage->inline_bodies) {
+    free(force_storage->bodies);
+    free(force_storage->links);
+  }
+  pool_release(force_storage->pool, force_storage);
+}
+
+force_batch_t *force_batch_init(force_kernel_t kernel) {
+  force_batch_t *batch = malloc(sizeof(force_batch_t));
+  assert(batch != NULL);
+  batch->kernel = kernel;
+  batch->size = 0;
+  batch->capacity = FORCE_BATCH_INITIAL_SIZE;
+  batch->records = malloc(sizeof(force_record_t) * batch->capacity);
+  batch->links =
+      malloc(sizeof(force_link_t) * batch->capacity * LINKS_PER_RECORD);
+  assert(batch->records != NULL && batch->links != NULL);
+  batch->has_removed = false;
+  return batch;
+}
+
+void force_batch_free(force_batch_t *batch) {
+  free(batch->records);
+  free(batch->links);
+  free(batch);
+}
+
+/**
+ * Copies a record and its links from one place to another in the batch's
+ * arrays, e.g. from the arrays it is growing out of,
+ * and points its bodies' lists at the copied links.
+ * Nothing may be left at the destination, and the source is dead afterwards.
+ */
+void force_batch_move(force_batch_t *batch, force_record_t *records,
+                      force_link_t *links, size_t from, size_t to) {
+  force_record_t *record = &batch->records[to];
+  *record = records[from];
+  body_t *bodies[LINKS_PER_RECORD] = {record->body1, record->body2};
+  for (size_t i = 0; i < LINKS_PER_RECORD; i++) {
+    if (bodies[i] != NULL) {
+      force_link_t *link = &batch->links[to * LINKS_PER_RECORD + i];
+      *link = links[from * LINKS_PER_RECORD + i];
+      body_move_force_link(bodies[i], link);
+    }
+  }
+}
+
+void force_batch_add(force_batch_t *batch, body_t *body1, body_t *body2,
+                     double constant) {
+  if (batch->size >= batch->capacity) {
+    force_record_t *records = batch->records;
+    force_link_t *links = batch->links;
+    batch->capacity *= FORCE_BATCH_GROW_FACTOR;
+    batch->records = malloc(sizeof(force_record_t) * batch->capacity);
+    batch->links =
+        malloc(sizeof(force_link_t) * batch->capacity * LINKS_PER_RECORD);
+    assert(batch->records != NULL && batch->links != NULL);
+    // the bodies' lists point into the old arrays until each record moves
+    for (size_t i = 0; i < batch->size; i++) {
+      force_batch_move(batch, records, links, i, i);
+    }
+    free(records);
+    free(links);
+  }
+  size_t index = batch->size++;
+  batch->records[index] = (force_record_t){body1, body2, constant};
+  body_t *bodies[LINKS_PER_RECORD] = {body1, body2};
+  for (size_t i = 0; i < LINKS_PER_RECORD; i++) {
+    if (bodies[i] != NULL) {
+      force_link_t *link = &batch->links[index * LINKS_PER_RECORD + i];
+      link->force = batch;
+      body_link_force(bodies[i], link);
+    }
+  }
+}
+
+/**
+ * Marks the record a link belongs to for removal
+ * and unlinks it from its bodies.
+ */
+void force_batch_remove(force_batch_t *batch, force_link_t *link) {
+  size_t index = (link - batch->links) / LINKS_PER_RECORD;
+  force_record_t *record = &batch->records[index];
+  body_t *bodies[LINKS_PER_RECORD] = {record->body1, record->body2};
+  for (size_t i = 0; i < LINKS_PER_RECORD; i++) {
+    if (bodies[i] != NULL) {
+      body_unlink_force(bodies[i],
+                        &batch->links[index * LINKS_PER_RECORD + i]);
+    }
+  }
+  record->body1 = NULL;
+  record->body2 = NULL;
+  batch->has_removed = true;
+}
+
+/** Drops the removed records, keeping the rest in order. */
+void force_batch_compact(force_batch_t *batch) {
+  size_t kept = 0;
+  for (size_t i = 0; i < batch->size; i++) {
+    if (batch->records[i].body1 == NULL) {
+      continue;
+    }
+    if (kept != i) {
+      force_batch_move(batch, batch->records, batch->links, i, kept);
+    }
+    kept++;
+  }
+  batch->size = kept;
+  batch->has_removed = false;
 }
 
-scene_t *scene_init(void) {
+void collision_rule_free(collision_rule_t *rule) {
+  if (rule->freer != NULL) {
+    rule->freer(rule->aux);
+  }
+  free(rule);
+}
+
+scene_t *scene_init(void) { return scene_init_with_threads(1); }
+
+scene_t *scene_init_with_threads(size_t threads) {
   scene_t *scene = malloc(sizeof(scene_t));
   assert(scene != NULL);
   scene->bodies = list_init(LIST_SIZE, (free_func_t)body_free);
   scene->force_infos = list_init(LIST_SIZE, (free_func_t)force_free);
+  size_t record_size = sizeof(force_info_t) > SCENE_RECORD_SIZE
+                           ? sizeof(force_info_t)
+                           : SCENE_RECORD_SIZE;
+  scene->pool = pool_init(record_size, POOL_SLAB_RECORDS);
+  scene->force_batches =
+      list_init(CONTACTS_INITIAL_SIZE, (free_func_t)force_batch_free);
+  scene->fields_capacity = FIELDS_INITIAL_SIZE;
+  scene->fields = malloc(sizeof(force_field_t) * scene->fields_capacity);
+  scene->field_kernels =
+      malloc(sizeof(field_kernel_t) * scene->fields_capacity);
+  assert(scene->fields != NULL && scene->field_kernels != NULL);
+  scene->field_count = 0;
+  scene->integrator = INTEGRATOR_AVERAGE_VELOCITY;
+  scene->substeps = 1;
+  scene->store = body_store_init(LIST_SIZE);
+  scene->collision_rules = list_init(CONTACTS_INITIAL_SIZE,
+                                     (free_func_t)collision_rule_free);
+  scene->broadphase =
+      broadphase_init(VEC_ZERO, (vector_t){MAX_WIDTH_GAME, MAX_HEIGHT_GAME},
+                      BROADPHASE_CELL_SIZE);
+  scene->index =
+      grid_init(VEC_ZERO, (vector_t){MAX_WIDTH_GAME, MAX_HEIGHT_GAME},
+                BROADPHASE_CELL_SIZE);
+  scene->collidables = NULL;
+  scene->collidable_bounds = NULL;
+  scene->collidables_capacity = 0;
+  scene->candidates = NULL;
+  scene->candidate_count = 0;
+  scene->candidates_capacity = 0;
+  scene->workers = worker_pool_init(threads);
+  scene->worker_results =
+      calloc(worker_pool_size(scene->workers), sizeof(worker_results_t));
+  assert(scene->worker_results != NULL);
+  scene->active_workers = 1;
+  scene->contacts = contact_cache_init();
+  scene->tick = 0;
+  scene->events = NULL;
+  scene->event_count = 0;
+  scene->events_capacity = 0;
+  scene->rewinds = NULL;
+  scene->rewinds_capacity = 0;
+  scene->static_bodies = list_init(CONTACTS_INITIAL_SIZE, NULL);
+  scene->static_store = body_store_init(CONTACTS_INITIAL_SIZE);
+  scene->static_tree = bvh_init();
+  scene->static_bounds = NULL;
+  scene->static_bounds_capacity = 0;
+  scene->static_dirty = false;
 
   return scene;
 }
@@ -36,11 +372,38 @@ scene_t *scene_init(void) {
 void scene_free(scene_t *scene) {
   list_free(scene->bodies);
   list_free(scene->force_infos);
+  pool_free(scene->pool);
+  list_free(scene->force_batches);
+  free(scene->fields);
+  free(scene->field_kernels);
+  body_store_free(scene->store);
+  list_free(scene->collision_rules);
+  broadphase_free(scene->broadphase);
+  grid_free(scene->index);
+  free(scene->collidables);
+  free(scene->collidable_bounds);
+  free(scene->candidates);
+  for (size_t i = 0; i < worker_pool_size(scene->workers); i++) {
+    free(scene->worker_results[i].results);
+  }
+  free(scene->worker_results);
+  worker_pool_free(scene->workers);
+  contact_cache_free(scene->contacts);
+  free(scene->events);
+  free(scene->rewinds);
+  list_free(scene->static_bodies);
+  body_store_free(scene->static_store);
+  bvh_free(scene->static_tree);
+  free(scene->static_bounds);
   free(scene);
 }
 
 size_t scene_bodies(scene_t *scene) { return list_size(scene->bodies); }
 
+size_t scene_threads(scene_t *scene) {
+  return worker_pool_size(scene->workers);
+}
+
 body_t *scene_get_body(scene_t *scene, size_t index) {
   assert(index < list_size(scene->bodies));
   assert(index >= 0);
@@ -49,6 +412,16 @@ body_t *scene_get_body(scene_t *scene, size_t index) {
 
 void scene_add_body(scene_t *scene, body_t *body) {
   list_add(scene->bodies, body);
+  body_store_add(scene->store, body);
+  body_set_proxy(body, grid_insert(scene->index, body, body_get_bounds(body)));
+}
+
+void scene_add_static_body(scene_t *scene, body_t *body) {
+  body_set_static(body);
+  list_add(scene->bodies, body);
+  body_store_add(scene->static_store, body);
+  list_add(scene->static_bodies, body);
+  scene->static_dirty = true;
 }
 
 void scene_remove_body(scene_t *scene, size_t index) {
@@ -62,53 +435,945 @@ void scene_add_force_creator(scene_t *scene, force_creator_t forcer, void *aux,
   // list_add(scene->auxes, aux);
 }
 
-void scene_add_bodies_force_creator(scene_t *scene, force_creator_t forcer,
-                                    void *aux, list_t *bodies,
-                                    free_func_t freer) {
-  force_info_t *force_storage = malloc(sizeof(force_info_t));
+/**
+ * Allocates a force creator from the scene's pool and links it to its bodies.
+ * Pairs are stored inline; more bodies than that take two allocations.
+ */
+void add_force_info(scene_t *scene, force_creator_t forcer, void *aux,
+                    list_t *body_list, body_t **bodies, size_t body_count,
+                    free_func_t freer) {
+  force_info_t *force_storage = pool_alloc(scene->pool);
   force_storage->forcer = forcer;
   force_storage->aux = aux;
-  force_storage->bodies = bodies;
+  force_storage->freer = freer;
+  force_storage->body_list = body_list;
+  force_storage->body_count = body_count;
+  if (body_count <= FORCE_INLINE_BODIES) {
+    force_storage->bodies = force_storage->inline_bodies;
+    force_storage->links = force_storage->inline_links;
+  } else {
+    force_storage->bodies = malloc(sizeof(body_t *) * body_count);
+    force_storage->links = malloc(sizeof(force_link_t) * body_count);
+    assert(force_storage->bodies != NULL && force_storage->links != NULL);
+  }
+  for (size_t i = 0; i < body_count; i++) {
+    force_storage->bodies[i] = bodies[i];
+    force_storage->links[i].force = force_storage;
+    body_link_force(bodies[i], &force_storage->links[i]);
+  }
+  force_storage->is_removed = false;
+  force_storage->pool = scene->pool;
 
   list_add(scene->force_infos, force_storage);
 }
 
-void scene_tick(scene_t *scene, double dt) {
-  for (size_t i = 0; i < list_size(scene->force_infos); i++) {
-    force_info_t *force_storage = list_get(scene->force_infos, i);
-    force_creator_t forcer = force_storage->forcer;
-    store_force_t *storage = (store_force_t *)force_storage->aux;
+void scene_add_bodies_force_creator(scene_t *scene, force_creator_t forcer,
+                                    void *aux, list_t *bodies,
+                                    free_func_t freer) {
+  size_t body_count = list_size(bodies);
+  body_t *inline_bodies[FORCE_INLINE_BODIES];
+  body_t **copy = inline_bodies;
+  if (body_count > FORCE_INLINE_BODIES) {
+    copy = malloc(sizeof(body_t *) * body_count);
+    assert(copy != NULL);
+  }
+  for (size_t i = 0; i < body_count; i++) {
+    copy[i] = list_get(bodies, i);
+  }
+  add_force_info(scene, forcer, aux, bodies, copy, body_count, freer);
+  if (copy != inline_bodies) {
+    free(copy);
+  }
+}
+
+void scene_add_pair_force_creator(scene_t *scene, force_creator_t forcer,
+                                  void *aux, body_t *body1, body_t *body2,
+                                  free_func_t freer) {
+  assert(body1 != NULL || body2 == NULL);
+  body_t *bodies[FORCE_INLINE_BODIES] = {body1, body2};
+  size_t body_count = body1 == NULL ? 0 : body2 == NULL ? 1 : 2;
+  add_force_info(scene, forcer, aux, NULL, bodies, body_count, freer);
+}
+
+void *scene_alloc(scene_t *scene, size_t size) {
+  assert(size <= SCENE_RECORD_SIZE);
+  return pool_alloc(scene->pool);
+}
+
+void scene_release(scene_t *scene, void *record) {
+  pool_release(scene->pool, record);
+}
 
-    forcer(storage);
+pool_stats_t scene_get_pool_stats(scene_t *scene) {
+  return pool_get_stats(scene->pool);
+}
+
+void scene_set_integrator(scene_t *scene, integrator_t integrator) {
+  scene->integrator = integrator;
+}
+
+void scene_set_substeps(scene_t *scene, size_t substeps) {
+  assert(substeps > 0);
+  scene->substeps = substeps;
+}
+
+/**
+ * Marks a force creator for removal and unlinks it from its bodies,
+ * so it is no longer found through any of them.
+ */
+void force_remove(force_info_t *force_storage) {
+  for (size_t i = 0; i < force_storage->body_count; i++) {
+    body_unlink_force(force_storage->bodies[i], &force_storage->links[i]);
   }
+  force_storage->is_removed = true;
+}
 
-  for (size_t i = 0; i < list_size(scene->force_infos); i++) {
-    force_info_t *force_storage = list_get(scene->force_infos, i);
+bool force_is_removed(force_info_t *force_storage, void *aux) {
+  return force_storage->is_removed;
+}
+
+void scene_add_batched_force(scene_t *scene, force_kernel_t kernel,
+                             body_t *body1, body_t *body2, double constant) {
+  assert(body1 != NULL);
+  force_batch_t *batch = NULL;
+  for (size_t i = 0; i < list_size(scene->force_batches); i++) {
+    force_batch_t *candidate = list_get(scene->force_batches, i);
+    if (candidate->kernel == kernel) {
+      batch = candidate;
+      break;
+    }
+  }
+  if (batch == NULL) {
+    batch = force_batch_init(kernel);
+    list_add(scene->force_batches, batch);
+  }
+  force_batch_add(batch, body1, body2, constant);
+}
+
+void scene_add_force_field(scene_t *scene, field_kernel_t kernel,
+                           force_field_t field) {
+  if (scene->field_count >= scene->fields_capacity) {
+    scene->fields_capacity *= FIELDS_GROW_FACTOR;
+    scene->fields = realloc(scene->fields,
+                            sizeof(force_field_t) * scene->fields_capacity);
+    scene->field_kernels = realloc(
+        scene->field_kernels, sizeof(field_kernel_t) * scene->fields_capacity);
+    assert(scene->fields != NULL && scene->field_kernels != NULL);
+  }
+  scene->fields[scene->field_count] = field;
+  scene->field_kernels[scene->field_count] = kernel;
+  scene->field_count++;
+}
+
+/** Applies every force field a body is tagged for to it. */
+void scene_apply_body_fields(body_t *body, scene_t *scene) {
+  size_t tags = body_get_tags(body);
+  for (size_t j = 0; j < scene->field_count; j++) {
+    force_field_t *field = &scene->fields[j];
+    if ((tags & field->tags) != 0 && field->source != body) {
+      scene->field_kernels[j](body, field);
+    }
+  }
+}
 
-    list_t *bodies = force_storage->bodies;
-
-    // loop through bodies to see if any are marked as removed
-    for (size_t j = 0; j < list_size(bodies); j++) {
-      body_t *body = list_get(bodies, j);
-      // if body is removed, remove the corresponding force
-      if (body_is_removed(body)) {
-        force_info_t *f = list_remove(scene->force_infos, i);
-        force_free(f);
-        i--;
-        break;
+void scene_apply_fields(scene_t *scene) {
+  if (scene->field_count == 0) {
+    return;
+  }
+  for (size_t i = 0; i < body_store_size(scene->store); i++) {
+    body_t *body = body_store_get(scene->store, i);
+    // bodies with substeps apply their fields as they take them
+    if (body_get_tags(body) == 0 || body_get_substeps(body) > 1) {
+      continue;
+    }
+    scene_apply_body_fields(body, scene);
+  }
+}
+
+/** Drops the force fields whose sources were removed, keeping their order. */
+void scene_remove_fields(scene_t *scene) {
+  size_t kept = 0;
+  for (size_t i = 0; i < scene->field_count; i++) {
+    body_t *source = scene->fields[i].source;
+    if (source == NULL || !body_is_removed(source)) {
+      scene->fields[kept] = scene->fields[i];
+      scene->field_kernels[kept] = scene->field_kernels[i];
+      kept++;
+    }
+  }
+  scene->field_count = kept;
+}
+
+/** Removes the force creator or batched force that a link belongs to. */
+void scene_remove_force(scene_t *scene, force_link_t *link) {
+  for (size_t i = 0; i < list_size(scene->force_batches); i++) {
+    force_batch_t *batch = list_get(scene->force_batches, i);
+    if (link->force == batch) {
+      force_batch_remove(batch, link);
+      return;
+    }
+  }
+  force_remove(link->force);
+}
+
+bool body_is_removed_predicate(body_t *body, void *aux) {
+  return body_is_removed(body);
+}
+
+void scene_add_collision_rule(scene_t *scene, size_t layer1, size_t layer2,
+                              collision_handler_t handler, void *aux,
+                              free_func_t freer) {
+  collision_rule_t *rule = malloc(sizeof(collision_rule_t));
+  assert(rule != NULL);
+  rule->layer1 = layer1;
+  rule->layer2 = layer2;
+  rule->handler = handler;
+  rule->contact_handler = NULL;
+  rule->events = CONTACT_BEGIN;
+  rule->aux = aux;
+  rule->freer = freer;
+  list_add(scene->collision_rules, rule);
+}
+
+void scene_add_contact_rule(scene_t *scene, size_t layer1, size_t layer2,
+                            size_t events, contact_handler_t handler,
+                            void *aux, free_func_t freer) {
+  collision_rule_t *rule = malloc(sizeof(collision_rule_t));
+  assert(rule != NULL);
+  rule->layer1 = layer1;
+  rule->layer2 = layer2;
+  rule->handler = NULL;
+  rule->contact_handler = handler;
+  rule->events = events;
+  rule->aux = aux;
+  rule->freer = freer;
+  list_add(scene->collision_rules, rule);
+}
+
+/** Gets a contact as seen from the other body. */
+contact_t contact_flip(const contact_t *contact) {
+  contact_t flipped = *contact;
+  flipped.body1 = contact->body2;
+  flipped.body2 = contact->body1;
+  flipped.normal = vec_negate(contact->normal);
+  return flipped;
+}
+
+void scene_queue_event(scene_t *scene, collision_event_t event) {
+  if (scene->event_count >= scene->events_capacity) {
+    scene->events_capacity = scene->events_capacity == 0
+                                 ? CONTACTS_INITIAL_SIZE
+                                 : scene->events_capacity *
+                                       CONTACTS_GROW_FACTOR;
+    scene->events = realloc(scene->events, sizeof(collision_event_t) *
+                                               scene->events_capacity);
+    assert(scene->events != NULL);
+  }
+  event.order = scene->event_count;
+  scene->events[scene->event_count++] = event;
+}
+
+void scene_queue_collision(scene_t *scene, body_t *body1, body_t *body2,
+                           collision_info_t collision,
+                           collision_handler_t handler, void *aux) {
+  collision_event_t event;
+  event.handler = handler;
+  event.contact_handler = NULL;
+  event.aux = aux;
+  event.contact = (contact_t){body1,           body2,       collision.axis,
+                              collision.depth, collision.contact,
+                              collision.time,  scene->tick, scene->tick};
+  event.event = CONTACT_BEGIN;
+  scene_queue_event(scene, event);
+}
+
+/**
+ * Queues a call to a rule's handler for an event on a contact,
+ * with the body on the rule's first layer first.
+ */
+void rule_queue(scene_t *scene, collision_rule_t *rule,
+                const contact_t *contact, contact_event_t event,
+                bool forward) {
+  if ((rule->events & event) == 0) {
+    return;
+  }
+  collision_event_t queued;
+  queued.handler = rule->handler;
+  queued.contact_handler = rule->contact_handler;
+  queued.aux = rule->aux;
+  queued.contact = forward ? *contact : contact_flip(contact);
+  queued.event = event;
+  scene_queue_event(scene, queued);
+}
+
+/** Gets the handler an event calls, to group events by. */
+uintptr_t event_handler_key(const collision_event_t *event) {
+  return event->handler != NULL ? (uintptr_t)event->handler
+                                : (uintptr_t)event->contact_handler;
+}
+
+int compare_events(const void *a, const void *b) {
+  const collision_event_t *event1 = a;
+  const collision_event_t *event2 = b;
+  uintptr_t key1 = event_handler_key(event1);
+  uintptr_t key2 = event_handler_key(event2);
+  if (key1 != key2) {
+    return key1 < key2 ? -1 : 1;
+  }
+  return event1->order < event2->order ? -1 : event1->order > event2->order;
+}
+
+/**
+ * Calls the handlers queued this tick, grouped by handler
+ * so each one's code and data stay in cache while it runs.
+ */
+void scene_dispatch_events(scene_t *scene) {
+  if (scene->event_count == 0) {
+    return;
+  }
+  qsort(scene->events, scene->event_count, sizeof(collision_event_t),
+        compare_events);
+  for (size_t i = 0; i < scene->event_count; i++) {
+    collision_event_t *event = &scene->events[i];
+    contact_t *contact = &event->contact;
+    if (event->handler != NULL) {
+      event->handler(contact->body1, contact->body2, contact->normal,
+                     event->aux);
+    } else {
+      event->contact_handler(contact->body1, contact->body2, contact,
+                             event->event, event->aux);
+    }
+  }
+  scene->event_count = 0;
+}
+
+/**
+ * Finds whether a rule covers a pair of bodies,
+ * and if so, whether body1 is on its first layer.
+ */
+bool rule_matches(collision_rule_t *rule, body_t *body1, body_t *body2,
+                  bool *forward) {
+  size_t category1 = body_get_collision_category(body1);
+  size_t category2 = body_get_collision_category(body2);
+  *forward = (category1 & rule->layer1) && (category2 & rule->layer2);
+  bool backward = (category2 & rule->layer1) && (category1 & rule->layer2);
+  return *forward || backward;
+}
+
+contact_event_t scene_record_contact(scene_t *scene, body_t *body1,
+                                     body_t *body2,
+                                     collision_info_t collision) {
+  contact_t *contact =
+      contact_cache_touch(scene->contacts, body1, body2, scene->tick);
+  bool same_order = contact->body1 == body1;
+  contact->normal = same_order ? collision.axis : vec_negate(collision.axis);
+  contact->depth = collision.depth;
+  contact->point = collision.contact;
+  contact->time = collision.time;
+  return contact->first_tick == scene->tick ? CONTACT_BEGIN : CONTACT_PERSIST;
+}
+
+size_t scene_contacts(scene_t *scene) {
+  return contact_cache_size(scene->contacts);
+}
+
+const contact_t *scene_get_contact(scene_t *scene, size_t index) {
+  return contact_cache_get(scene->contacts, index);
+}
+
+const contact_t *scene_find_contact(scene_t *scene, body_t *body1,
+                                    body_t *body2) {
+  return contact_cache_find(scene->contacts, body1, body2);
+}
+
+size_t scene_ticks(scene_t *scene) { return scene->tick; }
+
+/**
+ * Collects the moving bodies on some collision layer,
+ * along with their bounding boxes, for the broadphase.
+ * Returns the number of bodies collected.
+ */
+size_t scene_gather_collidables(scene_t *scene) {
+  size_t count = 0;
+  for (size_t i = 0; i < list_size(scene->bodies); i++) {
+    body_t *body = list_get(scene->bodies, i);
+    if (body_is_static(body) || body_is_removed(body) ||
+        body_get_collision_category(body) == 0) {
+      continue;
+    }
+    if (count >= scene->collidables_capacity) {
+      scene->collidables_capacity = scene->collidables_capacity == 0
+                                        ? CONTACTS_INITIAL_SIZE
+                                        : scene->collidables_capacity *
+                                              CONTACTS_GROW_FACTOR;
+      scene->collidables = realloc(
+          scene->collidables, sizeof(body_t *) * scene->collidables_capacity);
+      scene->collidable_bounds =
+          realloc(scene->collidable_bounds,
+                  sizeof(aabb_t) * scene->collidables_capacity);
+      assert(scene->collidables != NULL && scene->collidable_bounds != NULL);
+    }
+    scene->collidables[count] = body;
+    collision_prepare_body(body);
+    // bullets are checked along their whole path, see body_set_bullet()
+    scene->collidable_bounds[count] = body_is_bullet(body)
+                                          ? body_get_swept_bounds(body)
+                                          : body_get_bounds(body);
+    count++;
+  }
+  return count;
+}
+
+/**
+ * Whether two bodies' layers let them collide
+ * and some collision rule covers them.
+ */
+bool scene_pair_has_rule(scene_t *scene, body_t *body1, body_t *body2) {
+  if ((body_get_collision_category(body1) &
+       body_get_collision_mask(body2)) == 0 ||
+      (body_get_collision_category(body2) &
+       body_get_collision_mask(body1)) == 0) {
+    return false;
+  }
+  for (size_t i = 0; i < list_size(scene->collision_rules); i++) {
+    bool forward;
+    if (rule_matches(list_get(scene->collision_rules, i), body1, body2,
+                     &forward)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Records the contact of two colliding bodies and queues the handlers
+ * of the rules covering them that are subscribed to
+ * whether it began this tick or is continuing.
+ */
+void scene_resolve_pair(scene_t *scene, body_t *body1, body_t *body2,
+                        collision_info_t collision) {
+  contact_event_t event = scene_record_contact(scene, body1, body2, collision);
+  contact_t contact = *scene_find_contact(scene, body1, body2);
+  for (size_t i = 0; i < list_size(scene->collision_rules); i++) {
+    collision_rule_t *rule = list_get(scene->collision_rules, i);
+    bool forward;
+    if (rule_matches(rule, body1, body2, &forward)) {
+      rule_queue(scene, rule, &contact, event,
+                 forward == (contact.body1 == body1));
+    }
+  }
+}
+
+void scene_add_candidate(scene_t *scene, body_t *body1, body_t *body2) {
+  if (scene->candidate_count >= scene->candidates_capacity) {
+    scene->candidates_capacity = scene->candidates_capacity == 0
+                                     ? CONTACTS_INITIAL_SIZE
+                                     : scene->candidates_capacity *
+                                           CONTACTS_GROW_FACTOR;
+    scene->candidates =
+        realloc(scene->candidates,
+                sizeof(candidate_pair_t) * scene->candidates_capacity);
+    assert(scene->candidates != NULL);
+  }
+  scene->candidates[scene->candidate_count++] =
+      (candidate_pair_t){body1, body2};
+}
+
+void worker_results_add(worker_results_t *results, size_t pair,
+                        collision_info_t collision) {
+  if (results->count >= results->capacity) {
+    results->capacity = results->capacity == 0
+                            ? CONTACTS_INITIAL_SIZE
+                            : results->capacity * CONTACTS_GROW_FACTOR;
+    results->results = realloc(results->results,
+                               sizeof(pair_result_t) * results->capacity);
+    assert(results->results != NULL);
+  }
+  results->results[results->count++] = (pair_result_t){pair, collision};
+}
+
+/**
+ * Runs the narrow phase on one worker's share of the candidate pairs.
+ * Only reads the scene and the (prepared) bodies,
+ * writing just to the worker's own results.
+ */
+void narrow_phase_job(size_t worker, void *aux) {
+  scene_t *scene = aux;
+  if (worker >= scene->active_workers) {
+    return;
+  }
+  size_t count = scene->candidate_count;
+  size_t start = count * worker / scene->active_workers;
+  size_t end = count * (worker + 1) / scene->active_workers;
+  worker_results_t *results = &scene->worker_results[worker];
+  results->count = 0;
+  for (size_t i = start; i < end; i++) {
+    candidate_pair_t *pair = &scene->candidates[i];
+    if (!scene_pair_has_rule(scene, pair->body1, pair->body2)) {
+      continue;
+    }
+    collision_info_t collision = find_body_collision(pair->body1, pair->body2);
+    if (collision.collided) {
+      worker_results_add(results, i, collision);
+    }
+  }
+  // the first worker is the scene's own thread, which keeps its counts
+  results->stats = worker == 0 ? (collision_stats_t){0, 0}
+                               : collision_take_stats();
+}
+
+/**
+ * Tests the candidate pairs, on several threads if the scene has them,
+ * then handles the collisions in the order of the pairs,
+ * so the result does not depend on the number of threads.
+ */
+void scene_narrow_phase(scene_t *scene) {
+  size_t workers = worker_pool_size(scene->workers);
+  size_t useful = scene->candidate_count / MIN_PAIRS_PER_WORKER;
+  scene->active_workers = useful < 1 ? 1 : useful < workers ? useful : workers;
+  if (scene->active_workers == 1) {
+    narrow_phase_job(0, scene);
+  } else {
+    worker_pool_run(scene->workers, narrow_phase_job, scene);
+  }
+  for (size_t w = 0; w < scene->active_workers; w++) {
+    worker_results_t *results = &scene->worker_results[w];
+    collision_add_stats(results->stats);
+    for (size_t i = 0; i < results->count; i++) {
+      candidate_pair_t *pair = &scene->candidates[results->results[i].pair];
+      scene_resolve_pair(scene, pair->body1, pair->body2,
+                         results->results[i].collision);
+    }
+  }
+}
+
+/** Whether a contact was not found this tick or has a removed body. */
+bool contact_has_ended(contact_t *contact, scene_t *scene) {
+  return contact->last_tick != scene->tick ||
+         body_is_removed(contact->body1) || body_is_removed(contact->body2);
+}
+
+/**
+ * Queues the handlers subscribed to the end of each contact that ended,
+ * then drops those contacts.
+ * Contacts with removed bodies end now, since the bodies are about to be
+ * freed and their addresses may be reused by new bodies.
+ *
+ * @return the number of contacts that ended
+ */
+size_t scene_end_contacts(scene_t *scene) {
+  size_t ended = 0;
+  for (size_t i = 0; i < contact_cache_size(scene->contacts); i++) {
+    contact_t *contact = contact_cache_get(scene->contacts, i);
+    if (!contact_has_ended(contact, scene)) {
+      continue;
+    }
+    ended++;
+    for (size_t j = 0; j < list_size(scene->collision_rules); j++) {
+      collision_rule_t *rule = list_get(scene->collision_rules, j);
+      bool forward;
+      if (rule_matches(rule, contact->body1, contact->body2, &forward)) {
+        rule_queue(scene, rule, contact, CONTACT_END, forward);
+      }
+    }
+  }
+  if (ended > 0) {
+    contact_cache_remove_if(scene->contacts, (predicate_t)contact_has_ended,
+                            scene);
+  }
+  return ended;
+}
+
+/** Drops a static body that is about to be freed from the static tree. */
+void scene_forget_static_body(scene_t *scene, body_t *body) {
+  for (size_t i = 0; i < list_size(scene->static_bodies); i++) {
+    if (list_get(scene->static_bodies, i) == body) {
+      // the tree is rebuilt anyway, so the order does not matter
+      list_swap_remove(scene->static_bodies, i);
+      break;
+    }
+  }
+  scene->static_dirty = true;
+}
+
+/** Rebuilds the tree of static bodies from their current shapes. */
+void scene_build_static_tree(scene_t *scene) {
+  size_t count = list_size(scene->static_bodies);
+  if (count > scene->static_bounds_capacity) {
+    scene->static_bounds_capacity = count;
+    scene->static_bounds =
+        realloc(scene->static_bounds, sizeof(aabb_t) * count);
+    assert(scene->static_bounds != NULL);
+  }
+  for (size_t i = 0; i < count; i++) {
+    body_t *body = list_get(scene->static_bodies, i);
+    collision_prepare_body(body);
+    scene->static_bounds[i] = body_get_bounds(body);
+  }
+  bvh_build(scene->static_tree, scene->static_bounds, count);
+  scene->static_dirty = false;
+}
+
+/** Finds and handles the collisions covered by the scene's rules. */
+void scene_apply_collision_rules(scene_t *scene) {
+  if (list_size(scene->collision_rules) > 0) {
+    size_t count = scene_gather_collidables(scene);
+    index_pair_t *pairs;
+    size_t pair_count = broadphase_find_pairs(
+        scene->broadphase, scene->collidable_bounds, count, &pairs);
+    scene->candidate_count = 0;
+    for (size_t i = 0; i < pair_count; i++) {
+      scene_add_candidate(scene, scene->collidables[pairs[i].first],
+                          scene->collidables[pairs[i].second]);
+    }
+
+    // static bodies never collide with each other,
+    // so each moving body only needs to check the ones near it
+    if (scene->static_dirty) {
+      scene_build_static_tree(scene);
+    }
+    size_t static_hits = 0;
+    for (size_t i = 0; i < count; i++) {
+      size_t *hits;
+      size_t hit_count = bvh_query(scene->static_tree,
+                                   scene->collidable_bounds[i], &hits);
+      static_hits += hit_count;
+      for (size_t j = 0; j < hit_count; j++) {
+        body_t *body = list_get(scene->static_bodies, hits[j]);
+        if (!body_is_removed(body)) {
+          scene_add_candidate(scene, scene->collidables[i], body);
+        }
+      }
+    }
+    scene_narrow_phase(scene);
+    size_t static_count = list_size(scene->static_bodies);
+    collision_count_culled_pairs(count * (count - 1) / 2 - pair_count +
+                                 count * static_count - static_hits);
+  }
+}
+
+/** Where a ray cast through the scene is going and what it has hit. */
+typedef struct ray_query {
+  scene_t *scene;
+  vector_t origin;
+  vector_t direction;
+  size_t mask;
+  ray_hit_t best;
+} ray_query_t;
+
+/** Tests a ray against the static body in a box it reached. */
+double visit_static_body(size_t item, double max_distance, void *aux) {
+  ray_query_t *query = aux;
+  body_t *body = list_get(query->scene->static_bodies, item);
+  if (!body_is_removed(body) &&
+      (body_get_collision_category(body) & query->mask) != 0) {
+    ray_hit_t hit =
+        find_ray_hit(body, query->origin, query->direction, max_distance);
+    if (hit.body != NULL) {
+      query->best = hit;
+    }
+  }
+  return query->best.distance;
+}
+
+/** Tests a ray against a moving body whose box it reached. */
+double visit_moving_body(void *item, double max_distance, void *aux) {
+  ray_query_t *query = aux;
+  body_t *body = item;
+  if (!body_is_removed(body) &&
+      (body_get_collision_category(body) & query->mask) != 0) {
+    ray_hit_t hit =
+        find_ray_hit(body, query->origin, query->direction, max_distance);
+    if (hit.body != NULL) {
+      query->best = hit;
+    }
+  }
+  return query->best.distance;
+}
+
+ray_hit_t scene_raycast(scene_t *scene, vector_t origin, vector_t direction,
+                        double max_distance, size_t mask) {
+  double length = sqrt(vec_dot(direction, direction));
+  assert(length > 0);
+  direction = vec_multiply(1 / length, direction);
+  ray_query_t query = {scene, origin, direction, mask,
+                       {NULL, VEC_ZERO, VEC_ZERO, max_distance}};
+  grid_cast_ray(scene->index, origin, direction, max_distance,
+                visit_moving_body, &query);
+
+  // the moving bodies go first, so a near one cuts the walls' search short
+  if (scene->static_dirty) {
+    scene_build_static_tree(scene);
+  }
+  bvh_cast_ray(scene->static_tree, origin, direction, query.best.distance,
+               visit_static_body, &query);
+  return query.best;
+}
+
+ray_hit_t scene_segment_query(scene_t *scene, vector_t start, vector_t end,
+                              size_t mask) {
+  vector_t direction = vec_subtract(end, start);
+  double length = sqrt(vec_dot(direction, direction));
+  if (length == 0) {
+    return (ray_hit_t){NULL, start, VEC_ZERO, 0.0};
+  }
+  return scene_raycast(scene, start, direction, length, mask);
+}
+
+/**
+ * Moves the moving bodies' boxes in the index to where the bodies are now.
+ * Bodies that stayed within the same cells cost one comparison.
+ */
+void scene_update_index(scene_t *scene) {
+  for (size_t i = 0; i < body_store_size(scene->store); i++) {
+    body_t *body = body_store_get(scene->store, i);
+    grid_move(scene->index, body_get_proxy(body), body_get_bounds(body));
+  }
+}
+
+/** Where a region query writes what it finds, and what it is looking for. */
+typedef struct region_query {
+  size_t mask;
+  body_t **bodies;
+  size_t capacity;
+  size_t count;
+  // for radius queries, the circle the bodies' shapes must reach into
+  bool round;
+  vector_t center;
+  double radius;
+} region_query_t;
+
+void region_query_visit(void *item, void *aux) {
+  body_t *body = item;
+  region_query_t *query = aux;
+  if (body_is_removed(body) ||
+      (query->mask != SIZE_MAX &&
+       (body_get_collision_category(body) & query->mask) == 0) ||
+      (query->round &&
+       find_point_distance(body, query->center) > query->radius)) {
+    return;
+  }
+  if (query->count < query->capacity) {
+    query->bodies[query->count] = body;
+  }
+  query->count++;
+}
+
+size_t scene_query_region(scene_t *scene, aabb_t box, region_query_t *query) {
+  grid_query(scene->index, box, region_query_visit, query);
+  if (scene->static_dirty) {
+    scene_build_static_tree(scene);
+  }
+  size_t *hits;
+  size_t hit_count = bvh_query(scene->static_tree, box, &hits);
+  for (size_t i = 0; i < hit_count; i++) {
+    region_query_visit(list_get(scene->static_bodies, hits[i]), query);
+  }
+  return query->count;
+}
+
+size_t scene_query_aabb(scene_t *scene, aabb_t box, size_t mask,
+                        body_t **bodies, size_t capacity) {
+  region_query_t query = {mask, bodies, capacity, 0, false, VEC_ZERO, 0.0};
+  return scene_query_region(scene, box, &query);
+}
+
+size_t scene_query_radius(scene_t *scene, vector_t center, double radius,
+                          size_t mask, body_t **bodies, size_t capacity) {
+  region_query_t query = {mask, bodies, capacity, 0, true, center, radius};
+  aabb_t box = {{center.x - radius, center.y - radius},
+                {center.x + radius, center.y + radius}};
+  return scene_query_region(scene, box, &query);
+}
+
+/** Records that a bullet hit something at a time in this tick. */
+void scene_add_rewind(scene_t *scene, size_t *count, body_t *body,
+                      double time) {
+  if (!body_is_bullet(body) || time >= 1.0) {
+    return;
+  }
+  if (*count >= scene->rewinds_capacity) {
+    scene->rewinds_capacity = scene->rewinds_capacity == 0
+                                  ? CONTACTS_INITIAL_SIZE
+                                  : scene->rewinds_capacity *
+                                        CONTACTS_GROW_FACTOR;
+    scene->rewinds = realloc(scene->rewinds, sizeof(bullet_rewind_t) *
+                                                 scene->rewinds_capacity);
+    assert(scene->rewinds != NULL);
+  }
+  scene->rewinds[(*count)++] = (bullet_rewind_t){body, time};
+}
+
+int compare_rewinds(const void *a, const void *b) {
+  const bullet_rewind_t *rewind1 = a;
+  const bullet_rewind_t *rewind2 = b;
+  uintptr_t bullet1 = (uintptr_t)rewind1->bullet;
+  uintptr_t bullet2 = (uintptr_t)rewind2->bullet;
+  if (bullet1 != bullet2) {
+    return bullet1 < bullet2 ? -1 : 1;
+  }
+  return rewind1->time < rewind2->time ? -1 : rewind1->time > rewind2->time;
+}
+
+/**
+ * Moves bullets back to where they first hit something this tick.
+ * Each bullet is moved once, to the earliest of its contacts,
+ * since body_rewind() measures from where the bullet is now.
+ */
+void scene_rewind_bullets(scene_t *scene) {
+  size_t count = 0;
+  for (size_t i = 0; i < contact_cache_size(scene->contacts); i++) {
+    contact_t *contact = contact_cache_get(scene->contacts, i);
+    if (contact->last_tick == scene->tick) {
+      scene_add_rewind(scene, &count, contact->body1, contact->time);
+      scene_add_rewind(scene, &count, contact->body2, contact->time);
+    }
+  }
+  if (count == 0) {
+    return;
+  }
+  // sorted by bullet, so each bullet's earliest hit comes first
+  qsort(scene->rewinds, count, sizeof(bullet_rewind_t), compare_rewinds);
+  for (size_t i = 0; i < count; i++) {
+    if (i == 0 || scene->rewinds[i].bullet != scene->rewinds[i - 1].bullet) {
+      body_rewind(scene->rewinds[i].bullet, scene->rewinds[i].time);
+    }
+  }
+}
+
+/**
+ * Applies the forces that are evaluated at every stage of the integrator:
+ * the batched forces and the force fields.
+ */
+void scene_apply_stage_forces(scene_t *scene) {
+  for (size_t i = 0; i < list_size(scene->force_batches); i++) {
+    force_batch_t *batch = list_get(scene->force_batches, i);
+    batch->kernel(batch->records, batch->size);
+  }
+  scene_apply_fields(scene);
+}
+
+/**
+ * Finds the batch a link to a body belongs to.
+ *
+ * @return the batch, or NULL if the link is a force creator's
+ */
+force_batch_t *scene_find_batch(scene_t *scene, force_link_t *link) {
+  for (size_t i = 0; i < list_size(scene->force_batches); i++) {
+    force_batch_t *batch = list_get(scene->force_batches, i);
+    if (link->force == batch) {
+      return batch;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * Applies the stage forces on a body that takes its own substeps:
+ * the batched forces it is part of and the force fields it is tagged for.
+ * The other body of each batched force keeps the force it had,
+ * since it is integrated with the rest of the scene.
+ */
+void scene_apply_body_forces(body_t *body, scene_t *scene) {
+  for (force_link_t *link = body_get_force_links(body); link != NULL;
+       link = link->next) {
+    force_batch_t *batch = scene_find_batch(scene, link);
+    if (batch == NULL) {
+      continue;
+    }
+    force_record_t *record =
+        &batch->records[(link - batch->links) / LINKS_PER_RECORD];
+    body_t *other = record->body1 == body ? record->body2 : record->body1;
+    vector_t other_force = other != NULL ? body_get_force(other) : VEC_ZERO;
+    batch->kernel(record, 1);
+    if (other != NULL) {
+      body_set_force(other, other_force);
+    }
+  }
+  scene_apply_body_fields(body, scene);
+}
+
+/**
+ * Moves the bodies over a tick with the scene's integrator.
+ * The forces applied so far, by force creators and handlers,
+ * are held for the whole tick; every stage of every step re-evaluates
+ * the batched forces and fields on top of them.
+ */
+void scene_integrate(scene_t *scene, double dt) {
+  integrator_t integrator = scene->integrator;
+  body_store_hold_forces(scene->store);
+  scene_apply_stage_forces(scene);
+  body_store_step_substepped(scene->store, integrator, dt,
+                             (body_force_t)scene_apply_body_forces, scene);
+  size_t stages = integrator_stages(integrator);
+  double step = dt / scene->substeps;
+  for (size_t substep = 0; substep < scene->substeps; substep++) {
+    body_store_begin_step(scene->store, integrator, substep == 0);
+    for (size_t stage = 0; stage < stages; stage++) {
+      if (substep > 0 || stage > 0) {
+        body_store_restore_forces(scene->store);
+        scene_apply_stage_forces(scene);
       }
+      body_store_stage(scene->store, integrator, stage, step);
     }
+    body_store_end_step(scene->store, step);
+  }
+}
+
+void scene_tick(scene_t *scene, double dt) {
+  scene->tick++;
+  // force creators run once a tick, since many of them find collisions;
+  // their forces are held while the rest are re-evaluated (see
+  // scene_integrate())
+  for (size_t i = 0; i < list_size(scene->force_infos); i++) {
+    force_info_t *force_storage = list_get(scene->force_infos, i);
+    force_storage->forcer(force_storage->aux);
   }
 
-  size_t size = list_size(scene->bodies);
-  for (size_t i = 0; i < size; i++) {
-    if (body_is_removed(list_get(scene->bodies, i))) {
-      body_t *body = list_remove(scene->bodies, i);
-      body_free(body);
-      size--;
-      i--;
+  // find every collision before any handler changes the bodies
+  scene_apply_collision_rules(scene);
+  scene_rewind_bullets(scene);
+  scene_end_contacts(scene);
+  scene_dispatch_events(scene);
+  // the handlers may have removed bodies that are still touching others,
+  // and the handlers for the end of those contacts may remove more
+  while (scene_end_contacts(scene) > 0) {
+    scene_dispatch_events(scene);
+  }
+
+  // find the force creators acting on removed bodies through their links,
+  // then compact both lists in one pass each, keeping their order
+  size_t removed = 0;
+  for (size_t i = 0; i < list_size(scene->bodies); i++) {
+    body_t *body = list_get(scene->bodies, i);
+    if (!body_is_removed(body)) {
+      continue;
+    }
+    removed++;
+    // removing a force also unlinks it from this body
+    while (body_get_force_links(body) != NULL) {
+      scene_remove_force(scene, body_get_force_links(body));
+    }
+    if (body_is_static(body)) {
+      scene_forget_static_body(scene, body);
     } else {
-      body_tick(list_get(scene->bodies, i), dt);
+      grid_remove(scene->index, body_get_proxy(body));
     }
   }
+  if (removed > 0) {
+    // before the bodies are freed, since fields point at their sources
+    scene_remove_fields(scene);
+    list_remove_if(scene->force_infos, (predicate_t)force_is_removed, NULL);
+    for (size_t i = 0; i < list_size(scene->force_batches); i++) {
+      force_batch_t *batch = list_get(scene->force_batches, i);
+      if (batch->has_removed) {
+        force_batch_compact(batch);
+      }
+    }
+    list_remove_if(scene->bodies, (predicate_t)body_is_removed_predicate,
+                   NULL);
+  }
+
+  scene_integrate(scene, dt);
+  scene_update_index(scene);
 }
\ No newline at end of file
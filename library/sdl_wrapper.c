@@ -42,10 +42,10 @@ key_handler_t key_handler = NULL;
  */
 uint32_t key_start_timestamp;
 /**
- * The value of clock() when time_since_last_tick() was last called.
- * Initially 0.
+ * The monotonic time in seconds when time_since_last_tick() was last called,
+ * or a negative value if it has not been called yet.
  */
-clock_t last_clock = 0;
+double last_tick_time = -1.0;
 
 SDL_Texture *img = NULL;
 
@@ -235,9 +235,9 @@ void sdl_clear(void) {
   SDL_RenderClear(renderer);
 }
 
-void sdl_draw_polygon(list_t *points, rgb_color_t color) {
+void sdl_draw_polygon(const polygon_t *points, rgb_color_t color) {
   // Check parameters
-  size_t n = list_size(points);
+  size_t n = polygon_size(points);
   assert(n >= 3);
   assert(0 <= color.r && color.r <= 1);
   assert(0 <= color.g && color.g <= 1);
@@ -245,14 +245,19 @@ void sdl_draw_polygon(list_t *points, rgb_color_t color) {
 
   vector_t window_center = get_window_center();
 
-  // Convert each vertex to a point on screen
-  int16_t *x_points = malloc(sizeof(*x_points) * n),
-          *y_points = malloc(sizeof(*y_points) * n);
-  assert(x_points != NULL);
-  assert(y_points != NULL);
+  // Convert each vertex to a point on screen,
+  // only allocating if the polygon doesn't fit in the stack buffers
+  int16_t x_buffer[POLYGON_INLINE_SIZE], y_buffer[POLYGON_INLINE_SIZE];
+  int16_t *x_points = x_buffer, *y_points = y_buffer;
+  if (n > POLYGON_INLINE_SIZE) {
+    x_points = malloc(sizeof(*x_points) * n);
+    y_points = malloc(sizeof(*y_points) * n);
+    assert(x_points != NULL);
+    assert(y_points != NULL);
+  }
+  vector_t *vertices = polygon_points(points);
   for (size_t i = 0; i < n; i++) {
-    vector_t *vertex = list_get(points, i);
-    vector_t pixel = get_window_position(*vertex, window_center);
+    vector_t pixel = get_window_position(vertices[i], window_center);
     x_points[i] = pixel.x;
     y_points[i] = pixel.y;
   }
@@ -260,8 +265,10 @@ void sdl_draw_polygon(list_t *points, rgb_color_t color) {
   // Draw polygon with the given color
   filledPolygonRGBA(renderer, x_points, y_points, n, color.r * 255,
                     color.g * 255, color.b * 255, 255);
-  free(x_points);
-  free(y_points);
+  if (n > POLYGON_INLINE_SIZE) {
+    free(x_points);
+    free(y_points);
+  }
 }
 
 void sdl_show(void) {
@@ -284,24 +291,35 @@ void sdl_show(void) {
 }
 
 void sdl_render_scene(scene_t *scene) {
+  sdl_render_scene_interpolated(scene, 1.0);
+}
+
+void sdl_render_scene_interpolated(scene_t *scene, double alpha) {
   sdl_clear();
   size_t body_count = scene_bodies(scene);
   int *w = malloc(sizeof(int));
   int *h = malloc(sizeof(int));
+  // reused for every body, so drawing does not allocate
+  polygon_t shape = polygon_init(POLYGON_INLINE_SIZE);
   for (size_t i = 0; i < body_count; i++) {
     body_t *body = scene_get_body(scene, i);
-    list_t *shape = body_get_shape(body);
     if (body_get_image_path(body) == NULL) {
-      sdl_draw_polygon(shape, body_get_color(body));
+      if (alpha >= 1.0 || body_is_static(body)) {
+        sdl_draw_polygon(body_peek_shape(body), body_get_color(body));
+      } else {
+        body_get_interpolated_shape(body, alpha, &shape);
+        sdl_draw_polygon(&shape, body_get_color(body));
+      }
     } else {
       img = IMG_LoadTexture(renderer, body_get_image_path(body));
-      double angle = body_get_rotation(body) * -(180 / M_PI); // set the angle.
+      // set the angle.
+      double angle = body_get_interpolated_rotation(body, alpha) * -(180 / M_PI);
       SDL_RendererFlip flip = SDL_FLIP_NONE; // the flip of the texture.
       SDL_QueryTexture(img, NULL, NULL, w, h);
       SDL_Rect texr;
       vector_t window_center = get_window_center();
-      vector_t coord = {body_get_centroid(body).x - 40,
-                        body_get_centroid(body).y + 50};
+      vector_t centroid = body_get_interpolated_centroid(body, alpha);
+      vector_t coord = {centroid.x - 40, centroid.y + 50};
       SDL_Point center = {16, 20};
       vector_t pixel = get_window_position(coord, window_center);
       texr.x = pixel.x;
@@ -310,18 +328,21 @@ void sdl_render_scene(scene_t *scene) {
       texr.h = 40;
       SDL_RenderCopyEx(renderer, img, NULL, &texr, angle, &center, flip);
     }
-    list_free(shape);
   }
+  polygon_free(&shape);
   sdl_show();
 }
 
 void sdl_on_key(key_handler_t handler) { key_handler = handler; }
 
 double time_since_last_tick(void) {
-  clock_t now = clock();
-  double difference = last_clock
-                          ? (double)(now - last_clock) / CLOCKS_PER_SEC
+  // wall time, unlike clock(), which only counts time spent on the CPU
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  double time = now.tv_sec + now.tv_nsec * 1e-9;
+  double difference = last_tick_time >= 0
+                          ? time - last_tick_time
                           : 0.0; // return 0 the first time this is called
-  last_clock = now;
+  last_tick_time = time;
   return difference;
 }
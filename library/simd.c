@@ -0,0 +1,242 @@
+#include "simd.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+// SSE2 and AVX2 kernels are only built for x86; elsewhere
+// (including the WebAssembly build) only the scalar kernels exist
+#if defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+void scalar_translate(vector_t *points, size_t count, vector_t offset) {
+  for (size_t i = 0; i < count; i++) {
+    points[i].x += offset.x;
+    points[i].y += offset.y;
+  }
+}
+
+void scalar_transform(vector_t *out, const vector_t *in, size_t count,
+                      double cosine, double sine, vector_t from, vector_t to) {
+  for (size_t i = 0; i < count; i++) {
+    double x = in[i].x - from.x;
+    double y = in[i].y - from.y;
+    out[i].x = to.x + x * cosine - y * sine;
+    out[i].y = to.y + x * sine + y * cosine;
+  }
+}
+
+void scalar_project(const vector_t *points, size_t count, vector_t axis,
+                    double *min, double *max) {
+  double least = INFINITY;
+  double most = -INFINITY;
+  for (size_t i = 0; i < count; i++) {
+    double proj = points[i].x * axis.x + points[i].y * axis.y;
+    least = proj < least ? proj : least;
+    most = proj > most ? proj : most;
+  }
+  *min = least;
+  *max = most;
+}
+
+#ifdef SIMD_X86
+
+const size_t AVX2_MIN_PROJECT = 8;
+
+// a vector_t is two doubles, so an SSE2 register holds one point
+// and an AVX register holds two
+
+__attribute__((target("sse2"))) void
+sse2_translate(vector_t *points, size_t count, vector_t offset) {
+  double *values = (double *)points;
+  __m128d shift = _mm_set_pd(offset.y, offset.x);
+  for (size_t i = 0; i < count; i++) {
+    __m128d point = _mm_loadu_pd(values + 2 * i);
+    _mm_storeu_pd(values + 2 * i, _mm_add_pd(point, shift));
+  }
+}
+
+/**
+ * Rotates one offset (x, y) held in an SSE2 register:
+ * (x, y) * (cos, cos) + (y, x) * (-sin, sin).
+ */
+__attribute__((target("sse2"))) __m128d sse2_rotate(__m128d offset,
+                                                    __m128d cosine,
+                                                    __m128d sine) {
+  __m128d swapped = _mm_shuffle_pd(offset, offset, 1);
+  return _mm_add_pd(_mm_mul_pd(offset, cosine), _mm_mul_pd(swapped, sine));
+}
+
+__attribute__((target("sse2"))) void
+sse2_transform(vector_t *out, const vector_t *in, size_t count, double cosine,
+               double sine, vector_t from, vector_t to) {
+  const double *source = (const double *)in;
+  double *dest = (double *)out;
+  __m128d cosines = _mm_set1_pd(cosine);
+  __m128d sines = _mm_set_pd(sine, -sine);
+  __m128d origin = _mm_set_pd(from.y, from.x);
+  __m128d target = _mm_set_pd(to.y, to.x);
+  for (size_t i = 0; i < count; i++) {
+    __m128d offset = _mm_sub_pd(_mm_loadu_pd(source + 2 * i), origin);
+    __m128d rotated = sse2_rotate(offset, cosines, sines);
+    _mm_storeu_pd(dest + 2 * i, _mm_add_pd(rotated, target));
+  }
+}
+
+/** Folds the two lanes of a running min and max into one each. */
+__attribute__((target("sse2"))) void sse2_reduce(__m128d least, __m128d most,
+                                                 double *min, double *max) {
+  least = _mm_min_sd(least, _mm_unpackhi_pd(least, least));
+  most = _mm_max_sd(most, _mm_unpackhi_pd(most, most));
+  *min = _mm_cvtsd_f64(least);
+  *max = _mm_cvtsd_f64(most);
+}
+
+__attribute__((target("sse2"))) void sse2_project(const vector_t *points,
+                                                  size_t count, vector_t axis,
+                                                  double *min, double *max) {
+  const double *values = (const double *)points;
+  __m128d axis_x = _mm_set1_pd(axis.x);
+  __m128d axis_y = _mm_set1_pd(axis.y);
+  __m128d least = _mm_set1_pd(INFINITY);
+  __m128d most = _mm_set1_pd(-INFINITY);
+  size_t i = 0;
+  // two points at a time, as (x0, x1) and (y0, y1)
+  for (; i + 2 <= count; i += 2) {
+    __m128d first = _mm_loadu_pd(values + 2 * i);
+    __m128d second = _mm_loadu_pd(values + 2 * i + 2);
+    __m128d xs = _mm_unpacklo_pd(first, second);
+    __m128d ys = _mm_unpackhi_pd(first, second);
+    __m128d proj = _mm_add_pd(_mm_mul_pd(xs, axis_x), _mm_mul_pd(ys, axis_y));
+    least = _mm_min_pd(least, proj);
+    most = _mm_max_pd(most, proj);
+  }
+  sse2_reduce(least, most, min, max);
+  if (i < count) {
+    double proj = points[i].x * axis.x + points[i].y * axis.y;
+    *min = fmin(*min, proj);
+    *max = fmax(*max, proj);
+  }
+}
+
+__attribute__((target("avx2"))) void
+avx2_translate(vector_t *points, size_t count, vector_t offset) {
+  double *values = (double *)points;
+  __m256d shift = _mm256_set_pd(offset.y, offset.x, offset.y, offset.x);
+  size_t i = 0;
+  for (; i + 2 <= count; i += 2) {
+    __m256d pair = _mm256_loadu_pd(values + 2 * i);
+    _mm256_storeu_pd(values + 2 * i, _mm256_add_pd(pair, shift));
+  }
+  sse2_translate(points + i, count - i, offset);
+}
+
+__attribute__((target("avx2"))) void
+avx2_transform(vector_t *out, const vector_t *in, size_t count, double cosine,
+               double sine, vector_t from, vector_t to) {
+  const double *source = (const double *)in;
+  double *dest = (double *)out;
+  __m256d cosines = _mm256_set1_pd(cosine);
+  __m256d sines = _mm256_set_pd(sine, -sine, sine, -sine);
+  __m256d origin = _mm256_set_pd(from.y, from.x, from.y, from.x);
+  __m256d target = _mm256_set_pd(to.y, to.x, to.y, to.x);
+  size_t i = 0;
+  for (; i + 2 <= count; i += 2) {
+    __m256d offset = _mm256_sub_pd(_mm256_loadu_pd(source + 2 * i), origin);
+    // swap x and y within each point
+    __m256d swapped = _mm256_permute_pd(offset, 0x5);
+    __m256d rotated = _mm256_add_pd(_mm256_mul_pd(offset, cosines),
+                                    _mm256_mul_pd(swapped, sines));
+    _mm256_storeu_pd(dest + 2 * i, _mm256_add_pd(rotated, target));
+  }
+  sse2_transform(out + i, in + i, count - i, cosine, sine, from, to);
+}
+
+__attribute__((target("avx2"))) void avx2_project(const vector_t *points,
+                                                  size_t count, vector_t axis,
+                                                  double *min, double *max) {
+  // small shapes are done before the wider registers pay for themselves
+  if (count < AVX2_MIN_PROJECT) {
+    sse2_project(points, count, axis, min, max);
+    return;
+  }
+  const double *values = (const double *)points;
+  __m256d axis_x = _mm256_set1_pd(axis.x);
+  __m256d axis_y = _mm256_set1_pd(axis.y);
+  __m256d least = _mm256_set1_pd(INFINITY);
+  __m256d most = _mm256_set1_pd(-INFINITY);
+  size_t i = 0;
+  // four points at a time, as (x0, x2, x1, x3) and (y0, y2, y1, y3);
+  // the order does not matter for a min and max
+  for (; i + 4 <= count; i += 4) {
+    __m256d first = _mm256_loadu_pd(values + 2 * i);
+    __m256d second = _mm256_loadu_pd(values + 2 * i + 4);
+    __m256d xs = _mm256_unpacklo_pd(first, second);
+    __m256d ys = _mm256_unpackhi_pd(first, second);
+    __m256d proj =
+        _mm256_add_pd(_mm256_mul_pd(xs, axis_x), _mm256_mul_pd(ys, axis_y));
+    least = _mm256_min_pd(least, proj);
+    most = _mm256_max_pd(most, proj);
+  }
+  double tail_min;
+  double tail_max;
+  sse2_project(points + i, count - i, axis, &tail_min, &tail_max);
+  __m128d low_least = _mm_min_pd(_mm256_castpd256_pd128(least),
+                                 _mm256_extractf128_pd(least, 1));
+  __m128d low_most = _mm_max_pd(_mm256_castpd256_pd128(most),
+                                _mm256_extractf128_pd(most, 1));
+  sse2_reduce(low_least, low_most, min, max);
+  *min = fmin(*min, tail_min);
+  *max = fmax(*max, tail_max);
+}
+
+#endif // #ifdef SIMD_X86
+
+const simd_kernels_t SCALAR_KERNELS = {"scalar", scalar_translate,
+                                       scalar_transform, scalar_project};
+#ifdef SIMD_X86
+const simd_kernels_t SSE2_KERNELS = {"sse2", sse2_translate, sse2_transform,
+                                     sse2_project};
+const simd_kernels_t AVX2_KERNELS = {"avx2", avx2_translate, avx2_transform,
+                                     avx2_project};
+#endif
+
+// the supported kernels, filled in by simd_detect(), best last
+const simd_kernels_t *supported_kernels[3];
+size_t supported_count = 0;
+const simd_kernels_t *active_kernels = NULL;
+
+void simd_detect(void) {
+  supported_count = 0;
+  supported_kernels[supported_count++] = &SCALAR_KERNELS;
+#ifdef SIMD_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse2")) {
+    supported_kernels[supported_count++] = &SSE2_KERNELS;
+    if (__builtin_cpu_supports("avx2")) {
+      supported_kernels[supported_count++] = &AVX2_KERNELS;
+    }
+  }
+#endif
+  active_kernels = supported_kernels[supported_count - 1];
+}
+
+const simd_kernels_t *simd_kernels_get(void) {
+  if (active_kernels == NULL) {
+    simd_detect();
+  }
+  return active_kernels;
+}
+
+size_t simd_kernels_supported(const simd_kernels_t *const **kernels) {
+  if (active_kernels == NULL) {
+    simd_detect();
+  }
+  *kernels = supported_kernels;
+  return supported_count;
+}
+
+void simd_kernels_use(const simd_kernels_t *kernels) {
+  active_kernels = kernels;
+}
@@ -7,7 +7,7 @@
 #include <stdlib.h>
 
 typedef struct star {
-  list_t *polygon;
+  polygon_t polygon;
   vector_t *velocity;
   double rotation;
   bool just_moved;
@@ -16,29 +16,23 @@ typedef struct star {
   double b;
 } star_t;
 
-list_t *make_star(vector_t center, double length, int star_points) {
+polygon_t make_star(vector_t center, double length, int star_points) {
 
-  list_t *poly = list_init(star_points * 2, &free);
+  polygon_t poly = polygon_init(star_points * 2);
 
   for (size_t i = 0; i < star_points; i++) {
-    vector_t *top = malloc(sizeof(vector_t));
-    assert(top != NULL);
-    top->x = center.x;
-    top->y = center.y + length;
+    vector_t top = {center.x, center.y + length};
     // using law of sines
     double height_2 = (length * sin(M_PI / ((double)star_points * 2))) /
                       sin(M_PI - M_PI * 3 / 2 / star_points);
-    vector_t *middle = malloc(sizeof(vector_t));
-    assert(middle != NULL);
-    middle->x =
-        center.x - (height_2 * cos(M_PI / 2 - M_PI / (double)star_points));
-    middle->y =
-        center.y + (height_2 * sin(M_PI / 2 - M_PI / (double)star_points));
-    // add to list
-    list_add(poly, top);
-    list_add(poly, middle);
+    vector_t middle = {
+        center.x - (height_2 * cos(M_PI / 2 - M_PI / (double)star_points)),
+        center.y + (height_2 * sin(M_PI / 2 - M_PI / (double)star_points))};
+    // add to polygon
+    polygon_add(&poly, top);
+    polygon_add(&poly, middle);
     // rotate
-    polygon_rotate(poly, -2 * M_PI / ((double)star_points), center);
+    polygon_rotate(&poly, -2 * M_PI / ((double)star_points), center);
   }
 
   return poly;
@@ -70,15 +64,15 @@ star_t *star_init(int vertices, double height, double length, double speed,
 }
 
 void star_translate(star_t *star, vector_t vec) {
-  polygon_translate(star->polygon, vec);
+  polygon_translate(&star->polygon, vec);
 }
 void star_rotate(star_t *star, double angle, vector_t point) {
-  polygon_rotate(star->polygon, angle, point);
+  polygon_rotate(&star->polygon, angle, point);
 }
 
 vector_t *get_star_velocity(star_t *star) { return star->velocity; }
 
-list_t *get_star_polygon(star_t *star) { return star->polygon; }
+polygon_t *get_star_polygon(star_t *star) { return &star->polygon; }
 
 double get_star_rotation(star_t *star) { return star->rotation; }
 
@@ -95,6 +89,6 @@ void set_star_just_moved(star_t *star, bool val) { star->just_moved = val; }
 void star_free(star_t *star) {
   assert(star != NULL);
 
-  list_free(star->polygon);
+  polygon_free(&star->polygon);
   free(star);
 }
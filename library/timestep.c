@@ -0,0 +1,52 @@
+#include "timestep.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+typedef struct timestep {
+  double dt;
+  size_t max_steps;
+  // the time not yet run as a tick, always less than dt between frames
+  double accumulator;
+  double dropped;
+} timestep_t;
+
+timestep_t *timestep_init(double hz, size_t max_steps) {
+  assert(hz > 0 && max_steps > 0);
+  timestep_t *timestep = malloc(sizeof(timestep_t));
+  assert(timestep != NULL);
+  timestep->dt = 1.0 / hz;
+  timestep->max_steps = max_steps;
+  timestep->accumulator = 0.0;
+  timestep->dropped = 0.0;
+  return timestep;
+}
+
+void timestep_free(timestep_t *timestep) { free(timestep); }
+
+double timestep_get_dt(timestep_t *timestep) { return timestep->dt; }
+
+size_t timestep_advance(timestep_t *timestep, double elapsed) {
+  if (elapsed > 0) {
+    timestep->accumulator += elapsed;
+  }
+  size_t steps = 0;
+  while (timestep->accumulator >= timestep->dt &&
+         steps < timestep->max_steps) {
+    timestep->accumulator -= timestep->dt;
+    steps++;
+  }
+  // past the step limit, keep only the partial tick to interpolate
+  if (timestep->accumulator >= timestep->dt) {
+    double behind = timestep->accumulator;
+    timestep->accumulator = fmod(behind, timestep->dt);
+    timestep->dropped += behind - timestep->accumulator;
+  }
+  return steps;
+}
+
+double timestep_get_alpha(timestep_t *timestep) {
+  return timestep->accumulator / timestep->dt;
+}
+
+double timestep_get_dropped(timestep_t *timestep) { return timestep->dropped; }
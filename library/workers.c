@@ -0,0 +1,138 @@
+#include "workers.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+// WebAssembly only has threads when built with -pthread
+#if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
+#define WORKERS_THREADED 1
+#include <pthread.h>
+#endif
+
+typedef struct worker_pool {
+  size_t size;
+#ifdef WORKERS_THREADED
+  // threads[i] runs worker i + 1; worker 0 is whoever calls run
+  pthread_t *threads;
+  pthread_mutex_t lock;
+  // signalled when a job is posted or the pool is stopping
+  pthread_cond_t start;
+  // signalled when the last worker finishes a job
+  pthread_cond_t done;
+  worker_job_t job;
+  void *aux;
+  // bumped for every job, so workers can tell a new one from the last
+  size_t generation;
+  size_t running;
+  bool stopping;
+#endif
+} worker_pool_t;
+
+#ifdef WORKERS_THREADED
+
+typedef struct worker_start {
+  worker_pool_t *pool;
+  size_t index;
+} worker_start_t;
+
+void *worker_main(void *arg) {
+  worker_start_t start = *(worker_start_t *)arg;
+  free(arg);
+  worker_pool_t *pool = start.pool;
+  size_t seen = 0;
+  pthread_mutex_lock(&pool->lock);
+  while (true) {
+    while (pool->generation == seen && !pool->stopping) {
+      pthread_cond_wait(&pool->start, &pool->lock);
+    }
+    if (pool->stopping) {
+      break;
+    }
+    seen = pool->generation;
+    worker_job_t job = pool->job;
+    void *aux = pool->aux;
+    pthread_mutex_unlock(&pool->lock);
+
+    job(start.index, aux);
+
+    pthread_mutex_lock(&pool->lock);
+    if (--pool->running == 0) {
+      pthread_cond_signal(&pool->done);
+    }
+  }
+  pthread_mutex_unlock(&pool->lock);
+  return NULL;
+}
+
+#endif // #ifdef WORKERS_THREADED
+
+worker_pool_t *worker_pool_init(size_t workers) {
+  worker_pool_t *pool = malloc(sizeof(worker_pool_t));
+  assert(pool != NULL);
+#ifdef WORKERS_THREADED
+  pool->size = workers > 0 ? workers : 1;
+  pool->threads = malloc(sizeof(pthread_t) * pool->size);
+  assert(pool->threads != NULL);
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->start, NULL);
+  pthread_cond_init(&pool->done, NULL);
+  pool->job = NULL;
+  pool->aux = NULL;
+  pool->generation = 0;
+  pool->running = 0;
+  pool->stopping = false;
+  for (size_t i = 1; i < pool->size; i++) {
+    worker_start_t *start = malloc(sizeof(worker_start_t));
+    assert(start != NULL);
+    *start = (worker_start_t){pool, i};
+    int error = pthread_create(&pool->threads[i - 1], NULL, worker_main, start);
+    assert(error == 0);
+  }
+#else
+  pool->size = 1;
+#endif
+  return pool;
+}
+
+void worker_pool_free(worker_pool_t *pool) {
+#ifdef WORKERS_THREADED
+  pthread_mutex_lock(&pool->lock);
+  pool->stopping = true;
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->lock);
+  for (size_t i = 1; i < pool->size; i++) {
+    pthread_join(pool->threads[i - 1], NULL);
+  }
+  pthread_mutex_destroy(&pool->lock);
+  pthread_cond_destroy(&pool->start);
+  pthread_cond_destroy(&pool->done);
+  free(pool->threads);
+#endif
+  free(pool);
+}
+
+size_t worker_pool_size(worker_pool_t *pool) { return pool->size; }
+
+void worker_pool_run(worker_pool_t *pool, worker_job_t job, void *aux) {
+  if (pool->size == 1) {
+    job(0, aux);
+    return;
+  }
+#ifdef WORKERS_THREADED
+  pthread_mutex_lock(&pool->lock);
+  pool->job = job;
+  pool->aux = aux;
+  pool->running = pool->size - 1;
+  pool->generation++;
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->lock);
+
+  job(0, aux);
+
+  pthread_mutex_lock(&pool->lock);
+  while (pool->running > 0) {
+    pthread_cond_wait(&pool->done, &pool->lock);
+  }
+  pthread_mutex_unlock(&pool->lock);
+#endif
+}
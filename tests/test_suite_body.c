@@ -7,20 +7,18 @@
 void test_body_init() {
   vector_t v[] = {{1, 1}, {2, 1}, {2, 2}, {1, 2}};
   const size_t VERTICES = sizeof(v) / sizeof(*v);
-  list_t *shape = list_init(VERTICES, free);
+  polygon_t shape = polygon_init(VERTICES);
   for (size_t i = 0; i < VERTICES; i++) {
-    vector_t *list_v = malloc(sizeof(*list_v));
-    *list_v = v[i];
-    list_add(shape, list_v);
+    polygon_add(&shape, v[i]);
   }
   rgb_color_t color = {0, 0.5, 1};
   body_t *body = body_init(shape, 3, color);
-  list_t *shape2 = body_get_shape(body);
-  assert(list_size(shape2) == VERTICES);
+  polygon_t shape2 = body_get_shape(body);
+  assert(polygon_size(&shape2) == VERTICES);
   for (size_t i = 0; i < VERTICES; i++) {
-    assert(vec_isclose(*(vector_t *)list_get(shape2, i), v[i]));
+    assert(vec_isclose(polygon_get(&shape2, i), v[i]));
   }
-  list_free(shape2);
+  polygon_free(&shape2);
   assert(vec_isclose(body_get_centroid(body), (vector_t){1.5, 1.5}));
   assert(vec_equal(body_get_velocity(body), VEC_ZERO));
   assert(body_get_color(body).r == color.r);
@@ -31,16 +29,10 @@ void test_body_init() {
 }
 
 void test_body_setters() {
-  list_t *shape = list_init(3, free);
-  vector_t *v = malloc(sizeof(*v));
-  *v = (vector_t){+1, 0};
-  list_add(shape, v);
-  v = malloc(sizeof(*v));
-  *v = (vector_t){0, +1};
-  list_add(shape, v);
-  v = malloc(sizeof(*v));
-  *v = (vector_t){-1, 0};
-  list_add(shape, v);
+  polygon_t shape = polygon_init(3);
+  polygon_add(&shape, (vector_t){+1, 0});
+  polygon_add(&shape, (vector_t){0, +1});
+  polygon_add(&shape, (vector_t){-1, 0});
   body_t *body = body_init(shape, 1, (rgb_color_t){0, 0, 0});
   body_set_velocity(body, (vector_t){+5, -5});
   assert(vec_equal(body_get_velocity(body), (vector_t){+5, -5}));
@@ -48,36 +40,36 @@ void test_body_setters() {
   body_set_centroid(body, (vector_t){1, 2});
   assert(vec_isclose(body_get_centroid(body), (vector_t){1, 2}));
   shape = body_get_shape(body);
-  assert(list_size(shape) == 3);
+  assert(polygon_size(&shape) == 3);
   assert(
-      vec_isclose(*(vector_t *)list_get(shape, 0), (vector_t){2, 5.0 / 3.0}));
+      vec_isclose(polygon_get(&shape, 0), (vector_t){2, 5.0 / 3.0}));
   assert(
-      vec_isclose(*(vector_t *)list_get(shape, 1), (vector_t){1, 8.0 / 3.0}));
+      vec_isclose(polygon_get(&shape, 1), (vector_t){1, 8.0 / 3.0}));
   assert(
-      vec_isclose(*(vector_t *)list_get(shape, 2), (vector_t){0, 5.0 / 3.0}));
-  list_free(shape);
+      vec_isclose(polygon_get(&shape, 2), (vector_t){0, 5.0 / 3.0}));
+  polygon_free(&shape);
   body_set_rotation(body, M_PI / 2);
   assert(vec_isclose(body_get_centroid(body), (vector_t){1, 2}));
   shape = body_get_shape(body);
-  assert(list_size(shape) == 3);
+  assert(polygon_size(&shape) == 3);
   assert(
-      vec_isclose(*(vector_t *)list_get(shape, 0), (vector_t){4.0 / 3.0, 3}));
+      vec_isclose(polygon_get(&shape, 0), (vector_t){4.0 / 3.0, 3}));
   assert(
-      vec_isclose(*(vector_t *)list_get(shape, 1), (vector_t){1.0 / 3.0, 2}));
+      vec_isclose(polygon_get(&shape, 1), (vector_t){1.0 / 3.0, 2}));
   assert(
-      vec_isclose(*(vector_t *)list_get(shape, 2), (vector_t){4.0 / 3.0, 1}));
-  list_free(shape);
+      vec_isclose(polygon_get(&shape, 2), (vector_t){4.0 / 3.0, 1}));
+  polygon_free(&shape);
   body_set_centroid(body, (vector_t){3, 4});
   assert(vec_isclose(body_get_centroid(body), (vector_t){3, 4}));
   shape = body_get_shape(body);
-  assert(list_size(shape) == 3);
+  assert(polygon_size(&shape) == 3);
   assert(
-      vec_isclose(*(vector_t *)list_get(shape, 0), (vector_t){10.0 / 3.0, 5}));
+      vec_isclose(polygon_get(&shape, 0), (vector_t){10.0 / 3.0, 5}));
   assert(
-      vec_isclose(*(vector_t *)list_get(shape, 1), (vector_t){7.0 / 3.0, 4}));
+      vec_isclose(polygon_get(&shape, 1), (vector_t){7.0 / 3.0, 4}));
   assert(
-      vec_isclose(*(vector_t *)list_get(shape, 2), (vector_t){10.0 / 3.0, 3}));
-  list_free(shape);
+      vec_isclose(polygon_get(&shape, 2), (vector_t){10.0 / 3.0, 3}));
+  polygon_free(&shape);
   body_free(body);
 }
 
@@ -85,19 +77,11 @@ void test_body_tick() {
   const vector_t A = {1, 2};
   const double DT = 1e-6;
   const int STEPS = 1000000;
-  list_t *shape = list_init(4, free);
-  vector_t *v = malloc(sizeof(*v));
-  v->x = v->y = -1;
-  list_add(shape, v);
-  v = malloc(sizeof(*v));
-  *v = (vector_t){+1, -1};
-  list_add(shape, v);
-  v = malloc(sizeof(*v));
-  v->x = v->y = +1;
-  list_add(shape, v);
-  v = malloc(sizeof(*v));
-  *v = (vector_t){-1, +1};
-  list_add(shape, v);
+  polygon_t shape = polygon_init(4);
+  polygon_add(&shape, (vector_t){-1, -1});
+  polygon_add(&shape, (vector_t){+1, -1});
+  polygon_add(&shape, (vector_t){+1, +1});
+  polygon_add(&shape, (vector_t){-1, +1});
   body_t *body = body_init(shape, 1, (rgb_color_t){0, 0, 0});
 
   // Apply constant acceleration and ensure position is (a / 2) * t ** 2
@@ -110,32 +94,24 @@ void test_body_tick() {
   double t = STEPS * DT;
   vector_t new_x = vec_multiply(t * t / 2, A);
   shape = body_get_shape(body);
-  assert(vec_isclose(*(vector_t *)list_get(shape, 0),
+  assert(vec_isclose(polygon_get(&shape, 0),
                      vec_add((vector_t){-1, -1}, new_x)));
-  assert(vec_isclose(*(vector_t *)list_get(shape, 1),
+  assert(vec_isclose(polygon_get(&shape, 1),
                      vec_add((vector_t){+1, -1}, new_x)));
-  assert(vec_isclose(*(vector_t *)list_get(shape, 2),
+  assert(vec_isclose(polygon_get(&shape, 2),
                      vec_add((vector_t){+1, +1}, new_x)));
-  assert(vec_isclose(*(vector_t *)list_get(shape, 3),
+  assert(vec_isclose(polygon_get(&shape, 3),
                      vec_add((vector_t){-1, +1}, new_x)));
-  list_free(shape);
+  polygon_free(&shape);
   body_free(body);
 }
 
 void test_infinite_mass() {
-  list_t *shape = list_init(10, free);
-  vector_t *v = malloc(sizeof(*v));
-  *v = VEC_ZERO;
-  list_add(shape, v);
-  v = malloc(sizeof(*v));
-  *v = (vector_t){+1, 0};
-  list_add(shape, v);
-  v = malloc(sizeof(*v));
-  *v = (vector_t){+1, +1};
-  list_add(shape, v);
-  v = malloc(sizeof(*v));
-  *v = (vector_t){0, +1};
-  list_add(shape, v);
+  polygon_t shape = polygon_init(10);
+  polygon_add(&shape, VEC_ZERO);
+  polygon_add(&shape, (vector_t){+1, 0});
+  polygon_add(&shape, (vector_t){+1, +1});
+  polygon_add(&shape, (vector_t){0, +1});
   body_t *body = body_init(shape, INFINITY, (rgb_color_t){0, 0, 0});
   body_set_velocity(body, (vector_t){2, 3});
   assert(body_get_mass(body) == INFINITY);
@@ -149,16 +125,10 @@ void test_infinite_mass() {
 void test_forces() {
   const double MASS = 10;
   const double DT = 0.1;
-  list_t *shape = list_init(3, free);
-  vector_t *v = malloc(sizeof(*v));
-  *v = (vector_t){+1, 0};
-  list_add(shape, v);
-  v = malloc(sizeof(*v));
-  *v = (vector_t){0, +1};
-  list_add(shape, v);
-  v = malloc(sizeof(*v));
-  *v = (vector_t){-1, 0};
-  list_add(shape, v);
+  polygon_t shape = polygon_init(3);
+  polygon_add(&shape, (vector_t){+1, 0});
+  polygon_add(&shape, (vector_t){0, +1});
+  polygon_add(&shape, (vector_t){-1, 0});
   body_t *body = body_init(shape, MASS, (rgb_color_t){0, 0, 0});
   body_set_centroid(body, VEC_ZERO);
   vector_t old_velocity = {1, -2};
@@ -181,16 +151,10 @@ void test_forces() {
 }
 
 void test_body_remove() {
-  list_t *shape = list_init(3, free);
-  vector_t *v = malloc(sizeof(*v));
-  *v = (vector_t){+1, 0};
-  list_add(shape, v);
-  v = malloc(sizeof(*v));
-  *v = (vector_t){0, +1};
-  list_add(shape, v);
-  v = malloc(sizeof(*v));
-  *v = (vector_t){-1, 0};
-  list_add(shape, v);
+  polygon_t shape = polygon_init(3);
+  polygon_add(&shape, (vector_t){+1, 0});
+  polygon_add(&shape, (vector_t){0, +1});
+  polygon_add(&shape, (vector_t){-1, 0});
   body_t *body = body_init(shape, 1, (rgb_color_t){0, 0, 0});
   assert(!body_is_removed(body));
   body_remove(body);
@@ -201,16 +165,10 @@ void test_body_remove() {
 }
 
 void test_body_info() {
-  list_t *shape = list_init(3, free);
-  vector_t *v = malloc(sizeof(*v));
-  *v = (vector_t){+1, 0};
-  list_add(shape, v);
-  v = malloc(sizeof(*v));
-  *v = (vector_t){0, +1};
-  list_add(shape, v);
-  v = malloc(sizeof(*v));
-  *v = (vector_t){-1, 0};
-  list_add(shape, v);
+  polygon_t shape = polygon_init(3);
+  polygon_add(&shape, (vector_t){+1, 0});
+  polygon_add(&shape, (vector_t){0, +1});
+  polygon_add(&shape, (vector_t){-1, 0});
   int *info = malloc(sizeof(*info));
   *info = 123;
   body_t *body =
@@ -220,16 +178,10 @@ void test_body_info() {
 }
 
 void test_body_info_freer() {
-  list_t *shape = list_init(3, free);
-  vector_t *v = malloc(sizeof(*v));
-  *v = (vector_t){+1, 0};
-  list_add(shape, v);
-  v = malloc(sizeof(*v));
-  *v = (vector_t){0, +1};
-  list_add(shape, v);
-  v = malloc(sizeof(*v));
-  *v = (vector_t){-1, 0};
-  list_add(shape, v);
+  polygon_t shape = polygon_init(3);
+  polygon_add(&shape, (vector_t){+1, 0});
+  polygon_add(&shape, (vector_t){0, +1});
+  polygon_add(&shape, (vector_t){-1, 0});
   list_t *info = list_init(3, free);
   int *info_elem = malloc(sizeof(*info_elem));
   *info_elem = 10;
@@ -248,6 +200,217 @@ void test_body_info_freer() {
   body_free(body);
 }
 
+// Spinning a body for many ticks leaves its shape exactly where one
+// rotation by the total angle would put it
+void test_spin_no_drift() {
+  const double W = 3.0;
+  const double DT = 1e-3;
+  const int STEPS = 100000;
+  polygon_t shape = polygon_init(4);
+  polygon_add(&shape, (vector_t){-1, -2});
+  polygon_add(&shape, (vector_t){+1, -2});
+  polygon_add(&shape, (vector_t){+1, +2});
+  polygon_add(&shape, (vector_t){-1, +2});
+  polygon_t expected = polygon_copy(&shape);
+  body_t *body = body_init(shape, 1, (rgb_color_t){0, 0, 0});
+  body_set_rotation_speed(body, W);
+  for (int i = 0; i < STEPS; i++) {
+    body_tick(body, DT);
+    // querying the shape along the way must not affect the result
+    if (i % 1000 == 0) {
+      body_peek_shape(body);
+    }
+  }
+  polygon_rotate(&expected, body_get_rotation(body), VEC_ZERO);
+  const polygon_t *spun = body_peek_shape(body);
+  for (size_t i = 0; i < 4; i++) {
+    assert(vec_isclose(polygon_get(spun, i), polygon_get(&expected, i)));
+  }
+  polygon_free(&expected);
+
+  // Setting the rotation without rotating keeps the shape where it is
+  polygon_t before = body_get_shape(body);
+  body_set_rotation_empty(body, 0.0);
+  for (size_t i = 0; i < 4; i++) {
+    assert(vec_isclose(polygon_get(body_peek_shape(body), i),
+                       polygon_get(&before, i)));
+  }
+  polygon_free(&before);
+  body_free(body);
+}
+
+// The cached bounds follow the body as it moves, turns and changes shape
+void test_body_bounds() {
+  polygon_t shape = polygon_init(4);
+  polygon_add(&shape, (vector_t){1, 1});
+  polygon_add(&shape, (vector_t){-1, 1});
+  polygon_add(&shape, (vector_t){-1, -1});
+  polygon_add(&shape, (vector_t){1, -1});
+  body_t *body = body_init(shape, 1, (rgb_color_t){0, 0, 0});
+  body_set_velocity(body, (vector_t){2, 0});
+  for (int i = 0; i < 50; i++) {
+    body_set_rotation(body, i * 0.13);
+    body_tick(body, 0.1);
+    if (i % 7 == 0) {
+      body_set_centroid(body, (vector_t){i, -i});
+    }
+    aabb_t expected = polygon_bounds(body_peek_shape(body));
+    aabb_t actual = body_get_bounds(body);
+    assert(vec_isclose(actual.min, expected.min));
+    assert(vec_isclose(actual.max, expected.max));
+  }
+
+  polygon_t triangle = polygon_init(3);
+  polygon_add(&triangle, (vector_t){0, 0});
+  polygon_add(&triangle, (vector_t){6, 0});
+  polygon_add(&triangle, (vector_t){0, 3});
+  body_set_shape(body, triangle);
+  aabb_t expected = polygon_bounds(body_peek_shape(body));
+  aabb_t actual = body_get_bounds(body);
+  assert(vec_isclose(actual.min, expected.min));
+  assert(vec_isclose(actual.max, expected.max));
+  body_free(body);
+}
+
+void test_round_bodies() {
+  body_t *circle = body_init_circle((vector_t){3, 4}, 2, 1,
+                                    (rgb_color_t){0, 0, 0}, NULL, NULL);
+  assert(body_get_shape_type(circle) == SHAPE_CIRCLE);
+  assert(body_get_radius(circle) == 2);
+  assert(vec_equal(body_get_centroid(circle), (vector_t){3, 4}));
+  size_t count;
+  const vector_t *core = body_peek_core(circle, &count);
+  assert(count == 1 && vec_equal(core[0], (vector_t){3, 4}));
+  body_peek_axes(circle, &count);
+  assert(count == 0);
+  aabb_t bounds = body_get_bounds(circle);
+  assert(vec_isclose(bounds.min, (vector_t){1, 2}));
+  assert(vec_isclose(bounds.max, (vector_t){5, 6}));
+  // the outline is only for drawing
+  const polygon_t *outline = body_peek_shape(circle);
+  assert(polygon_size(outline) == ROUND_OUTLINE_POINTS);
+  for (size_t i = 0; i < polygon_size(outline); i++) {
+    vector_t offset = vec_subtract(polygon_get(outline, i), (vector_t){3, 4});
+    assert(isclose(vec_dot(offset, offset), 4));
+  }
+  body_free(circle);
+
+  body_t *capsule = body_init_capsule(VEC_ZERO, (vector_t){4, 0}, 1, 1,
+                                      (rgb_color_t){0, 0, 0}, NULL, NULL);
+  assert(body_get_shape_type(capsule) == SHAPE_CAPSULE);
+  assert(vec_equal(body_get_centroid(capsule), (vector_t){2, 0}));
+  bounds = body_get_bounds(capsule);
+  assert(vec_isclose(bounds.min, (vector_t){-1, -1}));
+  assert(vec_isclose(bounds.max, (vector_t){5, 1}));
+  body_set_rotation(capsule, M_PI / 2);
+  core = body_peek_core(capsule, &count);
+  assert(count == 2);
+  assert(vec_isclose(core[0], (vector_t){2, -2}));
+  assert(vec_isclose(core[1], (vector_t){2, 2}));
+  const vector_t *axes = body_peek_axes(capsule, &count);
+  assert(count == 1 && isclose(fabs(axes[0].x), 1));
+  bounds = body_get_bounds(capsule);
+  assert(vec_isclose(bounds.min, (vector_t){1, -3}));
+  assert(vec_isclose(bounds.max, (vector_t){3, 3}));
+
+  // turning the body without turning its shape keeps the core in place
+  body_set_rotation_empty(capsule, 0);
+  core = body_peek_core(capsule, &count);
+  assert(vec_isclose(core[0], (vector_t){2, -2}));
+
+  polygon_t square = polygon_init(4);
+  polygon_add(&square, (vector_t){3, 1});
+  polygon_add(&square, (vector_t){1, 1});
+  polygon_add(&square, (vector_t){1, -1});
+  polygon_add(&square, (vector_t){3, -1});
+  body_set_shape(capsule, square);
+  assert(body_get_shape_type(capsule) == SHAPE_POLYGON);
+  assert(body_get_radius(capsule) == 0);
+  body_peek_core(capsule, &count);
+  assert(count == 4);
+  body_free(capsule);
+}
+
+// Drawing between ticks places the shape between its last two transforms
+void test_interpolation() {
+  polygon_t shape = polygon_init(4);
+  polygon_add(&shape, (vector_t){-1, -1});
+  polygon_add(&shape, (vector_t){1, -1});
+  polygon_add(&shape, (vector_t){1, 1});
+  polygon_add(&shape, (vector_t){-1, 1});
+  body_t *body = body_init(shape, 1, (rgb_color_t){0, 0, 0});
+  body_set_velocity(body, (vector_t){4, 0});
+  body_set_rotation_speed(body, M_PI);
+  body_tick(body, 0.5);
+  assert(vec_isclose(body_get_interpolated_centroid(body, 0), VEC_ZERO));
+  assert(vec_isclose(body_get_interpolated_centroid(body, 0.25),
+                     (vector_t){0.5, 0}));
+  assert(isclose(body_get_interpolated_rotation(body, 0.5), M_PI / 4));
+  assert(isclose(body_get_interpolated_rotation(body, 1), M_PI / 2));
+
+  polygon_t drawn = polygon_init(1);
+  body_get_interpolated_shape(body, 1, &drawn);
+  const polygon_t *current = body_peek_shape(body);
+  assert(polygon_size(&drawn) == polygon_size(current));
+  for (size_t i = 0; i < polygon_size(current); i++) {
+    assert(vec_isclose(polygon_get(&drawn, i), polygon_get(current, i)));
+  }
+  body_get_interpolated_shape(body, 0.5, &drawn);
+  // halfway: centered at (1, 0) and turned by 45 degrees
+  assert(vec_isclose(polygon_get(&drawn, 0), (vector_t){1, -sqrt(2)}));
+
+  // a set rotation is a teleport, so it is drawn where it is
+  body_set_rotation(body, 3 * M_PI);
+  assert(isclose(body_get_interpolated_rotation(body, 0), 3 * M_PI));
+  polygon_free(&drawn);
+  body_free(body);
+}
+
+polygon_t make_triangle() {
+  polygon_t shape = polygon_init(3);
+  polygon_add(&shape, (vector_t){0, 0});
+  polygon_add(&shape, (vector_t){1, 0});
+  polygon_add(&shape, (vector_t){0, 1});
+  return shape;
+}
+
+// A constant force moves a body x0 + v t + a t^2 / 2 under the exact schemes
+void test_integrators() {
+  const vector_t FORCE = {4, -2};
+  const double MASS = 2, DT = 0.5;
+  integrator_t exact[] = {INTEGRATOR_AVERAGE_VELOCITY,
+                          INTEGRATOR_VELOCITY_VERLET, INTEGRATOR_RK4};
+  for (size_t i = 0; i < sizeof(exact) / sizeof(*exact); i++) {
+    for (size_t substeps = 1; substeps <= 4; substeps++) {
+      body_t *body = body_init(make_triangle(), MASS, (rgb_color_t){0, 0, 0});
+      vector_t start = body_get_centroid(body);
+      body_set_velocity(body, (vector_t){1, 1});
+      body_set_substeps(body, substeps);
+      body_add_force(body, FORCE);
+      body_tick_with(body, exact[i], DT, NULL, NULL);
+      vector_t moved = vec_subtract(body_get_centroid(body), start);
+      // a = F / MASS, so a t^2 / 2 = F t^2 / 4
+      assert(vec_isclose(moved, (vector_t){DT + FORCE.x * DT * DT / 4,
+                                           DT + FORCE.y * DT * DT / 4}));
+      assert(vec_isclose(body_get_velocity(body),
+                         (vector_t){1 + FORCE.x * DT / MASS,
+                                    1 + FORCE.y * DT / MASS}));
+      // the tick starts where the first substep does
+      assert(vec_isclose(body_get_previous_centroid(body), start));
+      body_free(body);
+    }
+  }
+
+  // semi-implicit Euler moves at the new velocity, overshooting by a t^2 / 2
+  body_t *body = body_init(make_triangle(), MASS, (rgb_color_t){0, 0, 0});
+  vector_t start = body_get_centroid(body);
+  body_add_force(body, FORCE);
+  body_tick_with(body, INTEGRATOR_SEMI_IMPLICIT_EULER, DT, NULL, NULL);
+  assert(vec_isclose(vec_subtract(body_get_centroid(body), start),
+                     (vector_t){FORCE.x * DT * DT / 2, FORCE.y * DT * DT / 2}));
+  body_free(body);
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -265,6 +428,11 @@ int main(int argc, char *argv[]) {
   DO_TEST(test_body_remove)
   DO_TEST(test_body_info)
   DO_TEST(test_body_info_freer)
+  DO_TEST(test_spin_no_drift)
+  DO_TEST(test_body_bounds)
+  DO_TEST(test_round_bodies)
+  DO_TEST(test_interpolation)
+  DO_TEST(test_integrators)
 
   puts("body_test PASS");
 }
@@ -0,0 +1,102 @@
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "broadphase.h"
+#include "test_util.h"
+
+const vector_t ARENA_MIN = {0, 0};
+const vector_t ARENA_MAX = {1000, 800};
+const double CELL_SIZE = 50;
+
+aabb_t make_box(double x, double y, double width, double height) {
+  return (aabb_t){{x, y}, {x + width, y + height}};
+}
+
+bool has_pair(index_pair_t *pairs, size_t count, size_t first,
+              size_t second) {
+  for (size_t i = 0; i < count; i++) {
+    if (pairs[i].first == first && pairs[i].second == second) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void test_simple_pairs() {
+  broadphase_t *grid = broadphase_init(ARENA_MIN, ARENA_MAX, CELL_SIZE);
+  aabb_t bounds[] = {
+      make_box(10, 10, 20, 20),
+      make_box(25, 25, 20, 20),  // overlaps box 0
+      make_box(200, 200, 10, 10),
+      make_box(40, 40, 165, 165), // spans many cells, overlaps boxes 1 and 2
+  };
+  index_pair_t *pairs;
+  size_t count = broadphase_find_pairs(grid, bounds, 4, &pairs);
+  assert(count == 3);
+  assert(has_pair(pairs, count, 0, 1));
+  assert(has_pair(pairs, count, 1, 3));
+  assert(has_pair(pairs, count, 2, 3));
+
+  // nothing is left over from the last call
+  count = broadphase_find_pairs(grid, bounds, 1, &pairs);
+  assert(count == 0);
+  broadphase_free(grid);
+}
+
+void test_outside_arena() {
+  broadphase_t *grid = broadphase_init(ARENA_MIN, ARENA_MAX, CELL_SIZE);
+  aabb_t bounds[] = {
+      make_box(-300, -300, 20, 20),
+      make_box(-290, -290, 20, 20),
+      make_box(-100, -100, 20, 20), // clamped to the same cell, but apart
+      make_box(990, 790, 100, 100),
+  };
+  index_pair_t *pairs;
+  size_t count = broadphase_find_pairs(grid, bounds, 4, &pairs);
+  assert(count == 1);
+  assert(has_pair(pairs, count, 0, 1));
+  broadphase_free(grid);
+}
+
+// The grid finds exactly the pairs that checking every pair would find
+void test_matches_all_pairs() {
+  const size_t BOX_COUNT = 500;
+  broadphase_t *grid = broadphase_init(ARENA_MIN, ARENA_MAX, CELL_SIZE);
+  aabb_t *bounds = malloc(sizeof(aabb_t) * BOX_COUNT);
+  srand(3);
+  for (size_t i = 0; i < BOX_COUNT; i++) {
+    bounds[i] = make_box(rand() % 1100 - 50, rand() % 900 - 50,
+                         rand() % 60 + 1, rand() % 60 + 1);
+  }
+  index_pair_t *pairs;
+  size_t count = broadphase_find_pairs(grid, bounds, BOX_COUNT, &pairs);
+  size_t expected = 0;
+  for (size_t i = 0; i < BOX_COUNT; i++) {
+    for (size_t j = i + 1; j < BOX_COUNT; j++) {
+      if (aabb_overlaps(bounds[i], bounds[j])) {
+        expected++;
+        assert(has_pair(pairs, count, i, j));
+      }
+    }
+  }
+  assert(count == expected);
+  free(bounds);
+  broadphase_free(grid);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_simple_pairs)
+  DO_TEST(test_outside_arena)
+  DO_TEST(test_matches_all_pairs)
+
+  puts("broadphase_test PASS");
+}
@@ -0,0 +1,173 @@
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "bvh.h"
+#include "test_util.h"
+
+aabb_t make_box(double x, double y, double width, double height) {
+  return (aabb_t){{x, y}, {x + width, y + height}};
+}
+
+bool has_hit(size_t *hits, size_t count, size_t item) {
+  for (size_t i = 0; i < count; i++) {
+    if (hits[i] == item) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void test_empty_tree() {
+  bvh_t *tree = bvh_init();
+  size_t *hits;
+  assert(bvh_query(tree, make_box(0, 0, 10, 10), &hits) == 0);
+  bvh_build(tree, NULL, 0);
+  assert(bvh_query(tree, make_box(0, 0, 10, 10), &hits) == 0);
+  bvh_free(tree);
+}
+
+void test_simple_query() {
+  bvh_t *tree = bvh_init();
+  aabb_t bounds[] = {make_box(0, 0, 10, 10), make_box(20, 0, 10, 10),
+                     make_box(0, 20, 10, 10)};
+  bvh_build(tree, bounds, 3);
+  size_t *hits;
+  size_t count = bvh_query(tree, make_box(5, 5, 20, 2), &hits);
+  assert(count == 2);
+  assert(has_hit(hits, count, 0));
+  assert(has_hit(hits, count, 1));
+  assert(bvh_query(tree, make_box(40, 40, 5, 5), &hits) == 0);
+
+  // rebuilding replaces the old boxes
+  bvh_build(tree, bounds + 2, 1);
+  count = bvh_query(tree, make_box(0, 0, 30, 30), &hits);
+  assert(count == 1 && hits[0] == 0);
+  bvh_free(tree);
+}
+
+// The tree finds exactly the boxes that checking every box would find
+void test_matches_all_boxes() {
+  const size_t BOX_COUNT = 1000;
+  const size_t QUERY_COUNT = 200;
+  bvh_t *tree = bvh_init();
+  aabb_t *bounds = malloc(sizeof(aabb_t) * BOX_COUNT);
+  srand(5);
+  for (size_t i = 0; i < BOX_COUNT; i++) {
+    // many boxes share a center, to exercise the median split
+    bounds[i] = make_box(rand() % 100 * 10, rand() % 80 * 10, rand() % 40 + 1,
+                         rand() % 40 + 1);
+  }
+  bvh_build(tree, bounds, BOX_COUNT);
+  for (size_t q = 0; q < QUERY_COUNT; q++) {
+    aabb_t box = make_box(rand() % 1000, rand() % 800, rand() % 100,
+                          rand() % 100);
+    size_t *hits;
+    size_t count = bvh_query(tree, box, &hits);
+    size_t expected = 0;
+    for (size_t i = 0; i < BOX_COUNT; i++) {
+      if (aabb_overlaps(bounds[i], box)) {
+        expected++;
+        assert(has_hit(hits, count, i));
+      }
+    }
+    assert(count == expected);
+  }
+  free(bounds);
+  bvh_free(tree);
+}
+
+typedef struct ray_visits {
+  const aabb_t *bounds;
+  bool *visited;
+  vector_t origin;
+  vector_t inverse;
+} ray_visits_t;
+
+/** Visits a box as though the ray hit something at the box's edge. */
+double record_visit(size_t item, double max_distance, void *aux) {
+  ray_visits_t *visits = aux;
+  assert(!visits->visited[item]);
+  visits->visited[item] = true;
+  return fmin(max_distance,
+              aabb_ray_distance(visits->bounds[item], visits->origin,
+                                visits->inverse, max_distance));
+}
+
+double keep_going(size_t item, double max_distance, void *aux) {
+  bool *visited = aux;
+  assert(!visited[item]);
+  visited[item] = true;
+  return max_distance;
+}
+
+// Rays visit exactly the boxes they cross, and find the nearest one
+// however the visitor cuts them short
+void test_cast_ray() {
+  const size_t BOX_COUNT = 1000;
+  const size_t RAY_COUNT = 200;
+  bvh_t *tree = bvh_init();
+  aabb_t *bounds = malloc(sizeof(aabb_t) * BOX_COUNT);
+  bool *visited = calloc(BOX_COUNT, sizeof(bool));
+  srand(6);
+  for (size_t i = 0; i < BOX_COUNT; i++) {
+    bounds[i] = make_box(rand() % 100 * 10, rand() % 80 * 10, rand() % 40 + 1,
+                         rand() % 40 + 1);
+  }
+  bvh_build(tree, bounds, BOX_COUNT);
+
+  // the first box is reached at the end of the ray, but not past it
+  aabb_t first = bounds[0];
+  vector_t origin = {first.min.x - 5, (first.min.y + first.max.y) / 2};
+  assert(bvh_cast_ray(tree, origin, (vector_t){1, 0}, 5, keep_going,
+                      visited) == 5);
+  assert(visited[0]);
+  visited[0] = false;
+  bvh_cast_ray(tree, origin, (vector_t){1, 0}, 4.9, keep_going, visited);
+  bvh_cast_ray(tree, origin, (vector_t){-1, 0}, 1000, keep_going, visited);
+  assert(!visited[0]);
+
+  // rays in every direction, including along the axes
+  for (size_t r = 0; r < RAY_COUNT; r++) {
+    vector_t origin = {rand() % 1000, rand() % 800};
+    double angle = r % 4 == 0 ? M_PI / 2 * (r / 4 % 4) : rand() % 628 / 100.0;
+    vector_t direction = {cos(angle), sin(angle)};
+    vector_t inverse = {1 / direction.x, 1 / direction.y};
+    double max_distance = rand() % 500;
+    double nearest = max_distance;
+    for (size_t i = 0; i < BOX_COUNT; i++) {
+      visited[i] = false;
+      nearest = fmin(nearest, aabb_ray_distance(bounds[i], origin, inverse,
+                                                max_distance));
+    }
+    bvh_cast_ray(tree, origin, direction, max_distance, keep_going, visited);
+    for (size_t i = 0; i < BOX_COUNT; i++) {
+      assert(visited[i] == (aabb_ray_distance(bounds[i], origin, inverse,
+                                              max_distance) <= max_distance));
+      visited[i] = false;
+    }
+    ray_visits_t visits = {bounds, visited, origin, inverse};
+    assert(bvh_cast_ray(tree, origin, direction, max_distance, record_visit,
+                        &visits) == nearest);
+  }
+  free(bounds);
+  free(visited);
+  bvh_free(tree);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_empty_tree)
+  DO_TEST(test_simple_query)
+  DO_TEST(test_matches_all_boxes)
+  DO_TEST(test_cast_ray)
+
+  puts("bvh_test PASS");
+}
@@ -5,4 +5,331 @@
 #include "forces.h"
 #include "test_util.h"
 
-int main(int argc, char *argv[]) { puts("collision tests pass"); }
+polygon_t make_square(vector_t center, double side) {
+  polygon_t square = polygon_init(4);
+  double half = side / 2;
+  polygon_add(&square, (vector_t){center.x + half, center.y + half});
+  polygon_add(&square, (vector_t){center.x - half, center.y + half});
+  polygon_add(&square, (vector_t){center.x - half, center.y - half});
+  polygon_add(&square, (vector_t){center.x + half, center.y - half});
+  return square;
+}
+
+polygon_t make_triangle(vector_t corner) {
+  polygon_t triangle = polygon_init(3);
+  polygon_add(&triangle, corner);
+  polygon_add(&triangle, vec_add(corner, (vector_t){4, 0}));
+  polygon_add(&triangle, vec_add(corner, (vector_t){0, 4}));
+  return triangle;
+}
+
+void test_separated() {
+  polygon_t square1 = make_square(VEC_ZERO, 2);
+  polygon_t square2 = make_square((vector_t){3, 0}, 2);
+  assert(!find_collision(&square1, &square2).collided);
+  assert(!find_collision(&square2, &square1).collided);
+  polygon_free(&square1);
+  polygon_free(&square2);
+}
+
+// The axis points from the first shape to the second, with the overlap depth
+void test_overlap_axis_and_depth() {
+  polygon_t square1 = make_square(VEC_ZERO, 2);
+  polygon_t square2 = make_square((vector_t){1.5, 0.2}, 2);
+  collision_info_t collision = find_collision(&square1, &square2);
+  assert(collision.collided);
+  assert(vec_isclose(collision.axis, (vector_t){1, 0}));
+  assert(isclose(collision.depth, 0.5));
+
+  collision = find_collision(&square2, &square1);
+  assert(collision.collided);
+  assert(vec_isclose(collision.axis, (vector_t){-1, 0}));
+  assert(isclose(collision.depth, 0.5));
+  polygon_free(&square1);
+  polygon_free(&square2);
+}
+
+// A corner poking into a face is the contact point
+void test_contact_point() {
+  polygon_t square = make_square(VEC_ZERO, 2);
+  polygon_t diamond = make_square((vector_t){2.3, 0}, 2);
+  polygon_rotate(&diamond, M_PI / 4, (vector_t){2.3, 0});
+  collision_info_t collision = find_collision(&square, &diamond);
+  assert(collision.collided);
+  assert(vec_isclose(collision.axis, (vector_t){1, 0}));
+  assert(isclose(collision.depth, 1 - (2.3 - sqrt(2))));
+  assert(vec_isclose(collision.contact, (vector_t){2.3 - sqrt(2), 0}));
+  polygon_free(&square);
+  polygon_free(&diamond);
+}
+
+void test_separating_axes() {
+  vector_t axes[4];
+  polygon_t square = make_square(VEC_ZERO, 2);
+  assert(find_separating_axes(&square, axes) == 2);
+  assert(isclose(fabs(vec_cross(axes[0], axes[1])), 1));
+  polygon_t triangle = make_triangle(VEC_ZERO);
+  assert(find_separating_axes(&triangle, axes) == 3);
+  for (size_t i = 0; i < 3; i++) {
+    assert(isclose(vec_dot(axes[i], axes[i]), 1));
+  }
+  polygon_free(&square);
+  polygon_free(&triangle);
+}
+
+// Bodies' cached axes give the same result as the shapes' own edges
+void test_body_collision() {
+  body_t *body1 = body_init(make_square(VEC_ZERO, 2), 1, (rgb_color_t){0});
+  body_t *body2 =
+      body_init(make_triangle((vector_t){0.5, -3}), 1, (rgb_color_t){0});
+  for (int i = 0; i < 100; i++) {
+    body_set_rotation(body1, i * 0.1);
+    body_set_centroid(body2, (vector_t){1.5 + 0.02 * i, -1.5 + 0.01 * i});
+    collision_info_t expected =
+        find_collision(body_peek_shape(body1), body_peek_shape(body2));
+    collision_info_t actual = find_body_collision(body1, body2);
+    assert(actual.collided == expected.collided);
+    if (expected.collided) {
+      assert(isclose(actual.depth, expected.depth));
+      assert(isclose(fabs(vec_dot(actual.axis, expected.axis)), 1));
+    }
+  }
+  body_free(body1);
+  body_free(body2);
+}
+
+// Far apart bodies are rejected by their bounding boxes, before SAT runs
+void test_bounds_early_out() {
+  body_t *body1 = body_init(make_square(VEC_ZERO, 2), 1, (rgb_color_t){0});
+  body_t *body2 =
+      body_init(make_square((vector_t){100, 0}, 2), 1, (rgb_color_t){0});
+  collision_take_stats();
+  assert(!find_body_collision(body1, body2).collided);
+  collision_stats_t stats = collision_take_stats();
+  assert(stats.pairs == 1);
+  assert(stats.sat_tests == 0);
+
+  // a rotated square's box can overlap without the squares touching
+  body_set_centroid(body2, (vector_t){2.3, 2.3});
+  body_set_rotation(body2, M_PI / 4);
+  assert(!find_body_collision(body1, body2).collided);
+  body_set_centroid(body2, (vector_t){1.5, 0});
+  assert(find_body_collision(body1, body2).collided);
+  collision_count_culled_pairs(3);
+  stats = collision_take_stats();
+  assert(stats.pairs == 5);
+  assert(stats.sat_tests == 2);
+  stats = collision_take_stats();
+  assert(stats.pairs == 0 && stats.sat_tests == 0);
+  body_free(body1);
+  body_free(body2);
+}
+
+// A bullet that crossed a thin wall during the tick is caught where it hit
+void test_swept_collision() {
+  body_t *wall =
+      body_init(make_square(VEC_ZERO, 1), INFINITY, (rgb_color_t){0});
+  body_t *bullet =
+      body_init(make_square((vector_t){-10, 0}, 2), 1, (rgb_color_t){0});
+  body_set_velocity(bullet, (vector_t){200, 0});
+  body_tick(bullet, 0.1);
+  assert(vec_isclose(body_get_centroid(bullet), (vector_t){10, 0}));
+  assert(!find_body_collision(bullet, wall).collided);
+
+  body_set_bullet(bullet, true);
+  collision_info_t collision = find_body_collision(bullet, wall);
+  assert(collision.collided);
+  // the bullet's leading edge reaches the wall 8.5 of 20 units along
+  assert(isclose(collision.time, 8.5 / 20));
+  assert(vec_isclose(collision.axis, (vector_t){1, 0}));
+  assert(isclose(collision.contact.x, -0.5));
+  collision = find_body_collision(wall, bullet);
+  assert(collision.collided && isclose(collision.time, 8.5 / 20));
+  assert(vec_isclose(collision.axis, (vector_t){-1, 0}));
+
+  // teleporting is not a sweep
+  body_set_centroid(bullet, (vector_t){10, 0});
+  assert(!find_body_collision(bullet, wall).collided);
+  body_free(wall);
+  body_free(bullet);
+}
+
+body_t *make_circle(vector_t center, double radius) {
+  return body_init_circle(center, radius, 1, (rgb_color_t){0}, NULL, NULL);
+}
+
+body_t *make_capsule(vector_t start, vector_t end, double radius) {
+  return body_init_capsule(start, end, radius, 1, (rgb_color_t){0}, NULL,
+                           NULL);
+}
+
+void bounce_bullet(body_t *bullet, body_t *wall, vector_t axis, void *aux) {
+  (*(size_t *)aux)++;
+  body_set_velocity(bullet, vec_negate(body_get_velocity(bullet)));
+}
+
+// A scene moves a bullet that crossed a wall back to where it hit
+void test_bullet_rewinds_in_scene() {
+  const size_t LAYER_BULLET = 1 << 0, LAYER_WALL = 1 << 1;
+  scene_t *scene = scene_init();
+  body_t *wall =
+      body_init(make_square(VEC_ZERO, 1), INFINITY, (rgb_color_t){0});
+  body_set_collision_layers(wall, LAYER_WALL, LAYER_BULLET);
+  scene_add_static_body(scene, wall);
+  body_t *bullet =
+      body_init(make_square((vector_t){-10, 0}, 2), 1, (rgb_color_t){0});
+  body_set_collision_layers(bullet, LAYER_BULLET, LAYER_WALL);
+  body_set_bullet(bullet, true);
+  body_set_velocity(bullet, (vector_t){200, 0});
+  scene_add_body(scene, bullet);
+  size_t *hits = malloc(sizeof(size_t));
+  *hits = 0;
+  scene_add_collision_rule(scene, LAYER_BULLET, LAYER_WALL, bounce_bullet,
+                           hits, free);
+
+  // the first tick moves the bullet through the wall, the second finds it
+  // there and moves the bullet back before sending it the other way
+  scene_tick(scene, 0.1);
+  assert(vec_isclose(body_get_centroid(bullet), (vector_t){10, 0}));
+  scene_tick(scene, 0.1);
+  assert(*hits == 1);
+  assert(vec_isclose(body_get_centroid(bullet), (vector_t){-21.5, 0}));
+  assert(vec_isclose(body_get_centroid(wall), VEC_ZERO));
+
+  // leaving the wall after touching it is not another hit
+  scene_tick(scene, 0.1);
+  assert(*hits == 1 && scene_contacts(scene) == 0);
+  scene_free(scene);
+}
+
+void test_circle_collision() {
+  body_t *circle1 = make_circle(VEC_ZERO, 1);
+  body_t *circle2 = make_circle((vector_t){1.5, 0}, 1);
+  collision_info_t collision = find_body_collision(circle1, circle2);
+  assert(collision.collided);
+  assert(isclose(collision.depth, 0.5));
+  assert(vec_isclose(collision.axis, (vector_t){1, 0}));
+  assert(vec_isclose(collision.contact, (vector_t){0.5, 0}));
+  body_set_centroid(circle2, (vector_t){1.5, 1.5});
+  assert(!find_body_collision(circle1, circle2).collided);
+
+  // a circle is round all the way to the square's corner
+  body_t *square = body_init(make_square(VEC_ZERO, 2), 1, (rgb_color_t){0});
+  body_set_centroid(circle2, (vector_t){1.6, 1.6});
+  collision = find_body_collision(square, circle2);
+  assert(collision.collided);
+  assert(isclose(collision.depth, 1 - 0.6 * sqrt(2)));
+  assert(vec_isclose(collision.axis, (vector_t){sqrt(0.5), sqrt(0.5)}));
+  body_set_centroid(circle2, (vector_t){1.8, 1.8});
+  assert(!find_body_collision(square, circle2).collided);
+  assert(!find_body_collision(circle2, square).collided);
+  body_set_centroid(circle2, (vector_t){0.2, 1.5});
+  collision = find_body_collision(circle2, square);
+  assert(collision.collided && isclose(collision.depth, 0.5));
+  assert(vec_isclose(collision.axis, (vector_t){0, -1}));
+  body_free(circle1);
+  body_free(circle2);
+  body_free(square);
+}
+
+void test_capsule_collision() {
+  body_t *square = body_init(make_square(VEC_ZERO, 2), 1, (rgb_color_t){0});
+  body_t *capsule = make_capsule((vector_t){-3, 2.2}, (vector_t){3, 2.2}, 1);
+  assert(!find_body_collision(square, capsule).collided);
+  body_set_centroid(capsule, (vector_t){0, 1.8});
+  collision_info_t collision = find_body_collision(square, capsule);
+  assert(collision.collided && isclose(collision.depth, 0.2));
+  assert(vec_isclose(collision.axis, (vector_t){0, 1}));
+
+  // the capsule's end is round near the square's corner
+  body_t *diagonal = make_capsule((vector_t){1.6, 1.6}, (vector_t){4, 4}, 1);
+  assert(find_body_collision(diagonal, square).collided);
+  body_set_centroid(diagonal, (vector_t){3, 3});
+  assert(!find_body_collision(diagonal, square).collided);
+
+  // a capsule's side against another's end, crossed and side by side
+  body_t *other = make_capsule((vector_t){0, 2.5}, (vector_t){0, 6}, 1);
+  body_set_centroid(capsule, VEC_ZERO);
+  assert(!find_body_collision(capsule, other).collided);
+  body_set_centroid(other, (vector_t){0, 3.25});
+  collision = find_body_collision(capsule, other);
+  assert(collision.collided && isclose(collision.depth, 0.5));
+  assert(vec_isclose(collision.axis, (vector_t){0, 1}));
+  body_set_centroid(other, VEC_ZERO);
+  assert(find_body_collision(capsule, other).collided);
+  body_set_rotation(other, M_PI / 2);
+  body_set_centroid(other, (vector_t){0, -1.5});
+  collision = find_body_collision(capsule, other);
+  assert(collision.collided && isclose(collision.depth, 0.5));
+  assert(vec_isclose(collision.axis, (vector_t){0, -1}));
+  body_free(square);
+  body_free(capsule);
+  body_free(diagonal);
+  body_free(other);
+}
+
+// Rays hit the near side of each shape, and miss past max_distance
+void test_ray_hit() {
+  body_t *square = body_init(make_square(VEC_ZERO, 2), 1, (rgb_color_t){0});
+  ray_hit_t hit = find_ray_hit(square, (vector_t){-5, 0.5}, (vector_t){1, 0}, 10);
+  assert(hit.body == square && isclose(hit.distance, 4));
+  assert(vec_isclose(hit.point, (vector_t){-1, 0.5}));
+  assert(vec_isclose(hit.normal, (vector_t){-1, 0}));
+  assert(find_ray_hit(square, (vector_t){-5, 0.5}, (vector_t){1, 0}, 3.9).body ==
+         NULL);
+  assert(find_ray_hit(square, (vector_t){-5, 1.5}, (vector_t){1, 0}, 10).body ==
+         NULL);
+  assert(find_ray_hit(square, (vector_t){5, 0}, (vector_t){1, 0}, 10).body ==
+         NULL);
+  // rays starting inside pass out without hitting
+  assert(find_ray_hit(square, VEC_ZERO, (vector_t){0, 1}, 10).body == NULL);
+
+  body_t *circle = make_circle((vector_t){0, 5}, 1);
+  hit = find_ray_hit(circle, VEC_ZERO, (vector_t){0, 1}, 10);
+  assert(hit.body == circle && isclose(hit.distance, 4));
+  assert(vec_isclose(hit.normal, (vector_t){0, -1}));
+  hit = find_ray_hit(circle, (vector_t){0.6, 0}, (vector_t){0, 1}, 10);
+  assert(isclose(hit.distance, 5 - 0.8));
+  assert(vec_isclose(hit.normal, (vector_t){0.6, -0.8}));
+
+  // a capsule is hit on its flat side and its round ends
+  body_t *capsule = make_capsule((vector_t){-3, 5}, (vector_t){3, 5}, 1);
+  hit = find_ray_hit(capsule, (vector_t){2, 0}, (vector_t){0, 1}, 10);
+  assert(hit.body == capsule && isclose(hit.distance, 4));
+  assert(vec_isclose(hit.normal, (vector_t){0, -1}));
+  hit = find_ray_hit(capsule, (vector_t){10, 5}, (vector_t){-1, 0}, 10);
+  assert(isclose(hit.distance, 6));
+  assert(vec_isclose(hit.normal, (vector_t){1, 0}));
+  hit = find_ray_hit(capsule, (vector_t){3.6, 0}, (vector_t){0, 1}, 10);
+  assert(isclose(hit.distance, 5 - 0.8));
+  assert(vec_isclose(hit.normal, (vector_t){0.6, -0.8}));
+  assert(find_ray_hit(capsule, (vector_t){0, 5.5}, (vector_t){1, 0}, 10).body ==
+         NULL);
+  body_free(square);
+  body_free(circle);
+  body_free(capsule);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_separated)
+  DO_TEST(test_overlap_axis_and_depth)
+  DO_TEST(test_contact_point)
+  DO_TEST(test_separating_axes)
+  DO_TEST(test_body_collision)
+  DO_TEST(test_bounds_early_out)
+  DO_TEST(test_swept_collision)
+  DO_TEST(test_bullet_rewinds_in_scene)
+  DO_TEST(test_circle_collision)
+  DO_TEST(test_capsule_collision)
+  DO_TEST(test_ray_hit)
+
+  puts("collision tests pass");
+}
@@ -0,0 +1,110 @@
+#include "contacts.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdlib.h>
+
+// more bodies than the cache starts with room for contacts between
+const size_t BODY_COUNT = 40;
+
+body_t **make_bodies(size_t count) {
+  body_t **bodies = malloc(sizeof(body_t *) * count);
+  assert(bodies != NULL);
+  for (size_t i = 0; i < count; i++) {
+    polygon_t shape = polygon_init(3);
+    polygon_add(&shape, (vector_t){0, 0});
+    polygon_add(&shape, (vector_t){1, 0});
+    polygon_add(&shape, (vector_t){0, 1});
+    bodies[i] = body_init(shape, 1, (rgb_color_t){0, 0, 0});
+  }
+  return bodies;
+}
+
+void free_bodies(body_t **bodies, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    body_free(bodies[i]);
+  }
+  free(bodies);
+}
+
+void test_empty_cache() {
+  body_t **bodies = make_bodies(2);
+  contact_cache_t *cache = contact_cache_init();
+  assert(contact_cache_size(cache) == 0);
+  assert(contact_cache_find(cache, bodies[0], bodies[1]) == NULL);
+  contact_cache_free(cache);
+  free_bodies(bodies, 2);
+}
+
+// A pair is found in either order and keeps the tick it was first touched
+void test_touch() {
+  body_t **bodies = make_bodies(3);
+  contact_cache_t *cache = contact_cache_init();
+  contact_t *contact = contact_cache_touch(cache, bodies[0], bodies[1], 5);
+  assert(contact->body1 == bodies[0] && contact->body2 == bodies[1]);
+  assert(contact->first_tick == 5 && contact->last_tick == 5);
+  assert(contact_cache_find(cache, bodies[1], bodies[0]) == contact);
+  assert(contact_cache_find(cache, bodies[0], bodies[2]) == NULL);
+
+  contact = contact_cache_touch(cache, bodies[1], bodies[0], 6);
+  assert(contact_cache_size(cache) == 1);
+  assert(contact->body1 == bodies[0]);
+  assert(contact->first_tick == 5 && contact->last_tick == 6);
+  contact_cache_free(cache);
+  free_bodies(bodies, 3);
+}
+
+bool touched_before(void *contact, void *tick) {
+  return ((contact_t *)contact)->last_tick < *(size_t *)tick;
+}
+
+// Every pair of many bodies, so the cache and its table have to grow
+void test_many_contacts() {
+  body_t **bodies = make_bodies(BODY_COUNT);
+  contact_cache_t *cache = contact_cache_init();
+  for (size_t i = 0; i < BODY_COUNT; i++) {
+    for (size_t j = i + 1; j < BODY_COUNT; j++) {
+      contact_cache_touch(cache, bodies[i], bodies[j], i % 2);
+    }
+  }
+  size_t pairs = BODY_COUNT * (BODY_COUNT - 1) / 2;
+  assert(contact_cache_size(cache) == pairs);
+  for (size_t i = 0; i < BODY_COUNT; i++) {
+    for (size_t j = i + 1; j < BODY_COUNT; j++) {
+      contact_t *contact = contact_cache_find(cache, bodies[j], bodies[i]);
+      assert(contact != NULL);
+      assert(contact->body1 == bodies[i] && contact->body2 == bodies[j]);
+    }
+  }
+
+  // drop the pairs touched on tick 0, i.e. those with an even first body
+  size_t tick = 1;
+  size_t removed = contact_cache_remove_if(cache, touched_before, &tick);
+  assert(removed + contact_cache_size(cache) == pairs);
+  for (size_t i = 0; i < contact_cache_size(cache); i++) {
+    assert(contact_cache_get(cache, i)->last_tick == 1);
+  }
+  for (size_t i = 0; i < BODY_COUNT; i++) {
+    for (size_t j = i + 1; j < BODY_COUNT; j++) {
+      contact_t *contact = contact_cache_find(cache, bodies[i], bodies[j]);
+      assert((contact != NULL) == (i % 2 == 1));
+    }
+  }
+  contact_cache_free(cache);
+  free_bodies(bodies, BODY_COUNT);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_empty_cache)
+  DO_TEST(test_touch)
+  DO_TEST(test_many_contacts)
+
+  puts("contacts_test PASS");
+}
@@ -2,22 +2,15 @@
 #include "test_util.h"
 #include <assert.h>
 #include <math.h>
+#include <stdint.h>
 #include <stdlib.h>
 
-list_t *make_shape() {
-  list_t *shape = list_init(4, free);
-  vector_t *v = malloc(sizeof(*v));
-  *v = (vector_t){-1, -1};
-  list_add(shape, v);
-  v = malloc(sizeof(*v));
-  *v = (vector_t){+1, -1};
-  list_add(shape, v);
-  v = malloc(sizeof(*v));
-  *v = (vector_t){+1, +1};
-  list_add(shape, v);
-  v = malloc(sizeof(*v));
-  *v = (vector_t){-1, +1};
-  list_add(shape, v);
+polygon_t make_shape() {
+  polygon_t shape = polygon_init(4);
+  polygon_add(&shape, (vector_t){-1, -1});
+  polygon_add(&shape, (vector_t){+1, -1});
+  polygon_add(&shape, (vector_t){+1, +1});
+  polygon_add(&shape, (vector_t){-1, +1});
   return shape;
 }
 
@@ -78,16 +71,10 @@ void test_energy_conservation() {
 }
 
 body_t *make_triangle_body() {
-  list_t *shape = list_init(3, free);
-  vector_t *v = malloc(sizeof(*v));
-  *v = (vector_t){1, 0};
-  list_add(shape, v);
-  v = malloc(sizeof(*v));
-  *v = (vector_t){-0.5, +sqrt(3) / 2};
-  list_add(shape, v);
-  v = malloc(sizeof(*v));
-  *v = (vector_t){-0.5, -sqrt(3) / 2};
-  list_add(shape, v);
+  polygon_t shape = polygon_init(3);
+  polygon_add(&shape, (vector_t){1, 0});
+  polygon_add(&shape, (vector_t){-0.5, +sqrt(3) / 2});
+  polygon_add(&shape, (vector_t){-0.5, -sqrt(3) / 2});
   return body_init(shape, 1, (rgb_color_t){0, 0, 0});
 }
 
@@ -150,6 +137,346 @@ void test_forces_removed() {
   scene_free(scene);
 }
 
+// Gravity with an exact quadtree pulls like a force creator for every pair
+void test_barnes_hut_gravity() {
+  const size_t BODY_COUNT = 20;
+  const double G = 100;
+  scene_t *pairs = scene_init();
+  scene_t *field = scene_init();
+  srand(6);
+  for (size_t i = 0; i < BODY_COUNT; i++) {
+    vector_t centroid = {rand() % 200, rand() % 200};
+    double mass = rand() % 10 + 1;
+    body_t *pair_body = body_init(make_shape(), mass, (rgb_color_t){0, 0, 0});
+    body_t *field_body = body_init(make_shape(), mass, (rgb_color_t){0, 0, 0});
+    body_set_centroid(pair_body, centroid);
+    body_set_centroid(field_body, centroid);
+    scene_add_body(pairs, pair_body);
+    scene_add_body(field, field_body);
+    for (size_t j = 0; j < i; j++) {
+      create_newtonian_gravity(pairs, G, pair_body, scene_get_body(pairs, j));
+    }
+  }
+  create_barnes_hut_gravity(field, G, 0, SIZE_MAX);
+
+  for (size_t tick = 0; tick < 10; tick++) {
+    scene_tick(pairs, 0.1);
+    scene_tick(field, 0.1);
+  }
+  for (size_t i = 0; i < BODY_COUNT; i++) {
+    assert(vec_isclose(body_get_centroid(scene_get_body(pairs, i)),
+                       body_get_centroid(scene_get_body(field, i))));
+  }
+
+  // removing a body just takes it out of the field
+  body_remove(scene_get_body(field, 0));
+  scene_tick(field, 0.1);
+  scene_tick(field, 0.1);
+  assert(scene_bodies(field) == BODY_COUNT - 1);
+  scene_free(pairs);
+  scene_free(field);
+}
+
+// Force fields act on the bodies with their tags, and attractors leave
+// with their source
+void test_force_fields() {
+  const size_t TAG_A = 1 << 0, TAG_B = 1 << 1;
+  const double GAMMA = 2, G = 100, DT = 0.01;
+  const vector_t DOWN = {0, -10};
+  scene_t *scene = scene_init();
+  body_t *a = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_t *b = body_init(make_shape(), 3, (rgb_color_t){0, 0, 0});
+  body_t *untagged = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_t *source = body_init(make_shape(), 5, (rgb_color_t){0, 0, 0});
+  body_set_tags(a, TAG_A);
+  body_set_tags(b, TAG_B);
+  body_set_tags(source, TAG_A | TAG_B);
+  body_set_centroid(b, (vector_t){10, 0});
+  body_set_centroid(source, (vector_t){10, 20});
+  body_set_velocity(a, (vector_t){1, 0});
+  body_set_velocity(untagged, (vector_t){1, 0});
+  scene_add_body(scene, a);
+  scene_add_body(scene, b);
+  scene_add_body(scene, untagged);
+  scene_add_body(scene, source);
+  create_drag_field(scene, GAMMA, TAG_A);
+  create_uniform_gravity(scene, DOWN, TAG_B);
+  create_attractor(scene, G, source, TAG_B);
+
+  scene_tick(scene, DT);
+  assert(vec_isclose(body_get_velocity(a), (vector_t){1 - GAMMA * DT, 0}));
+  assert(vec_isclose(body_get_velocity(untagged), (vector_t){1, 0}));
+  // G * 3 * 5 / 20^2 upwards, per unit mass of b, against gravity
+  double pull = G * 5 / 400;
+  assert(vec_isclose(body_get_velocity(b), (vector_t){0, (-10 + pull) * DT}));
+  // the source falls with b, but is not pulled by its own field
+  assert(vec_isclose(body_get_velocity(source), (vector_t){0, -10 * DT}));
+
+  // the field is removed with its source at the end of the next tick
+  body_remove(source);
+  scene_tick(scene, DT);
+  double speed = body_get_velocity(b).y;
+  scene_tick(scene, DT);
+  assert(isclose(body_get_velocity(b).y, speed - 10 * DT));
+  scene_free(scene);
+}
+
+/**
+ * Runs a unit mass on a spring with angular frequency 10 for 10 seconds
+ * and returns how far its energy drifted, relative to where it started.
+ */
+double spring_drift(integrator_t integrator, size_t substeps,
+                    double *position_error) {
+  const double K = 100, DT = 0.01, T = 10;
+  scene_t *scene = scene_init();
+  scene_set_integrator(scene, integrator);
+  scene_set_substeps(scene, substeps);
+  body_t *mass = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_centroid(mass, (vector_t){1, 0});
+  scene_add_body(scene, mass);
+  body_t *anchor = body_init(make_shape(), INFINITY, (rgb_color_t){0, 0, 0});
+  scene_add_body(scene, anchor);
+  create_spring(scene, K, mass, anchor);
+  for (size_t i = 0; i < (size_t)(T / DT + 0.5); i++) {
+    scene_tick(scene, DT);
+  }
+  vector_t x = body_get_centroid(mass);
+  vector_t v = body_get_velocity(mass);
+  *position_error = fabs(x.x - cos(sqrt(K) * T));
+  double energy = vec_dot(v, v) / 2 + K * vec_dot(x, x) / 2;
+  scene_free(scene);
+  return fabs(energy / (K / 2) - 1);
+}
+
+// Tests that the higher-order integrators and substeps keep a stiff spring
+// accurate at a tick too long for the averaging scheme
+void test_integrators() {
+  double average_error, euler_error, verlet_error, rk4_error, error;
+  double average = spring_drift(INTEGRATOR_AVERAGE_VELOCITY, 1, &average_error);
+  double euler =
+      spring_drift(INTEGRATOR_SEMI_IMPLICIT_EULER, 1, &euler_error);
+  double verlet = spring_drift(INTEGRATOR_VELOCITY_VERLET, 1, &verlet_error);
+  double rk4 = spring_drift(INTEGRATOR_RK4, 1, &rk4_error);
+  assert(average > 1);
+  assert(euler < 0.1 && verlet < 1e-3 && rk4 < 1e-4);
+  assert(average_error > euler_error && euler_error > verlet_error &&
+         verlet_error > rk4_error && rk4_error < 1e-4);
+
+  // splitting the tick re-evaluates the spring, so it helps every scheme
+  assert(spring_drift(INTEGRATOR_AVERAGE_VELOCITY, 10, &error) < 1);
+  assert(error < average_error);
+  assert(spring_drift(INTEGRATOR_RK4, 10, &error) < 1e-8);
+  assert(error < 1e-7);
+}
+
+/**
+ * Fires a body past an attractor and returns where it is after a second,
+ * taking ticks of length dt that the body splits into substeps.
+ */
+vector_t fly_past_attractor(double dt, size_t substeps) {
+  const double G = 1e4;
+  const size_t TAG = 1 << 0;
+  scene_t *scene = scene_init();
+  body_t *source = body_init(make_shape(), 10, (rgb_color_t){0, 0, 0});
+  body_set_centroid(source, (vector_t){0, 10});
+  scene_add_body(scene, source);
+  body_t *bullet = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_centroid(bullet, (vector_t){-50, 0});
+  body_set_velocity(bullet, (vector_t){100, 0});
+  body_set_tags(bullet, TAG);
+  body_set_substeps(bullet, substeps);
+  scene_add_body(scene, bullet);
+  create_attractor(scene, G, source, TAG);
+  for (size_t i = 0; i < (size_t)(1 / dt + 0.5); i++) {
+    scene_tick(scene, dt);
+  }
+  vector_t centroid = body_get_centroid(bullet);
+  scene_free(scene);
+  return centroid;
+}
+
+// Tests that a body's own substeps re-evaluate its fields,
+// so it follows a strong field as if the whole scene took shorter ticks
+void test_body_substeps() {
+  vector_t exact = fly_past_attractor(1e-4, 1);
+  vector_t coarse = fly_past_attractor(0.05, 1);
+  vector_t substepped = fly_past_attractor(0.05, 50);
+  vector_t coarse_miss = vec_subtract(coarse, exact);
+  vector_t substepped_miss = vec_subtract(substepped, exact);
+  assert(vec_dot(substepped_miss, substepped_miss) <
+         vec_dot(coarse_miss, coarse_miss) / 100);
+  // the same as ticking the whole scene at the length of a substep
+  assert(vec_isclose(substepped, fly_past_attractor(0.001, 1)));
+}
+
+/**
+ * Ticks two equal bodies joined by a spring with a multi-stage integrator,
+ * the first taking its own substeps, and returns their centre of mass.
+ */
+vector_t substepped_spring_center(size_t substeps) {
+  const double K = 100;
+  const double DT = 0.01;
+  const size_t TICKS = 100;
+  scene_t *scene = scene_init();
+  scene_set_integrator(scene, INTEGRATOR_RK4);
+  body_t *a = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_t *b = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_centroid(b, (vector_t){10, 0});
+  body_set_substeps(a, substeps);
+  scene_add_body(scene, a);
+  scene_add_body(scene, b);
+  create_spring(scene, K, a, b);
+  for (size_t i = 0; i < TICKS; i++) {
+    scene_tick(scene, DT);
+    // nothing applied during the tick is left over for the next one
+    assert(vec_equal(body_get_force(a), VEC_ZERO));
+    assert(vec_equal(body_get_impulse(a), VEC_ZERO));
+  }
+  vector_t center = vec_multiply(0.5, vec_add(body_get_centroid(a),
+                                              body_get_centroid(b)));
+  scene_free(scene);
+  return center;
+}
+
+// Tests that a substepped body in a multi-stage scene is not pushed twice
+void test_substeps_with_stages() {
+  assert(vec_isclose(substepped_spring_center(1), (vector_t){5, 0}));
+  // a's spring is re-evaluated as it moves while b's is held for the tick,
+  // so the pair drifts a little, but far less than a whole extra push
+  vector_t center = substepped_spring_center(2);
+  assert(fabs(center.x - 5) < 2 && center.y == 0);
+}
+
+/**
+ * Swings a body on a stiff spring to a fixed anchor for a second
+ * with velocity Verlet, which is only stable for steps shorter than
+ * the spring's period over pi,
+ * taking ticks of length dt that the body splits into substeps,
+ * and returns where it ends up.
+ */
+vector_t swing_on_stiff_spring(double dt, size_t substeps) {
+  const double K = 1e5;
+  scene_t *scene = scene_init();
+  scene_set_integrator(scene, INTEGRATOR_VELOCITY_VERLET);
+  body_t *anchor = body_init(make_shape(), INFINITY, (rgb_color_t){0, 0, 0});
+  scene_add_body(scene, anchor);
+  body_t *body = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_centroid(body, (vector_t){10, 0});
+  body_set_substeps(body, substeps);
+  scene_add_body(scene, body);
+  create_spring(scene, K, body, anchor);
+  for (size_t i = 0; i < (size_t)(1 / dt + 0.5); i++) {
+    scene_tick(scene, dt);
+  }
+  vector_t centroid = body_get_centroid(body);
+  scene_free(scene);
+  return centroid;
+}
+
+// Tests that a body's own substeps re-evaluate its batched forces,
+// so it stays on a spring too stiff for the scene's tick
+void test_body_substeps_springs() {
+  vector_t coarse = swing_on_stiff_spring(0.01, 1);
+  assert(!(fabs(coarse.x) < 100));
+  vector_t substepped = swing_on_stiff_spring(0.01, 10);
+  assert(fabs(substepped.x) < 11);
+  assert(vec_isclose(substepped, swing_on_stiff_spring(0.001, 1)));
+}
+
+size_t count_force_links(body_t *body) {
+  size_t count = 0;
+  for (force_link_t *link = body_get_force_links(body); link != NULL;
+       link = link->next) {
+    count++;
+  }
+  return count;
+}
+
+// Tests that removing a body only removes the force creators acting on it
+void test_other_forces_kept() {
+  const double GAMMA = 2;
+  const double DT = 0.01;
+  scene_t *scene = scene_init();
+  body_t *bodies[3];
+  for (int i = 0; i < 3; i++) {
+    bodies[i] = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    body_set_centroid(bodies[i], (vector_t){10 * i, 0});
+    body_set_velocity(bodies[i], (vector_t){1, 0});
+    scene_add_body(scene, bodies[i]);
+    create_drag(scene, GAMMA, bodies[i]);
+  }
+  create_spring(scene, 100, bodies[0], bodies[1]);
+  create_spring(scene, 100, bodies[1], bodies[2]);
+  assert(count_force_links(bodies[0]) == 2);
+  assert(count_force_links(bodies[1]) == 3);
+
+  body_remove(bodies[1]);
+  scene_tick(scene, 0);
+  assert(scene_bodies(scene) == 2);
+  assert(count_force_links(bodies[0]) == 1);
+  assert(count_force_links(bodies[2]) == 1);
+  // only drag is left, so both bodies slow down the same way
+  scene_tick(scene, DT);
+  vector_t expected = {1 - GAMMA * DT, 0};
+  assert(vec_isclose(body_get_velocity(bodies[0]), expected));
+  assert(vec_isclose(body_get_velocity(bodies[2]), expected));
+  scene_free(scene);
+}
+
+polygon_t make_box(vector_t center, double width, double height) {
+  polygon_t box = polygon_init(4);
+  polygon_add(&box, (vector_t){center.x - width / 2, center.y - height / 2});
+  polygon_add(&box, (vector_t){center.x + width / 2, center.y - height / 2});
+  polygon_add(&box, (vector_t){center.x + width / 2, center.y + height / 2});
+  polygon_add(&box, (vector_t){center.x - width / 2, center.y + height / 2});
+  return box;
+}
+
+/**
+ * Fires a sniper-sized bullet at a thin wall, ticking with the given dt,
+ * and returns the bullet's x-coordinate after one second.
+ */
+double fire_at_wall(double dt, bool is_bullet) {
+  const double WALL_X = 300;
+  const double WALL_WIDTH = 10;
+  const double BULLET_SPEED = 500;
+  const size_t LAYER_BULLET = 1 << 0, LAYER_WALL = 1 << 1;
+  scene_t *scene = scene_init();
+  size_t *wall_info = malloc(sizeof(size_t));
+  *wall_info = 0;
+  body_t *wall =
+      body_init_with_info(make_box((vector_t){WALL_X, 0}, WALL_WIDTH, 400),
+                          INFINITY, (rgb_color_t){0, 0, 0}, wall_info, free);
+  body_set_collision_layers(wall, LAYER_WALL, LAYER_BULLET);
+  scene_add_static_body(scene, wall);
+  size_t *bullet_info = malloc(sizeof(size_t));
+  *bullet_info = 1;
+  body_t *bullet = body_init_with_info(make_box(VEC_ZERO, 25, 10), 5,
+                                       (rgb_color_t){0, 0, 0}, bullet_info,
+                                       free);
+  body_set_collision_layers(bullet, LAYER_BULLET, LAYER_WALL);
+  body_set_bullet(bullet, is_bullet);
+  body_set_velocity(bullet, (vector_t){BULLET_SPEED, 0});
+  scene_add_body(scene, bullet);
+  create_layer_physics_collision(scene, 1.0, LAYER_BULLET, LAYER_WALL);
+  for (double time = 0; time < 1.0; time += dt) {
+    scene_tick(scene, dt);
+  }
+  double x = body_get_centroid(bullet).x;
+  scene_free(scene);
+  return x;
+}
+
+// Bullets bounce off walls thinner than they move in one tick
+void test_bullets_hit_thin_walls() {
+  const double DTS[] = {1.0 / 240, 1.0 / 60, 1.0 / 30, 1.0 / 15, 0.1, 0.15};
+  for (size_t i = 0; i < sizeof(DTS) / sizeof(*DTS); i++) {
+    assert(fire_at_wall(DTS[i], true) < 300);
+  }
+  // without the sweep, a slow frame lets the bullet through
+  assert(fire_at_wall(0.1, false) > 300);
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -163,6 +490,14 @@ int main(int argc, char *argv[]) {
   DO_TEST(test_energy_conservation)
   DO_TEST(test_collisions)
   DO_TEST(test_forces_removed)
+  DO_TEST(test_barnes_hut_gravity)
+  DO_TEST(test_force_fields)
+  DO_TEST(test_integrators)
+  DO_TEST(test_body_substeps)
+  DO_TEST(test_substeps_with_stages)
+  DO_TEST(test_body_substeps_springs)
+  DO_TEST(test_other_forces_kept)
+  DO_TEST(test_bullets_hit_thin_walls)
 
   puts("forces_test PASS");
 }
@@ -0,0 +1,233 @@
+#include "grid.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+// a grid of 10 x 10 cells
+const vector_t ARENA_MIN = {0, 0};
+const vector_t ARENA_MAX = {100, 100};
+const double CELL_SIZE = 10;
+
+aabb_t make_box(double x, double y, double width, double height) {
+  return (aabb_t){{x, y}, {x + width, y + height}};
+}
+
+typedef struct hits {
+  size_t *counts;
+  size_t total;
+} hits_t;
+
+/** Counts how often each item is found, using items that point into ids. */
+void count_hit(void *item, void *aux) {
+  hits_t *hits = aux;
+  hits->counts[*(size_t *)item]++;
+  hits->total++;
+}
+
+void test_empty_grid() {
+  grid_t *grid = grid_init(ARENA_MIN, ARENA_MAX, CELL_SIZE);
+  size_t counts[1] = {0};
+  hits_t hits = {counts, 0};
+  grid_query(grid, make_box(0, 0, 100, 100), count_hit, &hits);
+  assert(hits.total == 0);
+  grid_free(grid);
+}
+
+void test_insert_move_remove() {
+  grid_t *grid = grid_init(ARENA_MIN, ARENA_MAX, CELL_SIZE);
+  size_t ids[] = {0, 1, 2};
+  size_t counts[3] = {0};
+  hits_t hits = {counts, 0};
+  // spans four cells, so must still only be found once
+  size_t big = grid_insert(grid, &ids[0], make_box(5, 5, 10, 10));
+  size_t small = grid_insert(grid, &ids[1], make_box(50, 50, 2, 2));
+  grid_query(grid, make_box(0, 0, 100, 100), count_hit, &hits);
+  assert(hits.total == 2 && counts[0] == 1 && counts[1] == 1);
+
+  counts[0] = counts[1] = hits.total = 0;
+  grid_query(grid, make_box(14, 14, 1, 1), count_hit, &hits);
+  assert(hits.total == 1 && counts[0] == 1);
+
+  // moving within a cell and across cells
+  grid_move(grid, small, make_box(51, 51, 2, 2));
+  grid_move(grid, big, make_box(70, 5, 10, 10));
+  counts[0] = counts[1] = hits.total = 0;
+  grid_query(grid, make_box(0, 0, 20, 20), count_hit, &hits);
+  assert(hits.total == 0);
+  grid_query(grid, make_box(75, 10, 1, 1), count_hit, &hits);
+  assert(hits.total == 1 && counts[0] == 1);
+
+  // a removed item's proxy is reused
+  grid_remove(grid, small);
+  counts[0] = counts[1] = hits.total = 0;
+  grid_query(grid, make_box(0, 0, 100, 100), count_hit, &hits);
+  assert(hits.total == 1 && counts[1] == 0);
+  assert(grid_insert(grid, &ids[2], make_box(20, 20, 1, 1)) == small);
+  grid_free(grid);
+}
+
+// Boxes outside the arena are kept in the border cells
+void test_outside_arena() {
+  grid_t *grid = grid_init(ARENA_MIN, ARENA_MAX, CELL_SIZE);
+  size_t id = 0;
+  size_t counts[1] = {0};
+  hits_t hits = {counts, 0};
+  size_t proxy = grid_insert(grid, &id, make_box(-50, 40, 5, 5));
+  grid_query(grid, make_box(-60, 30, 20, 20), count_hit, &hits);
+  assert(hits.total == 1);
+  // the query box must still overlap the item's own box
+  grid_query(grid, make_box(1, 40, 5, 5), count_hit, &hits);
+  assert(hits.total == 1);
+  grid_move(grid, proxy, make_box(200, 200, 5, 5));
+  grid_query(grid, make_box(150, 150, 100, 100), count_hit, &hits);
+  assert(hits.total == 2);
+  grid_free(grid);
+}
+
+// The grid finds exactly the boxes that checking every box would find
+void test_matches_all_boxes() {
+  const size_t BOX_COUNT = 300;
+  const size_t ROUNDS = 20;
+  const size_t QUERY_COUNT = 50;
+  grid_t *grid = grid_init(ARENA_MIN, ARENA_MAX, CELL_SIZE);
+  size_t *ids = malloc(sizeof(size_t) * BOX_COUNT);
+  size_t *proxies = malloc(sizeof(size_t) * BOX_COUNT);
+  aabb_t *boxes = malloc(sizeof(aabb_t) * BOX_COUNT);
+  size_t *counts = malloc(sizeof(size_t) * BOX_COUNT);
+  srand(7);
+  for (size_t i = 0; i < BOX_COUNT; i++) {
+    ids[i] = i;
+    boxes[i] = make_box(rand() % 120 - 10, rand() % 120 - 10, rand() % 25,
+                        rand() % 25);
+    proxies[i] = grid_insert(grid, &ids[i], boxes[i]);
+  }
+  for (size_t round = 0; round < ROUNDS; round++) {
+    for (size_t i = 0; i < BOX_COUNT; i++) {
+      double dx = rand() % 9 - 4, dy = rand() % 9 - 4;
+      boxes[i] = make_box(boxes[i].min.x + dx, boxes[i].min.y + dy,
+                          boxes[i].max.x - boxes[i].min.x,
+                          boxes[i].max.y - boxes[i].min.y);
+      grid_move(grid, proxies[i], boxes[i]);
+    }
+    for (size_t q = 0; q < QUERY_COUNT; q++) {
+      aabb_t query = make_box(rand() % 120 - 10, rand() % 120 - 10,
+                              rand() % 40, rand() % 40);
+      for (size_t i = 0; i < BOX_COUNT; i++) {
+        counts[i] = 0;
+      }
+      hits_t hits = {counts, 0};
+      grid_query(grid, query, count_hit, &hits);
+      for (size_t i = 0; i < BOX_COUNT; i++) {
+        assert(counts[i] == (aabb_overlaps(boxes[i], query) ? 1 : 0));
+      }
+    }
+  }
+  free(ids);
+  free(proxies);
+  free(boxes);
+  free(counts);
+  grid_free(grid);
+}
+
+typedef struct ray_hits {
+  hits_t hits;
+  // how far to keep searching after an item is visited, by item
+  double *stops;
+} ray_hits_t;
+
+double count_ray_hit(void *item, double max_distance, void *aux) {
+  ray_hits_t *ray_hits = aux;
+  count_hit(item, &ray_hits->hits);
+  return fmin(max_distance, ray_hits->stops[*(size_t *)item]);
+}
+
+void test_cast_ray() {
+  grid_t *grid = grid_init(ARENA_MIN, ARENA_MAX, CELL_SIZE);
+  size_t ids[] = {0, 1, 2, 3, 4, 5};
+  size_t counts[6] = {0};
+  double stops[] = {INFINITY, INFINITY, INFINITY, 45, INFINITY, INFINITY};
+  ray_hits_t ray_hits = {{counts, 0}, stops};
+  // spans four cells along the ray, so must still only be visited once
+  grid_insert(grid, &ids[0], make_box(12, 3, 25, 4));
+  // in a cell the ray never enters
+  grid_insert(grid, &ids[1], make_box(55, 55, 2, 2));
+  // in a cell the ray crosses, but not on the ray
+  grid_insert(grid, &ids[2], make_box(21, 1, 2, 2));
+  grid_insert(grid, &ids[3], make_box(42, 4, 2, 2));
+  // past where the visitor stopped the search
+  grid_insert(grid, &ids[4], make_box(70, 4, 2, 2));
+  double distance = grid_cast_ray(grid, (vector_t){0, 5}, (vector_t){1, 0},
+                                  100, count_ray_hit, &ray_hits);
+  assert(isclose(distance, 45));
+  assert(ray_hits.hits.total == 2 && counts[0] == 1 && counts[3] == 1);
+
+  // rays from outside the arena walk the border cells
+  grid_insert(grid, &ids[5], make_box(-30, 120, 2, 2));
+  ray_hits.hits.total = 0;
+  grid_cast_ray(grid, (vector_t){-50, 150}, (vector_t){0.6, -0.8}, 100,
+                count_ray_hit, &ray_hits);
+  assert(ray_hits.hits.total == 1 && counts[5] == 1);
+  grid_free(grid);
+}
+
+// A ray visits exactly the boxes that checking every box would find
+void test_cast_ray_matches_all_boxes() {
+  const size_t BOX_COUNT = 300;
+  const size_t RAY_COUNT = 500;
+  grid_t *grid = grid_init(ARENA_MIN, ARENA_MAX, CELL_SIZE);
+  size_t *ids = malloc(sizeof(size_t) * BOX_COUNT);
+  aabb_t *boxes = malloc(sizeof(aabb_t) * BOX_COUNT);
+  size_t *counts = malloc(sizeof(size_t) * BOX_COUNT);
+  double *stops = malloc(sizeof(double) * BOX_COUNT);
+  srand(11);
+  for (size_t i = 0; i < BOX_COUNT; i++) {
+    ids[i] = i;
+    boxes[i] = make_box(rand() % 120 - 10, rand() % 120 - 10, rand() % 15,
+                        rand() % 15);
+    stops[i] = INFINITY;
+    grid_insert(grid, &ids[i], boxes[i]);
+  }
+  for (size_t r = 0; r < RAY_COUNT; r++) {
+    vector_t origin = {rand() % 140 - 20, rand() % 140 - 20};
+    double angle = rand() % 360 * M_PI / 180;
+    vector_t direction = {cos(angle), sin(angle)};
+    vector_t inverse = {1 / direction.x, 1 / direction.y};
+    double max_distance = rand() % 150;
+    for (size_t i = 0; i < BOX_COUNT; i++) {
+      counts[i] = 0;
+    }
+    ray_hits_t ray_hits = {{counts, 0}, stops};
+    grid_cast_ray(grid, origin, direction, max_distance, count_ray_hit,
+                  &ray_hits);
+    for (size_t i = 0; i < BOX_COUNT; i++) {
+      bool reached = aabb_ray_distance(boxes[i], origin, inverse,
+                                       max_distance) != INFINITY;
+      assert(counts[i] == (reached ? 1 : 0));
+    }
+  }
+  free(ids);
+  free(boxes);
+  free(counts);
+  free(stops);
+  grid_free(grid);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_empty_grid)
+  DO_TEST(test_insert_move_remove)
+  DO_TEST(test_outside_arena)
+  DO_TEST(test_matches_all_boxes)
+  DO_TEST(test_cast_ray)
+  DO_TEST(test_cast_ray_matches_all_boxes)
+
+  puts("grid_test PASS");
+}
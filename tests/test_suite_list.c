@@ -135,6 +135,73 @@ void test_null_values() {
   list_free(l);
 }
 
+// Builds a list of the vectors (i, 0) for i from 0 to size - 1
+list_t *make_counting_list(size_t initial_size, size_t size) {
+  list_t *l = list_init(initial_size, free);
+  for (size_t i = 0; i < size; i++) {
+    vector_t *v = malloc(sizeof(*v));
+    *v = (vector_t){i, 0};
+    list_add(l, v);
+  }
+  return l;
+}
+
+void test_grow_from_zero() {
+  list_t *l = make_counting_list(0, 10);
+  assert(list_size(l) == 10);
+  assert(((vector_t *)list_get(l, 9))->x == 9);
+  list_free(l);
+}
+
+void test_swap_remove() {
+  list_t *l = make_counting_list(5, 5);
+  vector_t *v = list_swap_remove(l, 1);
+  assert(v->x == 1);
+  free(v);
+  // the last element takes the removed one's place
+  assert(list_size(l) == 4);
+  assert(((vector_t *)list_get(l, 1))->x == 4);
+  v = list_swap_remove(l, 3);
+  assert(v->x == 3);
+  free(v);
+  assert(list_size(l) == 3);
+  list_free(l);
+}
+
+bool is_multiple(void *value, void *aux) {
+  return (size_t)((vector_t *)value)->x % *(size_t *)aux == 0;
+}
+void test_remove_if() {
+  const size_t size = 100;
+  list_t *l = make_counting_list(size, size);
+  size_t divisor = 3;
+  // the removed elements are freed by the list, which asan checks
+  assert(list_remove_if(l, is_multiple, &divisor) == 34);
+  assert(list_size(l) == size - 34);
+  // the remaining elements keep their order
+  size_t expected = 1;
+  for (size_t i = 0; i < list_size(l); i++) {
+    assert(((vector_t *)list_get(l, i))->x == expected);
+    expected += expected % 3 == 2 ? 2 : 1;
+  }
+  divisor = 1;
+  assert(list_remove_if(l, is_multiple, &divisor) == size - 34);
+  assert(list_size(l) == 0);
+  list_free(l);
+}
+
+void test_truncate_reserve() {
+  list_t *l = make_counting_list(1, 10);
+  list_truncate(l, 4);
+  assert(list_size(l) == 4);
+  assert(((vector_t *)list_get(l, 3))->x == 3);
+  list_reserve(l, 1000);
+  assert(list_size(l) == 4);
+  list_truncate(l, 0);
+  assert(list_size(l) == 0);
+  list_free(l);
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -150,6 +217,10 @@ int main(int argc, char *argv[]) {
   DO_TEST(test_out_of_bounds_access)
   DO_TEST(test_empty_remove)
   DO_TEST(test_null_values)
+  DO_TEST(test_grow_from_zero)
+  DO_TEST(test_swap_remove)
+  DO_TEST(test_remove_if)
+  DO_TEST(test_truncate_reserve)
 
   puts("list_test PASS");
 }
@@ -3,6 +3,102 @@
 #include <stdlib.h>
 
 #include "forces.h"
+#include "map.h"
+#include "star.h"
 #include "test_util.h"
 
-int main(int argc, char *argv[]) { puts("map tests pass"); }
+const double TANK_SIDE_LENGTH = 80.0;
+const double TANK_MASS = 1000.0;
+const double TANK_HEALTH = 50.0;
+const double TANK_SPEED = 200.0;
+const double ELASTICITY = 20.0;
+// more vertices than a polygon stores inline, so its shape is on the heap
+const int STAR_POINTS = 8;
+const double STAR_LENGTH = 40.0;
+
+// Builds the game's scene: two tanks that collide with each other
+// and with every obstacle on the map
+scene_t *make_game_scene() {
+  scene_t *scene = scene_init();
+  body_t *player1 = init_default_tank(
+      (vector_t){MAX_WIDTH_GAME / 6, MAX_HEIGHT_GAME - 400.0},
+      TANK_SIDE_LENGTH, VEC_ZERO, TANK_MASS, (rgb_color_t){1, 0, 0},
+      TANK_HEALTH, DEFAULT_TANK_TYPE);
+  body_t *player2 = init_default_tank(
+      (vector_t){MAX_WIDTH_GAME * 5 / 6, MAX_HEIGHT_GAME / 2 - 50.0},
+      TANK_SIDE_LENGTH, VEC_ZERO, TANK_MASS, (rgb_color_t){0, 0, 1},
+      TANK_HEALTH, DEFAULT_TANK_TYPE);
+  scene_add_body(scene, player1);
+  scene_add_body(scene, player2);
+  create_physics_collision(scene, ELASTICITY, player1, player2);
+  map_init(scene);
+  for (size_t i = 2; i < scene_bodies(scene); i++) {
+    body_t *obstacle = scene_get_body(scene, i);
+    create_physics_collision(scene, ELASTICITY, player1, obstacle);
+    create_physics_collision(scene, ELASTICITY, player2, obstacle);
+  }
+  return scene;
+}
+
+// Ticking the game with moving tanks must not allocate any shape storage,
+// even for a spinning body whose vertices are on the heap
+void test_tick_allocates_no_shapes() {
+  const double DT = 1.0 / 60;
+  const int TICKS = 600;
+
+  scene_t *scene = make_game_scene();
+  body_set_velocity(scene_get_body(scene, 0), (vector_t){TANK_SPEED, 0});
+  body_set_velocity(scene_get_body(scene, 1), (vector_t){-TANK_SPEED, 0});
+  body_set_rotation_speed(scene_get_body(scene, 1), 1.0);
+  body_t *star = body_init(
+      make_star((vector_t){MAX_WIDTH_GAME / 2, MAX_HEIGHT_GAME / 2},
+                STAR_LENGTH, STAR_POINTS),
+      TANK_MASS, (rgb_color_t){0, 1, 0});
+  body_set_velocity(star, (vector_t){0, TANK_SPEED});
+  body_set_rotation_speed(star, 1.0);
+  scene_add_body(scene, star);
+  scene_tick(scene, DT);
+  size_t allocations = polygon_allocation_count();
+  for (int i = 0; i < TICKS; i++) {
+    scene_tick(scene, DT);
+  }
+  assert(polygon_allocation_count() == allocations);
+  scene_free(scene);
+}
+
+// The borrowed shape is the body's own polygon, updated when peeked again
+void test_peek_shape() {
+  scene_t *scene = make_game_scene();
+  body_t *player1 = scene_get_body(scene, 0);
+  const polygon_t *shape = body_peek_shape(player1);
+  assert(polygon_size(shape) == 4);
+  assert(vec_isclose(polygon_centroid(shape), body_get_centroid(player1)));
+
+  size_t allocations = polygon_allocation_count();
+  body_set_velocity(player1, (vector_t){TANK_SPEED, 0});
+  scene_tick(scene, 0.1);
+  assert(body_peek_shape(player1) == shape);
+  assert(vec_isclose(polygon_centroid(shape), body_get_centroid(player1)));
+  assert(polygon_allocation_count() == allocations);
+
+  polygon_t copy = body_get_shape(player1);
+  assert(polygon_points(&copy) != polygon_points(shape));
+  assert(vec_equal(polygon_get(&copy, 0), polygon_get(shape, 0)));
+  polygon_free(&copy);
+  scene_free(scene);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests? True if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_tick_allocates_no_shapes)
+  DO_TEST(test_peek_shape)
+
+  puts("map tests pass");
+}
@@ -5,226 +5,232 @@
 #include <math.h>
 #include <stdlib.h>
 
-/*
 // Make square at (+/-1, +/-1)
-list_t *make_square() {
-    list_t *sq = vec_list_init(4);
-    vector_t *v = malloc(sizeof(*v));
-    *v = (vector_t) {+1, +1};
-    vec_list_add(sq, v);
-    v = malloc(sizeof(*v));
-    *v = (vector_t) {-1, +1};
-    vec_list_add(sq, v);
-    v = malloc(sizeof(*v));
-    *v = (vector_t) {-1, -1};
-    vec_list_add(sq, v);
-    v = malloc(sizeof(*v));
-    *v = (vector_t) {+1, -1};
-    vec_list_add(sq, v);
-    return sq;
+polygon_t make_square() {
+  polygon_t sq = polygon_init(4);
+  polygon_add(&sq, (vector_t){+1, +1});
+  polygon_add(&sq, (vector_t){-1, +1});
+  polygon_add(&sq, (vector_t){-1, -1});
+  polygon_add(&sq, (vector_t){+1, -1});
+  return sq;
 }
 
-
-
 void test_square_area_centroid() {
-    list_t *sq = make_square();
-    assert(isclose(polygon_area(sq), 4));
-    assert(vec_isclose(polygon_centroid(sq), VEC_ZERO));
-    vec_list_free(sq);
+  polygon_t sq = make_square();
+  assert(isclose(polygon_area(&sq), 4));
+  assert(vec_isclose(polygon_centroid(&sq), VEC_ZERO));
+  polygon_free(&sq);
 }
 
 void test_square_translate() {
-    list_t *sq = make_square();
-    polygon_translate(sq, (vector_t) {2, 3});
-    assert(vec_equal(*vec_list_get(sq, 0), (vector_t) {3, 4}));
-    assert(vec_equal(*vec_list_get(sq, 1), (vector_t) {1, 4}));
-    assert(vec_equal(*vec_list_get(sq, 2), (vector_t) {1, 2}));
-    assert(vec_equal(*vec_list_get(sq, 3), (vector_t) {3, 2}));
-    assert(isclose(polygon_area(sq), 4));
-    assert(vec_isclose(polygon_centroid(sq), (vector_t) {2, 3}));
-    vec_list_free(sq);
+  polygon_t sq = make_square();
+  polygon_translate(&sq, (vector_t){2, 3});
+  assert(vec_equal(polygon_get(&sq, 0), (vector_t){3, 4}));
+  assert(vec_equal(polygon_get(&sq, 1), (vector_t){1, 4}));
+  assert(vec_equal(polygon_get(&sq, 2), (vector_t){1, 2}));
+  assert(vec_equal(polygon_get(&sq, 3), (vector_t){3, 2}));
+  assert(isclose(polygon_area(&sq), 4));
+  assert(vec_isclose(polygon_centroid(&sq), (vector_t){2, 3}));
+  polygon_free(&sq);
 }
 
 void test_square_rotate() {
-    list_t *sq = make_square();
-    polygon_rotate(sq, 0.25 * M_PI, VEC_ZERO);
-    assert(vec_isclose(*vec_list_get(sq, 0), (vector_t) {0, sqrt(2)}));
-    assert(vec_isclose(*vec_list_get(sq, 1), (vector_t) {-sqrt(2), 0}));
-    assert(vec_isclose(*vec_list_get(sq, 2), (vector_t) {0, -sqrt(2)}));
-    assert(vec_isclose(*vec_list_get(sq, 3), (vector_t) {sqrt(2), 0}));
-    assert(isclose(polygon_area(sq), 4));
-    assert(vec_isclose(polygon_centroid(sq), VEC_ZERO));
-    vec_list_free(sq);
+  polygon_t sq = make_square();
+  polygon_rotate(&sq, 0.25 * M_PI, VEC_ZERO);
+  assert(vec_isclose(polygon_get(&sq, 0), (vector_t){0, sqrt(2)}));
+  assert(vec_isclose(polygon_get(&sq, 1), (vector_t){-sqrt(2), 0}));
+  assert(vec_isclose(polygon_get(&sq, 2), (vector_t){0, -sqrt(2)}));
+  assert(vec_isclose(polygon_get(&sq, 3), (vector_t){sqrt(2), 0}));
+  assert(isclose(polygon_area(&sq), 4));
+  assert(vec_isclose(polygon_centroid(&sq), VEC_ZERO));
+  polygon_free(&sq);
 }
 
 // Make 3-4-5 triangle
-list_t *make_triangle() {
-    list_t *tri = vec_list_init(3);
-    vector_t *v = malloc(sizeof(*v));
-    *v = VEC_ZERO;
-    vec_list_add(tri, v);
-    v = malloc(sizeof(*v));
-    *v = (vector_t) {4, 0};
-    vec_list_add(tri, v);
-    v = malloc(sizeof(*v));
-    *v = (vector_t) {4, 3};
-    vec_list_add(tri, v);
-    return tri;
+polygon_t make_triangle() {
+  polygon_t tri = polygon_init(3);
+  polygon_add(&tri, VEC_ZERO);
+  polygon_add(&tri, (vector_t){4, 0});
+  polygon_add(&tri, (vector_t){4, 3});
+  return tri;
 }
 
 void test_triangle_area_centroid() {
-    list_t *tri = make_triangle();
-    assert(isclose(polygon_area(tri), 6));
-    assert(vec_isclose(polygon_centroid(tri), (vector_t) {8.0 / 3.0, 1}));
-    vec_list_free(tri);
+  polygon_t tri = make_triangle();
+  assert(isclose(polygon_area(&tri), 6));
+  assert(vec_isclose(polygon_centroid(&tri), (vector_t){8.0 / 3.0, 1}));
+  polygon_free(&tri);
 }
 
 void test_triangle_translate() {
-    list_t *tri = make_triangle();
-    polygon_translate(tri, (vector_t) {-4, -3});
-    assert(vec_equal(*vec_list_get(tri, 0), (vector_t) {-4, -3}));
-    assert(vec_equal(*vec_list_get(tri, 1), (vector_t) {0,  -3}));
-    assert(vec_equal(*vec_list_get(tri, 2), (vector_t) {0,  0}));
-    assert(isclose(polygon_area(tri), 6));
-    assert(vec_isclose(polygon_centroid(tri), (vector_t) {-4.0 / 3.0, -2}));
-    vec_list_free(tri);
+  polygon_t tri = make_triangle();
+  polygon_translate(&tri, (vector_t){-4, -3});
+  assert(vec_equal(polygon_get(&tri, 0), (vector_t){-4, -3}));
+  assert(vec_equal(polygon_get(&tri, 1), (vector_t){0, -3}));
+  assert(vec_equal(polygon_get(&tri, 2), (vector_t){0, 0}));
+  assert(isclose(polygon_area(&tri), 6));
+  assert(vec_isclose(polygon_centroid(&tri), (vector_t){-4.0 / 3.0, -2}));
+  polygon_free(&tri);
 }
 
 void test_triangle_rotate() {
-    list_t *tri = make_triangle();
+  polygon_t tri = make_triangle();
 
-    // Rotate -acos(4/5) degrees around (4,3)
-    polygon_rotate(tri, -acos(4.0 / 5.0), (vector_t) {4, 3});
-    assert(vec_isclose(*vec_list_get(tri, 0), (vector_t) {-1,  3}));
-    assert(vec_isclose(*vec_list_get(tri, 1), (vector_t) {2.2, 0.6}));
-    assert(vec_isclose(*vec_list_get(tri, 2), (vector_t) {4,   3}));
-    assert(isclose(polygon_area(tri), 6));
-    assert(vec_isclose(polygon_centroid(tri), (vector_t) {26.0 / 15.0, 2.2}));
+  // Rotate -acos(4/5) degrees around (4,3)
+  polygon_rotate(&tri, -acos(4.0 / 5.0), (vector_t){4, 3});
+  assert(vec_isclose(polygon_get(&tri, 0), (vector_t){-1, 3}));
+  assert(vec_isclose(polygon_get(&tri, 1), (vector_t){2.2, 0.6}));
+  assert(vec_isclose(polygon_get(&tri, 2), (vector_t){4, 3}));
+  assert(isclose(polygon_area(&tri), 6));
+  assert(vec_isclose(polygon_centroid(&tri), (vector_t){26.0 / 15.0, 2.2}));
 
-    vec_list_free(tri);
+  polygon_free(&tri);
 }
 
 #define CIRC_NPOINTS 1000000
 #define CIRC_AREA (CIRC_NPOINTS * sin(2 * M_PI / CIRC_NPOINTS) / 2)
 
 // Circle with many points (stress test)
-list_t *make_big_circ() {
-    list_t *c = vec_list_init(CIRC_NPOINTS);
-    for (size_t i = 0; i < CIRC_NPOINTS; i++) {
-        double angle = 2 * M_PI * i / CIRC_NPOINTS;
-        vector_t *v = malloc(sizeof(*v));
-        *v = (vector_t) {cos(angle), sin(angle)};
-        vec_list_add(c, v);
-    }
-    return c;
+polygon_t make_big_circ() {
+  polygon_t c = polygon_init(CIRC_NPOINTS);
+  for (size_t i = 0; i < CIRC_NPOINTS; i++) {
+    double angle = 2 * M_PI * i / CIRC_NPOINTS;
+    polygon_add(&c, (vector_t){cos(angle), sin(angle)});
+  }
+  return c;
 }
 
 void test_circ_area_centroid() {
-    list_t *c = make_big_circ();
-    assert(isclose(polygon_area(c), CIRC_AREA));
-    assert(vec_isclose(polygon_centroid(c), VEC_ZERO));
-    vec_list_free(c);
+  polygon_t c = make_big_circ();
+  assert(isclose(polygon_area(&c), CIRC_AREA));
+  assert(vec_isclose(polygon_centroid(&c), VEC_ZERO));
+  polygon_free(&c);
 }
 
 void test_circ_translate() {
-    list_t *c = make_big_circ();
-    polygon_translate(c, (vector_t) {100, 200});
+  polygon_t c = make_big_circ();
+  polygon_translate(&c, (vector_t){100, 200});
 
-    for (size_t i = 0; i < CIRC_NPOINTS; i++) {
-        double angle = 2 * M_PI * i / CIRC_NPOINTS;
-        assert(vec_isclose(
-            *vec_list_get(c, i),
-            (vector_t) {100 + cos(angle), 200 + sin(angle)}
-        ));
-    }
-    assert(isclose(polygon_area(c), CIRC_AREA));
-    assert(vec_isclose(polygon_centroid(c), (vector_t) {100, 200}));
+  for (size_t i = 0; i < CIRC_NPOINTS; i++) {
+    double angle = 2 * M_PI * i / CIRC_NPOINTS;
+    assert(vec_isclose(polygon_get(&c, i),
+                       (vector_t){100 + cos(angle), 200 + sin(angle)}));
+  }
+  assert(isclose(polygon_area(&c), CIRC_AREA));
+  assert(vec_isclose(polygon_centroid(&c), (vector_t){100, 200}));
 
-    vec_list_free(c);
+  polygon_free(&c);
 }
 
 void test_circ_rotate() {
-    // Rotate about the origin at an unusual angle
-    const double ROT_ANGLE = 0.5;
+  // Rotate about the origin at an unusual angle
+  const double ROT_ANGLE = 0.5;
 
-    list_t *c = make_big_circ();
-    polygon_rotate(c, ROT_ANGLE, VEC_ZERO);
+  polygon_t c = make_big_circ();
+  polygon_rotate(&c, ROT_ANGLE, VEC_ZERO);
 
-    for (size_t i = 0; i < CIRC_NPOINTS; i++) {
-        double angle = 2 * M_PI * i / CIRC_NPOINTS;
-        assert(vec_isclose(
-            *vec_list_get(c, i),
-            (vector_t) {cos(angle + ROT_ANGLE), sin(angle + ROT_ANGLE)}
-        ));
-    }
-    assert(isclose(polygon_area(c), CIRC_AREA));
-    assert(vec_isclose(polygon_centroid(c), VEC_ZERO));
+  for (size_t i = 0; i < CIRC_NPOINTS; i++) {
+    double angle = 2 * M_PI * i / CIRC_NPOINTS;
+    assert(vec_isclose(polygon_get(&c, i), (vector_t){cos(angle + ROT_ANGLE),
+                                                      sin(angle + ROT_ANGLE)}));
+  }
+  assert(isclose(polygon_area(&c), CIRC_AREA));
+  assert(vec_isclose(polygon_centroid(&c), VEC_ZERO));
 
-    vec_list_free(c);
+  polygon_free(&c);
 }
 
 // Weird nonconvex polygon
-list_t *make_weird() {
-    list_t *w = vec_list_init(5);
-    vector_t *v = malloc(sizeof(*v));
-    *v = VEC_ZERO;
-    vec_list_add(w, v);
-    v = malloc(sizeof(*v));
-    *v = (vector_t) {4, 1};
-    vec_list_add(w, v);
-    v = malloc(sizeof(*v));
-    *v = (vector_t) {-2, 1};
-    vec_list_add(w, v);
-    v = malloc(sizeof(*v));
-    *v = (vector_t) {-5, 5};
-    vec_list_add(w, v);
-    v = malloc(sizeof(*v));
-    *v = (vector_t) {-1, -8};
-    vec_list_add(w, v);
-    return w;
+polygon_t make_weird() {
+  polygon_t w = polygon_init(5);
+  polygon_add(&w, VEC_ZERO);
+  polygon_add(&w, (vector_t){4, 1});
+  polygon_add(&w, (vector_t){-2, 1});
+  polygon_add(&w, (vector_t){-5, 5});
+  polygon_add(&w, (vector_t){-1, -8});
+  return w;
 }
 
 void test_weird_area_centroid() {
-    list_t *w = make_weird();
-    assert(isclose(polygon_area(w), 23));
-    assert(vec_isclose(polygon_centroid(w), (vector_t) {-223.0 / 138.0, -51.0
-/ 46.0})); vec_list_free(w);
+  polygon_t w = make_weird();
+  assert(isclose(polygon_area(&w), 23));
+  assert(vec_isclose(polygon_centroid(&w),
+                     (vector_t){-223.0 / 138.0, -51.0 / 46.0}));
+  polygon_free(&w);
 }
 
 void test_weird_translate() {
-    list_t *w = make_weird();
-    polygon_translate(w, (vector_t) {-10, -20});
-
-    assert(vec_isclose(*vec_list_get(w, 0), (vector_t) {-10, -20}));
-    assert(vec_isclose(*vec_list_get(w, 1), (vector_t) {-6,  -19}));
-    assert(vec_isclose(*vec_list_get(w, 2), (vector_t) {-12, -19}));
-    assert(vec_isclose(*vec_list_get(w, 3), (vector_t) {-15, -15}));
-    assert(vec_isclose(*vec_list_get(w, 4), (vector_t) {-11, -28}));
-    assert(isclose(polygon_area(w), 23));
-    assert(vec_isclose(polygon_centroid(w), (vector_t) {-1603.0 / 138.0, -971.0
-/ 46.0}));
-
-    vec_list_free(w);
+  polygon_t w = make_weird();
+  polygon_translate(&w, (vector_t){-10, -20});
+
+  assert(vec_isclose(polygon_get(&w, 0), (vector_t){-10, -20}));
+  assert(vec_isclose(polygon_get(&w, 1), (vector_t){-6, -19}));
+  assert(vec_isclose(polygon_get(&w, 2), (vector_t){-12, -19}));
+  assert(vec_isclose(polygon_get(&w, 3), (vector_t){-15, -15}));
+  assert(vec_isclose(polygon_get(&w, 4), (vector_t){-11, -28}));
+  assert(isclose(polygon_area(&w), 23));
+  assert(vec_isclose(polygon_centroid(&w),
+                     (vector_t){-1603.0 / 138.0, -971.0 / 46.0}));
+
+  polygon_free(&w);
 }
 
 void test_weird_rotate() {
-    list_t *w = make_weird();
-    // Rotate 90 degrees around (0, 2)
-    polygon_rotate(w, M_PI / 2, (vector_t) {0, 2});
+  polygon_t w = make_weird();
+  // Rotate 90 degrees around (0, 2)
+  polygon_rotate(&w, M_PI / 2, (vector_t){0, 2});
+
+  assert(vec_isclose(polygon_get(&w, 0), (vector_t){2, 2}));
+  assert(vec_isclose(polygon_get(&w, 1), (vector_t){1, 6}));
+  assert(vec_isclose(polygon_get(&w, 2), (vector_t){1, 0}));
+  assert(vec_isclose(polygon_get(&w, 3), (vector_t){-3, -3}));
+  assert(vec_isclose(polygon_get(&w, 4), (vector_t){10, 1}));
+  assert(isclose(polygon_area(&w), 23));
+  assert(vec_isclose(polygon_centroid(&w),
+                     (vector_t){143.0 / 46.0, 53.0 / 138.0}));
+
+  polygon_free(&w);
+}
 
-    assert(vec_isclose(*vec_list_get(w, 0), (vector_t) {2,  2}));
-    assert(vec_isclose(*vec_list_get(w, 1), (vector_t) {1,  6}));
-    assert(vec_isclose(*vec_list_get(w, 2), (vector_t) {1,  0}));
-    assert(vec_isclose(*vec_list_get(w, 3), (vector_t) {-3, -3}));
-    assert(vec_isclose(*vec_list_get(w, 4), (vector_t) {10, 1}));
-    assert(isclose(polygon_area(w), 23));
-    assert(vec_isclose(polygon_centroid(w), (vector_t) {143.0 / 46.0, 53.0 /
-138.0}));
+void polygon_get_past_end(polygon_t *polygon) {
+  polygon_get(polygon, polygon_size(polygon));
+}
 
-    vec_list_free(w);
+// Grows a polygon past its inline storage one vertex at a time
+void test_grow_past_inline() {
+  polygon_t p = polygon_init(0);
+  for (size_t i = 0; i < 3 * POLYGON_INLINE_SIZE; i++) {
+    polygon_add(&p, (vector_t){i, -(double)i});
+    assert(polygon_size(&p) == i + 1);
+  }
+  for (size_t i = 0; i < 3 * POLYGON_INLINE_SIZE; i++) {
+    assert(vec_equal(polygon_get(&p, i), (vector_t){i, -(double)i}));
+  }
+  assert(test_assert_fail((free_func_t)polygon_get_past_end, &p));
+  polygon_free(&p);
 }
 
-*/
+// Copies are independent of the original, whether inline or on the heap
+void test_copy() {
+  polygon_t sq = make_square();
+  polygon_t sq_copy = polygon_copy(&sq);
+  polygon_translate(&sq, (vector_t){5, 5});
+  assert(vec_equal(polygon_get(&sq_copy, 0), (vector_t){+1, +1}));
+  assert(vec_equal(polygon_get(&sq, 0), (vector_t){6, 6}));
+  polygon_free(&sq);
+  polygon_free(&sq_copy);
+
+  polygon_t w = polygon_init(POLYGON_INLINE_SIZE + 1);
+  for (size_t i = 0; i < POLYGON_INLINE_SIZE + 1; i++) {
+    polygon_add(&w, (vector_t){i, 0});
+  }
+  polygon_t w_copy = polygon_copy(&w);
+  polygon_free(&w);
+  assert(polygon_size(&w_copy) == POLYGON_INLINE_SIZE + 1);
+  assert(vec_equal(polygon_get(&w_copy, POLYGON_INLINE_SIZE),
+                   (vector_t){POLYGON_INLINE_SIZE, 0}));
+  polygon_free(&w_copy);
+}
 
 int main(int argc, char *argv[]) {
   // Run all tests? True if there are no command-line arguments
@@ -235,18 +241,20 @@ int main(int argc, char *argv[]) {
     read_testname(argv[1], testname, sizeof(testname));
   }
 
-  // DO_TEST(test_square_area_centroid)
-  // DO_TEST(test_square_translate)
-  // DO_TEST(test_square_rotate)
-  // DO_TEST(test_triangle_area_centroid)
-  // DO_TEST(test_triangle_translate)
-  // DO_TEST(test_triangle_rotate)
-  // DO_TEST(test_circ_area_centroid)
-  // DO_TEST(test_circ_translate)
-  // DO_TEST(test_circ_rotate)
-  // DO_TEST(test_weird_area_centroid)
-  // DO_TEST(test_weird_translate)
-  // DO_TEST(test_weird_rotate)
+  DO_TEST(test_square_area_centroid)
+  DO_TEST(test_square_translate)
+  DO_TEST(test_square_rotate)
+  DO_TEST(test_triangle_area_centroid)
+  DO_TEST(test_triangle_translate)
+  DO_TEST(test_triangle_rotate)
+  DO_TEST(test_circ_area_centroid)
+  DO_TEST(test_circ_translate)
+  DO_TEST(test_circ_rotate)
+  DO_TEST(test_weird_area_centroid)
+  DO_TEST(test_weird_translate)
+  DO_TEST(test_weird_rotate)
+  DO_TEST(test_grow_past_inline)
+  DO_TEST(test_copy)
 
   puts("polygon_test PASS");
 }
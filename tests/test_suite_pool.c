@@ -0,0 +1,94 @@
+#include "pool.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+const size_t RECORD_SIZE = 24;
+const size_t SLAB_RECORDS = 4;
+// enough records to fill several slabs
+const size_t RECORD_COUNT = 10;
+
+void test_empty_pool() {
+  pool_t *pool = pool_init(RECORD_SIZE, SLAB_RECORDS);
+  pool_stats_t stats = pool_get_stats(pool);
+  assert(stats.live == 0 && stats.peak == 0 && stats.slabs == 0);
+  pool_release(pool, NULL);
+  pool_free(pool);
+}
+
+// Records are distinct, aligned and usable, and slabs are added as needed
+void test_alloc() {
+  pool_t *pool = pool_init(RECORD_SIZE, SLAB_RECORDS);
+  char *records[RECORD_COUNT];
+  for (size_t i = 0; i < RECORD_COUNT; i++) {
+    records[i] = pool_alloc(pool);
+    assert((uintptr_t)records[i] % _Alignof(max_align_t) == 0);
+    memset(records[i], (int)i, RECORD_SIZE);
+  }
+  for (size_t i = 0; i < RECORD_COUNT; i++) {
+    for (size_t j = 0; j < RECORD_SIZE; j++) {
+      assert(records[i][j] == (char)i);
+    }
+  }
+  pool_stats_t stats = pool_get_stats(pool);
+  assert(stats.live == RECORD_COUNT && stats.peak == RECORD_COUNT);
+  assert(stats.slabs == (RECORD_COUNT + SLAB_RECORDS - 1) / SLAB_RECORDS);
+  pool_free(pool);
+}
+
+// Released records are handed out again before any new slab is added
+void test_reuse() {
+  pool_t *pool = pool_init(RECORD_SIZE, SLAB_RECORDS);
+  void *records[RECORD_COUNT];
+  for (size_t i = 0; i < RECORD_COUNT; i++) {
+    records[i] = pool_alloc(pool);
+  }
+  size_t slabs = pool_get_stats(pool).slabs;
+  for (size_t round = 0; round < 3; round++) {
+    for (size_t i = 0; i < RECORD_COUNT; i += 2) {
+      pool_release(pool, records[i]);
+    }
+    assert(pool_get_stats(pool).live == RECORD_COUNT / 2);
+    for (size_t i = 0; i < RECORD_COUNT; i += 2) {
+      records[i] = pool_alloc(pool);
+      for (size_t j = 1; j < RECORD_COUNT; j += 2) {
+        assert(records[i] != records[j]);
+      }
+    }
+  }
+  pool_stats_t stats = pool_get_stats(pool);
+  assert(stats.live == RECORD_COUNT && stats.peak == RECORD_COUNT);
+  assert(stats.slabs == slabs);
+  pool_free(pool);
+}
+
+// Records smaller than a pointer still fit on the free list
+void test_tiny_records() {
+  pool_t *pool = pool_init(1, SLAB_RECORDS);
+  void *first = pool_alloc(pool);
+  void *second = pool_alloc(pool);
+  assert(first != second);
+  pool_release(pool, first);
+  assert(pool_alloc(pool) == first);
+  pool_free(pool);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_empty_pool)
+  DO_TEST(test_alloc)
+  DO_TEST(test_reuse)
+  DO_TEST(test_tiny_records)
+
+  puts("pool_test PASS");
+}
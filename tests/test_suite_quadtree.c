@@ -0,0 +1,116 @@
+#include "quadtree.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+/** Sums the pull of every mass, as a baseline. */
+vector_t every_mass_field(const vector_t *points, const double *masses,
+                          size_t count, vector_t point, double min_distance) {
+  vector_t field = VEC_ZERO;
+  for (size_t i = 0; i < count; i++) {
+    vector_t offset = vec_subtract(points[i], point);
+    double distance = sqrt(vec_dot(offset, offset));
+    if (distance >= min_distance && distance > 0) {
+      field = vec_add(field, vec_multiply(masses[i] / pow(distance, 3), offset));
+    }
+  }
+  return field;
+}
+
+void test_empty_tree() {
+  quadtree_t *tree = quadtree_init();
+  assert(vec_isclose(quadtree_field(tree, VEC_ZERO, 0.5, 0), VEC_ZERO));
+  quadtree_build(tree, NULL, NULL, 0);
+  assert(vec_isclose(quadtree_field(tree, VEC_ZERO, 0.5, 0), VEC_ZERO));
+  quadtree_free(tree);
+}
+
+void test_single_mass() {
+  quadtree_t *tree = quadtree_init();
+  vector_t point = {3, 4};
+  double mass = 50;
+  quadtree_build(tree, &point, &mass, 1);
+  // 50 / 5^2 towards the mass
+  assert(vec_isclose(quadtree_field(tree, VEC_ZERO, 0.5, 0),
+                     (vector_t){1.2, 1.6}));
+  // the mass does not pull on itself, or on points too close to it
+  assert(vec_isclose(quadtree_field(tree, point, 0.5, 0), VEC_ZERO));
+  assert(vec_isclose(quadtree_field(tree, VEC_ZERO, 0.5, 6), VEC_ZERO));
+  quadtree_free(tree);
+}
+
+// Many masses in one place cannot be split apart, but still pull together
+void test_coincident_masses() {
+  const size_t COUNT = 100;
+  vector_t points[COUNT];
+  double masses[COUNT];
+  for (size_t i = 0; i < COUNT; i++) {
+    points[i] = (vector_t){10, 0};
+    masses[i] = 1;
+  }
+  quadtree_t *tree = quadtree_init();
+  quadtree_build(tree, points, masses, COUNT);
+  assert(vec_isclose(quadtree_field(tree, VEC_ZERO, 0.5, 0),
+                     (vector_t){1, 0}));
+  assert(vec_isclose(quadtree_field(tree, VEC_ZERO, 0, 0), (vector_t){1, 0}));
+  quadtree_free(tree);
+}
+
+// Theta 0 is exact, and larger angles stay close to the exact field
+void test_matches_every_mass() {
+  const size_t COUNT = 2000;
+  const size_t SAMPLES = 100;
+  const double MIN_DISTANCE = 1;
+  vector_t *points = malloc(sizeof(vector_t) * COUNT);
+  double *masses = malloc(sizeof(double) * COUNT);
+  srand(8);
+  for (size_t i = 0; i < COUNT; i++) {
+    // a dense clump and a sparse field, to get an uneven tree
+    double spread = i % 4 == 0 ? 50 : 1000;
+    points[i] = (vector_t){spread * rand() / RAND_MAX,
+                           spread * rand() / RAND_MAX};
+    masses[i] = rand() % 20 + 1;
+  }
+  quadtree_t *tree = quadtree_init();
+  // building twice reuses the tree
+  quadtree_build(tree, points + 1, masses + 1, COUNT / 2);
+  quadtree_build(tree, points, masses, COUNT);
+
+  double error = 0;
+  double magnitude = 0;
+  for (size_t i = 0; i < SAMPLES; i++) {
+    vector_t point = points[i * (COUNT / SAMPLES)];
+    vector_t exact =
+        every_mass_field(points, masses, COUNT, point, MIN_DISTANCE);
+    vector_t field = quadtree_field(tree, point, 0, MIN_DISTANCE);
+    vector_t gap = vec_subtract(field, exact);
+    assert(sqrt(vec_dot(gap, gap)) <= 1e-9 * sqrt(vec_dot(exact, exact)));
+
+    gap = vec_subtract(quadtree_field(tree, point, 0.5, MIN_DISTANCE), exact);
+    error += vec_dot(gap, gap);
+    magnitude += vec_dot(exact, exact);
+  }
+  // within 1% overall
+  assert(sqrt(error / magnitude) < 0.01);
+  free(points);
+  free(masses);
+  quadtree_free(tree);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_empty_tree)
+  DO_TEST(test_single_mass)
+  DO_TEST(test_coincident_masses)
+  DO_TEST(test_matches_every_mass)
+
+  puts("quadtree_test PASS");
+}
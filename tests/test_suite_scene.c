@@ -2,6 +2,7 @@
 #include "test_util.h"
 #include <assert.h>
 #include <math.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 void scene_get_first(void *scene) { scene_get_body(scene, 0); }
@@ -17,20 +18,12 @@ void test_empty_scene() {
   scene_free(scene);
 }
 
-list_t *make_shape() {
-  list_t *shape = list_init(4, free);
-  vector_t *v = malloc(sizeof(*v));
-  *v = (vector_t){-1, -1};
-  list_add(shape, v);
-  v = malloc(sizeof(*v));
-  *v = (vector_t){+1, -1};
-  list_add(shape, v);
-  v = malloc(sizeof(*v));
-  *v = (vector_t){+1, +1};
-  list_add(shape, v);
-  v = malloc(sizeof(*v));
-  *v = (vector_t){-1, +1};
-  list_add(shape, v);
+polygon_t make_shape() {
+  polygon_t shape = polygon_init(4);
+  polygon_add(&shape, (vector_t){-1, -1});
+  polygon_add(&shape, (vector_t){+1, -1});
+  polygon_add(&shape, (vector_t){+1, +1});
+  polygon_add(&shape, (vector_t){-1, +1});
   return shape;
 }
 
@@ -86,6 +79,35 @@ void test_scene() {
   scene_free(scene);
 }
 
+void test_scene_keeps_body_state() {
+  // State set before a body joins a scene must survive the move
+  body_t *body1 = body_init(make_shape(), 1, (rgb_color_t){1, 1, 1});
+  body_t *body2 = body_init(make_shape(), 2, (rgb_color_t){1, 1, 1});
+  body_t *body3 = body_init(make_shape(), 3, (rgb_color_t){1, 1, 1});
+  body_set_centroid(body1, (vector_t){1, 0});
+  body_set_velocity(body2, (vector_t){0, 2});
+  body_set_rotation(body3, M_PI / 2);
+  body_add_force(body3, (vector_t){3, 0});
+  scene_t *scene = scene_init();
+  scene_add_body(scene, body1);
+  scene_add_body(scene, body2);
+  scene_add_body(scene, body3);
+  assert(vec_isclose(body_get_centroid(body1), (vector_t){1, 0}));
+  assert(vec_isclose(body_get_velocity(body2), (vector_t){0, 2}));
+  assert(isclose(body_get_rotation(body3), M_PI / 2));
+  assert(body_get_mass(body3) == 3);
+
+  // Removing the first body must not disturb the ones after it
+  body_remove(body1);
+  scene_tick(scene, 1);
+  assert(scene_bodies(scene) == 2);
+  assert(vec_isclose(body_get_centroid(body2), (vector_t){0, 2}));
+  assert(vec_isclose(body_get_velocity(body3), (vector_t){1, 0}));
+  assert(vec_isclose(body_get_centroid(body3), (vector_t){0.5, 0}));
+  assert(body_get_mass(body2) == 2);
+  scene_free(scene);
+}
+
 // A force creator that moves a body in uniform circular motion about the origin
 void centripetal_force(void *aux) {
   body_t *body = aux;
@@ -230,6 +252,647 @@ void test_reaping() {
   scene_free(scene);
 }
 
+/*
+    This test checks that batched forces reach their kernel together,
+    survive their arrays growing, and are dropped with their bodies
+    while the rest keep their order.
+*/
+typedef struct {
+  size_t calls;
+  double sum;
+  size_t count;
+} kernel_log_t;
+kernel_log_t kernel_log;
+void log_records(const force_record_t *records, size_t count) {
+  kernel_log.calls++;
+  kernel_log.count = count;
+  kernel_log.sum = 0;
+  for (size_t i = 0; i < count; i++) {
+    assert(i == 0 || records[i].constant > records[i - 1].constant);
+    kernel_log.sum += records[i].constant;
+  }
+}
+
+size_t count_links(body_t *body) {
+  size_t count = 0;
+  for (force_link_t *link = body_get_force_links(body); link != NULL;
+       link = link->next) {
+    count++;
+  }
+  return count;
+}
+
+void test_batched_forces() {
+  const size_t BODY_COUNT = 10;
+  scene_t *scene = scene_init();
+  for (size_t i = 0; i < BODY_COUNT; i++) {
+    scene_add_body(scene, body_init(make_shape(), 1, (rgb_color_t){0, 0, 0}));
+  }
+  // a record for every body and every pair, numbered in order
+  double constant = 0;
+  double total = 0;
+  for (size_t i = 0; i < BODY_COUNT; i++) {
+    body_t *body = scene_get_body(scene, i);
+    scene_add_batched_force(scene, log_records, body, NULL, ++constant);
+    total += constant;
+    for (size_t j = 0; j < i; j++) {
+      scene_add_batched_force(scene, log_records, body,
+                              scene_get_body(scene, j), ++constant);
+      total += constant;
+    }
+  }
+  for (size_t i = 0; i < BODY_COUNT; i++) {
+    assert(count_links(scene_get_body(scene, i)) == BODY_COUNT);
+  }
+  kernel_log = (kernel_log_t){0, 0, 0};
+  scene_tick(scene, 1);
+  assert(kernel_log.calls == 1 && kernel_log.count == (size_t)constant);
+  assert(isclose(kernel_log.sum, total));
+
+  // renumber the records to find the ones acting on body 3
+  body_t *removed = scene_get_body(scene, 3);
+  double removed_sum = 0;
+  size_t removed_count = 0;
+  constant = 0;
+  for (size_t i = 0; i < BODY_COUNT; i++) {
+    constant++;
+    if (i == 3) {
+      removed_sum += constant;
+      removed_count++;
+    }
+    for (size_t j = 0; j < i; j++) {
+      constant++;
+      if (i == 3 || j == 3) {
+        removed_sum += constant;
+        removed_count++;
+      }
+    }
+  }
+  body_remove(removed);
+  scene_tick(scene, 1);
+  scene_tick(scene, 1);
+  assert(kernel_log.count == (size_t)constant - removed_count);
+  assert(isclose(kernel_log.sum, total - removed_sum));
+  for (size_t i = 0; i < scene_bodies(scene); i++) {
+    assert(count_links(scene_get_body(scene, i)) == BODY_COUNT - 1);
+  }
+
+  // removing the rest one at a time leaves an empty batch
+  while (scene_bodies(scene) > 0) {
+    body_remove(scene_get_body(scene, 0));
+    scene_tick(scene, 1);
+  }
+  scene_tick(scene, 1);
+  assert(kernel_log.count == 0);
+  scene_free(scene);
+}
+
+/*
+    This test checks that force creators and their pooled records
+    are returned to the scene's pool once their bodies are removed,
+    and that later ones reuse them without adding slabs.
+*/
+typedef struct {
+  scene_t *scene;
+  size_t calls;
+} pooled_aux_t;
+void count_pooled_calls(pooled_aux_t *aux) { aux->calls++; }
+void release_pooled_aux(pooled_aux_t *aux) { scene_release(aux->scene, aux); }
+
+void add_pooled_forces(scene_t *scene, size_t count) {
+  body_t *anchor = scene_get_body(scene, 0);
+  for (size_t i = 0; i < count; i++) {
+    body_t *body = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    scene_add_body(scene, body);
+    pooled_aux_t *aux = scene_alloc(scene, sizeof(pooled_aux_t));
+    *aux = (pooled_aux_t){scene, 0};
+    scene_add_pair_force_creator(scene, (force_creator_t)count_pooled_calls,
+                                 aux, anchor, body,
+                                 (free_func_t)release_pooled_aux);
+  }
+}
+
+void test_pooled_force_creators() {
+  const size_t FORCE_COUNT = 300;
+  scene_t *scene = scene_init();
+  scene_add_body(scene, body_init(make_shape(), 1, (rgb_color_t){0, 0, 0}));
+  pool_stats_t stats = scene_get_pool_stats(scene);
+  assert(stats.live == 0 && stats.slabs == 0);
+
+  // each force creator takes one record, and its aux another
+  add_pooled_forces(scene, FORCE_COUNT);
+  stats = scene_get_pool_stats(scene);
+  assert(stats.live == 2 * FORCE_COUNT && stats.peak == stats.live);
+  assert(count_links(scene_get_body(scene, 0)) == FORCE_COUNT);
+  size_t slabs = stats.slabs;
+  assert(slabs > 0);
+
+  for (size_t i = 1; i < scene_bodies(scene); i++) {
+    body_remove(scene_get_body(scene, i));
+  }
+  scene_tick(scene, 1);
+  assert(scene_bodies(scene) == 1);
+  stats = scene_get_pool_stats(scene);
+  assert(stats.live == 0 && stats.peak == 2 * FORCE_COUNT);
+  assert(count_links(scene_get_body(scene, 0)) == 0);
+
+  add_pooled_forces(scene, FORCE_COUNT);
+  stats = scene_get_pool_stats(scene);
+  assert(stats.live == 2 * FORCE_COUNT && stats.slabs == slabs);
+
+  // a force creator on no bodies is never removed
+  pooled_aux_t *aux = scene_alloc(scene, sizeof(pooled_aux_t));
+  *aux = (pooled_aux_t){scene, 0};
+  scene_add_pair_force_creator(scene, (force_creator_t)count_pooled_calls, aux,
+                               NULL, NULL, NULL);
+  body_remove(scene_get_body(scene, 0));
+  scene_tick(scene, 1);
+  scene_tick(scene, 1);
+  assert(aux->calls == 2);
+  assert(scene_get_pool_stats(scene).live == 2);
+  scene_free(scene);
+}
+
+/*
+    This test checks that a collision rule runs its handler once
+    each time two bodies on its layers start touching,
+    passing the body on its first layer first,
+    and ignores bodies on other layers or whose masks exclude each other.
+    Each body's type is the same as its layer, to check the order.
+*/
+typedef struct {
+  int count;
+  size_t first_type;
+} rule_aux_t;
+void count_contacts(body_t *body1, body_t *body2, vector_t axis, void *aux) {
+  rule_aux_t *rule_aux = aux;
+  assert(body_get_type(body1) == rule_aux->first_type);
+  rule_aux->count++;
+}
+
+body_t *make_layered_body(size_t layer, size_t mask, vector_t centroid) {
+  size_t *info = malloc(sizeof(size_t));
+  *info = layer;
+  body_t *body =
+      body_init_with_info(make_shape(), 1, (rgb_color_t){0, 0, 0}, info, free);
+  body_set_collision_layers(body, layer, mask);
+  body_set_centroid(body, centroid);
+  return body;
+}
+
+void test_collision_rules() {
+  const size_t LAYER_A = 1 << 0, LAYER_B = 1 << 1, LAYER_C = 1 << 2;
+  const size_t ALL_LAYERS = LAYER_A | LAYER_B | LAYER_C;
+  scene_t *scene = scene_init();
+  body_t *a = make_layered_body(LAYER_A, ALL_LAYERS, (vector_t){100, 100});
+  body_t *b = make_layered_body(LAYER_B, ALL_LAYERS, (vector_t){200, 100});
+  // touches a the whole time, but no rule covers it
+  body_t *c = make_layered_body(LAYER_C, ALL_LAYERS, (vector_t){101, 100});
+  // on the same layer as a, but its mask leaves out b
+  body_t *d = make_layered_body(LAYER_A, LAYER_C, (vector_t){102, 100});
+  scene_add_body(scene, a);
+  scene_add_body(scene, b);
+  scene_add_body(scene, c);
+  scene_add_body(scene, d);
+  rule_aux_t *forward = malloc(sizeof(rule_aux_t));
+  *forward = (rule_aux_t){0, LAYER_A};
+  rule_aux_t *backward = malloc(sizeof(rule_aux_t));
+  *backward = (rule_aux_t){0, LAYER_B};
+  scene_add_collision_rule(scene, LAYER_A, LAYER_B, count_contacts, forward,
+                           free);
+  scene_add_collision_rule(scene, LAYER_B, LAYER_A, count_contacts, backward,
+                           free);
+
+  scene_tick(scene, 0);
+  assert(forward->count == 0 && backward->count == 0);
+  body_set_centroid(b, (vector_t){101.5, 100});
+  for (int i = 0; i < 3; i++) {
+    scene_tick(scene, 0);
+    assert(forward->count == 1 && backward->count == 1);
+  }
+  body_set_centroid(b, (vector_t){200, 100});
+  scene_tick(scene, 0);
+  body_set_centroid(b, (vector_t){98.5, 100});
+  scene_tick(scene, 0);
+  assert(forward->count == 2 && backward->count == 2);
+  scene_free(scene);
+}
+
+// Static bodies collide through rules but are never moved by the scene
+void test_static_bodies() {
+  const size_t LAYER_A = 1 << 0, LAYER_WALL = 1 << 1;
+  scene_t *scene = scene_init();
+  body_t *a = make_layered_body(LAYER_A, LAYER_WALL, (vector_t){100, 100});
+  body_set_velocity(a, (vector_t){20, 0});
+  scene_add_body(scene, a);
+  body_t *wall = make_layered_body(LAYER_WALL, LAYER_A, (vector_t){103, 100});
+  scene_add_static_body(scene, wall);
+  assert(body_is_static(wall) && !body_is_static(a));
+  assert(scene_bodies(scene) == 2 && scene_get_body(scene, 1) == wall);
+  rule_aux_t *rule_aux = malloc(sizeof(rule_aux_t));
+  *rule_aux = (rule_aux_t){0, LAYER_A};
+  scene_add_collision_rule(scene, LAYER_A, LAYER_WALL, count_contacts,
+                           rule_aux, free);
+
+  body_add_impulse(wall, (vector_t){-100, 0});
+  scene_tick(scene, 0.1);
+  assert(rule_aux->count == 0);
+  assert(vec_isclose(body_get_centroid(wall), (vector_t){103, 100}));
+  assert(vec_isclose(body_get_velocity(wall), VEC_ZERO));
+  scene_tick(scene, 0.1);
+  assert(rule_aux->count == 1);
+
+  // removing the wall takes it out of the tree
+  body_remove(wall);
+  scene_tick(scene, 0);
+  assert(scene_bodies(scene) == 1);
+  body_set_centroid(a, (vector_t){103, 100});
+  scene_tick(scene, 0);
+  assert(rule_aux->count == 1);
+  scene_free(scene);
+}
+
+/*
+    This test checks that a contact rule hears about a contact
+    when it begins, on each tick it persists and when it ends,
+    including when one of the bodies is removed.
+*/
+typedef struct {
+  size_t begins, persists, ends;
+  body_t *first;
+} events_aux_t;
+void count_events(body_t *body1, body_t *body2, const contact_t *contact,
+                  contact_event_t event, void *aux) {
+  events_aux_t *events = aux;
+  assert(body1 == events->first && contact->body1 == body1);
+  assert(contact->body2 == body2);
+  if (event == CONTACT_BEGIN) {
+    events->begins++;
+  } else if (event == CONTACT_PERSIST) {
+    events->persists++;
+  } else {
+    assert(event == CONTACT_END);
+    events->ends++;
+  }
+}
+
+void test_contact_events() {
+  const size_t LAYER_A = 1 << 0, LAYER_B = 1 << 1;
+  scene_t *scene = scene_init();
+  body_t *a = make_layered_body(LAYER_A, LAYER_B, (vector_t){100, 100});
+  body_t *b = make_layered_body(LAYER_B, LAYER_A, (vector_t){200, 100});
+  scene_add_body(scene, b);
+  scene_add_body(scene, a);
+  events_aux_t *all = malloc(sizeof(events_aux_t));
+  *all = (events_aux_t){0, 0, 0, a};
+  scene_add_contact_rule(scene, LAYER_A, LAYER_B,
+                         CONTACT_BEGIN | CONTACT_PERSIST | CONTACT_END,
+                         count_events, all, free);
+  // a rule on the reversed layers that skips persisting contacts
+  events_aux_t *edges = malloc(sizeof(events_aux_t));
+  *edges = (events_aux_t){0, 0, 0, b};
+  scene_add_contact_rule(scene, LAYER_B, LAYER_A, CONTACT_BEGIN | CONTACT_END,
+                         count_events, edges, free);
+
+  scene_tick(scene, 0);
+  assert(scene_contacts(scene) == 0);
+  body_set_centroid(b, (vector_t){101.5, 100});
+  for (size_t i = 0; i < 3; i++) {
+    scene_tick(scene, 0);
+  }
+  assert(all->begins == 1 && all->persists == 2 && all->ends == 0);
+  assert(edges->begins == 1 && edges->persists == 0 && edges->ends == 0);
+  assert(scene_contacts(scene) == 1);
+  const contact_t *contact = scene_find_contact(scene, a, b);
+  assert(contact == scene_get_contact(scene, 0));
+  assert(contact == scene_find_contact(scene, b, a));
+  assert(contact->first_tick == scene_ticks(scene) - 2);
+  assert(contact->last_tick == scene_ticks(scene));
+
+  body_set_centroid(b, (vector_t){200, 100});
+  scene_tick(scene, 0);
+  assert(all->ends == 1 && edges->ends == 1);
+  assert(scene_contacts(scene) == 0);
+  assert(scene_find_contact(scene, a, b) == NULL);
+
+  // removing a body ends its contacts before it is freed
+  body_set_centroid(b, (vector_t){98.5, 100});
+  scene_tick(scene, 0);
+  assert(all->begins == 2 && edges->begins == 2);
+  body_remove(b);
+  scene_tick(scene, 0);
+  assert(all->ends == 2 && edges->ends == 2);
+  assert(scene_contacts(scene) == 0);
+  scene_free(scene);
+}
+
+/*
+    This test checks that a body a handler removes has its contacts ended
+    before it is freed, so later ticks never look at it again
+    and a new body touching the same one begins a new contact.
+*/
+void remove_second(body_t *body1, body_t *body2, vector_t axis, void *aux) {
+  body_remove(body2);
+}
+
+void test_handler_removes_body() {
+  const size_t LAYER_A = 1 << 0, LAYER_B = 1 << 1;
+  scene_t *scene = scene_init();
+  body_t *a = make_layered_body(LAYER_A, LAYER_B, (vector_t){100, 100});
+  body_t *b = make_layered_body(LAYER_B, LAYER_A, (vector_t){101.5, 100});
+  scene_add_body(scene, a);
+  scene_add_body(scene, b);
+  scene_add_collision_rule(scene, LAYER_A, LAYER_B, remove_second, NULL,
+                           NULL);
+  events_aux_t *events = malloc(sizeof(events_aux_t));
+  *events = (events_aux_t){0, 0, 0, a};
+  scene_add_contact_rule(scene, LAYER_A, LAYER_B,
+                         CONTACT_BEGIN | CONTACT_PERSIST | CONTACT_END,
+                         count_events, events, free);
+
+  scene_tick(scene, 0);
+  assert(scene_bodies(scene) == 1);
+  assert(scene_contacts(scene) == 0);
+  assert(events->begins == 1 && events->ends == 1);
+  scene_tick(scene, 0);
+  scene_tick(scene, 0);
+  assert(events->begins == 1 && events->persists == 0 && events->ends == 1);
+
+  body_t *c = make_layered_body(LAYER_B, LAYER_A, (vector_t){98.5, 100});
+  scene_add_body(scene, c);
+  scene_tick(scene, 0);
+  assert(events->begins == 2 && events->persists == 0 && events->ends == 2);
+  assert(scene_bodies(scene) == 1 && scene_contacts(scene) == 0);
+  scene_free(scene);
+}
+
+/*
+    This test checks that a bullet which passes through two walls in a tick
+    is moved back to the first one, however many contacts it has.
+*/
+void stop_bullet(body_t *body1, body_t *body2, vector_t axis, void *aux) {
+  body_set_velocity(body1, VEC_ZERO);
+}
+
+void test_bullet_hits_two_bodies() {
+  const size_t LAYER_BULLET = 1 << 0, LAYER_WALL = 1 << 1;
+  scene_t *scene = scene_init();
+  body_t *bullet =
+      make_layered_body(LAYER_BULLET, LAYER_WALL, (vector_t){0, 100});
+  body_set_bullet(bullet, true);
+  body_set_velocity(bullet, (vector_t){500, 0});
+  scene_add_body(scene, bullet);
+  body_t *near =
+      make_layered_body(LAYER_WALL, LAYER_BULLET, (vector_t){30, 100});
+  body_t *far =
+      make_layered_body(LAYER_WALL, LAYER_BULLET, (vector_t){60, 100});
+  scene_add_static_body(scene, near);
+  scene_add_static_body(scene, far);
+  scene_add_collision_rule(scene, LAYER_BULLET, LAYER_WALL, stop_bullet, NULL,
+                           NULL);
+
+  // the first tick moves the bullet past both walls, the second finds them
+  scene_tick(scene, 0.2);
+  assert(vec_isclose(body_get_centroid(bullet), (vector_t){100, 100}));
+  scene_tick(scene, 0.2);
+  assert(scene_contacts(scene) == 2);
+  double near_time = scene_find_contact(scene, bullet, near)->time;
+  double far_time = scene_find_contact(scene, bullet, far)->time;
+  assert(isclose(near_time, 0.28) && isclose(far_time, 0.58));
+  assert(vec_isclose(body_get_centroid(bullet), (vector_t){28, 100}));
+  scene_free(scene);
+}
+
+/*
+    This test checks that collision handlers only run once every collision
+    of the tick has been found, grouped by handler:
+    moving a body away in one handler does not hide its other contacts.
+*/
+typedef struct {
+  scene_t *scene;
+  char log[8];
+  size_t calls;
+} deferred_aux_t;
+void push_away(body_t *body1, body_t *body2, vector_t axis, void *aux) {
+  deferred_aux_t *deferred = aux;
+  assert(scene_contacts(deferred->scene) == 2);
+  deferred->log[deferred->calls++] = 'p';
+  body_set_centroid(body2, (vector_t){500, 500});
+}
+void log_contact(body_t *body1, body_t *body2, vector_t axis, void *aux) {
+  deferred_aux_t *deferred = aux;
+  assert(scene_contacts(deferred->scene) == 2);
+  deferred->log[deferred->calls++] = 'l';
+}
+
+void test_deferred_handlers() {
+  const size_t LAYER_A = 1 << 0, LAYER_B = 1 << 1;
+  scene_t *scene = scene_init();
+  body_t *a = make_layered_body(LAYER_A, LAYER_B, (vector_t){100, 100});
+  body_t *b = make_layered_body(LAYER_B, LAYER_A, (vector_t){101.5, 100});
+  body_t *c = make_layered_body(LAYER_B, LAYER_A, (vector_t){98.5, 100});
+  scene_add_body(scene, a);
+  scene_add_body(scene, b);
+  scene_add_body(scene, c);
+  deferred_aux_t *deferred = malloc(sizeof(deferred_aux_t));
+  *deferred = (deferred_aux_t){scene, {0}, 0};
+  scene_add_collision_rule(scene, LAYER_A, LAYER_B, push_away, deferred,
+                           NULL);
+  scene_add_collision_rule(scene, LAYER_B, LAYER_A, log_contact, deferred,
+                           free);
+
+  scene_tick(scene, 0);
+  assert(deferred->calls == 4);
+  assert(deferred->log[0] == deferred->log[1]);
+  assert(deferred->log[2] == deferred->log[3]);
+  assert(deferred->log[0] != deferred->log[2]);
+  scene_free(scene);
+}
+
+void test_raycast() {
+  const size_t LAYER_A = 1 << 0, LAYER_WALL = 1 << 1;
+  scene_t *scene = scene_init();
+  body_t *a = make_layered_body(LAYER_A, LAYER_WALL, (vector_t){100, 100});
+  body_t *near = make_layered_body(LAYER_A, LAYER_WALL, (vector_t){105, 100});
+  body_t *wall = make_layered_body(LAYER_WALL, LAYER_A, (vector_t){110, 100});
+  scene_add_body(scene, a);
+  scene_add_body(scene, near);
+  scene_add_static_body(scene, wall);
+
+  // the ray starts inside a, so passes through it to near
+  ray_hit_t hit = scene_raycast(scene, (vector_t){100, 100}, (vector_t){2, 0},
+                                100, LAYER_A | LAYER_WALL);
+  assert(hit.body == near && isclose(hit.distance, 4));
+  assert(vec_isclose(hit.point, (vector_t){104, 100}));
+  assert(vec_isclose(hit.normal, (vector_t){-1, 0}));
+  hit = scene_raycast(scene, (vector_t){100, 100}, (vector_t){1, 0}, 100,
+                      LAYER_WALL);
+  assert(hit.body == wall && isclose(hit.distance, 9));
+  assert(scene_raycast(scene, (vector_t){100, 100}, (vector_t){1, 0}, 8,
+                       LAYER_WALL)
+             .body == NULL);
+  assert(scene_raycast(scene, (vector_t){100, 100}, (vector_t){0, 1}, 100,
+                       LAYER_A | LAYER_WALL)
+             .body == NULL);
+
+  hit = scene_segment_query(scene, (vector_t){120, 100}, (vector_t){100, 100},
+                            LAYER_A | LAYER_WALL);
+  assert(hit.body == wall && isclose(hit.distance, 9));
+  assert(vec_isclose(hit.normal, (vector_t){1, 0}));
+  body_remove(wall);
+  hit = scene_segment_query(scene, (vector_t){120, 100}, (vector_t){100, 100},
+                            LAYER_A | LAYER_WALL);
+  assert(hit.body == near);
+  scene_free(scene);
+}
+
+// Moving bodies are only tested if the ray crosses their cells in the index
+void test_raycast_walks_index() {
+  const size_t LAYER_A = 1 << 0;
+  scene_t *scene = scene_init();
+  body_t *behind = make_layered_body(LAYER_A, 0, (vector_t){100, 100});
+  body_t *off = make_layered_body(LAYER_A, 0, (vector_t){700, 900});
+  scene_add_body(scene, behind);
+  scene_add_body(scene, off);
+  scene_tick(scene, 0.01);
+
+  // on the ray now, but still indexed in a cell the ray never enters
+  body_set_centroid(off, (vector_t){300, 100});
+  assert(scene_raycast(scene, (vector_t){150, 100}, (vector_t){1, 0}, 1000,
+                       LAYER_A)
+             .body == NULL);
+  scene_tick(scene, 0.01);
+  ray_hit_t hit = scene_raycast(scene, (vector_t){150, 100}, (vector_t){1, 0},
+                                1000, LAYER_A);
+  assert(hit.body == off && isclose(hit.distance, 149));
+  scene_free(scene);
+}
+
+bool has_body(body_t **bodies, size_t count, body_t *body) {
+  for (size_t i = 0; i < count; i++) {
+    if (bodies[i] == body) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void test_region_queries() {
+  const size_t LAYER_A = 1 << 0, LAYER_WALL = 1 << 1;
+  scene_t *scene = scene_init();
+  body_t *a = make_layered_body(LAYER_A, 0, (vector_t){100, 100});
+  body_t *far = make_layered_body(LAYER_A, 0, (vector_t){300, 100});
+  body_t *wall = make_layered_body(LAYER_WALL, 0, (vector_t){110, 100});
+  body_t *plain = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_centroid(plain, (vector_t){100, 110});
+  scene_add_body(scene, a);
+  scene_add_body(scene, far);
+  scene_add_static_body(scene, wall);
+  scene_add_body(scene, plain);
+
+  body_t *found[4];
+  aabb_t box = {{95, 95}, {115, 105}};
+  size_t count = scene_query_aabb(scene, box, LAYER_A | LAYER_WALL, found, 4);
+  assert(count == 2 && has_body(found, count, a) &&
+         has_body(found, count, wall));
+  count = scene_query_aabb(scene, box, LAYER_WALL, found, 4);
+  assert(count == 1 && found[0] == wall);
+  // only SIZE_MAX finds bodies on no layer
+  count = scene_query_aabb(scene, (aabb_t){{90, 90}, {120, 120}}, SIZE_MAX,
+                           found, 4);
+  assert(count == 3 && has_body(found, count, plain));
+
+  // the radius reaches the edges of a and the wall, but not plain's corner
+  count = scene_query_radius(scene, (vector_t){105, 100}, 4.5, SIZE_MAX,
+                             found, 4);
+  assert(count == 2 && has_body(found, count, a) &&
+         has_body(found, count, wall));
+  count = scene_query_radius(scene, (vector_t){105, 100}, 3.5, SIZE_MAX,
+                             found, 4);
+  assert(count == 0);
+
+  // a full buffer still counts every body
+  count = scene_query_aabb(scene, (aabb_t){{0, 0}, {400, 200}}, SIZE_MAX,
+                           found, 2);
+  assert(count == 4);
+
+  // the index follows bodies as they move and leaves out removed ones
+  body_set_velocity(far, (vector_t){-100, 0});
+  scene_tick(scene, 1);
+  count = scene_query_aabb(scene, (aabb_t){{190, 90}, {210, 110}}, LAYER_A,
+                           found, 4);
+  assert(count == 1 && found[0] == far);
+  assert(scene_query_aabb(scene, (aabb_t){{290, 90}, {310, 110}}, LAYER_A,
+                          found, 4) == 0);
+  body_set_velocity(far, VEC_ZERO);
+  body_remove(a);
+  count = scene_query_radius(scene, (vector_t){100, 100}, 20, SIZE_MAX,
+                             found, 4);
+  assert(count == 2 && !has_body(found, count, a));
+  scene_tick(scene, 1);
+  count = scene_query_radius(scene, (vector_t){100, 100}, 20, SIZE_MAX,
+                             found, 4);
+  assert(count == 2 && !has_body(found, count, a));
+  scene_free(scene);
+}
+
+// enough touching pairs to be split between several threads
+const size_t ROW_LENGTH = 400;
+
+typedef struct pair_log {
+  size_t *pairs;
+  size_t count;
+} pair_log_t;
+void log_pair(body_t *body1, body_t *body2, vector_t axis, void *aux) {
+  pair_log_t *log = aux;
+  log->pairs[log->count++] = *(size_t *)body_get_info(body1);
+  log->pairs[log->count++] = *(size_t *)body_get_info(body2);
+}
+
+/**
+ * Ticks a row of overlapping bodies in a scene with the given thread count,
+ * returning the order the collision handler saw the pairs in.
+ */
+pair_log_t run_row(size_t threads) {
+  scene_t *scene = scene_init_with_threads(threads);
+  for (size_t i = 0; i < ROW_LENGTH; i++) {
+    size_t *index = malloc(sizeof(size_t));
+    *index = i;
+    body_t *body = body_init_with_info(make_shape(), 1, (rgb_color_t){0, 0, 0},
+                                       index, free);
+    body_set_collision_layers(body, 1, 1);
+    // shuffled, so the pairs are not found in the order the bodies were added
+    body_set_centroid(body, (vector_t){100 + 1.5 * (i * 7 % ROW_LENGTH), 100});
+    scene_add_body(scene, body);
+  }
+  pair_log_t *log = malloc(sizeof(pair_log_t));
+  log->pairs = malloc(sizeof(size_t) * 2 * ROW_LENGTH);
+  log->count = 0;
+  scene_add_collision_rule(scene, 1, 1, log_pair, log, NULL);
+  scene_tick(scene, 0);
+  assert(scene_contacts(scene) == ROW_LENGTH - 1);
+  assert(log->count == 2 * (ROW_LENGTH - 1));
+  scene_free(scene);
+  pair_log_t result = *log;
+  free(log);
+  return result;
+}
+
+void test_threaded_narrow_phase() {
+  scene_t *scene = scene_init_with_threads(4);
+  assert(scene_threads(scene) == 4);
+  scene_free(scene);
+
+  pair_log_t serial = run_row(1);
+  pair_log_t threaded = run_row(4);
+  assert(threaded.count == serial.count);
+  for (size_t i = 0; i < serial.count; i++) {
+    assert(threaded.pairs[i] == serial.pairs[i]);
+  }
+  free(serial.pairs);
+  free(threaded.pairs);
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -241,6 +904,19 @@ int main(int argc, char *argv[]) {
 
   DO_TEST(test_empty_scene)
   DO_TEST(test_scene)
+  DO_TEST(test_scene_keeps_body_state)
+  DO_TEST(test_batched_forces)
+  DO_TEST(test_pooled_force_creators)
+  DO_TEST(test_collision_rules)
+  DO_TEST(test_static_bodies)
+  DO_TEST(test_contact_events)
+  DO_TEST(test_deferred_handlers)
+  DO_TEST(test_handler_removes_body)
+  DO_TEST(test_bullet_hits_two_bodies)
+  DO_TEST(test_threaded_narrow_phase)
+  DO_TEST(test_raycast)
+  DO_TEST(test_raycast_walks_index)
+  DO_TEST(test_region_queries)
   // these two tests are deprecated due to the new scene force handling
   // DO_TEST(test_force_creator)
   // DO_TEST(test_force_creator_aux)
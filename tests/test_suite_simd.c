@@ -0,0 +1,103 @@
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "simd.h"
+#include "test_util.h"
+
+// covers empty arrays, the vector loops and every length of leftover tail
+const size_t MAX_POINTS = 21;
+
+vector_t *make_points(size_t count) {
+  vector_t *points = malloc(sizeof(vector_t) * (count > 0 ? count : 1));
+  assert(points != NULL);
+  for (size_t i = 0; i < count; i++) {
+    points[i] = (vector_t){rand() % 2000 - 1000.0, rand() % 2000 - 1000.0};
+  }
+  return points;
+}
+
+void test_scalar_first() {
+  const simd_kernels_t *const *kernels;
+  size_t count = simd_kernels_supported(&kernels);
+  assert(count >= 1);
+  assert(strcmp(kernels[0]->name, "scalar") == 0);
+  // the best supported kernels are picked by default
+  assert(simd_kernels_get() == kernels[count - 1]);
+}
+
+// Every instruction set gives the scalar kernels' results
+void test_matches_scalar() {
+  const simd_kernels_t *const *kernels;
+  size_t kernel_count = simd_kernels_supported(&kernels);
+  const simd_kernels_t *scalar = kernels[0];
+  for (size_t k = 1; k < kernel_count; k++) {
+    const simd_kernels_t *simd = kernels[k];
+    for (size_t count = 0; count <= MAX_POINTS; count++) {
+      vector_t *expected = make_points(count);
+      vector_t *actual = malloc(sizeof(vector_t) * (count > 0 ? count : 1));
+      for (size_t i = 0; i < count; i++) {
+        actual[i] = expected[i];
+      }
+
+      vector_t axis = {0.6, -0.8};
+      double expected_min, expected_max, actual_min, actual_max;
+      scalar->project(expected, count, axis, &expected_min, &expected_max);
+      simd->project(actual, count, axis, &actual_min, &actual_max);
+      assert(isclose(expected_min, actual_min) ||
+             expected_min == actual_min);
+      assert(isclose(expected_max, actual_max) ||
+             expected_max == actual_max);
+
+      scalar->translate(expected, count, (vector_t){3.5, -7});
+      simd->translate(actual, count, (vector_t){3.5, -7});
+      scalar->transform(expected, expected, count, cos(1.2), sin(1.2),
+                        (vector_t){10, 20}, (vector_t){-5, 4});
+      simd->transform(actual, actual, count, cos(1.2), sin(1.2),
+                      (vector_t){10, 20}, (vector_t){-5, 4});
+      for (size_t i = 0; i < count; i++) {
+        assert(vec_isclose(expected[i], actual[i]));
+      }
+      free(expected);
+      free(actual);
+    }
+  }
+}
+
+void test_empty_projection() {
+  const simd_kernels_t *const *kernels;
+  size_t kernel_count = simd_kernels_supported(&kernels);
+  for (size_t k = 0; k < kernel_count; k++) {
+    double min, max;
+    kernels[k]->project(NULL, 0, (vector_t){1, 0}, &min, &max);
+    assert(min == INFINITY && max == -INFINITY);
+  }
+}
+
+void test_use_kernels() {
+  const simd_kernels_t *const *kernels;
+  size_t kernel_count = simd_kernels_supported(&kernels);
+  const simd_kernels_t *best = simd_kernels_get();
+  simd_kernels_use(kernels[0]);
+  assert(simd_kernels_get() == kernels[0]);
+  simd_kernels_use(kernels[kernel_count - 1]);
+  assert(simd_kernels_get() == best);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_scalar_first)
+  DO_TEST(test_matches_scalar)
+  DO_TEST(test_empty_projection)
+  DO_TEST(test_use_kernels)
+
+  puts("simd_test PASS");
+}
@@ -0,0 +1,65 @@
+#include "test_util.h"
+#include "timestep.h"
+#include <assert.h>
+#include <stdlib.h>
+
+const double HZ = 100.0;
+const size_t MAX_STEPS = 4;
+
+void test_timestep_init() {
+  timestep_t *timestep = timestep_init(HZ, MAX_STEPS);
+  assert(isclose(timestep_get_dt(timestep), 1 / HZ));
+  assert(timestep_get_alpha(timestep) == 0);
+  assert(timestep_advance(timestep, 0) == 0);
+  assert(timestep_advance(timestep, -1) == 0);
+  assert(timestep_get_dropped(timestep) == 0);
+  timestep_free(timestep);
+}
+
+// Partial ticks are carried over from frame to frame
+void test_timestep_carry() {
+  timestep_t *timestep = timestep_init(HZ, MAX_STEPS);
+  assert(timestep_advance(timestep, 0.004) == 0);
+  assert(isclose(timestep_get_alpha(timestep), 0.4));
+  assert(timestep_advance(timestep, 0.008) == 1);
+  assert(isclose(timestep_get_alpha(timestep), 0.2));
+  assert(timestep_advance(timestep, 0.025) == 2);
+  assert(isclose(timestep_get_alpha(timestep), 0.7));
+
+  // frames of any length add up to the same number of ticks
+  size_t steps = 0;
+  for (size_t i = 0; i < 300; i++) {
+    steps += timestep_advance(timestep, 1.0 / 60);
+  }
+  assert(steps == 500);
+  assert(timestep_get_dropped(timestep) == 0);
+  timestep_free(timestep);
+}
+
+// A long frame runs at most the step limit, dropping whole ticks
+void test_timestep_catch_up() {
+  timestep_t *timestep = timestep_init(HZ, MAX_STEPS);
+  assert(timestep_advance(timestep, 0.105) == MAX_STEPS);
+  assert(isclose(timestep_get_alpha(timestep), 0.5));
+  assert(isclose(timestep_get_dropped(timestep), 0.06));
+  // nothing dropped is run on later frames
+  assert(timestep_advance(timestep, 0.005) == 1);
+  assert(timestep_get_alpha(timestep) < 1e-6);
+  timestep_free(timestep);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_timestep_init)
+  DO_TEST(test_timestep_carry)
+  DO_TEST(test_timestep_catch_up)
+
+  puts("timestep_test PASS");
+}
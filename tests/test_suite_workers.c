@@ -0,0 +1,53 @@
+#include "test_util.h"
+#include "workers.h"
+#include <assert.h>
+#include <stdlib.h>
+
+const size_t WORKER_COUNT = 4;
+const size_t JOB_COUNT = 100;
+
+/** Counts how many times each worker has run a job. */
+void count_run(size_t worker, void *aux) {
+  size_t *runs = aux;
+  runs[worker]++;
+}
+
+void test_single_worker() {
+  worker_pool_t *pool = worker_pool_init(0);
+  assert(worker_pool_size(pool) == 1);
+  size_t runs[1] = {0};
+  worker_pool_run(pool, count_run, runs);
+  assert(runs[0] == 1);
+  worker_pool_free(pool);
+}
+
+// Every worker runs every job exactly once, and the pool can be reused
+void test_many_jobs() {
+  worker_pool_t *pool = worker_pool_init(WORKER_COUNT);
+  assert(worker_pool_size(pool) == WORKER_COUNT);
+  size_t *runs = calloc(WORKER_COUNT, sizeof(size_t));
+  assert(runs != NULL);
+  for (size_t i = 1; i <= JOB_COUNT; i++) {
+    worker_pool_run(pool, count_run, runs);
+    for (size_t w = 0; w < WORKER_COUNT; w++) {
+      assert(runs[w] == i);
+    }
+  }
+  free(runs);
+  worker_pool_free(pool);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_single_worker)
+  DO_TEST(test_many_jobs)
+
+  puts("workers_test PASS");
+}